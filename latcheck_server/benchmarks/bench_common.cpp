@@ -0,0 +1,220 @@
+#include "bench_common.h"
+
+#include "config/config_manager.h"
+#include "logger/logger.h"
+#include "database/database_pool.h"
+#include "database/server_dao.h"
+#include "latency/latency_matrix.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QTemporaryFile>
+#include <QSqlQuery>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <time.h>
+
+const char *BenchDatabase::kUserName = "latcheck-bench";
+const char *BenchDatabase::kServerPrefix = "latcheck-bench-server-";
+
+bool initBenchEnvironment(const BenchOptions &options)
+{
+    QString configPath = options.configPath;
+
+    // ConfigManager只能从文件加载，覆盖项写入临时的配置文件
+    QTemporaryFile overridden;
+    if (!options.databaseOverrides.isEmpty())
+    {
+        QFile file(options.configPath);
+        QJsonObject root;
+        if (file.open(QIODevice::ReadOnly))
+        {
+            root = QJsonDocument::fromJson(file.readAll()).object();
+        }
+        QJsonObject database = root.value("database").toObject();
+        for (auto it = options.databaseOverrides.constBegin(); it != options.databaseOverrides.constEnd(); ++it)
+        {
+            database.insert(it.key(), it.value());
+        }
+        root.insert("database", database);
+
+        if (!overridden.open() || overridden.write(QJsonDocument(root).toJson()) < 0 || !overridden.flush())
+        {
+            printLine("Failed to write overridden configuration");
+            return false;
+        }
+        configPath = overridden.fileName();
+    }
+
+    if (!ConfigManager::instance()->loadConfig(configPath))
+    {
+        printLine(QString("Failed to load configuration: %1").arg(options.configPath));
+        return false;
+    }
+
+    LogConfig logConfig = ConfigManager::instance()->getLogConfig();
+    logConfig.level = "warning";
+    logConfig.enableFile = false;
+    return Logger::instance()->initialize(logConfig);
+}
+
+BenchDatabase::BenchDatabase(const BenchOptions &options)
+    : config_(ConfigManager::instance()->getDatabaseConfig()), open_(false)
+{
+    config_.backend = options.backend;
+    config_.maxConnections = qMax(1, options.connections);
+    config_.minConnections = qMin(config_.minConnections, config_.maxConnections);
+    if (config_.backend == "sqlite")
+    {
+        temp_dir_ = std::make_unique<QTemporaryDir>();
+        if (!temp_dir_->isValid())
+        {
+            printLine("Failed to create temporary directory for SQLite database");
+            return;
+        }
+        config_.sqlitePath = temp_dir_->filePath("bench.db");
+    }
+
+    open_ = DatabasePool::instance()->initialize(config_);
+    if (!open_)
+    {
+        printLine(QString("Failed to open %1 database").arg(config_.backend));
+        return;
+    }
+
+    // 上次中断的运行可能留下数据
+    cleanup();
+}
+
+BenchDatabase::~BenchDatabase()
+{
+    if (open_)
+    {
+        cleanup();
+    }
+    // 每项测试使用新的连接池，统计从零开始
+    DatabasePool::destroyInstance();
+    temp_dir_.reset();
+}
+
+QList<ServerInfo> BenchDatabase::seedServers(int count)
+{
+    QList<ServerCatalogEntry> entries;
+    entries.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        ServerCatalogEntry entry;
+        entry.location = QString("%1%2").arg(kServerPrefix).arg(i, 5, 10, QChar('0'));
+        entry.ipAddr = 0x0A000000u + static_cast<quint32>(i) + 1; // 10.0.0.0/8
+        entries.append(entry);
+    }
+
+    ServerDAO serverDao;
+    if (!serverDao.upsertServers(entries, config_.insertChunkSize))
+    {
+        return QList<ServerInfo>();
+    }
+
+    // 只取本次写入的服务器（MySQL的测试库中可能还有其他服务器）
+    QList<ServerInfo> servers;
+    DatabaseConnection conn;
+    QSqlQuery query(conn.database());
+    query.prepare("SELECT server_id, ip_addr FROM test_server WHERE location LIKE ? ORDER BY server_id");
+    query.addBindValue(QString("%1%").arg(kServerPrefix));
+    if (query.exec())
+    {
+        while (query.next())
+        {
+            servers.append(ServerInfo(query.value(0).toUInt(), query.value(1).toUInt()));
+        }
+    }
+    return servers;
+}
+
+qint64 BenchDatabase::storageBytes()
+{
+    DatabaseConnection conn;
+    QSqlQuery query(conn.database());
+    if (config_.backend == "sqlite")
+    {
+        qint64 pages = 0;
+        qint64 pageSize = 0;
+        qint64 freePages = 0;
+        if (query.exec("PRAGMA page_count") && query.next())
+        {
+            pages = query.value(0).toLongLong();
+        }
+        if (query.exec("PRAGMA page_size") && query.next())
+        {
+            pageSize = query.value(0).toLongLong();
+        }
+        if (query.exec("PRAGMA freelist_count") && query.next())
+        {
+            freePages = query.value(0).toLongLong();
+        }
+        return (pages - freePages) * pageSize;
+    }
+
+    query.exec("ANALYZE TABLE latcheck_report, report_record, report_latency_blob");
+    if (query.exec("SELECT SUM(data_length + index_length) FROM information_schema.tables "
+                   "WHERE table_schema = DATABASE() AND table_name IN ('latcheck_report', 'report_record', 'report_latency_blob')") &&
+        query.next())
+    {
+        return query.value(0).toLongLong();
+    }
+    return 0;
+}
+
+void BenchDatabase::cleanup()
+{
+    // report_record、report_latency_blob和calculated_latencies随报告级联删除
+    DatabaseConnection conn;
+    QSqlQuery query(conn.database());
+    query.prepare("DELETE FROM latcheck_report WHERE user_name = ?");
+    query.addBindValue(QString(kUserName));
+    query.exec();
+
+    query.prepare("DELETE FROM test_server WHERE location LIKE ?");
+    query.addBindValue(QString("%1%").arg(kServerPrefix));
+    query.exec();
+}
+
+QList<ReportRecord> makeRecords(const QList<ServerInfo> &servers, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    QList<ReportRecord> records;
+    records.reserve(servers.size());
+    for (const ServerInfo &server : servers)
+    {
+        ReportRecord record;
+        record.serverId = server.serverId;
+        record.serverIp = server.ipAddr;
+        record.latency = random.bounded(10) == 0 ? LatencyMatrix::kUnreachableLatency : static_cast<int>(1 + random.bounded(400));
+        records.append(record);
+    }
+    return records;
+}
+
+qint64 threadCpuUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+void printHistogram(const QString &name, const LatencyHistogram &histogram)
+{
+    printLine(QString("  %1: n=%2 mean=%3us p50=%4us p99=%5us max=%6us")
+                  .arg(name, -28)
+                  .arg(histogram.count())
+                  .arg(histogram.mean(), 0, 'f', 1)
+                  .arg(histogram.percentile(50))
+                  .arg(histogram.percentile(99))
+                  .arg(histogram.max()));
+}
+
+void printLine(const QString &line)
+{
+    static QTextStream out(stdout);
+    out << line << Qt::endl;
+}
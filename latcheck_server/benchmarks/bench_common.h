@@ -0,0 +1,90 @@
+#ifndef BENCHCOMMON_H
+#define BENCHCOMMON_H
+
+#include <QString>
+#include <QList>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <memory>
+
+#include "common/types.h"
+#include "common/latency_histogram.h"
+#include "protocol/message_protocol.h"
+
+// 基准测试参数，命令行中以--name value指定
+struct BenchOptions
+{
+    QString configPath = "config/config.json";
+    QString backend = "sqlite"; // sqlite使用临时数据库文件；mysql使用配置文件中的数据库
+    int threads = 16;           // pool_contention：并发线程数
+    int connections = 4;        // 连接池上限
+    int iterations = 2000;      // 每个线程/每项测量的重复次数
+    int servers = 500;          // 每个报告的记录数（测试服务器数）
+    int reports = 2000;         // ingest/report_paging：写入的报告数
+    int groupSize = 64;         // ingest：每个事务包含的报告数
+    int locations = 10000;      // latency_*：检测地点数
+    int topK = 20;              // latency_topk：top-K查询的K
+    int pipeline = 8;           // rest_load：每个连接未完成的请求数
+    QString apiUser;            // rest_load：REST接口的登录用户
+    QString apiPassword;
+    QJsonObject databaseOverrides; // 覆盖配置文件database部分的项（DAO从配置中读取）
+};
+
+// 基准测试使用的数据库：按options选择后端初始化连接池，结束时删除写入的数据。
+// SQLite数据库建在临时目录中，不影响配置文件中的数据库；
+// MySQL直接写入配置的数据库，应指向专用的测试库
+class BenchDatabase
+{
+public:
+    explicit BenchDatabase(const BenchOptions &options);
+    ~BenchDatabase();
+
+    bool isOpen() const { return open_; }
+    QString backendName() const { return config_.backend; }
+
+    // 写入count个测试服务器，返回其ID和IP
+    QList<ServerInfo> seedServers(int count);
+
+    // 报告相关表占用的存储空间（字节）。SQLite为整个数据库文件的已用页，
+    // MySQL为information_schema中报告表的数据和索引大小（先更新统计信息）
+    qint64 storageBytes();
+
+    static const char *kUserName;
+    static const char *kServerPrefix;
+
+private:
+    void cleanup();
+
+    DatabaseConfig config_;
+    std::unique_ptr<QTemporaryDir> temp_dir_;
+    bool open_;
+};
+
+// 加载配置文件（应用databaseOverrides）并初始化日志（只输出警告以上的日志）
+bool initBenchEnvironment(const BenchOptions &options);
+
+// 为servers生成一个报告的记录，约10%不可达，seed相同时结果相同
+QList<ReportRecord> makeRecords(const QList<ServerInfo> &servers, quint32 seed);
+
+// 当前线程消耗的CPU时间（微秒）
+qint64 threadCpuUs();
+
+// 输出一行结果：名称、次数、均值和百分位（微秒）
+void printHistogram(const QString &name, const LatencyHistogram &histogram);
+void printLine(const QString &line);
+
+// 各项基准测试，返回false表示测试无法运行
+bool benchPoolContention(const BenchOptions &options);
+bool benchIngest(const BenchOptions &options);
+bool benchReportPaging(const BenchOptions &options);
+bool benchRecordFetch(const BenchOptions &options);
+bool benchLatencyEngine(const BenchOptions &options);
+bool benchLatencyMatrix(const BenchOptions &options);
+bool benchLatencyTopK(const BenchOptions &options);
+bool benchServerIndex(const BenchOptions &options);
+bool benchTlsResume(const BenchOptions &options);
+bool benchFrameBuffer(const BenchOptions &options);
+bool benchRestLoad(const BenchOptions &options);
+bool benchListResponse(const BenchOptions &options);
+
+#endif // BENCHCOMMON_H
@@ -0,0 +1,381 @@
+#include "bench_common.h"
+
+#include "config/config_manager.h"
+#include "database/database_pool.h"
+#include "database/report_dao.h"
+#include "database/column_index.h"
+
+#include <QThread>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QAtomicInt>
+#include <QRandomGenerator>
+#include <vector>
+
+// 连接池争用：threads个线程共享connections个连接，每次借出连接执行SELECT 1后归还
+bool benchPoolContention(const BenchOptions &options)
+{
+    BenchDatabase db(options);
+    if (!db.isOpen())
+    {
+        return false;
+    }
+
+    printLine(QString("pool_contention: backend=%1 threads=%2 connections=%3 iterations=%4")
+                  .arg(db.backendName())
+                  .arg(options.threads)
+                  .arg(options.connections)
+                  .arg(options.iterations));
+
+    // 直方图只允许一个线程写入，每个线程一个，结束后合并
+    std::vector<std::unique_ptr<LatencyHistogram>> histograms;
+    QList<QThread *> threads;
+    QAtomicInt failures(0);
+    for (int i = 0; i < options.threads; ++i)
+    {
+        histograms.push_back(std::make_unique<LatencyHistogram>());
+        LatencyHistogram *histogram = histograms.back().get();
+        threads.append(QThread::create(
+            [histogram, &failures, &options]()
+            {
+                for (int n = 0; n < options.iterations; ++n)
+                {
+                    qint64 startUs = LatencyStats::nowUs();
+                    {
+                        DatabaseConnection conn;
+                        if (!conn.isValid())
+                        {
+                            failures.ref();
+                            continue;
+                        }
+                        QSqlQuery query(conn.database());
+                        if (!query.exec("SELECT 1") || !query.next())
+                        {
+                            failures.ref();
+                        }
+                    }
+                    histogram->record(LatencyStats::nowUs() - startUs);
+                }
+                DatabasePool::instance()->releaseThreadConnections();
+            }));
+    }
+
+    qint64 startUs = LatencyStats::nowUs();
+    for (QThread *thread : std::as_const(threads))
+    {
+        thread->start();
+    }
+    for (QThread *thread : std::as_const(threads))
+    {
+        thread->wait();
+    }
+    qint64 elapsedUs = LatencyStats::nowUs() - startUs;
+    qDeleteAll(threads);
+
+    LatencyHistogram total;
+    for (const auto &histogram : histograms)
+    {
+        total.merge(*histogram);
+    }
+
+    DatabasePool *pool = DatabasePool::instance();
+    printLine(QString("  throughput: %1 ops/s, %2 failures, %3 acquire timeouts")
+                  .arg(total.count() * 1000000.0 / qMax<qint64>(1, elapsedUs), 0, 'f', 0)
+                  .arg(failures.loadRelaxed())
+                  .arg(pool->getAcquireTimeouts()));
+    printHistogram("borrow + SELECT 1 + return", total);
+    printHistogram("acquire wait", pool->getAcquireWaitHistogram());
+    return true;
+}
+
+// 报告写入：按groupSize个报告一个事务（组提交）写入reports个报告，再随机读回
+bool benchIngest(const BenchOptions &options)
+{
+    BenchDatabase db(options);
+    if (!db.isOpen())
+    {
+        return false;
+    }
+
+    QList<ServerInfo> servers = db.seedServers(options.servers);
+    if (servers.size() != options.servers)
+    {
+        printLine("Failed to seed test servers");
+        return false;
+    }
+
+    DatabaseConfig config = ConfigManager::instance()->getDatabaseConfig();
+    printLine(QString("ingest: backend=%1 record_storage=%2 reports=%3 servers=%4 group_size=%5 insert_chunk_size=%6")
+                  .arg(db.backendName())
+                  .arg(config.recordStorage)
+                  .arg(options.reports)
+                  .arg(options.servers)
+                  .arg(options.groupSize)
+                  .arg(config.insertChunkSize));
+
+    qint64 storageBefore = db.storageBytes();
+
+    ReportDAO reportDao;
+    LatencyHistogram groupHistogram;
+    QList<qint64> reportIds;
+    int failures = 0;
+
+    qint64 startUs = LatencyStats::nowUs();
+    for (int first = 0; first < options.reports; first += options.groupSize)
+    {
+        int count = qMin(options.groupSize, options.reports - first);
+        QList<Report> reports;
+        QList<QList<ReportRecord>> records;
+        for (int i = first; i < first + count; ++i)
+        {
+            Report report;
+            report.userName = BenchDatabase::kUserName;
+            report.location = QString("bench-location-%1").arg(i % 100);
+            reports.append(report);
+            records.append(makeRecords(servers, static_cast<quint32>(i)));
+        }
+
+        QList<qint64> ids;
+        qint64 groupStartUs = LatencyStats::nowUs();
+        QList<ErrorCode> results = reportDao.createReportGroup(reports, records, &ids);
+        groupHistogram.record(LatencyStats::nowUs() - groupStartUs);
+
+        for (int i = 0; i < results.size(); ++i)
+        {
+            if (results.at(i) == ErrorCode::Success)
+            {
+                reportIds.append(ids.at(i));
+            }
+            else
+            {
+                ++failures;
+            }
+        }
+    }
+    qint64 elapsedUs = qMax<qint64>(1, LatencyStats::nowUs() - startUs);
+
+    printLine(QString("  write: %1 reports/s, %2 records/s, %3 us/report, %4 failures")
+                  .arg(options.reports * 1000000.0 / elapsedUs, 0, 'f', 1)
+                  .arg(static_cast<double>(options.reports) * options.servers * 1000000.0 / elapsedUs, 0, 'f', 0)
+                  .arg(static_cast<double>(elapsedUs) / qMax(1, options.reports), 0, 'f', 1)
+                  .arg(failures));
+    // 事务从开始到提交的时间，即事务持有锁的时间
+    printHistogram("transaction hold", groupHistogram);
+
+    qint64 storedBytes = db.storageBytes() - storageBefore;
+    printLine(QString("  storage: %1 MB, %2 bytes/record")
+                  .arg(storedBytes / (1024.0 * 1024.0), 0, 'f', 1)
+                  .arg(static_cast<double>(storedBytes) / qMax<qint64>(1, static_cast<qint64>(options.reports) * options.servers), 0, 'f', 1));
+
+    if (reportIds.isEmpty())
+    {
+        return failures == 0;
+    }
+
+    LatencyHistogram readHistogram;
+    QRandomGenerator random(1);
+    int reads = qMin(options.iterations, static_cast<int>(reportIds.size()));
+    for (int i = 0; i < reads; ++i)
+    {
+        qint64 reportId = reportIds.at(random.bounded(static_cast<int>(reportIds.size())));
+        qint64 readStartUs = LatencyStats::nowUs();
+        QList<ReportRecord> records = reportDao.getReportRecords(reportId);
+        readHistogram.record(LatencyStats::nowUs() - readStartUs);
+        if (records.size() != options.servers)
+        {
+            ++failures;
+        }
+    }
+    printHistogram("read report records", readHistogram);
+    return failures == 0;
+}
+
+// 报告列表分页：同一深度的一页分别用OFFSET和键集（created_time, report_id）读取
+bool benchReportPaging(const BenchOptions &options)
+{
+    BenchDatabase db(options);
+    if (!db.isOpen())
+    {
+        return false;
+    }
+
+    const int pageSize = 100;
+    printLine(QString("report_paging: backend=%1 reports=%2 page_size=%3")
+                  .arg(db.backendName())
+                  .arg(options.reports)
+                  .arg(pageSize));
+
+    // 每两个报告共用一个创建时间，覆盖按report_id区分同一时间的情况
+    ReportDAO reportDao;
+    QDateTime base = QDateTime::currentDateTime().addSecs(-options.reports);
+    for (int first = 0; first < options.reports; first += 500)
+    {
+        QList<Report> reports;
+        QList<QList<ReportRecord>> records;
+        for (int i = first; i < qMin(first + 500, options.reports); ++i)
+        {
+            Report report;
+            report.userName = BenchDatabase::kUserName;
+            report.location = QString("bench-location-%1").arg(i % 100);
+            report.createdAt = base.addSecs(i / 2);
+            reports.append(report);
+            records.append(QList<ReportRecord>());
+        }
+        reportDao.createReportGroup(reports, records);
+    }
+
+    const int repeats = qMax(1, options.iterations / 100);
+    const int depthPercents[] = {0, 25, 50, 90};
+    for (int percent : depthPercents)
+    {
+        int depth = static_cast<int>(static_cast<qint64>(options.reports) * percent / 100) / pageSize * pageSize;
+
+        LatencyHistogram offsetHistogram;
+        for (int i = 0; i < repeats; ++i)
+        {
+            qint64 startUs = LatencyStats::nowUs();
+            reportDao.getReportsByUserName(BenchDatabase::kUserName, pageSize, depth);
+            offsetHistogram.record(LatencyStats::nowUs() - startUs);
+        }
+
+        // 翻页到该深度得到游标（不计时）
+        ReportPageCursor cursor;
+        for (int skipped = 0; skipped < depth; skipped += pageSize)
+        {
+            ReportPageCursor next;
+            reportDao.getReportsPageByUserName(BenchDatabase::kUserName, cursor, pageSize, &next);
+            cursor = next;
+        }
+
+        LatencyHistogram keysetHistogram;
+        for (int i = 0; i < repeats; ++i)
+        {
+            qint64 startUs = LatencyStats::nowUs();
+            reportDao.getReportsPageByUserName(BenchDatabase::kUserName, cursor, pageSize);
+            keysetHistogram.record(LatencyStats::nowUs() - startUs);
+        }
+
+        printHistogram(QString("offset %1").arg(depth), offsetHistogram);
+        printHistogram(QString("keyset %1").arg(depth), keysetHistogram);
+    }
+    return true;
+}
+
+// 读取10万条记录的报告历史（一个用户的所有报告记录）：
+// 默认的可回滚结果集 + 每行按列名取值，与只向前遍历 + 执行后解析一次列序号对比，输出每秒读取的行数
+bool benchRecordFetch(const BenchOptions &options)
+{
+    if (ConfigManager::instance()->getDatabaseConfig().recordStorage != "rows")
+    {
+        printLine("record_fetch: skipped (requires record_storage rows)");
+        return true;
+    }
+
+    BenchDatabase db(options);
+    if (!db.isOpen())
+    {
+        return false;
+    }
+
+    QList<ServerInfo> servers = db.seedServers(options.servers);
+    if (servers.isEmpty())
+    {
+        printLine("Failed to seed test servers");
+        return false;
+    }
+
+    const int totalRecords = 100000;
+    const int reportCount = (totalRecords + servers.size() - 1) / servers.size();
+    printLine(QString("record_fetch: backend=%1 reports=%2 records=%3")
+                  .arg(db.backendName())
+                  .arg(reportCount)
+                  .arg(reportCount * servers.size()));
+
+    ReportDAO reportDao;
+    for (int first = 0; first < reportCount; first += options.groupSize)
+    {
+        QList<Report> reports;
+        QList<QList<ReportRecord>> records;
+        for (int i = first; i < qMin(first + options.groupSize, reportCount); ++i)
+        {
+            Report report;
+            report.userName = BenchDatabase::kUserName;
+            report.location = QString("bench-location-%1").arg(i % 100);
+            reports.append(report);
+            records.append(makeRecords(servers, static_cast<quint32>(i)));
+        }
+        reportDao.createReportGroup(reports, records);
+    }
+
+    const QString sql = "SELECT rr.record_id, rr.report_id, rr.server_ip, rr.server_id, rr.latency "
+                        "FROM report_record rr JOIN latcheck_report r ON r.report_id = rr.report_id "
+                        "WHERE r.user_name = ?";
+    enum RecordColumn
+    {
+        RecordIdColumn,
+        ReportIdColumn,
+        ServerIpColumn,
+        ServerIdColumn,
+        LatencyColumn,
+        RecordColumnCount
+    };
+
+    DatabaseConnection conn;
+    const int repeats = qMax(1, options.iterations / 500);
+    qint64 checksum = 0;
+
+    const bool forwardOnlyModes[] = {false, true};
+    for (bool forwardOnly : forwardOnlyModes)
+    {
+        qint64 rows = 0;
+        qint64 elapsedUs = 0;
+        for (int i = 0; i < repeats; ++i)
+        {
+            QSqlQuery query(conn.database());
+            query.setForwardOnly(forwardOnly);
+            query.prepare(sql);
+            query.addBindValue(QString(BenchDatabase::kUserName));
+
+            qint64 startUs = LatencyStats::nowUs();
+            if (!query.exec())
+            {
+                printLine(QString("  query failed: %1").arg(query.lastError().text()));
+                return false;
+            }
+
+            if (forwardOnly)
+            {
+                ColumnIndex<RecordColumnCount> columns(query, {"record_id", "report_id", "server_ip", "server_id", "latency"});
+                while (query.next())
+                {
+                    checksum += columns.value(query, RecordIdColumn).toLongLong() +
+                                columns.value(query, ReportIdColumn).toLongLong() +
+                                columns.value(query, ServerIpColumn).toUInt() +
+                                columns.value(query, ServerIdColumn).toUInt() +
+                                columns.value(query, LatencyColumn).toInt();
+                    ++rows;
+                }
+            }
+            else
+            {
+                while (query.next())
+                {
+                    checksum += query.value("record_id").toLongLong() +
+                                query.value("report_id").toLongLong() +
+                                query.value("server_ip").toUInt() +
+                                query.value("server_id").toUInt() +
+                                query.value("latency").toInt();
+                    ++rows;
+                }
+            }
+            elapsedUs += LatencyStats::nowUs() - startUs;
+        }
+
+        printLine(QString("  %1: %2 rows/s")
+                      .arg(forwardOnly ? "forward-only, column ordinals" : "scrollable, column names", -32)
+                      .arg(rows * 1e6 / qMax<qint64>(1, elapsedUs), 0, 'f', 0));
+    }
+
+    printLine(QString("  checksum: %1").arg(checksum));
+    return true;
+}
@@ -0,0 +1,245 @@
+#include "bench_common.h"
+
+#include "latency/latency_matrix.h"
+#include "catalog/server_ip_index.h"
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QRandomGenerator>
+
+namespace
+{
+    // 连续的服务器ID（spread为1）或按spread间隔分布的稀疏ID
+    QList<ServerInfo> syntheticServers(int count, quint32 spread)
+    {
+        QList<ServerInfo> servers;
+        servers.reserve(count);
+        for (int i = 0; i < count; ++i)
+        {
+            servers.append(ServerInfo(1 + static_cast<quint32>(i) * spread, 0x0A000000u + static_cast<quint32>(i) + 1));
+        }
+        return servers;
+    }
+
+    QString locationName(int index)
+    {
+        return QString("location-%1").arg(index);
+    }
+
+    void printPerCall(const QString &name, qint64 elapsedNs, qint64 calls)
+    {
+        printLine(QString("  %1: %2 calls, %3 ns/call")
+                      .arg(name, -28)
+                      .arg(calls)
+                      .arg(static_cast<double>(elapsedNs) / qMax<qint64>(1, calls), 0, 'f', 1));
+    }
+
+    // 每个地点一个报告，报告ID为地点序号加1
+    void loadMatrix(LatencyMatrix &matrix, const QList<ServerInfo> &servers, int locations)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < locations; ++i)
+        {
+            matrix.setLocation(locationName(i), i + 1, makeRecords(servers, static_cast<quint32>(i)));
+        }
+        printLine(QString("  load: %1 ms, %2 MB")
+                      .arg(timer.elapsed())
+                      .arg(matrix.memoryBytes() / (1024.0 * 1024.0), 0, 'f', 1));
+    }
+}
+
+// 地点间延时引擎的增量计算：新报告替换一个地点的延时行，并重新计算该地点与其他L-1个地点的地点对
+// （LatencyEngine每个报告的计算量，不含写入calculated_latencies）
+bool benchLatencyEngine(const BenchOptions &options)
+{
+    printLine(QString("latency_engine: locations=%1 servers=%2 kernel=%3")
+                  .arg(options.locations)
+                  .arg(options.servers)
+                  .arg(LatencyMatrix::kernelName()));
+
+    QList<ServerInfo> servers = syntheticServers(options.servers, 1);
+    LatencyMatrix matrix;
+    loadMatrix(matrix, servers, options.locations);
+
+    QRandomGenerator random(1);
+    const int repeats = qMax(1, options.iterations / 100);
+    qint64 checksum = 0;
+
+    LatencyHistogram updateHistogram;
+    qint64 nextReportId = options.locations + 1;
+    for (int i = 0; i < repeats; ++i)
+    {
+        int location = random.bounded(options.locations);
+        QList<ReportRecord> records = makeRecords(servers, static_cast<quint32>(nextReportId));
+        qint64 startUs = LatencyStats::nowUs();
+        matrix.setLocation(locationName(location), nextReportId++, records);
+        checksum += matrix.pairsFor(locationName(location)).size();
+        updateHistogram.record(LatencyStats::nowUs() - startUs);
+    }
+    printHistogram("update location", updateHistogram);
+
+    printLine(QString("  checksum: %1").arg(checksum));
+    return true;
+}
+
+// 地点矩阵的内存和查询：加载L个地点后的内存占用、随机两地查询、一个地点对所有地点
+bool benchLatencyMatrix(const BenchOptions &options)
+{
+    printLine(QString("latency_matrix: locations=%1 servers=%2 kernel=%3")
+                  .arg(options.locations)
+                  .arg(options.servers)
+                  .arg(LatencyMatrix::kernelName()));
+
+    QList<ServerInfo> servers = syntheticServers(options.servers, 1);
+    LatencyMatrix matrix;
+    loadMatrix(matrix, servers, options.locations);
+
+    QList<QString> names;
+    names.reserve(options.locations);
+    for (int i = 0; i < options.locations; ++i)
+    {
+        names.append(locationName(i));
+    }
+
+    QRandomGenerator random(1);
+    qint64 checksum = 0;
+
+    const int pairQueries = options.iterations * 10;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < pairQueries; ++i)
+    {
+        LocationPairLatency pair;
+        if (matrix.pairLatency(names.at(random.bounded(options.locations)), names.at(random.bounded(options.locations)), pair))
+        {
+            checksum += pair.latency;
+        }
+    }
+    printPerCall("pair latency", timer.nsecsElapsed(), pairQueries);
+
+    const int repeats = qMax(1, options.iterations / 100);
+    LatencyHistogram allHistogram;
+    for (int i = 0; i < repeats; ++i)
+    {
+        const QString &location = names.at(random.bounded(options.locations));
+        qint64 startUs = LatencyStats::nowUs();
+        checksum += matrix.pairsFor(location).size();
+        allHistogram.record(LatencyStats::nowUs() - startUs);
+    }
+    printHistogram("one vs all", allHistogram);
+
+    printLine(QString("  checksum: %1").arg(checksum));
+    return true;
+}
+
+// top-K查询：某地点的最佳服务器和最近的地点
+bool benchLatencyTopK(const BenchOptions &options)
+{
+    printLine(QString("latency_topk: locations=%1 servers=%2 k=%3")
+                  .arg(options.locations)
+                  .arg(options.servers)
+                  .arg(options.topK));
+
+    QList<ServerInfo> servers = syntheticServers(options.servers, 1);
+    LatencyMatrix matrix;
+    loadMatrix(matrix, servers, options.locations);
+
+    QRandomGenerator random(1);
+    qint64 checksum = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < options.iterations; ++i)
+    {
+        checksum += matrix.bestServers(locationName(random.bounded(options.locations)), options.topK).size();
+    }
+    printPerCall("best servers", timer.nsecsElapsed(), options.iterations);
+
+    const int repeats = qMax(1, options.iterations / 100);
+    LatencyHistogram nearestHistogram;
+    for (int i = 0; i < repeats; ++i)
+    {
+        QString location = locationName(random.bounded(options.locations));
+        qint64 startUs = LatencyStats::nowUs();
+        checksum += matrix.nearestLocations(location, options.topK).size();
+        nearestHistogram.record(LatencyStats::nowUs() - startUs);
+    }
+    printHistogram("nearest locations", nearestHistogram);
+
+    printLine(QString("  checksum: %1").arg(checksum));
+    return true;
+}
+
+// 报告记录的服务器IP查找：QMap与目录快照中的ServerIpIndex（连续ID直接定位，稀疏ID二分查找）
+bool benchServerIndex(const BenchOptions &options)
+{
+    printLine(QString("server_index: servers=%1 reports=%2")
+                  .arg(options.servers)
+                  .arg(options.iterations));
+
+    quint64 checksum = 0;
+    const quint32 spreads[] = {1, 16};
+    for (quint32 spread : spreads)
+    {
+        QList<ServerInfo> servers = syntheticServers(options.servers, spread);
+        QList<ReportRecord> records = makeRecords(servers, 1);
+
+        QMap<quint32, quint32> map;
+        for (const ServerInfo &server : std::as_const(servers))
+        {
+            map.insert(server.serverId, server.ipAddr);
+        }
+        ServerIpIndex index(servers);
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < options.iterations; ++i)
+        {
+            for (const ReportRecord &record : std::as_const(records))
+            {
+                if (map.contains(record.serverId))
+                {
+                    checksum += map.value(record.serverId);
+                }
+            }
+        }
+        qint64 containsNs = timer.nsecsElapsed();
+
+        timer.restart();
+        for (int i = 0; i < options.iterations; ++i)
+        {
+            for (const ReportRecord &record : std::as_const(records))
+            {
+                auto it = map.constFind(record.serverId);
+                if (it != map.constEnd())
+                {
+                    checksum += it.value();
+                }
+            }
+        }
+        qint64 findNs = timer.nsecsElapsed();
+
+        timer.restart();
+        for (int i = 0; i < options.iterations; ++i)
+        {
+            for (const ReportRecord &record : std::as_const(records))
+            {
+                quint32 ipAddr = 0;
+                if (index.find(record.serverId, ipAddr))
+                {
+                    checksum += ipAddr;
+                }
+            }
+        }
+        qint64 indexNs = timer.nsecsElapsed();
+
+        QString ids = spread == 1 ? "dense ids" : "sparse ids";
+        printPerCall(QString("%1, QMap contains+value").arg(ids), containsNs, options.iterations);
+        printPerCall(QString("%1, QMap constFind").arg(ids), findNs, options.iterations);
+        printPerCall(QString("%1, ServerIpIndex (%2)").arg(ids, index.isDirect() ? "direct" : "sorted"), indexNs, options.iterations);
+    }
+
+    printLine(QString("  checksum: %1").arg(checksum));
+    return true;
+}
@@ -0,0 +1,171 @@
+// latcheck_bench：服务器各模块的基准测试，用于复现提交说明中的测量结果。
+// 用法（在latcheck_server目录下运行，与服务器使用相同的配置文件）：
+//   latcheck_bench [--backend sqlite|mysql] [--threads N] ... [benchmark...]
+// 不指定benchmark时运行全部。默认使用临时SQLite数据库，不需要外部服务；
+// --backend mysql写入config.json中配置的MySQL数据库，应指向专用的测试库
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <functional>
+
+#include "bench_common.h"
+#include "config/config_manager.h"
+
+namespace
+{
+    struct Benchmark
+    {
+        const char *name;
+        const char *description;
+        std::function<bool(const BenchOptions &)> run;
+    };
+
+    const Benchmark kBenchmarks[] = {
+        {"pool_contention", "Database pool borrow/return under thread contention", benchPoolContention},
+        {"ingest", "Group-committed report writes and record reads", benchIngest},
+        {"report_paging", "OFFSET vs keyset report list pages", benchReportPaging},
+        {"record_fetch", "Rows/s reading a 100k-record history: ordinals vs column names", benchRecordFetch},
+        {"latency_engine", "Incremental location update with synthetic locations", benchLatencyEngine},
+        {"latency_matrix", "Location matrix memory, pair and one-vs-all queries", benchLatencyMatrix},
+        {"latency_topk", "Best servers and nearest locations (top-K)", benchLatencyTopK},
+        {"server_index", "Server IP lookup: QMap vs ServerIpIndex", benchServerIndex},
+        {"tls_resume", "TLS reconnect CPU per handshake, with and without session resumption", benchTlsResume},
+        {"frame_buffer", "Pipelined frame parsing: QByteArray left/mid/remove vs FrameBuffer", benchFrameBuffer},
+        {"rest_load", "REST keep-alive and pipelined load against a running server", benchRestLoad},
+        {"list_response", "Server list response: query + serialize vs cached full/delta", benchListResponse},
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("latcheck_bench");
+
+    BenchOptions options;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("LatCheck server benchmarks");
+    parser.addHelpOption();
+    parser.addPositionalArgument("benchmark", "Benchmarks to run (default: all)", "[benchmark...]");
+
+    QCommandLineOption configOption("config", "Configuration file", "path", options.configPath);
+    QCommandLineOption backendOption("backend", "Database backend: sqlite (temporary file) or mysql (configured database)", "backend", options.backend);
+    QCommandLineOption listOption("list", "List benchmarks");
+    QCommandLineOption storageOption("record-storage", "Override database.record_storage: rows or packed", "mode");
+    QCommandLineOption apiUserOption("api-user", "rest_load: REST API user name", "name");
+    QCommandLineOption apiPasswordOption("api-password", "rest_load: REST API password", "password");
+    QCommandLineOption chunkSizeOption("insert-chunk-size", "Override database.insert_chunk_size (rows per INSERT statement)", "n");
+    parser.addOption(configOption);
+    parser.addOption(backendOption);
+    parser.addOption(listOption);
+    parser.addOption(chunkSizeOption);
+    parser.addOption(storageOption);
+    parser.addOption(apiUserOption);
+    parser.addOption(apiPasswordOption);
+
+    struct IntOption
+    {
+        QCommandLineOption option;
+        int *value;
+    };
+    QList<IntOption> intOptions = {
+        {QCommandLineOption("threads", "pool_contention: worker threads; rest_load: connections", "n", QString::number(options.threads)), &options.threads},
+        {QCommandLineOption("connections", "Database pool connection limit", "n", QString::number(options.connections)), &options.connections},
+        {QCommandLineOption("iterations", "Repetitions per thread or measurement", "n", QString::number(options.iterations)), &options.iterations},
+        {QCommandLineOption("servers", "Test servers (records per report)", "n", QString::number(options.servers)), &options.servers},
+        {QCommandLineOption("reports", "ingest/report_paging: reports to write", "n", QString::number(options.reports)), &options.reports},
+        {QCommandLineOption("group-size", "ingest: reports per transaction", "n", QString::number(options.groupSize)), &options.groupSize},
+        {QCommandLineOption("locations", "latency_*: check locations", "n", QString::number(options.locations)), &options.locations},
+        {QCommandLineOption("top-k", "latency_topk: k for top-K queries", "n", QString::number(options.topK)), &options.topK},
+        {QCommandLineOption("pipeline", "rest_load: requests in flight per connection", "n", QString::number(options.pipeline)), &options.pipeline},
+    };
+    for (const IntOption &intOption : std::as_const(intOptions))
+    {
+        parser.addOption(intOption.option);
+    }
+
+    parser.process(app);
+
+    if (parser.isSet(listOption))
+    {
+        for (const Benchmark &benchmark : kBenchmarks)
+        {
+            printLine(QString("%1  %2").arg(benchmark.name, -16).arg(benchmark.description));
+        }
+        return 0;
+    }
+
+    options.configPath = parser.value(configOption);
+    options.backend = parser.value(backendOption);
+    options.apiUser = parser.value(apiUserOption);
+    options.apiPassword = parser.value(apiPasswordOption);
+    for (const IntOption &intOption : std::as_const(intOptions))
+    {
+        bool ok = false;
+        int value = parser.value(intOption.option).toInt(&ok);
+        if (!ok || value <= 0)
+        {
+            printLine(QString("Invalid value for --%1").arg(intOption.option.names().first()));
+            return 1;
+        }
+        *intOption.value = value;
+    }
+
+    if (parser.isSet(storageOption))
+    {
+        QString storage = parser.value(storageOption);
+        if (storage != "rows" && storage != "packed")
+        {
+            printLine("Invalid value for --record-storage");
+            return 1;
+        }
+        options.databaseOverrides.insert("record_storage", storage);
+    }
+    if (parser.isSet(chunkSizeOption))
+    {
+        int chunkSize = parser.value(chunkSizeOption).toInt();
+        if (chunkSize <= 0)
+        {
+            printLine("Invalid value for --insert-chunk-size");
+            return 1;
+        }
+        options.databaseOverrides.insert("insert_chunk_size", chunkSize);
+    }
+
+    QStringList selected = parser.positionalArguments();
+    for (const QString &name : std::as_const(selected))
+    {
+        bool known = false;
+        for (const Benchmark &benchmark : kBenchmarks)
+        {
+            known = known || name == benchmark.name;
+        }
+        if (!known)
+        {
+            printLine(QString("Unknown benchmark: %1 (see --list)").arg(name));
+            return 1;
+        }
+    }
+
+    if (!initBenchEnvironment(options))
+    {
+        return 1;
+    }
+
+    int failed = 0;
+    for (const Benchmark &benchmark : kBenchmarks)
+    {
+        if (!selected.isEmpty() && !selected.contains(benchmark.name))
+        {
+            continue;
+        }
+        if (!benchmark.run(options))
+        {
+            printLine(QString("%1: FAILED").arg(benchmark.name));
+            ++failed;
+        }
+    }
+
+    ConfigManager::destroyInstance();
+    return failed == 0 ? 0 : 1;
+}
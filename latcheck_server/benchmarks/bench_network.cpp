@@ -0,0 +1,513 @@
+#include "bench_common.h"
+
+#include "config/config_manager.h"
+#include "server/tls_session_cache.h"
+
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QSslCertificate>
+#include <QSslConfiguration>
+#include <QSslKey>
+#include <QSslSocket>
+#include <QTcpServer>
+#include <QThread>
+#include <QTimer>
+#include <QUrlQuery>
+#include <deque>
+#include <vector>
+
+namespace
+{
+    // 回环地址上的TLS服务端，与ConnectionWorker相同：在会话缓存作用域内启动握手，
+    // 握手完成后记录是否为会话复用。运行在独立线程中，该线程的CPU时间全部用于握手
+    class HandshakeServer : public QTcpServer
+    {
+    public:
+        HandshakeServer(const QSslConfiguration &config, TlsSessionCache *cache)
+            : config_(config), cache_(cache)
+        {
+        }
+
+    protected:
+        void incomingConnection(qintptr socketDescriptor) override
+        {
+            QSslSocket *socket = new QSslSocket(this);
+            if (!socket->setSocketDescriptor(socketDescriptor))
+            {
+                delete socket;
+                return;
+            }
+
+            void *sslHandle = nullptr;
+            {
+                TlsSessionCache::Scope scope(cache_);
+                socket->setSslConfiguration(config_);
+                socket->startServerEncryption();
+                sslHandle = scope.sslHandle();
+            }
+
+            TlsSessionCache *cache = cache_;
+            connect(socket, &QSslSocket::encrypted, socket, [cache, sslHandle]()
+                    {
+                        if (sslHandle)
+                        {
+                            cache->recordHandshake(sslHandle);
+                        } });
+            connect(socket, &QSslSocket::disconnected, socket, &QObject::deleteLater);
+        }
+
+    private:
+        QSslConfiguration config_;
+        TlsSessionCache *cache_;
+    };
+
+    bool loadServerSslConfiguration(QSslConfiguration &config)
+    {
+        ServerConfig serverConfig = ConfigManager::instance()->getServerConfig();
+
+        QFile certFile(serverConfig.certificatePath);
+        QFile keyFile(serverConfig.privateKeyPath);
+        if (!certFile.open(QIODevice::ReadOnly) || !keyFile.open(QIODevice::ReadOnly))
+        {
+            printLine(QString("Failed to open %1 or %2").arg(serverConfig.certificatePath, serverConfig.privateKeyPath));
+            return false;
+        }
+
+        QSslCertificate cert(&certFile, QSsl::Pem);
+        QSslKey key(&keyFile, QSsl::Rsa, QSsl::Pem);
+        if (cert.isNull() || key.isNull())
+        {
+            printLine("Invalid server certificate or private key");
+            return false;
+        }
+
+        config = QSslConfiguration::defaultConfiguration();
+        config.setLocalCertificate(cert);
+        config.setPrivateKey(key);
+        // 与发布的配置（protocol: TLSv1.2）一致；TLS 1.3的票据在握手之后才发送
+        config.setProtocol(QSsl::TlsV1_2);
+        return true;
+    }
+
+    // 连接并完成握手，失败返回false
+    bool handshake(QSslSocket &socket, quint16 port)
+    {
+        QEventLoop loop;
+        QObject::connect(&socket, &QSslSocket::encrypted, &loop, &QEventLoop::quit);
+        QObject::connect(&socket, &QSslSocket::errorOccurred, &loop, &QEventLoop::quit);
+        QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+        socket.connectToHostEncrypted("127.0.0.1", port);
+        loop.exec();
+        return socket.isEncrypted();
+    }
+}
+
+// 重连的TLS握手开销：同一客户端在回环地址上重连N次，不复用会话（每次完整握手）
+// 与携带上次的会话票据（服务端通过TlsSessionCache解密票据后复用会话）对比，
+// 输出每次握手的服务端和客户端CPU时间。服务端不要求客户端证书
+bool benchTlsResume(const BenchOptions &options)
+{
+    QSslConfiguration serverSslConfig;
+    if (!loadServerSslConfiguration(serverSslConfig))
+    {
+        return false;
+    }
+
+    printLine(QString("tls_resume: handshakes=%1 protocol=TLSv1.2").arg(options.iterations));
+
+    ServerConfig serverConfig = ConfigManager::instance()->getServerConfig();
+    TlsSessionSettings settings;
+    settings.cacheSize = qMax(0, serverConfig.tlsSessionCacheSize);
+    settings.sessionTimeout = qMax(1, serverConfig.tlsSessionTimeout);
+    settings.ticketRotationInterval = qMax(1, serverConfig.tlsTicketRotationInterval);
+    TlsSessionCache cache(settings);
+    serverSslConfig.setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+
+    QThread serverThread;
+    serverThread.setObjectName("bench-tls-server");
+    HandshakeServer *server = new HandshakeServer(serverSslConfig, &cache);
+    server->moveToThread(&serverThread);
+    QObject::connect(&serverThread, &QThread::finished, server, &QObject::deleteLater);
+    serverThread.start();
+
+    quint16 port = 0;
+    QMetaObject::invokeMethod(
+        server, [server, &port]()
+        {
+            if (server->listen(QHostAddress::LocalHost, 0))
+            {
+                port = server->serverPort();
+            } },
+        Qt::BlockingQueuedConnection);
+
+    bool ok = port != 0;
+    if (!ok)
+    {
+        printLine("Failed to listen on the loopback address");
+    }
+
+    const bool modes[] = {false, true};
+    for (bool resume : modes)
+    {
+        if (!ok)
+        {
+            break;
+        }
+
+        QSslConfiguration clientConfig = QSslConfiguration::defaultConfiguration();
+        clientConfig.setPeerVerifyMode(QSslSocket::VerifyNone);
+        clientConfig.setProtocol(QSsl::TlsV1_2);
+        clientConfig.setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+        clientConfig.setSslOption(QSsl::SslOptionDisableSessionPersistence, !resume);
+
+        quint64 resumedBefore = cache.getResumedHandshakes();
+        qint64 serverCpuStart = 0;
+        QMetaObject::invokeMethod(server, [&serverCpuStart]()
+                                  { serverCpuStart = threadCpuUs(); }, Qt::BlockingQueuedConnection);
+        qint64 clientCpuStart = threadCpuUs();
+
+        LatencyHistogram wallHistogram;
+        for (int i = 0; i < options.iterations; ++i)
+        {
+            QSslSocket socket;
+            socket.setSslConfiguration(clientConfig);
+            qint64 startUs = LatencyStats::nowUs();
+            if (!handshake(socket, port))
+            {
+                printLine(QString("  handshake failed: %1").arg(socket.errorString()));
+                ok = false;
+                break;
+            }
+            wallHistogram.record(LatencyStats::nowUs() - startUs);
+
+            // 下一次连接携带本次取得的会话票据
+            if (resume)
+            {
+                clientConfig.setSessionTicket(socket.sslConfiguration().sessionTicket());
+            }
+            socket.disconnectFromHost();
+        }
+
+        qint64 clientCpuUs = threadCpuUs() - clientCpuStart;
+        qint64 serverCpuUs = 0;
+        QMetaObject::invokeMethod(server, [&serverCpuUs, serverCpuStart]()
+                                  { serverCpuUs = threadCpuUs() - serverCpuStart; }, Qt::BlockingQueuedConnection);
+
+        const double handshakes = static_cast<double>(qMax<quint64>(1, wallHistogram.count()));
+        QString mode = resume ? "resumed" : "full";
+        printHistogram(QString("%1 handshake wall").arg(mode), wallHistogram);
+        printLine(QString("  %1 handshake cpu: server %2 us, client %3 us per handshake, %4 resumed by server")
+                      .arg(mode, -16)
+                      .arg(serverCpuUs / handshakes, 0, 'f', 1)
+                      .arg(clientCpuUs / handshakes, 0, 'f', 1)
+                      .arg(cache.getResumedHandshakes() - resumedBefore));
+    }
+
+    QMetaObject::invokeMethod(server, [server]()
+                              { server->close(); }, Qt::BlockingQueuedConnection);
+    serverThread.quit();
+    serverThread.wait();
+    return ok;
+}
+
+namespace
+{
+    struct HttpResponse
+    {
+        int status = 0;
+        QByteArray body;
+    };
+
+    // 从缓冲区取出一个完整的响应（按Content-Length），数据不足时返回false
+    bool takeResponse(QByteArray &buffer, HttpResponse &response)
+    {
+        qsizetype headerEnd = buffer.indexOf("\r\n\r\n");
+        if (headerEnd < 0)
+        {
+            return false;
+        }
+
+        QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+        qsizetype contentLength = 0;
+        for (int i = 1; i < lines.size(); ++i)
+        {
+            const QByteArray &line = lines.at(i);
+            qsizetype colon = line.indexOf(':');
+            if (colon > 0 && line.left(colon).trimmed().toLower() == "content-length")
+            {
+                contentLength = line.mid(colon + 1).trimmed().toLongLong();
+            }
+        }
+
+        qsizetype total = headerEnd + 4 + contentLength;
+        if (buffer.size() < total)
+        {
+            return false;
+        }
+
+        QList<QByteArray> statusLine = lines.first().split(' ');
+        response.status = statusLine.size() > 1 ? statusLine.at(1).toInt() : 0;
+        response.body = buffer.mid(headerEnd + 4, contentLength);
+        buffer.remove(0, total);
+        return true;
+    }
+
+    QByteArray httpRequest(const QByteArray &method, const QByteArray &path, const QByteArray &token,
+                           const QByteArray &body = QByteArray())
+    {
+        QByteArray request = method + ' ' + path + " HTTP/1.1\r\nHost: latcheck\r\nConnection: keep-alive\r\n";
+        if (!token.isEmpty())
+        {
+            request += "Authorization: Bearer " + token + "\r\n";
+        }
+        if (!body.isEmpty())
+        {
+            request += "Content-Type: application/json\r\nContent-Length: " + QByteArray::number(body.size()) + "\r\n";
+        }
+        request += "\r\n";
+        request += body;
+        return request;
+    }
+
+    // 连接REST接口（启用SSL时不验证证书），失败返回false
+    bool connectApi(QSslSocket &socket, const ApiConfig &config)
+    {
+        QString host = config.host == "0.0.0.0" ? QString("127.0.0.1") : config.host;
+
+        QEventLoop loop;
+        QObject::connect(&socket, &QSslSocket::errorOccurred, &loop, &QEventLoop::quit);
+        QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+        if (config.enableSSL)
+        {
+            socket.setPeerVerifyMode(QSslSocket::VerifyNone);
+            QObject::connect(&socket, &QSslSocket::encrypted, &loop, &QEventLoop::quit);
+            socket.connectToHostEncrypted(host, static_cast<quint16>(config.port));
+            loop.exec();
+            return socket.isEncrypted();
+        }
+
+        QObject::connect(&socket, &QSslSocket::connected, &loop, &QEventLoop::quit);
+        socket.connectToHost(host, static_cast<quint16>(config.port));
+        loop.exec();
+        return socket.state() == QAbstractSocket::ConnectedState;
+    }
+
+    // 发送一个请求并等待其响应
+    bool roundTrip(QSslSocket &socket, const QByteArray &request, HttpResponse &response)
+    {
+        QByteArray buffer;
+        QEventLoop loop;
+        bool received = false;
+        QObject::connect(&socket, &QSslSocket::readyRead, &loop, [&]()
+                         {
+                             buffer += socket.readAll();
+                             if (takeResponse(buffer, response))
+                             {
+                                 received = true;
+                                 loop.quit();
+                             } });
+        QObject::connect(&socket, &QSslSocket::disconnected, &loop, &QEventLoop::quit);
+        QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+        socket.write(request);
+        loop.exec();
+        return received;
+    }
+
+    // 持久连接上的负载：每个连接保持depth个未完成的请求，收到一个响应就补发一个
+    struct LoadConnection
+    {
+        std::unique_ptr<QSslSocket> socket;
+        QByteArray buffer;
+        std::deque<qint64> sentUs; // 未完成请求的发送时间，响应按请求顺序返回
+        int sent = 0;
+    };
+
+    struct LoadResult
+    {
+        qint64 elapsedUs = 0;
+        quint64 completed = 0;
+        quint64 errors = 0;
+    };
+
+    bool runLoad(const ApiConfig &config, const QList<QByteArray> &requests, int connections, int requestsPerConnection,
+                 int depth, LatencyHistogram &histogram, LoadResult &result)
+    {
+        std::vector<LoadConnection> clients(connections);
+        for (LoadConnection &client : clients)
+        {
+            client.socket = std::make_unique<QSslSocket>();
+            if (!connectApi(*client.socket, config))
+            {
+                printLine(QString("  failed to connect: %1").arg(client.socket->errorString()));
+                return false;
+            }
+        }
+
+        const quint64 total = static_cast<quint64>(connections) * requestsPerConnection;
+        QEventLoop loop;
+        QTimer idleTimer;
+        idleTimer.setSingleShot(true);
+        idleTimer.setInterval(10000);
+        QObject::connect(&idleTimer, &QTimer::timeout, &loop, &QEventLoop::quit);
+
+        int next = 0;
+        auto send = [&](LoadConnection &client)
+        {
+            QByteArray pending;
+            while (client.sent < requestsPerConnection && static_cast<int>(client.sentUs.size()) < depth)
+            {
+                pending += requests.at(next++ % requests.size());
+                client.sentUs.push_back(LatencyStats::nowUs());
+                ++client.sent;
+            }
+            if (!pending.isEmpty())
+            {
+                client.socket->write(pending);
+            }
+        };
+
+        for (LoadConnection &client : clients)
+        {
+            LoadConnection *clientPtr = &client;
+            QObject::connect(client.socket.get(), &QSslSocket::readyRead, &loop, [&, clientPtr]()
+                             {
+                                 clientPtr->buffer += clientPtr->socket->readAll();
+                                 HttpResponse response;
+                                 while (!clientPtr->sentUs.empty() && takeResponse(clientPtr->buffer, response))
+                                 {
+                                     histogram.record(LatencyStats::nowUs() - clientPtr->sentUs.front());
+                                     clientPtr->sentUs.pop_front();
+                                     result.errors += response.status == 200 ? 0 : 1;
+                                     ++result.completed;
+                                 }
+                                 idleTimer.start();
+                                 if (result.completed == total)
+                                 {
+                                     loop.quit();
+                                     return;
+                                 }
+                                 send(*clientPtr); });
+            QObject::connect(client.socket.get(), &QSslSocket::disconnected, &loop, &QEventLoop::quit);
+        }
+
+        qint64 startUs = LatencyStats::nowUs();
+        for (LoadConnection &client : clients)
+        {
+            send(client);
+        }
+        idleTimer.start();
+        loop.exec();
+        result.elapsedUs = LatencyStats::nowUs() - startUs;
+
+        if (result.completed != total)
+        {
+            printLine(QString("  only %1 of %2 responses received").arg(result.completed).arg(total));
+            return false;
+        }
+        return true;
+    }
+}
+
+// REST接口的持久连接和管线化负载：对运行中的服务器（config.json的api部分）登录后，
+// 取最近的报告，交替请求/api/latency（两个报告地点之间）和/api/report/{id}。
+// 先每个连接一次一个请求（只用持久连接），再保持--pipeline个请求，输出吞吐量和延时分布。
+// 需要--api-user和--api-password，未指定时跳过
+bool benchRestLoad(const BenchOptions &options)
+{
+    if (options.apiUser.isEmpty() || options.apiPassword.isEmpty())
+    {
+        printLine("rest_load: skipped (requires --api-user and --api-password of a running server)");
+        return true;
+    }
+
+    ApiConfig config = ConfigManager::instance()->getApiConfig();
+    printLine(QString("rest_load: %1:%2 connections=%3 requests=%4 pipeline=%5")
+                  .arg(config.host)
+                  .arg(config.port)
+                  .arg(options.threads)
+                  .arg(options.iterations)
+                  .arg(options.pipeline));
+
+    QSslSocket control;
+    if (!connectApi(control, config))
+    {
+        printLine(QString("  failed to connect: %1").arg(control.errorString()));
+        return false;
+    }
+
+    HttpResponse response;
+    QJsonObject login;
+    login["user_name"] = options.apiUser;
+    login["password"] = options.apiPassword;
+    if (!roundTrip(control, httpRequest("POST", "/api/login", QByteArray(), QJsonDocument(login).toJson(QJsonDocument::Compact)), response) ||
+        response.status != 200)
+    {
+        printLine(QString("  login failed: HTTP %1 %2").arg(response.status).arg(QString::fromUtf8(response.body)));
+        return false;
+    }
+    QByteArray token = QJsonDocument::fromJson(response.body).object().value("token").toString().toLatin1();
+
+    if (!roundTrip(control, httpRequest("GET", "/api/reports?limit=200", token), response) || response.status != 200)
+    {
+        printLine(QString("  report list failed: HTTP %1").arg(response.status));
+        return false;
+    }
+    control.disconnectFromHost();
+
+    QList<qint64> reportIds;
+    QStringList locations;
+    const QJsonArray reports = QJsonDocument::fromJson(response.body).object().value("reports").toArray();
+    for (const QJsonValue &value : reports)
+    {
+        QJsonObject report = value.toObject();
+        reportIds.append(report.value("report_id").toInteger());
+        QString location = report.value("check_location").toString();
+        if (!locations.contains(location))
+        {
+            locations.append(location);
+        }
+    }
+    if (reportIds.isEmpty())
+    {
+        printLine("  the server has no reports");
+        return false;
+    }
+
+    // 请求序列：报告与（至少有两个地点时）两地延时交替
+    QRandomGenerator random(1);
+    QList<QByteArray> requests;
+    for (int i = 0; i < 1024; ++i)
+    {
+        if (i % 2 == 0 && locations.size() >= 2)
+        {
+            QUrlQuery query;
+            query.addQueryItem("location1", locations.at(random.bounded(locations.size())));
+            query.addQueryItem("location2", locations.at(random.bounded(locations.size())));
+            requests.append(httpRequest("GET", "/api/latency?" + query.toString(QUrl::FullyEncoded).toUtf8(), token));
+        }
+        else
+        {
+            requests.append(httpRequest("GET", "/api/report/" + QByteArray::number(reportIds.at(random.bounded(reportIds.size()))), token));
+        }
+    }
+
+    const int depths[] = {1, options.pipeline};
+    for (int depth : depths)
+    {
+        LatencyHistogram histogram;
+        LoadResult result;
+        if (!runLoad(config, requests, options.threads, options.iterations, depth, histogram, result))
+        {
+            return false;
+        }
+        printLine(QString("  pipeline %1: %2 req/s, %3 non-200")
+                      .arg(depth)
+                      .arg(result.completed * 1e6 / qMax<qint64>(1, result.elapsedUs), 0, 'f', 0)
+                      .arg(result.errors));
+        printHistogram(QString("pipeline %1 latency").arg(depth), histogram);
+    }
+    return true;
+}
@@ -0,0 +1,246 @@
+#include "bench_common.h"
+
+#include "protocol/frame_buffer.h"
+#include "catalog/server_catalog.h"
+#include "database/database_pool.h"
+#include "database/server_dao.h"
+
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QThread>
+
+namespace
+{
+    // 每次从socket读取的数据量，帧跨越读取边界
+    constexpr qsizetype kReadChunk = 16 * 1024;
+
+    // 流水线发送的消息流：每8帧中7帧为短小的列表请求，1帧为每台服务器12字节的报告
+    QByteArray pipelinedStream(int frames, int servers)
+    {
+        QByteArray version(8, '\x01');
+        QByteArray report(servers * 12, '\x02');
+
+        QByteArray stream;
+        for (int i = 0; i < frames; ++i)
+        {
+            switch (i % 8)
+            {
+            case 0:
+                MessageProtocol::appendMessage(stream, MessageType::REPORT_REQUEST, report);
+                break;
+            case 1:
+                MessageProtocol::appendMessage(stream, MessageType::LIST_DELTA_REQUEST, version);
+                break;
+            default:
+                MessageProtocol::appendMessage(stream, MessageType::LIST_REQUEST, QByteArrayView());
+                break;
+            }
+        }
+        return stream;
+    }
+
+    void printFrameRate(const QString &name, qint64 elapsedNs, int frames)
+    {
+        printLine(QString("  %1: %2 frames/s, %3 ns/frame")
+                      .arg(name, -28)
+                      .arg(frames * 1e9 / qMax<qint64>(1, elapsedNs), 0, 'f', 0)
+                      .arg(static_cast<double>(elapsedNs) / qMax(1, frames), 0, 'f', 1));
+    }
+}
+
+// 会话接收缓冲区的分帧：流水线发送的大量消息分块到达，
+// 逐块追加后取出所有完整帧。对比原先的QByteArray left/mid/remove(0)循环
+// （每帧复制消息头和载荷，并把剩余数据前移）与FrameBuffer的原地解析和读游标
+bool benchFrameBuffer(const BenchOptions &options)
+{
+    const int frames = options.iterations * 100;
+    QByteArray stream = pipelinedStream(frames, options.servers);
+    printLine(QString("frame_buffer: frames=%1 bytes=%2 read_chunk=%3")
+                  .arg(frames)
+                  .arg(stream.size())
+                  .arg(kReadChunk));
+
+    const qsizetype headerSize = static_cast<qsizetype>(sizeof(MessageHeader));
+    quint64 checksum = 0;
+    int parsed = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    QByteArray buffer;
+    for (qsizetype offset = 0; offset < stream.size(); offset += kReadChunk)
+    {
+        buffer.append(stream.constData() + offset, qMin(kReadChunk, stream.size() - offset));
+        while (buffer.size() >= headerSize)
+        {
+            MessageHeader header = MessageProtocol::deserializeHeader(buffer.left(headerSize));
+            qsizetype totalSize = headerSize + header.dataLength;
+            if (buffer.size() < totalSize)
+            {
+                break;
+            }
+            QByteArray payload = buffer.mid(headerSize, header.dataLength);
+            buffer.remove(0, totalSize);
+            checksum += header.msgType + payload.size();
+            ++parsed;
+        }
+    }
+    qint64 oldNs = timer.nsecsElapsed();
+    int oldParsed = parsed;
+
+    parsed = 0;
+    timer.restart();
+    FrameBuffer frameBuffer;
+    for (qsizetype offset = 0; offset < stream.size(); offset += kReadChunk)
+    {
+        if (!frameBuffer.append(stream.constData() + offset, qMin(kReadChunk, stream.size() - offset)))
+        {
+            printLine("  frame buffer limit exceeded");
+            return false;
+        }
+
+        MessageHeader header;
+        QByteArrayView payload;
+        while (frameBuffer.peekFrame(header, payload) == FrameBuffer::FrameStatus::Ready)
+        {
+            checksum += header.msgType + payload.size();
+            frameBuffer.consume(headerSize + payload.size());
+            ++parsed;
+        }
+    }
+    qint64 newNs = timer.nsecsElapsed();
+
+    if (oldParsed != frames || parsed != frames)
+    {
+        printLine(QString("  parsed %1 and %2 of %3 frames").arg(oldParsed).arg(parsed).arg(frames));
+        return false;
+    }
+
+    printFrameRate("left/mid/remove loop", oldNs, frames);
+    printFrameRate("FrameBuffer", newNs, frames);
+    printLine(QString("  checksum: %1").arg(checksum));
+    return true;
+}
+
+namespace
+{
+    void printPerRequest(const QString &name, qint64 cpuUs, int requests, qsizetype bytes)
+    {
+        printLine(QString("  %1: %2 us cpu/request, %3 bytes")
+                      .arg(name, -28)
+                      .arg(static_cast<double>(cpuUs) / qMax(1, requests), 0, 'f', 3)
+                      .arg(bytes));
+    }
+}
+
+// 服务器列表响应：原先每个请求查询test_server并序列化（getActiveServers + QDataStream），
+// 与目录快照中预先序列化的完整列表、增量和未变化响应对比，输出每个请求的CPU时间和响应字节数
+bool benchListResponse(const BenchOptions &options)
+{
+    BenchDatabase db(options);
+    if (!db.isOpen())
+    {
+        return false;
+    }
+
+    QList<ServerInfo> servers = db.seedServers(options.servers);
+    if (servers.isEmpty())
+    {
+        printLine("Failed to seed test servers");
+        return false;
+    }
+
+    printLine(QString("list_response: backend=%1 servers=%2 requests=%3")
+                  .arg(db.backendName())
+                  .arg(servers.size())
+                  .arg(options.iterations));
+
+    quint64 checksum = 0;
+
+    ServerDAO serverDao;
+    qsizetype perRequestBytes = 0;
+    qint64 startCpuUs = threadCpuUs();
+    for (int i = 0; i < options.iterations; ++i)
+    {
+        QList<ServerInfo> active;
+        if (!serverDao.getActiveServers(active))
+        {
+            printLine("  failed to read active servers");
+            return false;
+        }
+        QByteArray response = MessageProtocol::serializeListResponse(active);
+        perRequestBytes = response.size();
+        checksum += response.size();
+    }
+    printPerRequest("query + serialize", threadCpuUs() - startCpuUs, options.iterations, perRequestBytes);
+
+    // 目录只读取数据库中的活跃服务器（文件不存在），每秒检查一次test_server
+    QTemporaryDir catalogDir;
+    ServerCatalog *catalog = ServerCatalog::instance();
+    if (!catalog->start(catalogDir.filePath("ip_result.txt"), 1))
+    {
+        printLine("  failed to start server catalog");
+        ServerCatalog::destroyInstance();
+        return false;
+    }
+
+    const int cachedRequests = options.iterations * 100;
+    ServerCatalogSnapshotPtr snapshot;
+    startCpuUs = threadCpuUs();
+    for (int i = 0; i < cachedRequests; ++i)
+    {
+        snapshot = catalog->snapshot();
+        QByteArray response = snapshot->listResponse;
+        checksum += response.size();
+    }
+    printPerRequest("cached full list", threadCpuUs() - startCpuUs, cachedRequests, snapshot->listResponse.size());
+
+    // 修改1%的服务器IP，等待目录发布新版本后请求旧版本到新版本的增量
+    const quint64 oldVersion = snapshot->version;
+    {
+        DatabaseConnection conn;
+        QSqlQuery query(conn.database());
+        query.prepare("UPDATE test_server SET ip_addr = ip_addr + 1000000 WHERE location LIKE ? AND server_id % 100 = 0");
+        query.addBindValue(QString("%1%").arg(BenchDatabase::kServerPrefix));
+        query.exec();
+    }
+    QDeadlineTimer deadline(10000);
+    while (catalog->getVersion() == oldVersion && !deadline.hasExpired())
+    {
+        QThread::msleep(50);
+    }
+
+    bool ok = catalog->getVersion() != oldVersion;
+    if (ok)
+    {
+        const ListDeltaKind kinds[] = {ListDeltaKind::Delta, ListDeltaKind::NotModified};
+        for (ListDeltaKind expected : kinds)
+        {
+            ListDeltaKind kind = ListDeltaKind::Full;
+            qsizetype bytes = 0;
+            startCpuUs = threadCpuUs();
+            for (int i = 0; i < cachedRequests; ++i)
+            {
+                snapshot = catalog->snapshot();
+                quint64 clientVersion = expected == ListDeltaKind::Delta ? oldVersion : snapshot->version;
+                QByteArray response = snapshot->listDeltaResponse(clientVersion, kind);
+                bytes = response.size();
+                checksum += response.size();
+            }
+            QString name = kind == ListDeltaKind::Delta ? "cached delta (1% changed)" : kind == ListDeltaKind::NotModified ? "cached not modified" : "cached full (no delta)";
+            printPerRequest(name, threadCpuUs() - startCpuUs, cachedRequests, bytes);
+        }
+    }
+    else
+    {
+        printLine("  server catalog did not publish a new version");
+    }
+
+    snapshot.reset();
+    catalog->stop();
+    ServerCatalog::destroyInstance();
+
+    printLine(QString("  checksum: %1").arg(checksum));
+    return ok;
+}
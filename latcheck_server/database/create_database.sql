@@ -3,6 +3,8 @@ CREATE DATABASE IF NOT EXISTS latcheck CHARACTER SET utf8mb4 COLLATE utf8mb4_uni
 USE latcheck;
 
 -- 删除现有的表（按照外键依赖关系顺序删除）
+DROP TABLE IF EXISTS calculated_latencies;
+DROP TABLE IF EXISTS report_latency_blob;
 DROP TABLE IF EXISTS report_record;
 DROP TABLE IF EXISTS latcheck_report;
 DROP TABLE IF EXISTS test_server;
@@ -27,7 +29,7 @@ CREATE TABLE IF NOT EXISTS users (
     INDEX idx_created_at (created_at)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci;
 
--- 创建报告表
+-- 创建报告表（user_name和check_location索引含created_time，已有数据库执行migrate_report_indexes.sql迁移）
 CREATE TABLE IF NOT EXISTS latcheck_report (
     report_id BIGINT AUTO_INCREMENT PRIMARY KEY,
     user_name VARCHAR(50) NOT NULL,
@@ -35,8 +37,9 @@ CREATE TABLE IF NOT EXISTS latcheck_report (
     status TINYINT NOT NULL DEFAULT 0 COMMENT '0=Pending, 1=Processing, 2=Completed, 3=Failed',
     created_time DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP,
     updated_at DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
-    INDEX idx_user_name (user_name),
-    INDEX idx_location (check_location),
+    -- 二级索引隐含主键report_id，以下索引支持按(created_time, report_id)的键集分页
+    INDEX idx_user_name (user_name, created_time),
+    INDEX idx_location (check_location, created_time),
     INDEX idx_created_time (created_time),
     INDEX idx_status (status)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci;
@@ -65,6 +68,32 @@ CREATE TABLE IF NOT EXISTS report_record (
     FOREIGN KEY (server_id) REFERENCES test_server(server_id) ON DELETE CASCADE
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci;
 
+-- 紧凑存储的报告记录（record_storage为packed时使用），每个报告一行，
+-- payload编码格式见ReportDAO::encodeRecords；其中的server_id不受外键约束
+CREATE TABLE IF NOT EXISTS report_latency_blob (
+    report_id BIGINT PRIMARY KEY,
+    record_count INT UNSIGNED NOT NULL COMMENT '记录数',
+    payload MEDIUMBLOB NOT NULL COMMENT '编码后的延迟记录',
+    FOREIGN KEY (report_id) REFERENCES latcheck_report(report_id) ON DELETE CASCADE
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci;
+
+-- 计算的地点间延时：每对检测地点一行，由两地各自的最新报告标识，
+-- 延时为经过同一测试服务器的两段延时之和的最小值（由LatencyEngine增量维护）
+CREATE TABLE IF NOT EXISTS calculated_latencies (
+    id BIGINT AUTO_INCREMENT PRIMARY KEY COMMENT '主键ID',
+    report1 BIGINT NOT NULL COMMENT '较小的report_id',
+    report2 BIGINT NOT NULL COMMENT '较大的report_id',
+    latency INT UNSIGNED NOT NULL COMMENT '延时值（毫秒）',
+    server_id INT NOT NULL COMMENT '服务器ID',
+    created_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP COMMENT '创建时间',
+    INDEX idx_reports (report1, report2),
+    INDEX idx_report2 (report2),
+    INDEX idx_server_id (server_id),
+    INDEX idx_created_time (created_time),
+    FOREIGN KEY (report1) REFERENCES latcheck_report(report_id) ON DELETE CASCADE,
+    FOREIGN KEY (report2) REFERENCES latcheck_report(report_id) ON DELETE CASCADE
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci;
+
 -- 插入默认管理员用户（密码：Medbot8848）
 INSERT INTO users (username, password_hash, salt, role, status) VALUES 
 ('admin', 
@@ -0,0 +1,117 @@
+-- SQLite版本的数据库结构，与create_database.sql保持一致
+-- database.backend为sqlite且数据库文件中没有表时，由服务器启动时自动执行
+-- 差异说明：
+--   自增主键使用INTEGER PRIMARY KEY AUTOINCREMENT
+--   索引名在整个数据库内唯一，加表名前缀
+--   ON UPDATE CURRENT_TIMESTAMP使用触发器实现，时间统一使用本地时间
+
+-- 创建用户表
+CREATE TABLE IF NOT EXISTS users (
+    user_id INTEGER PRIMARY KEY AUTOINCREMENT,
+    username VARCHAR(50) NOT NULL UNIQUE,
+    password_hash VARCHAR(255) NOT NULL,
+    salt VARCHAR(255) NOT NULL,
+    email VARCHAR(100),
+    role TINYINT NOT NULL DEFAULT 2, -- 0=Admin, 1=ReportUploader, 2=ReportViewer
+    status TINYINT NOT NULL DEFAULT 0, -- 0=Active, 1=Inactive, 2=Suspended, 3=Deleted
+    login_attempts INT DEFAULT 0,
+    locked_until DATETIME NULL,
+    created_at DATETIME NOT NULL DEFAULT (datetime('now', 'localtime')),
+    updated_at DATETIME NOT NULL DEFAULT (datetime('now', 'localtime')),
+    last_login_at DATETIME NULL
+);
+CREATE INDEX IF NOT EXISTS idx_users_username ON users (username);
+CREATE INDEX IF NOT EXISTS idx_users_status ON users (status);
+CREATE INDEX IF NOT EXISTS idx_users_created_at ON users (created_at);
+
+CREATE TRIGGER IF NOT EXISTS trg_users_updated_at AFTER UPDATE ON users
+FOR EACH ROW WHEN NEW.updated_at = OLD.updated_at
+BEGIN
+    UPDATE users SET updated_at = datetime('now', 'localtime') WHERE user_id = NEW.user_id;
+END;
+
+-- 创建报告表
+CREATE TABLE IF NOT EXISTS latcheck_report (
+    report_id INTEGER PRIMARY KEY AUTOINCREMENT,
+    user_name VARCHAR(50) NOT NULL,
+    check_location VARCHAR(255) NOT NULL,
+    status TINYINT NOT NULL DEFAULT 0, -- 0=Pending, 1=Processing, 2=Completed, 3=Failed
+    created_time DATETIME NOT NULL DEFAULT (datetime('now', 'localtime')),
+    updated_at DATETIME NOT NULL DEFAULT (datetime('now', 'localtime'))
+);
+-- 索引隐含rowid（即report_id），以下索引支持按(created_time, report_id)的键集分页；
+-- 已有数据库的旧索引不会被IF NOT EXISTS替换，需执行migrate_report_indexes_sqlite.sql
+CREATE INDEX IF NOT EXISTS idx_latcheck_report_user_name ON latcheck_report (user_name, created_time);
+CREATE INDEX IF NOT EXISTS idx_latcheck_report_location ON latcheck_report (check_location, created_time);
+CREATE INDEX IF NOT EXISTS idx_latcheck_report_created_time ON latcheck_report (created_time);
+CREATE INDEX IF NOT EXISTS idx_latcheck_report_status ON latcheck_report (status);
+
+CREATE TRIGGER IF NOT EXISTS trg_latcheck_report_updated_at AFTER UPDATE ON latcheck_report
+FOR EACH ROW WHEN NEW.updated_at = OLD.updated_at
+BEGIN
+    UPDATE latcheck_report SET updated_at = datetime('now', 'localtime') WHERE report_id = NEW.report_id;
+END;
+
+-- 创建测试服务器表（移到report_record表之前）
+CREATE TABLE IF NOT EXISTS test_server (
+    server_id INTEGER PRIMARY KEY AUTOINCREMENT, -- 服务器ID，主键
+    location VARCHAR(128) UNIQUE NOT NULL, -- 位置信息，唯一
+    ip_addr INTEGER NOT NULL CHECK (ip_addr BETWEEN 0 AND 4294967295), -- IPv4地址整数值
+    update_time TIMESTAMP DEFAULT (datetime('now', 'localtime')), -- 更新时间
+    active BOOLEAN DEFAULT 1 -- 是否活跃
+);
+CREATE INDEX IF NOT EXISTS idx_test_server_location ON test_server (location);
+CREATE INDEX IF NOT EXISTS idx_test_server_active ON test_server (active);
+
+CREATE TRIGGER IF NOT EXISTS trg_test_server_update_time AFTER UPDATE ON test_server
+FOR EACH ROW WHEN NEW.update_time IS OLD.update_time
+BEGIN
+    UPDATE test_server SET update_time = datetime('now', 'localtime') WHERE server_id = NEW.server_id;
+END;
+
+CREATE TABLE IF NOT EXISTS report_record (
+    record_id INTEGER PRIMARY KEY AUTOINCREMENT,
+    report_id INTEGER NOT NULL,
+    server_ip INTEGER NOT NULL CHECK (server_ip BETWEEN 0 AND 4294967295), -- 存储为无符号整数以支持完整的IPv4范围
+    server_id INTEGER NOT NULL, -- 关联测试服务器ID
+    latency INTEGER NOT NULL DEFAULT 10000 CHECK (latency BETWEEN 0 AND 10000),
+    FOREIGN KEY (report_id) REFERENCES latcheck_report(report_id) ON DELETE CASCADE,
+    FOREIGN KEY (server_id) REFERENCES test_server(server_id) ON DELETE CASCADE
+);
+CREATE INDEX IF NOT EXISTS idx_report_record_report_id ON report_record (report_id);
+CREATE INDEX IF NOT EXISTS idx_report_record_server_id ON report_record (server_id);
+
+-- 紧凑存储的报告记录（record_storage为packed时使用），每个报告一行，
+-- payload编码格式见ReportDAO::encodeRecords；其中的server_id不受外键约束
+CREATE TABLE IF NOT EXISTS report_latency_blob (
+    report_id INTEGER PRIMARY KEY,
+    record_count INTEGER NOT NULL, -- 记录数
+    payload BLOB NOT NULL, -- 编码后的延迟记录
+    FOREIGN KEY (report_id) REFERENCES latcheck_report(report_id) ON DELETE CASCADE
+);
+
+-- 计算的地点间延时：每对检测地点一行，由两地各自的最新报告标识，
+-- 延时为经过同一测试服务器的两段延时之和的最小值（由LatencyEngine增量维护）
+CREATE TABLE IF NOT EXISTS calculated_latencies (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    report1 INTEGER NOT NULL, -- 较小的report_id
+    report2 INTEGER NOT NULL, -- 较大的report_id
+    latency INTEGER NOT NULL, -- 延时值（毫秒）
+    server_id INTEGER NOT NULL, -- 服务器ID
+    created_time DATETIME DEFAULT (datetime('now', 'localtime')),
+    FOREIGN KEY (report1) REFERENCES latcheck_report(report_id) ON DELETE CASCADE,
+    FOREIGN KEY (report2) REFERENCES latcheck_report(report_id) ON DELETE CASCADE
+);
+CREATE INDEX IF NOT EXISTS idx_calculated_latencies_reports ON calculated_latencies (report1, report2);
+CREATE INDEX IF NOT EXISTS idx_calculated_latencies_report2 ON calculated_latencies (report2);
+CREATE INDEX IF NOT EXISTS idx_calculated_latencies_server_id ON calculated_latencies (server_id);
+
+-- 插入默认管理员用户（密码：Medbot8848）
+-- SQLite没有SHA2函数，哈希值为SHA256('Medbot8848' || 'initial_admin_salt_2025')的十六进制结果
+INSERT OR IGNORE INTO users (username, password_hash, salt, role, status) VALUES (
+    'admin',
+    '410382f09b9ff4ab964d9ceb8783afbbe0a75d882e12cdf5da53f6bf53918cf5',
+    'initial_admin_salt_2025',
+    0, -- Admin角色
+    0 -- 启用状态（对应UserStatus::Active）
+);
@@ -0,0 +1,12 @@
+-- 已有MySQL数据库的索引迁移（新建的数据库由create_database.sql直接创建，不需要执行）：
+-- latcheck_report的idx_user_name和idx_location扩展为(列, created_time)，
+-- 按用户和地点的报告列表可以沿索引做(created_time, report_id)键集分页。
+-- 用法: mysql -u root -p latcheck < migrate_report_indexes.sql
+-- 重复执行只会重建一次相同的索引。大表上ALTER TABLE需要较长时间，建议在低峰期执行
+USE latcheck;
+
+ALTER TABLE latcheck_report
+    DROP INDEX idx_user_name,
+    ADD INDEX idx_user_name (user_name, created_time),
+    DROP INDEX idx_location,
+    ADD INDEX idx_location (check_location, created_time);
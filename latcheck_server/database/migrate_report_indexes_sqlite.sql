@@ -0,0 +1,9 @@
+-- 已有SQLite数据库的索引迁移（建表脚本中的CREATE INDEX IF NOT EXISTS不会修改已存在的索引）：
+-- user_name和check_location索引扩展为(列, created_time)，用于报告列表的键集分页。
+-- 用法: sqlite3 data/latcheck.db < migrate_report_indexes_sqlite.sql
+BEGIN;
+DROP INDEX IF EXISTS idx_latcheck_report_user_name;
+DROP INDEX IF EXISTS idx_latcheck_report_location;
+CREATE INDEX idx_latcheck_report_user_name ON latcheck_report (user_name, created_time);
+CREATE INDEX idx_latcheck_report_location ON latcheck_report (check_location, created_time);
+COMMIT;
@@ -0,0 +1,165 @@
+#ifndef RESTQUERYSERVER_H
+#define RESTQUERYSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QSslSocket>
+#include <QSslConfiguration>
+#include <QTimer>
+#include <QHash>
+#include <QCache>
+#include <QByteArray>
+#include <QDateTime>
+#include <deque>
+#include <memory>
+
+#include "common/types.h"
+#include "server/admission_controller.h"
+
+class AuthManager;
+
+// REST查询接口（见rest_api requirements.txt）：HTTPS，事件驱动，不阻塞主线程。
+//   POST /api/login                              {"user_name","password"} -> {"success","token","expires_in"}
+//   GET  /api/latency?location1=X&location2=Y    两地间的估算延时（来自LatencyEngine的延时矩阵）
+//   GET  /api/latencies/all                      calculated_latencies全部数据
+//   GET  /api/reports?limit=N&cursor=C           报告列表（键集分页，C为上一页的next_cursor；也接受offset=M）
+//   GET  /api/report/{id}                        报告基本信息
+//   GET  /api/report/{id}/detail                 报告详细记录
+// 除登录外都需要Authorization: Bearer <token>（管理员或报告查询者）。
+// 新连接与TLS服务器一样经过接入控制（连接数、每个源IP的连接速率、握手数）；
+// 登录按源IP限速，连续失败的账户由AuthManager锁定。默认只监听本机地址。
+// 延时查询直接读取内存矩阵；报告和记录不会被修改，序列化后的响应按报告ID缓存，
+// calculated_latencies的响应按LatencyEngine的更新次数缓存；只有未命中时才经DbExecutor访问数据库。
+// 连接支持HTTP/1.1持久连接和管线化：同一连接上的请求可以同时处理，响应按请求顺序发送。
+class RestQueryServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    explicit RestQueryServer(QObject *parent = nullptr);
+    ~RestQueryServer();
+
+    // 登录限速和账户锁定，需在start()之前设置
+    void setAuthManager(std::shared_ptr<AuthManager> authManager) { auth_manager_ = std::move(authManager); }
+
+    bool start(const ApiConfig &config);
+    void stop();
+
+    // 获取状态
+    int getConnectionCount() const { return connections_.size(); }
+    quint64 getRequestCount() const { return request_count_; }
+    quint64 getCacheHits() const { return cache_hits_; }
+    quint64 getCacheMisses() const { return cache_misses_; }
+    const AdmissionController *getAdmissionController() const { return admission_.get(); }
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+
+private slots:
+    void onReadyRead();
+    void onDisconnected();
+
+private:
+    // 一个请求的响应位置，响应按位置顺序发送
+    struct ResponseSlot
+    {
+        quint64 sequence = 0;
+        bool ready = false;
+        bool close = false;
+        QByteArray data;
+    };
+
+    struct Connection
+    {
+        quint64 id = 0;
+        QSslSocket *socket = nullptr;
+        QTimer *idleTimer = nullptr;
+        QByteArray buffer;
+        std::deque<ResponseSlot> responses;
+        quint64 nextSequence = 0;
+        bool closing = false;          // 已收到Connection: close，不再读取后续请求
+        bool handshakePending = false; // 是否仍占用接入控制的握手名额
+    };
+
+    struct HttpRequest
+    {
+        QByteArray method;
+        QByteArray path;
+        QByteArray query;
+        QByteArray body;
+        QByteArray authorization;
+        bool keepAlive = true;
+    };
+
+    // 登录令牌
+    struct TokenInfo
+    {
+        QString userName;
+        QDateTime expiresAt;
+    };
+
+    // 请求完成时定位响应位置
+    struct ResponseHandle
+    {
+        quint64 connectionId = 0;
+        quint64 sequence = 0;
+        bool keepAlive = true;
+    };
+
+    // 从缓冲区中解析完整的请求并分派；返回false表示请求无效，连接需要关闭
+    bool processBuffer(Connection *connection);
+    bool parseRequest(Connection *connection, HttpRequest &request, bool &finished);
+
+    void dispatch(const HttpRequest &request, const ResponseHandle &handle);
+
+    // 各接口
+    void handleLogin(const HttpRequest &request, const ResponseHandle &handle);
+    void handleLatency(const HttpRequest &request, const ResponseHandle &handle);
+    void handleAllLatencies(const ResponseHandle &handle);
+    void handleReports(const HttpRequest &request, const ResponseHandle &handle);
+    void handleReport(qint64 reportId, bool detail, const ResponseHandle &handle);
+
+    // 校验Authorization头中的令牌
+    bool authorize(const HttpRequest &request, QString &userName);
+
+    // 填充响应位置，并按顺序发送已完成的响应
+    void complete(const ResponseHandle &handle, int status, const QByteArray &body);
+    void flushResponses(Connection *connection);
+    void closeConnection(Connection *connection);
+
+    // 握手完成或连接关闭时释放接入控制的握手名额
+    void releaseHandshake(Connection *connection);
+
+    static QByteArray httpResponse(int status, const QByteArray &body, bool keepAlive);
+    static QByteArray errorBody(const QString &message);
+    static const char *statusReason(int status);
+
+    ApiConfig config_;
+    QSslConfiguration ssl_config_;
+    bool use_ssl_;
+
+    QHash<quint64, Connection *> connections_;
+    QHash<QSslSocket *, Connection *> sockets_;
+    quint64 next_connection_id_;
+
+    QHash<QString, TokenInfo> tokens_;
+
+    std::unique_ptr<AdmissionController> admission_;
+    std::shared_ptr<AuthManager> auth_manager_;
+
+    // 序列化后的响应缓存（只在主线程访问）
+    QCache<qint64, QByteArray> report_cache_;
+    QCache<qint64, QByteArray> detail_cache_;
+    QByteArray latencies_body_;
+    quint64 latencies_version_;
+    bool latencies_cached_;
+
+    quint64 request_count_;
+    quint64 cache_hits_;
+    quint64 cache_misses_;
+
+    static constexpr int MaxHeaderSize = 8192;
+    static constexpr int MaxBodySize = 65536;
+};
+
+#endif // RESTQUERYSERVER_H
@@ -0,0 +1,143 @@
+#ifndef SERVERCATALOG_H
+#define SERVERCATALOG_H
+
+#include <QObject>
+#include <QTimer>
+#include <QFileSystemWatcher>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QByteArray>
+#include <QAtomicInteger>
+#include <memory>
+
+#include "common/singleton.h"
+#include "common/worker_thread.h"
+#include "catalog/server_ip_index.h"
+#include "database/server_dao.h"
+#include "protocol/message_protocol.h"
+
+// 某一时刻的活跃测试服务器目录。发布后不再修改，可以在任意线程中读取
+struct ServerCatalogSnapshot
+{
+    quint64 version = 0;                // 每次内容变化加1，0表示尚未加载；每次启动从随机值开始
+    QList<ServerInfo> servers;          // 活跃服务器，按server_id升序
+    ServerIpIndex serverIndex;          // 服务器ID到IP地址的索引
+
+    // 发布时预先序列化的响应数据，所有会话共享同一份（QByteArray隐式共享，发送时不复制）
+    QByteArray listResponse;                    // LIST_RESPONSE
+    QByteArray fullDeltaResponse;               // 完整列表的LIST_DELTA_RESPONSE
+    QByteArray notModifiedResponse;             // 客户端已是本版本时的LIST_DELTA_RESPONSE
+    QHash<quint64, QByteArray> deltaResponses;  // 最近的旧版本到本版本的LIST_DELTA_RESPONSE
+
+    // 客户端缓存版本对应的LIST_DELTA_RESPONSE，没有该版本的增量时返回完整列表
+    const QByteArray &listDeltaResponse(quint64 clientVersion, ListDeltaKind &kind) const;
+};
+
+using ServerCatalogSnapshotPtr = std::shared_ptr<const ServerCatalogSnapshot>;
+
+class ServerCatalog;
+
+// 服务器目录线程中的执行对象
+class ServerCatalogWorker : public ThreadWorker
+{
+    Q_OBJECT
+
+public:
+    ServerCatalogWorker(ServerCatalog *catalog, const QString &filePath, int pollInterval, QObject *parent = nullptr);
+    ~ServerCatalogWorker();
+
+public slots:
+    // 在目录线程中创建DAO和文件监视，加载文件并发布第一个快照
+    void start() override;
+
+    // 在目录线程中释放DAO和文件监视
+    void stop() override;
+
+private slots:
+    void onFileChanged(const QString &path);
+    void onDirectoryChanged(const QString &path);
+
+    // 将文件中的变化写入test_server后刷新快照
+    void reloadFile();
+
+    // 读取test_server中的活跃服务器，内容变化时发布新快照
+    void refresh();
+
+private:
+    // 文件被替换（编辑器保存、mv覆盖）后监视会失效，需要重新加入
+    void watchFile();
+
+    ServerCatalog *catalog_;
+    QString file_path_;
+    int poll_interval_;
+    std::unique_ptr<ServerDAO> server_dao_;
+    QFileSystemWatcher *watcher_;
+    QTimer *reload_timer_; // 合并短时间内的多次文件变化
+    QTimer *poll_timer_;
+};
+
+// 测试服务器目录：监视ip_result.txt，并定期检查test_server（其他实例或手工修改的数据），
+// 有变化时发布新的不可变快照。会话通过snapshot()原子地取得当前快照，读取时不加锁、
+// 不访问数据库；旧快照在最后一个持有者释放后回收，目录更新不影响已建立的连接
+class ServerCatalog : public QObject, public Singleton<ServerCatalog>
+{
+    Q_OBJECT
+
+public:
+    // 启动目录线程，返回前完成文件的加载和第一个快照的发布
+    bool start(const QString &filePath, int pollInterval);
+
+    void stop();
+
+    bool isRunning() const;
+
+    // 当前快照，可在任意线程调用
+    ServerCatalogSnapshotPtr snapshot() const;
+
+    // 获取状态
+    quint64 getVersion() const { return snapshot()->version; }
+    quint64 getReloadCount() const { return reload_count_.loadRelaxed(); }
+
+    // 记录一次列表响应，用于统计各类响应的次数和发送的字节数
+    void recordListResponse(ListDeltaKind kind, qsizetype bytes);
+    quint64 getListResponseCount(ListDeltaKind kind) const;
+    quint64 getListResponseBytes() const { return list_response_bytes_.loadRelaxed(); }
+
+private:
+    friend class Singleton<ServerCatalog>;
+    friend class ServerCatalogWorker;
+
+    explicit ServerCatalog(QObject *parent = nullptr);
+    ~ServerCatalog();
+
+    // 发布新快照（目录线程调用）
+    void publish(const QList<ServerInfo> &servers);
+
+    // 计算从旧快照到新快照的增量响应，增量不小于完整列表时返回空
+    static QByteArray buildDeltaResponse(const ServerCatalogSnapshot &from, const ServerCatalogSnapshot &to);
+
+    // 保留多少个旧版本用于计算增量，更旧的客户端收到完整列表
+    static constexpr int MaxDeltaHistory = 16;
+
+    WorkerThread thread_;
+
+    // 通过std::atomic_load/atomic_store读写
+    ServerCatalogSnapshotPtr snapshot_;
+
+    QAtomicInteger<quint64> reload_count_;
+
+    // 最近发布的快照，只在目录线程中访问
+    QList<ServerCatalogSnapshotPtr> history_;
+
+    // 第一个快照的版本为version_base_ + 1。客户端会跨服务器重启缓存版本号，
+    // 每次启动使用随机的起点，避免新进程的版本号与上次运行的版本号相同而内容不同
+    quint64 version_base_;
+
+    QAtomicInteger<quint64> list_full_count_;
+    QAtomicInteger<quint64> list_delta_count_;
+    QAtomicInteger<quint64> list_not_modified_count_;
+    QAtomicInteger<quint64> list_response_bytes_;
+};
+
+#endif // SERVERCATALOG_H
@@ -0,0 +1,59 @@
+#ifndef SERVERCATALOGLOADER_H
+#define SERVERCATALOGLOADER_H
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+
+#include "common/types.h"
+
+// 一次加载的统计和耗时
+struct ServerCatalogLoadStats
+{
+    int lines = 0;      // 数据行数（不含表头）
+    int parsed = 0;     // 状态为success且格式有效的行
+    int skipped = 0;    // 状态不是success或格式无效的行
+    int duplicates = 0; // 同一位置重复出现的行（以最后一行为准）
+    int inserted = 0;   // 新增的服务器
+    int updated = 0;    // IP或活跃状态变化的服务器
+    int unchanged = 0;  // 与数据库一致的服务器
+    qint64 parseMs = 0;
+    qint64 diffMs = 0;
+    qint64 applyMs = 0;
+};
+
+// 从ip_result.txt加载测试服务器目录。
+// 文件每行为"序号, 状态, IP, 延迟, 位置描述"，第一行为表头，只加载状态为success的行。
+// 解析结果与test_server的现有内容对比，只有新增或变化的服务器通过多行插入或更新写入，
+// 内容未变化时不写数据库。文件中没有的服务器保持不变。
+// 大文件按行边界分块，在多个线程中并行解析
+class ServerCatalogLoader
+{
+public:
+    explicit ServerCatalogLoader(int chunkSize = 500);
+
+    // 解析文件并写入变化的服务器
+    bool load(const QString &filePath, ServerCatalogLoadStats &stats);
+
+    // 解析文件内容，同一位置出现多次时以最后一行为准（保留第一次出现的位置）
+    static QList<ServerCatalogEntry> parse(const QByteArray &content, ServerCatalogLoadStats &stats);
+
+    // 解析点分十进制IPv4地址
+    static bool parseIPv4(const char *begin, const char *end, quint32 &address);
+
+private:
+    // 解析一段完整的行
+    static void parseLines(const char *begin, const char *end, QList<ServerCatalogEntry> &entries,
+                           ServerCatalogLoadStats &stats);
+
+    // 每条多行插入语句包含的服务器数
+    int chunk_size_;
+
+    // 单个线程至少解析的字节数，小文件不拆分
+    static constexpr int MinParallelChunkBytes = 256 * 1024;
+
+    // 与test_server.location的长度一致
+    static constexpr int MaxLocationLength = 128;
+};
+
+#endif // SERVERCATALOGLOADER_H
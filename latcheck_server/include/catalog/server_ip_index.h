@@ -0,0 +1,64 @@
+#ifndef SERVERIPINDEX_H
+#define SERVERIPINDEX_H
+
+#include <QtGlobal>
+#include <QList>
+
+#include "protocol/message_protocol.h"
+
+// 服务器ID到IP地址的只读索引，随目录快照构建一次后在所有会话间共享。
+// server_id为自增值，通常是连续的，此时按(server_id - 最小ID)直接定位；
+// ID过于稀疏（范围超过服务器数的4倍）时改为在有序数组中二分查找
+class ServerIpIndex
+{
+public:
+    ServerIpIndex();
+
+    // servers可以是任意顺序，同一ID出现多次时以最后一个为准
+    explicit ServerIpIndex(const QList<ServerInfo> &servers);
+
+    // 查找服务器的IP地址，找不到时返回false
+    bool find(quint32 serverId, quint32 &ipAddr) const
+    {
+        if (direct_)
+        {
+            quint32 offset = serverId - base_id_;
+            if (offset >= static_cast<quint32>(slots_.size()) || slots_.at(offset) == 0)
+            {
+                return false;
+            }
+            ipAddr = ips_.at(slots_.at(offset) - 1);
+            return true;
+        }
+        return findSorted(serverId, ipAddr);
+    }
+
+    bool contains(quint32 serverId) const
+    {
+        quint32 ipAddr;
+        return find(serverId, ipAddr);
+    }
+
+    int size() const { return ids_.size(); }
+    bool isEmpty() const { return ids_.isEmpty(); }
+
+    // 是否使用直接定位
+    bool isDirect() const { return direct_; }
+
+    // 索引占用的字节数（用于统计）
+    qsizetype memoryUsage() const;
+
+private:
+    bool findSorted(quint32 serverId, quint32 &ipAddr) const;
+
+    // ID范围不超过服务器数的这个倍数时使用直接定位
+    static constexpr int MaxDirectSpread = 4;
+
+    QList<quint32> ids_;   // 服务器ID，升序
+    QList<quint32> ips_;   // 与ids_对应的IP地址
+    QList<quint32> slots_; // 直接定位表：ips_下标加1，0表示该ID不存在
+    quint32 base_id_;
+    bool direct_;
+};
+
+#endif // SERVERIPINDEX_H
@@ -0,0 +1,109 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QMutex>
+#include <QAtomicInteger>
+#include <atomic>
+#include <vector>
+
+// HDR风格的对数线性直方图（单位：微秒）。
+// 每个2的幂区间划分为32个子桶，相对误差约3%，最大记录值约71分钟，超出部分计入最后一个桶。
+// 只允许一个线程写入；计数使用relaxed原子变量，其他线程可以随时读取合并。
+class alignas(64) LatencyHistogram
+{
+public:
+    static constexpr int SubBucketBits = 5;
+    static constexpr int SubBucketCount = 1 << SubBucketBits;
+    static constexpr int MaxValueBits = 32;
+    static constexpr int BucketCount = (MaxValueBits - SubBucketBits + 1) * SubBucketCount;
+
+    LatencyHistogram() = default;
+
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    // 记录一个值（仅所属线程调用）
+    void record(qint64 valueUs);
+
+    // 累加另一个直方图的计数（用于合并各线程的分片）
+    void merge(const LatencyHistogram &other);
+
+    quint64 count() const { return total_count_.loadRelaxed(); }
+    quint64 sum() const { return sum_.loadRelaxed(); }
+    quint64 max() const { return max_.loadRelaxed(); }
+    double mean() const;
+
+    // 百分位值（0-100），返回所在桶的上界
+    quint64 percentile(double percent) const;
+
+    // 不大于valueUs的记录数（按桶上界判断，用于导出累计分布）
+    quint64 countAtOrBelow(quint64 valueUs) const;
+
+    static int bucketIndex(quint64 valueUs);
+    static quint64 bucketUpperBound(int index);
+
+private:
+    QAtomicInteger<quint64> counts_[BucketCount];
+    QAtomicInteger<quint64> total_count_;
+    QAtomicInteger<quint64> sum_;
+    QAtomicInteger<quint64> max_;
+};
+
+// 请求处理阶段
+enum class LatencyStage
+{
+    Queue = 0, // 数据库任务排队
+    Parse,     // 请求反序列化
+    Database,  // 数据库任务执行
+    Serialize, // 响应序列化
+    Write,     // 响应写入socket
+    Total,     // 收到完整请求到发出响应
+    StageCount
+};
+
+// 按消息类型和处理阶段统计耗时。
+// 每个线程首次记录时创建自己的分片（按缓存行对齐），记录时不加锁、不与其他线程共享缓存行；
+// 查询时遍历所有分片合并结果。线程退出后分片保留，统计不会丢失。
+class LatencyStats
+{
+public:
+    static constexpr int MaxMessageTypes = 16; // 消息类型编号超出范围的计入0号
+
+    using TypeNameFunc = const char *(*)(quint32 msgType);
+
+    static LatencyStats *instance();
+
+    // 记录一次耗时（任意线程调用）
+    void record(quint32 msgType, LatencyStage stage, qint64 elapsedUs);
+
+    // 合并所有线程分片中指定消息类型和阶段的直方图
+    void merged(quint32 msgType, LatencyStage stage, LatencyHistogram &result) const;
+
+    // 生成可读的统计报告，每个有数据的消息类型和阶段一行
+    QString report(TypeNameFunc typeName = nullptr) const;
+
+    // 单调时钟（微秒）
+    static qint64 nowUs();
+
+    static const char *stageName(LatencyStage stage);
+
+private:
+    LatencyStats() = default;
+
+    static constexpr int StageCount = static_cast<int>(LatencyStage::StageCount);
+
+    // 线程分片，直方图在首次使用时分配
+    struct alignas(64) Shard
+    {
+        std::atomic<LatencyHistogram *> histograms[MaxMessageTypes][StageCount] = {};
+    };
+
+    Shard *localShard();
+
+    mutable QMutex shards_mutex_;
+    std::vector<Shard *> shards_;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,50 @@
+#ifndef SINGLETON_H
+#define SINGLETON_H
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <atomic>
+
+// 进程内单例：instance()首次调用时创建，destroyInstance()销毁。
+// instance()在请求处理路径上频繁调用，实例创建后只做一次acquire读取，不加锁；
+// 只有创建和销毁时加锁。destroyInstance()不能与其他线程的instance()及对实例的使用并发。
+// T的构造和析构函数可以是私有的，此时需要将Singleton<T>声明为友元
+template <typename T>
+class Singleton
+{
+public:
+    static T *instance()
+    {
+        T *instance = instance_.load(std::memory_order_acquire);
+        if (instance)
+        {
+            return instance;
+        }
+
+        QMutexLocker locker(&mutex_);
+        instance = instance_.load(std::memory_order_relaxed);
+        if (!instance)
+        {
+            instance = new T();
+            // release与上面的acquire配对，其他线程看到指针时构造已完成
+            instance_.store(instance, std::memory_order_release);
+        }
+        return instance;
+    }
+
+    static void destroyInstance()
+    {
+        QMutexLocker locker(&mutex_);
+        delete instance_.exchange(nullptr, std::memory_order_acq_rel);
+    }
+
+protected:
+    Singleton() = default;
+    ~Singleton() = default;
+
+private:
+    static inline std::atomic<T *> instance_{nullptr};
+    static inline QMutex mutex_;
+};
+
+#endif // SINGLETON_H
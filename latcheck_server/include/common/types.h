@@ -63,6 +63,16 @@ struct ReportRecord
     int latency = 10000;  // 对应表中的 latency，默认值10000
 };
 
+// 两个检测地点之间的估算延时（对应calculated_latencies表）：
+// 经过两地都测到的服务器中，两段延时之和最小的一个
+struct LocationPairLatency
+{
+    qint64 report1 = 0;   // 较小的report_id
+    qint64 report2 = 0;   // 较大的report_id
+    int latency = 0;      // 两段延时之和（毫秒）
+    quint32 serverId = 0; // 取得最小值的服务器ID
+};
+
 // 报告结构
 struct Report
 {
@@ -75,9 +85,30 @@ struct Report
     QList<ReportRecord> details;
 };
 
+// 测试服务器目录中的一个服务器（对应test_server表，以location为唯一键）
+struct ServerCatalogEntry
+{
+    QString location;
+    quint32 ipAddr = 0;
+    bool active = true;
+};
+
+// 报告列表的分页位置：按(created_time, report_id)降序排列时最后一条报告的键值。
+// 默认值表示从最新的报告开始
+struct ReportPageCursor
+{
+    QDateTime createdTime;
+    qint64 reportId = 0;
+
+    bool isStart() const { return reportId == 0; }
+};
+
 // 数据库配置结构
 struct DatabaseConfig
 {
+    QString backend = "mysql"; // 存储后端：mysql或sqlite
+    QString sqlitePath = "data/latcheck.db";
+    QString sqliteSchema = "database/create_database_sqlite.sql"; // SQLite数据库为空时执行的建表脚本
     QString host = "localhost";
     int port = 3306;
     QString database = "latcheck";
@@ -87,6 +118,14 @@ struct DatabaseConfig
     int maxConnections = 10;
     int connectionTimeout = 30;
     int idleTimeout = 300; // 添加空闲超时时间（秒）
+    int validateAfterIdleMs = 30000; // 空闲超过该时间的连接借出前验证（毫秒，-1为不验证）
+    int workerThreads = 4; // 数据库执行线程数
+    int insertChunkSize = 500; // 批量插入时每条语句包含的行数
+    QString recordStorage = "rows"; // 新报告记录的存储方式："rows"逐行存储，"packed"每个报告一行紧凑存储
+    int statementCacheSize = 64; // 每个连接缓存的预处理语句数
+    int groupCommitMaxReports = 64; // 组提交：每个事务最多包含的报告数
+    int groupCommitMaxDelayMs = 20; // 组提交：报告最长等待时间（毫秒）
+    bool calculateLatencies = true; // 报告入库后增量计算地点间延时（calculated_latencies）
     QString charset = "utf8mb4";
     bool enableSSL = false;
     QString sslCert;
@@ -104,6 +143,21 @@ struct ServerConfig
     int port = 8443;
     int maxConnections = 1000;
     int connectionTimeout = 300;
+    int authTimeout = 10;  // 登录超时（秒）
+    int workerThreads = 0; // 连接工作线程数，0表示按CPU核数自动确定
+    int sessionBufferLimit = 65536; // 每个会话接收缓冲区上限（字节），超过该长度的消息直接断开
+    bool tlsSessionResumption = true;  // 是否启用TLS会话复用
+    bool tlsSessionTickets = true;     // 是否启用TLS会话票据
+    int tlsSessionCacheSize = 20480;   // TLS会话缓存最大条目数
+    int tlsSessionTimeout = 7200;      // TLS会话有效期（秒）
+    int tlsTicketRotationInterval = 3600; // 会话票据密钥轮换间隔（秒）
+    double perIpConnectRate = 10.0;       // 每个源IP每秒允许的新建连接数，0表示不限制
+    int perIpConnectBurst = 20;           // 每个源IP允许的突发连接数
+    int maxPendingHandshakes = 256;       // 同时进行中的TLS握手上限，0表示不限制
+    int acceptQueueHighWatermark = 512;   // 等待工作线程接管的连接上限，0表示不限制
+    int admissionIpTableSize = 4096;      // 源IP令牌桶表条目数
+    QString serverListFile = "config/ip_result.txt"; // 测试服务器列表文件，修改后自动加载
+    int serverCatalogPollInterval = 30;   // 检查test_server变化的间隔（秒），0表示不检查
     bool enableSSL = true;
     QString certificatePath;
     QString privateKeyPath;
@@ -113,7 +167,8 @@ struct ServerConfig
 // API配置结构
 struct ApiConfig
 {
-    QString host = "0.0.0.0";
+    bool enabled = false;
+    QString host = "127.0.0.1"; // 默认只接受本机连接，对外开放需显式配置
     int port = 8080;
     bool enableSSL = false;
     QString certificatePath;
@@ -121,6 +176,11 @@ struct ApiConfig
     bool enableCORS = true;
     QStringList allowedOrigins;
     QString logLevel = "INFO";
+    int keepAliveTimeout = 30;       // 空闲连接保持时间（秒）
+    int maxPipelinedRequests = 16;   // 每个连接同时处理的请求数上限
+    int maxConnections = 1000;       // 同时打开的连接上限
+    int reportCacheEntries = 4096;   // 报告及其记录的缓存条目数
+    int tokenTtl = 86400;            // 登录令牌有效期（秒）
 };
 
 // TLS配置结构
@@ -134,6 +194,14 @@ struct TlsConfig
     QString clientCertPath;
 };
 
+// 监控端点配置结构（仅监听本机回环地址）
+struct MetricsConfig
+{
+    bool enabled = true;
+    QString host = "127.0.0.1";
+    int port = 9100;
+};
+
 // 日志配置结构
 struct LogConfig
 {
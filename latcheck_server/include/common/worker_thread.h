@@ -0,0 +1,79 @@
+#ifndef WORKERTHREAD_H
+#define WORKERTHREAD_H
+
+#include <QObject>
+#include <QThread>
+#include <QString>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+
+// 在专用线程中运行的工作对象。start()在线程启动后、stop()在线程结束前于该线程中执行，
+// 子类在start()中创建DAO、定时器等对象，使其线程亲和性与使用它们的线程一致
+class ThreadWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ThreadWorker(QObject *parent = nullptr);
+    ~ThreadWorker() override;
+
+public slots:
+    virtual void start() = 0;
+    virtual void stop() = 0;
+};
+
+// 工作线程：拥有一个线程及其中的工作对象。
+// 停止时在线程中执行工作对象的stop()，随后关闭该线程持有的数据库连接（连接与线程绑定），再结束线程
+class WorkerThread
+{
+public:
+    WorkerThread() = default;
+    ~WorkerThread();
+
+    WorkerThread(const WorkerThread &) = delete;
+    WorkerThread &operator=(const WorkerThread &) = delete;
+
+    // 创建线程并将worker移入，取得worker的所有权。
+    // waitStarted为true时等待worker->start()执行完毕后返回
+    void start(const QString &name, ThreadWorker *worker, bool waitStarted = false);
+
+    // 在线程中执行worker->stop()并等待线程结束
+    void stop();
+
+    bool isRunning() const { return thread_ != nullptr; }
+
+    template <typename Worker>
+    Worker *worker() const { return static_cast<Worker *>(worker_); }
+
+private:
+    QThread *thread_ = nullptr;
+    ThreadWorker *worker_ = nullptr;
+};
+
+// 已提交但尚未完成的任务计数，可以等待计数归零
+class PendingCounter
+{
+public:
+    PendingCounter() = default;
+
+    PendingCounter(const PendingCounter &) = delete;
+    PendingCounter &operator=(const PendingCounter &) = delete;
+
+    int count() const { return count_.loadRelaxed(); }
+
+    void add(int n = 1) { count_.fetchAndAddRelaxed(n); }
+
+    // 完成n个任务，计数归零时唤醒等待方
+    void finish(int n = 1);
+
+    // 等待计数归零，超时返回false
+    bool waitForZero(int timeoutMs);
+
+private:
+    QAtomicInt count_;
+    QMutex mutex_;
+    QWaitCondition idle_;
+};
+
+#endif // WORKERTHREAD_H
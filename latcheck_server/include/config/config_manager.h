@@ -31,6 +31,7 @@ public:
     ApiConfig getApiConfig() const;
     TlsConfig getTlsConfig() const;
     LogConfig getLogConfig() const;
+    MetricsConfig getMetricsConfig() const;
 
     // 数据库配置获取方法
     QString getDatabaseHost() const;
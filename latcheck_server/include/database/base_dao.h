@@ -7,10 +7,51 @@
 #include <QSqlError>
 #include <QVariant>
 #include <QDateTime>
+#include <QStringList>
 #include "common/types.h"
 #include "common/error_codes.h"
 #include "database/database_pool.h"
 
+// 查询结果：持有执行查询的连接和语句，析构时结束结果集并归还连接。
+// 语句取自连接的语句缓存，读取结果期间连接不归还，同一线程的其他查询使用其他连接，
+// 不会覆盖尚未读完的结果集。只能在执行查询的线程中使用，读完后应尽快析构
+class QueryResult
+{
+public:
+    QueryResult(QueryResult &&other) noexcept;
+    ~QueryResult();
+
+    QueryResult(const QueryResult &) = delete;
+    QueryResult &operator=(const QueryResult &) = delete;
+    QueryResult &operator=(QueryResult &&) = delete;
+
+    bool next() { return query_->next(); }
+    bool isValid() const { return query_->isValid(); }
+    QVariant value(int index) const { return query_->value(index); }
+    QVariant value(const QString &name) const { return query_->value(name); }
+    QSqlError lastError() const { return query_->lastError(); }
+    int size() const { return query_->size(); }
+    int numRowsAffected() const { return query_->numRowsAffected(); }
+
+    // 提前结束结果集并归还连接（之后不能再读取），析构时自动调用
+    void finish();
+
+    // 供按QSqlQuery读取行的辅助函数（如ColumnIndex）使用
+    const QSqlQuery &query() const { return *query_; }
+    operator const QSqlQuery &() const { return *query_; }
+
+private:
+    friend class BaseDAO;
+
+    QueryResult(DatabasePool *pool, const QSqlDatabase &db, bool releaseConnection);
+
+    DatabasePool *pool_;
+    QSqlDatabase db_;
+    QSqlQuery own_query_;   // 事务中、连接不可用或prepare失败时使用的独立语句
+    QSqlQuery *query_;      // 指向缓存中的语句或own_query_
+    bool release_;          // 析构时归还连接（事务连接在事务结束时归还）
+};
+
 class BaseDAO : public QObject
 {
     Q_OBJECT
@@ -19,20 +60,45 @@ public:
     explicit BaseDAO(QObject *parent = nullptr);
     virtual ~BaseDAO() override;
 
-    // 执行SQL查询
-    QSqlQuery executeQuery(const QString &sql, const QVariantList &params = {});
+    // 执行SQL查询，语句取自连接的语句缓存（事务中使用独立的语句）。
+    // 结果集只能用next()向前遍历，驱动不需要保留已读取的行；连接在返回的结果析构时归还
+    QueryResult executeQuery(const QString &sql, const QVariantList &params = {});
     // 执行SQL更新
     bool executeUpdate(const QString &sql, const QVariantList &params = {});
 
+    // 批量插入：每chunkSize行合并为一条多行INSERT，完整分块的语句缓存在连接中，不足chunkSize行的最后一块单独prepare。
+    // rows中每一项为一行的列值，顺序与columns一致；suffix附加在VALUES之后（如插入冲突时的更新子句）。
+    // 返回执行的语句数，失败返回-1
+    int executeBatchInsert(const QString &table, const QStringList &columns,
+                           const QList<QVariantList> &rows, int chunkSize, const QString &suffix = QString());
+
     // 事务管理
     bool beginTransaction();
     bool commitTransaction();
     bool rollbackTransaction();
 
+    // 事务内保存点（用于组提交中单独回滚部分数据）
+    bool createSavepoint(const QString &name);
+    bool rollbackToSavepoint(const QString &name);
+    bool releaseSavepoint(const QString &name);
+
     // 获取最后插入的ID
     qint64 getLastInsertId();
 
 protected:
+    // 从连接的语句缓存中取得已预处理的语句（未命中时prepare），失败返回nullptr。
+    // 返回的语句属于连接，只能在释放连接前使用，绑定参数后用executeStatement执行
+    QSqlQuery *cachedStatement(const QSqlDatabase &db, const QString &sql);
+
+    // 执行语句，连接错误时使该连接的语句缓存失效
+    bool executeStatement(const QSqlDatabase &db, QSqlQuery &query);
+
+    // 语句因连接错误失败时标记连接的语句缓存失效
+    void markStatementsStale(const QSqlDatabase &db, const QSqlQuery &query);
+
+    // 当前存储后端的SQL方言
+    const SqlDialect &dialect() const { return pool_->dialect(); }
+
     // 参数绑定
     void bindParameters(QSqlQuery &query, const QVariantList &params);
     // SQL错误日志
@@ -46,6 +112,9 @@ protected:
     bool validateParameters(const QVariantList &params, int expectedCount);
 
 private:
+    // 在事务连接上直接执行保存点语句
+    bool executeSavepointCommand(const QString &sql);
+
     // 调整顺序以匹配构造函数中的初始化顺序
     bool in_transaction_;
     DatabasePool *pool_;
@@ -0,0 +1,38 @@
+#ifndef CALCULATEDLATENCYDAO_H
+#define CALCULATEDLATENCYDAO_H
+
+#include <QList>
+#include <QSet>
+#include "database/base_dao.h"
+#include "common/types.h"
+
+// calculated_latencies表的访问：每对检测地点保存一行，
+// 由两个地点各自的最新报告ID标识（report1 < report2）
+class CalculatedLatencyDAO : public BaseDAO
+{
+    Q_OBJECT
+
+public:
+    explicit CalculatedLatencyDAO(QObject *parent = nullptr);
+
+    // 在一个事务中删除replacedReportId参与的所有地点对（为0时不删除），并写入新的地点对
+    bool replacePairs(qint64 replacedReportId, const QList<LocationPairLatency> &pairs);
+
+    // 删除不属于任何地点最新报告的地点对，返回删除的行数，失败返回-1
+    int deleteStalePairs();
+
+    // 获取出现在地点对中的报告ID
+    QSet<qint64> getReportsWithPairs();
+
+    // 获取所有地点对
+    QList<LocationPairLatency> getAllPairs();
+
+    // 获取地点对数量
+    int getPairCount();
+
+private:
+    // 每条多行INSERT包含的行数
+    int insert_chunk_size_;
+};
+
+#endif // CALCULATEDLATENCYDAO_H
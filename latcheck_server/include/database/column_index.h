@@ -0,0 +1,43 @@
+#ifndef COLUMNINDEX_H
+#define COLUMNINDEX_H
+
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QLatin1String>
+#include <QVariant>
+#include <array>
+#include <cstddef>
+
+// 结果集的列序号表：执行查询后按列名查找一次序号，逐行读取时按序号取值，
+// 避免每行的每个字段都按名称查找列。names的顺序与调用方的列枚举一致：
+//   enum UserColumn { UserIdColumn, UserNameColumn, UserColumnCount };
+//   ColumnIndex<UserColumnCount> columns(query, {"user_id", "username"});
+//   while (query.next()) { qint64 id = columns.value(query, UserIdColumn).toLongLong(); ... }
+// 结果集中没有的列序号为-1，读取时返回无效值
+template <std::size_t N>
+class ColumnIndex
+{
+public:
+    ColumnIndex(const QSqlQuery &query, const std::array<const char *, N> &names)
+    {
+        const QSqlRecord record = query.record();
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            ordinals_[i] = record.indexOf(QLatin1String(names[i]));
+        }
+    }
+
+    int operator[](std::size_t column) const { return ordinals_[column]; }
+
+    bool contains(std::size_t column) const { return ordinals_[column] >= 0; }
+
+    QVariant value(const QSqlQuery &query, std::size_t column) const
+    {
+        return ordinals_[column] >= 0 ? query.value(ordinals_[column]) : QVariant();
+    }
+
+private:
+    std::array<int, N> ordinals_;
+};
+
+#endif // COLUMNINDEX_H
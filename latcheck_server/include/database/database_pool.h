@@ -3,16 +3,29 @@
 
 #include <QObject>
 #include <QSqlDatabase>
-#include <QQueue>
+#include <QList>
+#include <QHash>
 #include <QMutex>
 #include <QWaitCondition>
 #include <QTimer>
 #include <QThread>
+#include <deque>
 #include "common/types.h"
+#include "common/latency_histogram.h"
+#include "database/statement_cache.h"
+#include "database/sql_dialect.h"
 #include "logger/logger.h"
 
 
 
+// 线程绑定的数据库连接池。
+// Qt要求连接只能在创建它的线程中使用，因此每个线程维护自己的空闲连接（后进先出），
+// 连接只会借给创建它的线程；所有线程的连接总数受max_connections限制。
+// 达到上限时请求按先来先服务排队：优先使用本线程归还的连接，否则回收其他线程
+// 空闲时间最长的连接名额，被回收的连接投递到其所属线程的事件循环中关闭。
+// 有事件循环的线程各有一个清理定时器，即使线程不再访问连接池，空闲超时的连接也会被关闭；
+// 没有事件循环的线程在下次访问连接池时清理。
+// 空闲连接只在空闲时间超过validate_after_idle毫秒后借出时才执行SELECT 1验证。
 class DatabasePool : public QObject
 {
     Q_OBJECT
@@ -20,63 +33,156 @@ class DatabasePool : public QObject
 public:
     static DatabasePool* instance();
     static void destroyInstance();
-    
+
     // 初始化连接池
     bool initialize(const DatabaseConfig& config);
-    
-    // 获取数据库连接
+
+    // 当前存储后端的SQL方言
+    const SqlDialect &dialect() const { return dialect_; }
+
+    // 获取数据库连接（连接只能在当前线程中使用）
     QSqlDatabase getConnection();
-    
-    // 释放数据库连接
+
+    // 释放数据库连接（必须在获取连接的线程中调用）
     void releaseConnection(QSqlDatabase& db);
-    
+
+    // 关闭当前线程的所有空闲连接，线程退出前调用
+    void releaseThreadConnections();
+
     // 关闭连接池
     void close();
-    
+
     // 获取连接池状态
-    int getActiveConnections() const { return active_connections_; }
-    int getIdleConnections() const { return idle_connections_.size(); }
-    int getTotalConnections() const { return active_connections_ + idle_connections_.size(); }
-    
+    int getActiveConnections() const;
+    int getIdleConnections() const;
+    int getTotalConnections() const;
+    int getWaitingRequests() const;
+
+    // 获取连接的等待时间分布（微秒）和超时次数
+    const LatencyHistogram &getAcquireWaitHistogram() const { return acquire_wait_histogram_; }
+    quint64 getAcquireTimeouts() const { return acquire_timeouts_.loadRelaxed(); }
+
+    // 借出时执行验证的次数和验证失败的次数
+    quint64 getValidationCount() const { return validations_.loadRelaxed(); }
+    quint64 getValidationFailures() const { return validation_failures_.loadRelaxed(); }
+
+    // 获取连接对应的预处理语句缓存（只能在连接所属的线程中调用，不加锁），连接无效时返回nullptr
+    StatementCache *statementCache(const QSqlDatabase &db);
+
+    // 预处理语句缓存统计
+    quint64 getStatementCacheHits() const { return statement_cache_stats_.hits.loadRelaxed(); }
+    quint64 getStatementCacheMisses() const { return statement_cache_stats_.misses.loadRelaxed(); }
+    quint64 getStatementCacheEvictions() const { return statement_cache_stats_.evictions.loadRelaxed(); }
+    quint64 getStatementCacheInvalidations() const { return statement_cache_stats_.invalidations.loadRelaxed(); }
+
     // 测试数据库连接
     bool testConnection();
-    
+
 private slots:
     void checkConnections();
-    
+
 private:
     explicit DatabasePool(QObject *parent = nullptr);
     ~DatabasePool();
-    
+
     friend class std::default_delete<DatabasePool>;
+
+    // 空闲连接
+    struct IdleConnection
+    {
+        QSqlDatabase db;
+        qint64 idleSinceMs = 0; // 归还时间（单调时钟，毫秒）
+    };
+
+    // 每个线程的连接
+    struct ThreadConnections
+    {
+        QList<IdleConnection> idle;  // 表尾为最近归还
+        QList<QSqlDatabase> retired; // 名额已被其他线程回收、等待本线程关闭的连接
+        QTimer *purgeTimer = nullptr; // 属于该线程的清理定时器，也用于向该线程投递关闭任务
+    };
+
+    // 排队等待连接的请求
+    struct Waiter
+    {
+        QThread *thread = nullptr;
+        QWaitCondition condition;
+        bool granted = false;
+        IdleConnection connection; // 分配到的本线程空闲连接，连接无效时表示分配到新建连接的名额
+    };
+
+    // 为指定线程分配连接或新建名额，无法分配时返回false（需持有connection_mutex_）
+    bool takeSlot(QThread *thread, IdleConnection &slot);
+
+    // 按先来先服务顺序为排队的请求分配连接（需持有connection_mutex_）
+    void grantWaiters();
+
+    // 从其他线程回收空闲时间最长的连接的名额（需持有connection_mutex_）
+    bool retireOldestIdle(QThread *exclude);
+
+    // 取出当前线程待关闭的连接，以及空闲超时的连接（需持有connection_mutex_）
+    QList<QSqlDatabase> takeExpired(QThread *thread);
+
+    // 为当前线程创建清理定时器，线程没有事件循环时不创建（需持有connection_mutex_）
+    void ensurePurgeTimer(ThreadConnections &connections);
+
+    // 关闭当前线程待关闭和空闲超时的连接（在连接所属线程的事件循环中执行）
+    void purgeThreadConnections();
+
+    // 生成当前线程的新连接名（需持有connection_mutex_）
+    QString nextConnectionName();
+
     // 创建新连接
-    QSqlDatabase createConnection();
-    
+    QSqlDatabase createConnection(const QString &connectionName);
+    QSqlDatabase createSqliteConnection(const QString &connectionName);
+
+    // SQLite数据库文件中没有表时执行建表脚本
+    bool initializeSqliteSchema(QSqlDatabase &db);
+
+    // 关闭连接并从Qt连接表中移除（调用方不能再持有该连接的其他副本）
+    void discardConnections(QList<QSqlDatabase> connections);
+
     // 验证连接是否有效
     bool isConnectionValid(const QSqlDatabase& db);
-    
-    // 清理无效连接
-    void cleanupInvalidConnections();
-    
+
+    // 连接关闭或被替换前丢弃其语句缓存（在连接所属的线程中调用）
+    void dropStatementCache(const QSqlDatabase &db);
+
+    static qint64 nowMs() { return LatencyStats::nowUs() / 1000; }
+
     static DatabasePool* instance_;
     static QMutex mutex_;
-    
+
     DatabaseConfig config_;
-    QQueue<QSqlDatabase> idle_connections_;
-    QMutex connection_mutex_;
-    QWaitCondition connection_condition_;
-    
-    int active_connections_;
+    SqlDialect dialect_;
+    QHash<QThread *, ThreadConnections> threads_;
+    std::deque<Waiter *> waiters_;
+    mutable QMutex connection_mutex_;
+
+    int active_connections_; // 已借出
+    int idle_connections_;   // 各线程空闲连接总数
+    int open_connections_;   // 占用名额的连接总数（借出 + 空闲 + 正在创建）
     int connection_counter_;
     bool initialized_;
-    
+
     QTimer* health_check_timer_;
-    
+
     // 连接池配置
     int min_connections_;
     int max_connections_;
-    int connection_timeout_; // 获取连接超时时间（毫秒）
-    int idle_timeout_;       // 空闲连接超时时间（秒）
+    int connection_timeout_;   // 获取连接超时时间（毫秒）
+    int idle_timeout_;         // 空闲连接超时时间（秒）
+    int validate_after_idle_;  // 空闲超过该时间（毫秒）的连接借出前验证
+
+    // 获取连接的等待时间，在connection_mutex_内记录（单写者）
+    LatencyHistogram acquire_wait_histogram_;
+    QAtomicInteger<quint64> acquire_timeouts_;
+    QAtomicInteger<quint64> validations_;
+    QAtomicInteger<quint64> validation_failures_;
+
+    // 预处理语句缓存保存在各线程中，这里只有统计
+    StatementCacheStats statement_cache_stats_;
+    int statement_cache_size_;
 };
 
 // RAII连接管理器
@@ -85,10 +191,10 @@ class DatabaseConnection
 public:
     DatabaseConnection();
     ~DatabaseConnection();
-    
+
     QSqlDatabase& database() { return db_; }
     bool isValid() const { return db_.isValid() && db_.isOpen(); }
-    
+
 private:
     QSqlDatabase db_;
 };
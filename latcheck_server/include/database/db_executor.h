@@ -0,0 +1,159 @@
+#ifndef DBEXECUTOR_H
+#define DBEXECUTOR_H
+
+#include <QObject>
+#include <QList>
+#include <QMutex>
+#include <QAtomicInt>
+#include <memory>
+#include <exception>
+#include <type_traits>
+
+#include "common/singleton.h"
+#include "common/worker_thread.h"
+#include "database/user_dao.h"
+#include "database/report_dao.h"
+#include "database/server_dao.h"
+#include "database/calculated_latency_dao.h"
+#include "logger/logger.h"
+
+// DB线程上下文：每个DB工作线程持有自己的一组DAO实例，
+// DAO内部的事务状态和数据库连接只会在该线程中使用
+struct DbContext
+{
+    UserDAO *userDao = nullptr;
+    ReportDAO *reportDao = nullptr;
+    ServerDAO *serverDao = nullptr;
+    CalculatedLatencyDAO *calculatedLatencyDao = nullptr;
+};
+
+// DB工作线程中的执行对象
+class DbWorker : public ThreadWorker
+{
+    Q_OBJECT
+
+public:
+    explicit DbWorker(int index, QObject *parent = nullptr);
+    ~DbWorker();
+
+    int index() const { return index_; }
+
+    // 已提交但尚未完成的任务数
+    int pendingJobs() const { return pending_jobs_.loadRelaxed(); }
+
+    DbContext &context() { return context_; }
+
+    void jobQueued() { pending_jobs_.ref(); }
+    void jobFinished() { pending_jobs_.deref(); }
+
+public slots:
+    // 在DB线程中创建DAO实例
+    void start() override;
+
+    // 在DB线程中释放DAO实例
+    void stop() override;
+
+private:
+    int index_;
+    QAtomicInt pending_jobs_;
+
+    std::unique_ptr<UserDAO> user_dao_;
+    std::unique_ptr<ReportDAO> report_dao_;
+    std::unique_ptr<ServerDAO> server_dao_;
+    std::unique_ptr<CalculatedLatencyDAO> calculated_latency_dao_;
+    DbContext context_;
+};
+
+// 异步DAO执行器：数据库操作在专用的DB线程池中执行，
+// 结果通过回调投递回调用方所在线程，避免阻塞socket事件循环
+class DbExecutor : public QObject, public Singleton<DbExecutor>
+{
+    Q_OBJECT
+
+public:
+    // 启动DB工作线程
+    bool start(int threadCount);
+
+    // 停止DB工作线程（等待已提交任务完成）
+    void stop();
+
+    bool isRunning() const;
+
+    // 获取状态
+    int getWorkerCount() const;
+    int getPendingJobs() const { return pending_jobs_.count(); }
+
+    // 等待所有已提交任务执行完毕
+    bool waitForIdle(int timeoutMs = 30000);
+
+    // 提交数据库任务：job在DB线程中以DbContext&为参数执行，
+    // done在context对象所在线程中以job的返回值为参数执行。
+    // job抛出异常时done收到默认构造的结果，因此结果类型的默认值应表示失败。
+    // context必须在任务完成前保持有效（调用方在销毁前应先waitForIdle）。
+    template <typename Job, typename Done>
+    bool submit(QObject *context, Job job, Done done);
+
+private:
+    friend class Singleton<DbExecutor>;
+
+    explicit DbExecutor(QObject *parent = nullptr);
+    ~DbExecutor();
+
+    // 选择待处理任务最少的DB工作线程
+    DbWorker *selectWorker() const;
+
+    QList<WorkerThread *> threads_;
+    mutable QMutex workers_mutex_;
+
+    PendingCounter pending_jobs_;
+};
+
+template <typename Job, typename Done>
+bool DbExecutor::submit(QObject *context, Job job, Done done)
+{
+    using Result = std::decay_t<std::invoke_result_t<Job &, DbContext &>>;
+
+    DbWorker *worker = selectWorker();
+    if (!worker || !context)
+    {
+        Logger::instance()->error("Database executor is not running, job rejected", "DbExecutor");
+        return false;
+    }
+
+    worker->jobQueued();
+    pending_jobs_.add();
+
+    QMetaObject::invokeMethod(
+        worker,
+        [this, worker, context, job = std::move(job), done = std::move(done)]() mutable
+        {
+            Result result{};
+            try
+            {
+                result = job(worker->context());
+            }
+            catch (const std::exception &e)
+            {
+                Logger::instance()->error(QString("Exception in database job: %1").arg(e.what()), "DbExecutor");
+            }
+            catch (...)
+            {
+                Logger::instance()->error("Unknown exception in database job", "DbExecutor");
+            }
+
+            // 将结果投递回调用方线程
+            QMetaObject::invokeMethod(
+                context,
+                [done = std::move(done), result = std::move(result)]() mutable
+                { done(result); },
+                Qt::QueuedConnection);
+
+            worker->jobFinished();
+            pending_jobs_.finish();
+        },
+        Qt::QueuedConnection);
+
+    return true;
+}
+
+#endif // DBEXECUTOR_H
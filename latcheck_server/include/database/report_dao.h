@@ -3,7 +3,9 @@
 
 #include "common/error_codes.h"
 #include <QList>
+#include <functional>
 #include "database/base_dao.h"
+#include "database/column_index.h"
 #include "common/types.h"
 
 class ReportDAO : public BaseDAO
@@ -19,6 +21,12 @@ public:
     // 创建报告（带记录列表）
     ErrorCode createReport(const Report &report, const QList<ReportRecord> &records = QList<ReportRecord>());
 
+    // 在同一个事务中创建一组报告（组提交），records[i]为reports[i]的记录列表。
+    // 每个报告使用独立的保存点，失败的报告单独回滚；返回每个报告的结果。
+    // reportIds不为空时返回每个报告的ID（未写入的报告为0）
+    QList<ErrorCode> createReportGroup(const QList<Report> &reports, const QList<QList<ReportRecord>> &records,
+                                       QList<qint64> *reportIds = nullptr);
+
     // 根据ID获取报告
     Report getReportById(qint64 reportId);
 
@@ -34,6 +42,22 @@ public:
     // 获取所有报告列表
     QList<Report> getAllReports(int limit = 100, int offset = 0);
 
+    // 键集分页：按(created_time, report_id)降序返回after之后的最多limit个报告，
+    // next不为空时设置为本页最后一个报告的位置（没有更多报告时为after）。
+    // 与OFFSET分页不同，每页的查询代价与页的深度无关
+    QList<Report> getReportsPage(const ReportPageCursor &after, int limit, ReportPageCursor *next = nullptr);
+    QList<Report> getReportsPageByUserName(const QString &userName, const ReportPageCursor &after, int limit,
+                                           ReportPageCursor *next = nullptr);
+    QList<Report> getReportsPageByLocation(const QString &location, const ReportPageCursor &after, int limit,
+                                           ReportPageCursor *next = nullptr);
+
+    // 流式遍历：按同样的顺序每次读取batchSize个报告交给callback，callback返回false时停止。
+    // 内存占用只与batchSize有关，用于导出等需要遍历大量报告的场景；查询失败返回false
+    using ReportBatchCallback = std::function<bool(const QList<Report> &reports)>;
+    bool streamReports(const ReportBatchCallback &callback, int batchSize = 500);
+    bool streamReportsByUserName(const QString &userName, const ReportBatchCallback &callback, int batchSize = 500);
+    bool streamReportsByLocation(const QString &location, const ReportBatchCallback &callback, int batchSize = 500);
+
     // 获取报告数量
     int getReportCount();
 
@@ -46,17 +70,89 @@ public:
     // 获取最新报告
     Report getLatestReportByUserName(const QString &userName);
 
-    // 获取报告详细记录
+    // 获取每个检测地点的最新报告（按报告ID升序）
+    QList<Report> getLatestReportPerLocation();
+
+    // 获取报告详细记录（紧凑存储和逐行存储的报告都可读取，一次查询同时取得两种存储）
     QList<ReportRecord> getReportRecords(qint64 reportId);
 
+    // 紧凑存储：一个报告的所有延迟记录编码为一个二进制值。
+    // 格式：版本号(1字节)、记录数(varint)，之后每条记录依次为
+    // 服务器ID与上一条的差值(zigzag varint)、延迟(varint，写入前已检查在0到10000之间)、服务器IP(4字节大端序)。
+    // 记录保持原有顺序，客户端按服务器ID顺序上报时差值通常只占1字节；解码出的record_id为0
+    static QByteArray encodeRecords(const QList<ReportRecord> &records);
+    static bool decodeRecords(const QByteArray &payload, qint64 reportId, QList<ReportRecord> &records);
+
+    // 数据迁移：获取仍以逐行方式存储记录的报告ID（大于afterId，按ID升序）
+    QList<qint64> getReportIdsWithRowRecords(qint64 afterId, int limit);
+
+    // 数据迁移：将一个报告的逐行记录转换为紧凑存储，并删除原有行（在同一事务中）
+    ErrorCode packReportRecords(qint64 reportId, int *recordCount = nullptr);
+
 private:
+    // 写入报告及其记录（调用方负责事务），成功时返回报告ID
+    ErrorCode insertReport(const Report &report, const QList<ReportRecord> &records, qint64 &reportId);
+
+    // 整组回滚时将已写入和未处理的报告标记为事务失败
+    static void failPending(QList<ErrorCode> &results);
+
+    // 记录报告创建成功的审计日志
+    void logReportCreated(const Report &report, int recordCount, qint64 reportId);
+
+    // 查询一页报告，filterColumn为空时不过滤
+    bool queryReportsPage(const QString &filterColumn, const QVariant &filterValue, const ReportPageCursor &after,
+                          int limit, QList<Report> &reports);
+    bool streamReportsBy(const QString &filterColumn, const QVariant &filterValue,
+                         const ReportBatchCallback &callback, int batchSize);
+
+    // 查询结果中的列，每个结果集解析一次序号
+    enum ReportColumn
+    {
+        ReportIdColumn,
+        ReportLocationColumn,
+        ReportUserNameColumn,
+        ReportCreatedTimeColumn,
+        ReportColumnCount
+    };
+    enum RecordColumn
+    {
+        RecordIdColumn,
+        RecordReportIdColumn,
+        RecordServerIpColumn,
+        RecordServerIdColumn,
+        RecordLatencyColumn,
+        RecordColumnCount
+    };
+    using ReportColumns = ColumnIndex<ReportColumnCount>;
+    using RecordColumns = ColumnIndex<RecordColumnCount>;
+    static ReportColumns reportColumns(const QSqlQuery &query);
+    static RecordColumns recordColumns(const QSqlQuery &query);
+
     // 从查询结果构建报告对象
-    Report buildReportFromQuery(const QSqlQuery &query);
+    Report buildReportFromQuery(const QSqlQuery &query, const ReportColumns &columns);
 
     // 从查询结果构建报告详细对象
-    ReportRecord buildReportRecordFromQuery(const QSqlQuery &query);
+    ReportRecord buildReportRecordFromQuery(const QSqlQuery &query, const RecordColumns &columns);
+
+    // 逐行存储/紧凑存储的记录读写
+    bool getRowRecords(qint64 reportId, QList<ReportRecord> &records);
+    bool getPackedRecords(qint64 reportId, QList<ReportRecord> &records, bool &found);
+    bool insertRowRecords(qint64 reportId, const QList<ReportRecord> &records);
+    bool insertPackedRecords(qint64 reportId, const QList<ReportRecord> &records);
 
     // 验证报告数据
     bool validateReportData(const Report &report);
+
+    // 验证记录的延时范围，两种存储方式使用相同的规则
+    bool validateRecords(const QList<ReportRecord> &records);
+
+    // 延时的有效范围，与report_record表的CHECK约束一致
+    static constexpr int MaxRecordLatency = 10000;
+
+    // 每条多行INSERT包含的记录数
+    int insert_chunk_size_;
+
+    // 新报告的记录使用紧凑存储
+    bool packed_records_;
 };
 #endif // REPORTDAO_H
\ No newline at end of file
@@ -0,0 +1,137 @@
+#ifndef REPORTINGESTQUEUE_H
+#define REPORTINGESTQUEUE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <functional>
+#include <memory>
+
+#include "common/types.h"
+#include "common/singleton.h"
+#include "common/worker_thread.h"
+#include "protocol/message_protocol.h"
+#include "database/report_dao.h"
+#include "database/server_dao.h"
+#include "catalog/server_catalog.h"
+
+// 报告保存结果
+struct ReportIngestResult
+{
+    ErrorCode code = ErrorCode::ServerInternal;
+    ServerCatalogSnapshotPtr catalog; // 会话没有目录快照时后备方案使用的快照
+};
+
+// 待保存的报告
+struct ReportIngestItem
+{
+    Report report;
+    QList<LatencyRecord> records;
+    ServerCatalogSnapshotPtr catalog; // 查找服务器IP的目录快照，为空时使用后备方案
+    quint32 msgType = 0;              // 用于耗时统计
+    qint64 submittedUs = 0;
+    QObject *context = nullptr;
+    std::function<void(const ReportIngestResult &)> done;
+};
+
+class ReportIngestQueue;
+
+// 组提交线程中的执行对象
+class ReportIngestWorker : public ThreadWorker
+{
+    Q_OBJECT
+
+public:
+    explicit ReportIngestWorker(ReportIngestQueue *queue, QObject *parent = nullptr);
+    ~ReportIngestWorker();
+
+public slots:
+    // 在组提交线程中创建DAO实例和定时器
+    void start() override;
+
+    // 在组提交线程中释放DAO实例
+    void stop() override;
+
+    // 有新报告入队：达到数量阈值时立即提交，否则按最早报告的等待时间启动定时器
+    void schedule();
+
+    // 取出一组报告在一个事务中提交
+    void flush();
+
+private:
+    // 转换记录并写入数据库，返回每个报告的结果
+    QList<ReportIngestResult> commitGroup(QList<ReportIngestItem> &items);
+
+    ReportIngestQueue *queue_;
+    QTimer *timer_;
+    std::unique_ptr<ReportDAO> report_dao_;
+    std::unique_ptr<ServerDAO> server_dao_;
+};
+
+// 跨会话的报告组提交队列：多个客户端的报告在同一个事务中提交，
+// 达到数量阈值或最早的报告等待超过时间阈值时触发提交。
+// 客户端只在其报告所在的事务提交成功后收到结果；
+// 组内单个报告失败只回滚该报告（保存点），提交失败时整组报告都返回失败。
+class ReportIngestQueue : public QObject, public Singleton<ReportIngestQueue>
+{
+    Q_OBJECT
+
+public:
+    // 启动组提交线程
+    bool start(int maxReports, int maxDelayMs);
+
+    // 停止组提交线程（等待已提交报告写入完毕）
+    void stop();
+
+    bool isRunning() const;
+
+    // 提交报告：done在context对象所在线程中以保存结果为参数执行。
+    // context必须在报告写入完成前保持有效（调用方在销毁前应先waitForIdle）
+    bool submit(QObject *context, ReportIngestItem item);
+
+    // 等待所有已提交报告写入完毕
+    bool waitForIdle(int timeoutMs = 30000);
+
+    // 获取状态
+    int getPendingReports() const { return pending_reports_.count(); }
+    quint64 getGroupCount() const { return group_count_.loadRelaxed(); }
+    quint64 getReportCount() const { return report_count_.loadRelaxed(); }
+
+    int maxReports() const { return max_reports_; }
+    int maxDelayMs() const { return max_delay_ms_; }
+
+private:
+    friend class Singleton<ReportIngestQueue>;
+    friend class ReportIngestWorker;
+
+    explicit ReportIngestQueue(QObject *parent = nullptr);
+    ~ReportIngestQueue();
+
+    // 取出最多max_reports_个报告（组提交线程调用）
+    QList<ReportIngestItem> takeGroup();
+
+    // 队列中最早报告的入队时间，队列为空时返回-1
+    qint64 oldestQueuedUs() const;
+    int queuedCount() const;
+
+    // 报告结果已投递
+    void groupFinished(int reports);
+
+    WorkerThread thread_;
+    int max_reports_;
+    int max_delay_ms_;
+
+    mutable QMutex queue_mutex_;
+    QList<ReportIngestItem> queue_;
+    bool accepting_;
+
+    PendingCounter pending_reports_;
+    QAtomicInteger<quint64> group_count_;
+    QAtomicInteger<quint64> report_count_;
+};
+
+#endif // REPORTINGESTQUEUE_H
@@ -2,6 +2,7 @@
 #define SERVERDAO_H
 
 #include "base_dao.h"
+#include "database/column_index.h"
 #include "protocol/message_protocol.h"
 #include <QList>
 #include <QString>
@@ -15,6 +16,9 @@ public:
     
     // 获取活跃的服务器列表
     QList<ServerInfo> getActiveServers();
+
+    // 获取活跃的服务器列表（按server_id升序），查询失败返回false
+    bool getActiveServers(QList<ServerInfo> &servers);
     
     // 根据ID获取服务器信息
     ServerInfo getServerById(int serverId);
@@ -33,10 +37,26 @@ public:
     
     // 删除服务器
     bool deleteServer(int serverId);
+
+    // 获取服务器目录（位置、IP、是否活跃），查询失败返回false
+    bool getServerCatalog(QList<ServerCatalogEntry> &servers);
+
+    // 在一个事务中批量插入或更新服务器（按location），每条语句包含chunkSize行
+    bool upsertServers(const QList<ServerCatalogEntry> &servers, int chunkSize);
     
 private:
+    // 查询结果中的列，每个结果集解析一次序号
+    enum ServerColumn
+    {
+        ServerIdColumn,
+        ServerIpColumn,
+        ServerColumnCount
+    };
+    using ServerColumns = ColumnIndex<ServerColumnCount>;
+    static ServerColumns serverColumns(const QSqlQuery& query);
+
     // 从查询结果构建ServerInfo对象
-    ServerInfo buildServerInfoFromQuery(const QSqlQuery& query);
+    ServerInfo buildServerInfoFromQuery(const QSqlQuery& query, const ServerColumns& columns);
 };
 
 #endif // SERVERDAO_H
\ No newline at end of file
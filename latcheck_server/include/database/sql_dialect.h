@@ -0,0 +1,48 @@
+#ifndef SQLDIALECT_H
+#define SQLDIALECT_H
+
+#include <QString>
+#include <QStringList>
+
+// 存储后端
+enum class DatabaseBackend
+{
+    MySQL = 0,
+    SQLite
+};
+
+// 各存储后端之间的SQL差异。DAO中的通用SQL直接书写，
+// 只有时间函数、插入或更新、自增ID等方言相关的部分通过这里生成。
+class SqlDialect
+{
+public:
+    explicit SqlDialect(DatabaseBackend backend = DatabaseBackend::MySQL) : backend_(backend) {}
+
+    // 解析配置中的后端名称（"mysql"/"sqlite"，不区分大小写）
+    static DatabaseBackend parseBackend(const QString &name, bool *ok = nullptr);
+    static const char *backendName(DatabaseBackend backend);
+
+    DatabaseBackend backend() const { return backend_; }
+    bool isSQLite() const { return backend_ == DatabaseBackend::SQLite; }
+
+    // Qt SQL驱动名称
+    QString driverName() const;
+
+    // 当前本地时间
+    QString now() const;
+
+    // 获取本连接最后插入的自增ID
+    QString lastInsertIdQuery() const;
+
+    // 插入冲突时更新指定列，附加在INSERT ... VALUES (...)之后；
+    // conflictColumn为触发冲突的唯一键列（MySQL不需要）
+    QString upsertClause(const QString &conflictColumn, const QStringList &updateColumns) const;
+
+    // 单条语句允许的最大占位符数量
+    int maxBindParameters() const;
+
+private:
+    DatabaseBackend backend_;
+};
+
+#endif // SQLDIALECT_H
@@ -0,0 +1,61 @@
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <QString>
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QAtomicInteger>
+#include <list>
+
+// 语句缓存统计（连接池内所有连接共享）
+struct StatementCacheStats
+{
+    QAtomicInteger<quint64> hits;
+    QAtomicInteger<quint64> misses;
+    QAtomicInteger<quint64> evictions;
+    QAtomicInteger<quint64> invalidations;
+};
+
+// 单个数据库连接的预处理语句缓存：以SQL文本为键，按最近使用顺序淘汰。
+// 缓存随连接一起被借出，同一时刻只有持有连接的线程访问，因此内部不加锁。
+// 连接重建或出现连接错误时必须调用invalidate()，服务端的语句句柄已随旧连接失效。
+class StatementCache
+{
+public:
+    StatementCache(const QSqlDatabase &db, int capacity, StatementCacheStats *stats);
+    ~StatementCache();
+
+    StatementCache(const StatementCache &) = delete;
+    StatementCache &operator=(const StatementCache &) = delete;
+
+    // 取得已预处理的语句，未命中时prepare并加入缓存；prepare失败返回nullptr。
+    // 返回的语句在下一次acquire()或invalidate()之前有效
+    QSqlQuery *acquire(const QString &sql);
+
+    // 丢弃所有语句
+    void invalidate();
+
+    // 标记缓存失效，下一次acquire()时丢弃所有语句（调用方此时可能仍持有语句指针）
+    void markStale() { stale_ = true; }
+
+    int size() const { return static_cast<int>(entries_.size()); }
+    int capacity() const { return capacity_; }
+
+private:
+    struct Entry
+    {
+        QString sql;
+        QSqlQuery query;
+    };
+
+    QSqlDatabase db_;
+    int capacity_;
+    StatementCacheStats *stats_;
+    bool stale_;
+
+    std::list<Entry> entries_; // 表头为最近使用
+    QHash<QString, std::list<Entry>::iterator> index_;
+};
+
+#endif // STATEMENTCACHE_H
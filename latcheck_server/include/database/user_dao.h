@@ -2,6 +2,7 @@
 #define USERDAO_H
 
 #include "database/base_dao.h"
+#include "database/column_index.h"
 #include "common/types.h"
 #include "common/error_codes.h"
 #include <QList>
@@ -57,8 +58,25 @@ public:
     int getUserCount();
     
 private:
+    // 查询结果中的列，每个结果集解析一次序号
+    enum UserColumn
+    {
+        UserIdColumn,
+        UserNameColumn,
+        UserPasswordHashColumn,
+        UserSaltColumn,
+        UserRoleColumn,
+        UserStatusColumn,
+        UserCreatedAtColumn,
+        UserUpdatedAtColumn,
+        UserLastLoginAtColumn,
+        UserColumnCount
+    };
+    using UserColumns = ColumnIndex<UserColumnCount>;
+    static UserColumns userColumns(const QSqlQuery& query);
+
     // 从查询结果构建用户对象
-    User buildUserFromQuery(const QSqlQuery& query);
+    User buildUserFromQuery(const QSqlQuery& query, const UserColumns& columns);
     
     // 验证用户数据
     bool validateUserData(const QString& userName);
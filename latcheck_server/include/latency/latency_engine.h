@@ -0,0 +1,114 @@
+#ifndef LATENCYENGINE_H
+#define LATENCYENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <memory>
+
+#include "common/types.h"
+#include "common/singleton.h"
+#include "common/worker_thread.h"
+#include "database/report_dao.h"
+#include "database/calculated_latency_dao.h"
+#include "latency/latency_matrix.h"
+
+class LatencyEngine;
+
+// 地点间延时计算线程中的执行对象
+class LatencyEngineWorker : public ThreadWorker
+{
+    Q_OBJECT
+
+public:
+    explicit LatencyEngineWorker(LatencyEngine *engine, QObject *parent = nullptr);
+    ~LatencyEngineWorker();
+
+public slots:
+    // 在计算线程中创建DAO实例，从数据库加载各地点的最新报告
+    void start() override;
+
+    // 在计算线程中释放DAO实例
+    void stop() override;
+
+    // 处理排队的报告
+    void process();
+
+private:
+    // 加载各地点最新报告，补算上次退出前未写入的地点对
+    void loadFromDatabase();
+
+    // 更新地点并写入地点对
+    void applyReport(const QString &location, qint64 reportId, const QList<ReportRecord> &records);
+
+    LatencyEngine *engine_;
+    std::unique_ptr<ReportDAO> report_dao_;
+    std::unique_ptr<CalculatedLatencyDAO> calculated_dao_;
+};
+
+// 地点间延时引擎：启动时从数据库加载各地点最新报告的延时矩阵，报告入库后增量更新。
+// 新报告只重新计算其地点与其他L-1个地点的地点对（O(L·S)），并替换calculated_latencies中
+// 该地点上一报告的地点对；同一地点排队中的多个报告只处理最新的一个
+class LatencyEngine : public QObject, public Singleton<LatencyEngine>
+{
+    Q_OBJECT
+
+public:
+    // 启动计算线程
+    bool start();
+
+    // 停止计算线程（处理完已排队的报告）
+    void stop();
+
+    bool isRunning() const;
+
+    // 报告已提交到数据库，排队计算（未启动时忽略）
+    void submitReport(const QString &location, qint64 reportId, const QList<ReportRecord> &records);
+
+    // 各地点最新报告的延时矩阵，可在任意线程查询
+    const LatencyMatrix &matrix() const { return matrix_; }
+
+    // 获取状态
+    int getLocationCount() const { return location_count_.loadRelaxed(); }
+    int getPendingReports() const { return pending_reports_.loadRelaxed(); }
+    quint64 getUpdateCount() const { return update_count_.loadRelaxed(); }
+    quint64 getPairUpdates() const { return pair_updates_.loadRelaxed(); }
+    quint64 getFailureCount() const { return failures_.loadRelaxed(); }
+
+private:
+    friend class Singleton<LatencyEngine>;
+    friend class LatencyEngineWorker;
+
+    struct PendingReport
+    {
+        qint64 reportId = 0;
+        QList<ReportRecord> records;
+    };
+
+    explicit LatencyEngine(QObject *parent = nullptr);
+    ~LatencyEngine();
+
+    // 取出所有排队的报告（计算线程调用）
+    QHash<QString, PendingReport> takePending();
+
+    WorkerThread thread_;
+
+    // 只由计算线程写入
+    LatencyMatrix matrix_;
+
+    mutable QMutex pending_mutex_;
+    QHash<QString, PendingReport> pending_;
+    bool accepting_;
+
+    QAtomicInt location_count_;
+    QAtomicInt pending_reports_;
+    QAtomicInteger<quint64> update_count_;
+    QAtomicInteger<quint64> pair_updates_;
+    QAtomicInteger<quint64> failures_;
+};
+
+#endif // LATENCYENGINE_H
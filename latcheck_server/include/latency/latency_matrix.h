@@ -0,0 +1,112 @@
+#ifndef LATENCYMATRIX_H
+#define LATENCYMATRIX_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QReadWriteLock>
+#include <vector>
+
+#include "common/types.h"
+
+// 一个地点到一个测试服务器的延时
+struct LatencySample
+{
+    quint32 serverId = 0;
+    quint16 latency = 0;
+};
+
+// 与某地点之间的估算延时
+struct LocationDistance
+{
+    QString location;
+    qint64 reportId = 0;
+    int latency = 0;      // 两段延时之和（毫秒）
+    quint32 serverId = 0; // 取得最小值的服务器ID
+};
+
+// 地点×服务器的稠密延时矩阵：每行为一个检测地点最新报告的延时（quint16），
+// 每列为一个测试服务器，另有按行存放的有效位图。
+// 无效单元格保存kInvalidCell（0x7FFF），两地延时按16位饱和加法相加后，
+// 只要任一方无效结果就饱和为kInvalidCell，因此求两行和的最小值不需要按位图过滤，
+// 可以直接用SSE2/AVX2逐16/32个单元格计算（不支持时使用标量实现）。
+// 行宽按32个单元格对齐，出现新服务器超出行宽时重新分配。
+// 写入（计算线程）持有写锁，查询持有读锁
+class LatencyMatrix
+{
+public:
+    // 达到该值的延时视为不可达（与report_record.latency的上限一致）
+    static const int kUnreachableLatency = 10000;
+    static const quint16 kInvalidCell = 0x7FFF;
+
+    LatencyMatrix();
+
+    // 用报告替换地点的延时行。报告不比地点当前的报告新时忽略并返回false；
+    // replacedReportId为被替换的报告ID（新地点为0）
+    bool setLocation(const QString &location, qint64 reportId, const QList<ReportRecord> &records,
+                     qint64 *replacedReportId = nullptr);
+
+    // 两地之间的估算延时，任一地点未知或没有共同可达的服务器时返回false
+    bool pairLatency(const QString &location1, const QString &location2, LocationPairLatency &result) const;
+
+    // 地点与其他所有地点的估算延时（没有共同可达服务器的地点对不包含在内）
+    QList<LocationPairLatency> pairsFor(const QString &location) const;
+
+    // 地点的有效延时（按服务器ID升序）
+    QList<LatencySample> samplesOf(const QString &location) const;
+
+    // 地点延时最小的k个服务器（按延时升序），只对有效单元格做部分排序
+    QList<LatencySample> bestServers(const QString &location, int k) const;
+
+    // 与地点估算延时最小的k个其他地点（按延时升序）：逐行计算最小和，
+    // 用大小为k的堆筛选，只为入选的地点查找取得最小值的服务器
+    QList<LocationDistance> nearestLocations(const QString &location, int k) const;
+
+    // 地点当前的报告ID，未知地点返回0
+    qint64 reportIdOf(const QString &location) const;
+
+    int locationCount() const;
+    int serverCount() const;
+
+    // 单元格和位图占用的内存（字节）
+    qint64 memoryBytes() const;
+
+    // 当前CPU使用的计算实现（"avx2"/"sse2"/"scalar"）
+    static const char *kernelName();
+
+    // 两行逐单元格相加后的最小值，n为单元格数（32的倍数）；没有两方都有效的单元格时返回kInvalidCell
+    static quint16 minPairSum(const quint16 *a, const quint16 *b, int n);
+
+private:
+    struct Row
+    {
+        QString location;
+        qint64 reportId = 0;
+    };
+
+    // 以下函数需要持有写锁
+    int rowFor(const QString &location);
+    int columnFor(quint32 serverId);
+    void reserveColumns(int columns);
+
+    // 以下函数需要持有读锁
+    const quint16 *cellsOf(int row) const { return cells_.data() + static_cast<size_t>(row) * stride_; }
+    const quint64 *validOf(int row) const { return valid_.data() + static_cast<size_t>(row) * bitmap_words_; }
+    bool pairAt(int row1, int row2, LocationPairLatency &result) const;
+    quint32 bestServerAt(int row1, int row2, quint16 best) const;
+    QList<LatencySample> validSamples(int row) const;
+
+    mutable QReadWriteLock lock_;
+
+    QHash<QString, int> rows_;
+    std::vector<Row> row_info_;
+    QHash<quint32, int> columns_;
+    std::vector<quint32> column_servers_;
+
+    int stride_;       // 每行的单元格数（32的倍数）
+    int bitmap_words_; // 每行位图的64位字数
+    std::vector<quint16> cells_;
+    std::vector<quint64> valid_;
+};
+
+#endif // LATENCYMATRIX_H
@@ -0,0 +1,66 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QIODevice>
+#include "protocol/message_protocol.h"
+
+// 会话接收缓冲区：连续存储 + 读游标。
+// 数据直接从socket读入缓冲区尾部，消息头原地解码，
+// 有效载荷以视图形式交给处理函数，消费时只移动读游标，
+// 仅在尾部空间不足时才整体前移一次未读数据。
+class FrameBuffer
+{
+public:
+    static constexpr qsizetype HeaderSize = 8;            // 消息头长度
+    static constexpr qsizetype DefaultLimit = 64 * 1024;  // 默认缓冲区上限
+    static constexpr qsizetype InitialCapacity = 4096;    // 初始容量
+
+    enum class FrameStatus
+    {
+        Incomplete, // 数据不足一帧
+        Ready,      // 已有完整帧
+        TooLarge    // 帧长度超过缓冲区上限
+    };
+
+    explicit FrameBuffer(qsizetype limit = DefaultLimit);
+
+    // 缓冲区上限（单帧长度不能超过该值）
+    void setLimit(qsizetype limit);
+    qsizetype limit() const { return limit_; }
+
+    // 未读数据长度
+    qsizetype size() const { return write_pos_ - read_pos_; }
+    bool isEmpty() const { return write_pos_ == read_pos_; }
+
+    // 剩余可写入的数据量
+    qsizetype freeSpace() const { return limit_ - size(); }
+
+    // 从设备读取数据直接写入缓冲区，最多读到缓冲区上限，返回读取的字节数
+    qint64 readFrom(QIODevice *device);
+
+    // 追加数据，超过上限时返回false且不写入
+    bool append(const char *data, qsizetype len);
+
+    // 解析下一帧：header原地解码，payload指向缓冲区内部。
+    // payload在下一次consume/readFrom/append之前有效。
+    FrameStatus peekFrame(MessageHeader &header, QByteArrayView &payload) const;
+
+    // 消费指定长度的数据
+    void consume(qsizetype len);
+
+    // 清空缓冲区
+    void clear();
+
+private:
+    // 确保尾部至少有len字节可写空间
+    void reserveTail(qsizetype len);
+
+    QByteArray storage_;
+    qsizetype read_pos_;
+    qsizetype write_pos_;
+    qsizetype limit_;
+};
+
+#endif // FRAMEBUFFER_H
@@ -3,6 +3,7 @@
 
 #include <QtGlobal>
 #include <QByteArray>
+#include <QByteArrayView>
 #include <QString>
 #include <QList>
 #include "common/error_codes.h"
@@ -19,7 +20,9 @@ enum class MessageType : quint32
     REPORT_OK = 0x0007,               // 报告上传成功
     REPORT_FAIL = 0x0008,             // 报告上传失败
     CHANGE_PASSWORD_REQUEST = 0x0009, // 修改密码请求
-    CHANGE_PASSWORD_RESPONSE = 0x000A // 修改密码响应
+    CHANGE_PASSWORD_RESPONSE = 0x000A, // 修改密码响应
+    LIST_DELTA_REQUEST = 0x000B,       // 服务器列表增量请求
+    LIST_DELTA_RESPONSE = 0x000C       // 服务器列表增量响应
 };
 
 // 消息头结构（8字节）
@@ -65,6 +68,33 @@ struct ListResponseData
     ListResponseData() : serverCount(0) {}
 };
 
+// 服务器列表增量请求数据
+struct ListDeltaRequestData
+{
+    quint64 catalogVersion; // 客户端已缓存的目录版本（8字节），0表示没有缓存
+
+    ListDeltaRequestData() : catalogVersion(0) {}
+};
+
+// 服务器列表增量响应类型
+enum class ListDeltaKind : quint32
+{
+    NotModified = 0, // 客户端缓存已是当前版本，不包含服务器数据
+    Delta = 1,       // 相对客户端版本删除的服务器ID，以及新增或IP变化的服务器
+    Full = 2         // 客户端版本过旧或未知，包含完整列表
+};
+
+// 服务器列表增量响应数据
+struct ListDeltaResponseData
+{
+    quint64 catalogVersion;     // 当前目录版本（8字节）
+    ListDeltaKind kind;         // 响应类型（4字节）
+    QList<quint32> removedIds;  // 删除的服务器ID（仅Delta）
+    QList<ServerInfo> servers;  // Delta为新增或变化的服务器，Full为完整列表
+
+    ListDeltaResponseData() : catalogVersion(0), kind(ListDeltaKind::NotModified) {}
+};
+
 // 延时记录
 struct LatencyRecord
 {
@@ -119,37 +149,56 @@ public:
     static QByteArray serializeHeader(const MessageHeader &header);
 
     // 反序列化消息头
-    static MessageHeader deserializeHeader(const QByteArray &data);
+    static MessageHeader deserializeHeader(QByteArrayView data);
+
+    // 消息类型名称（用于日志和统计）
+    static const char *messageTypeName(quint32 msgType);
+
+    // 将完整消息（消息头+数据）追加到发送缓冲区尾部，一次写入连续内存
+    static void appendMessage(QByteArray &out, MessageType type, QByteArrayView payload);
 
     // 序列化登录请求
     static QByteArray serializeLoginRequest(const QString &userName, const QString &passwordHash);
 
     // 反序列化登录请求
-    static LoginRequestData deserializeLoginRequest(const QByteArray &data);
+    static LoginRequestData deserializeLoginRequest(QByteArrayView data);
 
     // 序列化服务器列表响应
     static QByteArray serializeListResponse(const QList<ServerInfo> &servers);
 
     // 反序列化服务器列表响应
-    static ListResponseData deserializeListResponse(const QByteArray &data);
+    static ListResponseData deserializeListResponse(QByteArrayView data);
+
+    // 序列化服务器列表增量请求
+    static QByteArray serializeListDeltaRequest(quint64 catalogVersion);
+
+    // 反序列化服务器列表增量请求
+    static ListDeltaRequestData deserializeListDeltaRequest(QByteArrayView data);
+
+    // 序列化服务器列表增量响应，removedIds只用于Delta，servers不用于NotModified
+    static QByteArray serializeListDeltaResponse(quint64 catalogVersion, ListDeltaKind kind,
+                                                 const QList<quint32> &removedIds, const QList<ServerInfo> &servers);
+
+    // 反序列化服务器列表增量响应，数据不完整时返回版本为0的NotModified
+    static ListDeltaResponseData deserializeListDeltaResponse(QByteArrayView data);
 
     // 序列化报告上传请求
     static QByteArray serializeReportRequest(const QString &location, const QList<LatencyRecord> &records);
 
     // 反序列化报告上传请求
-    static ReportRequestData deserializeReportRequest(const QByteArray &data);
+    static ReportRequestData deserializeReportRequest(QByteArrayView data);
 
     // 序列化修改密码请求
     static QByteArray serializeChangePasswordRequest(const QString &userName, const QString &oldPasswordHash, const QString &newPasswordHash);
 
     // 反序列化修改密码请求
-    static ChangePasswordRequestData deserializeChangePasswordRequest(const QByteArray &data);
+    static ChangePasswordRequestData deserializeChangePasswordRequest(QByteArrayView data);
 
     // 序列化修改密码响应
     static QByteArray serializeChangePasswordResponse(quint32 resultCode);
 
     // 反序列化修改密码响应
-    static ChangePasswordResponseData deserializeChangePasswordResponse(const QByteArray &data);
+    static ChangePasswordResponseData deserializeChangePasswordResponse(QByteArrayView data);
 
     // 验证消息头
     static bool validateHeader(const MessageHeader &header);
@@ -0,0 +1,102 @@
+#ifndef ADMISSIONCONTROLLER_H
+#define ADMISSIONCONTROLLER_H
+
+#include <QtGlobal>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QHostAddress>
+#include <vector>
+
+// 接入控制配置
+struct AdmissionSettings
+{
+    int maxConnections = 1000;          // 最大连接数
+    double perIpRate = 10.0;            // 每个源IP每秒补充的令牌数（允许的新建连接速率）
+    int perIpBurst = 20;                // 每个源IP的令牌桶容量（允许的突发连接数）
+    int maxPendingHandshakes = 256;     // 同时进行中的TLS握手上限
+    int acceptQueueHighWatermark = 512; // 已接入但尚未被工作线程接管的描述符上限
+    int ipTableSize = 4096;             // 令牌桶表条目数（固定内存）
+};
+
+// 接入判定结果
+enum class AdmissionResult
+{
+    Accepted = 0,
+    AcceptQueueFull, // 接入队列超过高水位
+    MaxConnections,  // 超过最大连接数
+    HandshakeLimit,  // 进行中的握手过多
+    RateLimited,     // 源IP超过连接速率
+    ResultCount
+};
+
+// 握手前接入控制：在创建任何TLS状态之前决定是否接收一个新描述符。
+//
+// 每个源IP一个令牌桶，存放在固定大小的组相联表中（每组4路，满时淘汰最久未使用
+// 的条目），内存占用不随客户端数量增长。被拒绝的描述符直接close，不创建socket对象。
+// admit()只能在接入线程调用；握手计数和接入队列计数可在任意线程释放。
+class AdmissionController
+{
+public:
+    explicit AdmissionController(const AdmissionSettings &settings);
+
+    AdmissionController(const AdmissionController &) = delete;
+    AdmissionController &operator=(const AdmissionController &) = delete;
+
+    const AdmissionSettings &settings() const { return settings_; }
+
+    // 判定是否接收描述符，接收时占用一个握手名额和一个接入队列名额（仅接入线程调用）
+    AdmissionResult admit(qintptr socketDescriptor, int connectionCount, QHostAddress *peerAddress = nullptr);
+
+    // 工作线程接管描述符后释放接入队列名额
+    void dispatched() { accept_queue_depth_.deref(); }
+
+    // 握手完成（成功、失败或连接断开）后释放握手名额
+    void handshakeFinished() { pending_handshakes_.deref(); }
+
+    // 不经过socket对象直接关闭描述符
+    static void closeDescriptor(qintptr socketDescriptor);
+
+    static const char *resultName(AdmissionResult result);
+
+    // 统计信息
+    int getPendingHandshakes() const { return pending_handshakes_.loadRelaxed(); }
+    int getAcceptQueueDepth() const { return accept_queue_depth_.loadRelaxed(); }
+    quint64 getAcceptedCount() const { return counters_[0].loadRelaxed(); }
+    quint64 getRejectedCount(AdmissionResult result) const;
+    quint64 getRejectedTotal() const;
+
+private:
+    static constexpr int Ways = 4; // 每组条目数
+
+    // 令牌桶（源地址统一为IPv6形式，IPv4使用映射地址）
+    struct Bucket
+    {
+        quint64 keyHigh = 0;
+        quint64 keyLow = 0;
+        qint64 lastMs = 0; // 上次补充令牌的时间（单调时钟，毫秒）
+        double tokens = 0.0;
+        bool used = false;
+    };
+
+    // 读取对端地址，失败时返回false
+    static bool peerKey(qintptr socketDescriptor, quint64 &keyHigh, quint64 &keyLow, QHostAddress *peerAddress);
+
+    // 消耗源IP的一个令牌，令牌不足时返回false
+    bool takeToken(quint64 keyHigh, quint64 keyLow);
+
+    AdmissionResult reject(AdmissionResult result);
+
+    AdmissionSettings settings_;
+    QElapsedTimer clock_;
+
+    std::vector<Bucket> buckets_; // 仅接入线程访问
+    quint32 set_mask_;
+    size_t hash_seed_;
+
+    QAtomicInt pending_handshakes_;
+    QAtomicInt accept_queue_depth_;
+    QAtomicInteger<quint64> counters_[static_cast<int>(AdmissionResult::ResultCount)];
+};
+
+#endif // ADMISSIONCONTROLLER_H
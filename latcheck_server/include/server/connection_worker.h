@@ -0,0 +1,121 @@
+#ifndef CONNECTIONWORKER_H
+#define CONNECTIONWORKER_H
+
+#include <QObject>
+#include <QSslSocket>
+#include <QSslError>
+#include <QTimer>
+#include <QHash>
+#include <QAtomicInt>
+
+#include "server/timing_wheel.h"
+#include "protocol/message_protocol.h"
+
+// 前向声明
+class TlsServer;
+struct ClientSession;
+
+// 连接工作线程：每个实例运行在独立的QThread事件循环中，
+// 负责其分片内所有会话的TLS握手、数据收发和消息分发。
+// 会话一旦分配到某个worker，在其生命周期内都固定在该线程上。
+class ConnectionWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ConnectionWorker(TlsServer *server, int index, QObject *parent = nullptr);
+    ~ConnectionWorker();
+
+    int index() const { return index_; }
+
+    // 当前分片的连接数（包含已预占但尚未建立的连接），可跨线程读取
+    int connectionCount() const { return connection_count_.loadRelaxed(); }
+
+    // 当前分片的已认证会话数，可跨线程读取
+    int authenticatedCount() const { return authenticated_count_.loadRelaxed(); }
+
+    // 已发送的响应数和实际的socket写入次数，可跨线程读取
+    quint64 responseCount() const { return response_count_.loadRelaxed(); }
+    quint64 writeCount() const { return write_count_.loadRelaxed(); }
+
+    // 接入线程在投递描述符之前预占一个连接名额
+    void reserveConnection() { connection_count_.ref(); }
+
+    // 在本线程中接管socket描述符并启动握手（由接入线程通过队列调用）
+    void addConnection(qintptr socketDescriptor);
+
+    // 会话认证成功后更新分片计数（仅在本线程调用）
+    void markAuthenticated(ClientSession *session);
+
+    // 按socket和会话序号查找会话，会话已断开时返回nullptr（仅在本线程调用）
+    ClientSession *findSession(QSslSocket *socket, quint64 sessionId);
+
+    // 异步请求完成后恢复会话的消息处理（仅在本线程调用）
+    void resumeSession(ClientSession *session);
+
+    // 将响应追加到会话的发送缓冲区；会话未处于批量处理中时立即写出（仅在本线程调用）
+    void queueResponse(ClientSession *session, MessageType type, QByteArrayView data);
+
+    // 会话有活动时重新计算空闲超时（仅在本线程调用）
+    void refreshIdleTimeout(ClientSession *session);
+
+    // 本线程的时间轮，可用于登记其他截止时间（仅在本线程使用）
+    TimingWheel &timingWheel() { return timing_wheel_; }
+
+public slots:
+    // 线程启动后调用
+    void start();
+
+    // 断开并释放本分片的所有会话（线程退出前调用）
+    void shutdown();
+
+private slots:
+    // SSL就绪处理
+    void onSslReady();
+
+    // SSL错误处理
+    void onSslErrors(const QList<QSslError> &errors);
+
+    // 数据接收处理
+    void onDataReceived();
+
+    // 客户端断开处理
+    void onClientDisconnected();
+
+    // 时间轮刻度定时器
+    void onTick();
+
+private:
+    ClientSession *findSessionBySocket(QSslSocket *socket);
+
+    // 握手结束（完成或连接断开）后归还接入控制的握手名额
+    void releaseHandshake(ClientSession *session);
+
+    // 从会话缓冲区中解析并分发完整消息，本批次产生的响应在结束时一次写出
+    void processBuffer(ClientSession *session);
+
+    // 结束批量处理，将发送缓冲区中的响应一次写入socket
+    void flushResponses(ClientSession *session);
+
+    // 超时处理（由时间轮回调）
+    void onAuthTimeout(ClientSession *session);
+    void onIdleTimeout(ClientSession *session);
+
+private:
+    TlsServer *server_;
+    int index_;
+
+    // 本分片的会话表，仅在本线程访问，无需加锁
+    QHash<QSslSocket *, ClientSession *> clients_;
+
+    // 本线程所有会话的超时都由一个时间轮和一个刻度定时器管理
+    TimingWheel timing_wheel_;
+    QTimer *tick_timer_;
+
+    QAtomicInt connection_count_;
+    QAtomicInt authenticated_count_;
+    QAtomicInteger<quint64> response_count_;
+    QAtomicInteger<quint64> write_count_;
+};
+
+#endif // CONNECTIONWORKER_H
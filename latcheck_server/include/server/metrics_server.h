@@ -0,0 +1,78 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+#include <QByteArray>
+#include <QDateTime>
+
+#include "common/types.h"
+
+// 前向声明
+class TlsServer;
+class DatabasePool;
+class LatencyHistogram;
+
+// 本机监控端点：明文HTTP，只监听回环地址。
+//   /health   服务状态（监听状态、数据库连接池状态），JSON格式
+//   /metrics  Prometheus文本格式的计数器和直方图
+//   /stats    各消息类型各阶段的耗时百分位（与SIGUSR1输出相同）
+//   /topk/servers?location=X&k=N    地点X延时最小的N个测试服务器，JSON格式
+//   /topk/locations?location=X&k=N  与地点X估算延时最小的N个其他地点，JSON格式
+// 所有数据都来自原子计数器或O(1)的快照，采集时不会长时间持有任何业务锁。
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsServer(TlsServer *tlsServer, DatabasePool *dbPool, QObject *parent = nullptr);
+    ~MetricsServer();
+
+    // 启动监听，非回环地址会被拒绝
+    bool start(const MetricsConfig &config);
+    void stop();
+
+    bool isListening() const { return server_->isListening(); }
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onDisconnected();
+
+private:
+    // 处理一个HTTP请求，返回完整的响应报文
+    QByteArray handleRequest(const QByteArray &method, const QByteArray &path, const QByteArray &query);
+
+    QByteArray buildHealth() const;
+    QByteArray buildMetrics() const;
+    QByteArray buildStats() const;
+
+    // Top-K查询（数据来自LatencyEngine的延时矩阵），参数错误时返回空并设置错误信息
+    QByteArray buildTopServers(const QByteArray &query, QString &error) const;
+    QByteArray buildNearestLocations(const QByteArray &query, QString &error) const;
+
+    // 解析Top-K查询参数：location必填，k默认10，上限MaxTopK
+    static bool parseTopKQuery(const QByteArray &query, QString &location, int &k, QString &error);
+
+    static constexpr int DefaultTopK = 10;
+    static constexpr int MaxTopK = 1000;
+
+    static QByteArray httpResponse(int status, const char *reason, const char *contentType, const QByteArray &body);
+
+    // 以Prometheus直方图格式输出（单位转换为秒）
+    static void appendHistogram(QByteArray &out, const char *name, const QByteArray &labels,
+                                const LatencyHistogram &histogram);
+
+    static constexpr int MaxRequestSize = 8192; // 请求头上限
+    static constexpr int RequestTimeoutMs = 5000;
+
+    TlsServer *tls_server_;
+    DatabasePool *db_pool_;
+    QTcpServer *server_;
+    QHash<QTcpSocket *, QByteArray> pending_; // 未读完请求头的连接
+    QDateTime start_time_;
+};
+
+#endif // METRICSSERVER_H
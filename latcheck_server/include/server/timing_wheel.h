@@ -0,0 +1,85 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <QtGlobal>
+#include <QElapsedTimer>
+#include <functional>
+
+class TimingWheel;
+
+// 定时器节点：嵌入到所属对象中（侵入式链表），启动和取消都不分配内存。
+// 节点析构时自动从时间轮中移除。
+struct TimerNode
+{
+    TimerNode() = default;
+    ~TimerNode();
+
+    TimerNode(const TimerNode &) = delete;
+    TimerNode &operator=(const TimerNode &) = delete;
+
+    // 是否已启动
+    bool isArmed() const { return wheel != nullptr; }
+
+    std::function<void()> callback; // 到期回调
+
+    // 以下字段由TimingWheel维护
+    TimerNode *prev = nullptr;
+    TimerNode *next = nullptr;
+    TimingWheel *wheel = nullptr;
+    quint64 expireTick = 0;
+};
+
+// 分层时间轮：每个事件循环线程一个，统一管理登录超时、空闲超时等截止时间。
+// 使用单调时钟，启动、取消、到期均为O(1)；由所属线程的一个定时器周期性驱动。
+// 非线程安全，只能在所属线程中使用。
+class TimingWheel
+{
+public:
+    static constexpr int SlotBits = 6;
+    static constexpr int SlotCount = 1 << SlotBits; // 每层槽数
+    static constexpr int LevelCount = 4;            // 层数
+
+    explicit TimingWheel(int tickMs = 100);
+    ~TimingWheel();
+
+    TimingWheel(const TimingWheel &) = delete;
+    TimingWheel &operator=(const TimingWheel &) = delete;
+
+    // 时间刻度（毫秒）
+    int tickMs() const { return tick_ms_; }
+
+    // 已启动的定时器数量
+    int size() const { return size_; }
+
+    // 启动（或重新启动）定时器，delayMs毫秒后到期
+    void schedule(TimerNode *node, qint64 delayMs);
+
+    // 取消定时器，未启动时无操作
+    void cancel(TimerNode *node);
+
+    // 推进到当前时间并执行所有到期回调，返回到期的定时器数量
+    int advance();
+
+private:
+    // 按到期刻度放入对应层的槽中
+    void insert(TimerNode *node);
+
+    // 将上层槽中的定时器重新分配到下层
+    void cascade(int level, int index);
+
+    static void link(TimerNode *head, TimerNode *node);
+    static void unlink(TimerNode *node);
+
+    // 将一个槽的整条链表移动到另一个空链表头上
+    static void spliceSlot(TimerNode *from, TimerNode *to);
+
+    // 每个槽的链表头（哨兵节点，循环双向链表）
+    TimerNode slots_[LevelCount][SlotCount];
+
+    QElapsedTimer clock_;
+    quint64 current_tick_;
+    int tick_ms_;
+    int size_;
+};
+
+#endif // TIMINGWHEEL_H
@@ -9,6 +9,8 @@
 #include <QTimer>
 #include <QHash>
 #include <QMutex>
+#include <QThread>
+#include <memory>
 
 // 前向声明
 class ConfigManager;
@@ -16,6 +18,7 @@ class Logger;
 class UserDAO;
 class ReportDAO;
 class ServerDAO; // 添加ServerDAO前向声明
+class ConnectionWorker;
 
 #include "config/config_manager.h"
 #include "logger/logger.h"
@@ -23,9 +26,15 @@ class ServerDAO; // 添加ServerDAO前向声明
 #include "database/user_dao.h"
 #include "database/report_dao.h"
 #include "database/server_dao.h" // 添加ServerDAO头文件
+#include "catalog/server_catalog.h"
 #include "protocol/message_protocol.h"
+#include "protocol/frame_buffer.h"
+#include "server/timing_wheel.h"
+#include "server/tls_session_cache.h"
+#include "server/admission_controller.h"
 #include "common/error_codes.h"
 #include "common/types.h"
+#include "common/latency_histogram.h"
 
 // 客户端连接状态
 enum class ClientState
@@ -39,24 +48,37 @@ enum class ClientState
 struct ClientSession
 {
     QSslSocket *socket;
+    ConnectionWorker *worker; // 会话所属的连接工作线程
     ClientState state;
     QString userName;
     QDateTime connectTime;
-    QDateTime lastActiveTime;
-    QByteArray pendingData;
-    QByteArray buffer;
+    FrameBuffer buffer; // 接收缓冲区（带读游标，上限由配置决定）
     bool isAuthenticated;
-    QTimer *loginTimer;
-    QList<ServerInfo> servers;          // 存储客户端的服务器列表
-    QMap<quint32, quint32> serverIpMap; // 存储服务器ID到IP地址的映射
+    TimerNode authTimer; // 登录超时（登记在所属工作线程的时间轮中）
+    TimerNode idleTimer; // 空闲超时，收到数据时重新计时
+    quint64 sessionId;    // 会话序号，异步请求完成时用于确认会话仍然存在
+    void *sslHandle;      // 底层SSL对象，仅用于查询握手是否为会话复用
+    bool handshakePending; // 是否仍占用接入控制的握手名额
+    QByteArray outBuffer;  // 发送缓冲区，同一批次的响应合并后一次写入socket（容量重复使用）
+    bool corked;           // 是否正在批量处理，为true时响应暂存在outBuffer中
+    quint32 requestType;   // 当前处理的请求类型（用于耗时统计）
+    qint64 requestStartUs; // 当前请求开始处理的时间（单调时钟，微秒）
+    bool requestInFlight; // 是否有未完成的数据库请求
+    ServerCatalogSnapshotPtr catalog; // 客户端最近取得的服务器目录版本（与其他会话共享）
 
     ClientSession() : socket(nullptr),
+                      worker(nullptr),
                       state(ClientState::Connected),
                       isAuthenticated(false),
-                      loginTimer(nullptr)
+                      sessionId(0),
+                      sslHandle(nullptr),
+                      handshakePending(false),
+                      corked(false),
+                      requestType(0),
+                      requestStartUs(0),
+                      requestInFlight(false)
     {
         connectTime = QDateTime::currentDateTime();
-        lastActiveTime = connectTime;
     }
 };
 
@@ -64,6 +86,9 @@ class TlsServer : public QTcpServer
 {
     Q_OBJECT
 
+    // 连接工作线程需要访问SSL配置和消息处理方法
+    friend class ConnectionWorker;
+
 public:
     explicit TlsServer(QObject *parent = nullptr);
     ~TlsServer();
@@ -72,60 +97,69 @@ public:
     bool startServer(quint16 port); // 向后兼容
     void stopServer();
 
-    // 获取连接数
+    // 获取连接数（汇总所有工作线程）
     int getConnectionCount() const;
 
-    // 获取认证用户数
+    // 获取认证用户数（汇总所有工作线程）
     int getAuthenticatedUserCount() const;
 
+    // 获取工作线程数
+    int getWorkerCount() const { return workers_.size(); }
+
+    // 获取已发送的响应数和socket写入次数（汇总所有工作线程）
+    quint64 getResponseCount() const;
+    quint64 getResponseWriteCount() const;
+
+    // 会话复用和接入控制的统计（服务器未启动时为nullptr）
+    const TlsSessionCache *sessionCache() const { return session_cache_.get(); }
+    const AdmissionController *admissionController() const { return admission_.get(); }
+
     // 设置依赖组件
     void setConfigManager(QSharedPointer<ConfigManager> config);
-    void setUserDAO(QSharedPointer<UserDAO> userDAO);
-    void setReportDAO(QSharedPointer<ReportDAO> reportDAO);
-    void setServerDAO(QSharedPointer<ServerDAO> serverDAO);
     void setAuthManager(QSharedPointer<AuthManager> authManager);
 
 protected:
-    // 重写新连接处理
+    // 重写新连接处理：只负责接入，socket交给负载最低的工作线程
     void incomingConnection(qintptr socketDescriptor) override;
 
-private slots:
-    // SSL就绪处理
-    void onSslReady();
-
-    // SSL错误处理
-    void onSslErrors(const QList<QSslError> &errors);
-
-    // 数据接收处理
-    void onDataReceived();
-
-    // 客户端断开处理
-    void onClientDisconnected();
-
-    // 清理定时器
-    void onCleanupTimer();
-
 private:
     // SSL初始化
     bool initializeSsl();
 
-    // 添加缺失的方法声明
-    ClientSession *findSessionBySocket(QSslSocket *socket);
+    // 启动/停止连接工作线程
+    void startWorkers(int count);
+    void stopWorkers();
+
+    // 选择当前连接数最少的工作线程
+    ConnectionWorker *selectWorker() const;
 
-    // 消息处理
-    void processMessage(ClientSession *session, const MessageHeader &header, const QByteArray &data);
+    // 消息处理（在会话所属的工作线程中调用），data指向会话接收缓冲区，仅在调用期间有效
+    void processMessage(ClientSession *session, const MessageHeader &header, QByteArrayView data);
+
+    // 包装异步请求的完成回调，使其在会话仍然存在时处理结果并恢复消息分发
+    template <typename Done>
+    auto sessionCallback(ClientSession *session, Done done);
+
+    // 提交数据库任务，完成后在会话所属的工作线程中回调
+    template <typename Job, typename Done>
+    bool submitDbRequest(ClientSession *session, Job job, Done done);
 
     // 登录请求处理
-    void handleLoginRequest(ClientSession *session, const QByteArray &data);
+    void handleLoginRequest(ClientSession *session, QByteArrayView data);
+    void completeLoginRequest(ClientSession *session, const QString &userName,
+                              const QString &plainPassword, const User &user);
 
     // 列表请求处理
     void handleListRequest(ClientSession *session);
 
+    // 列表增量请求处理：按客户端缓存的目录版本返回未变化、增量或完整列表
+    void handleListDeltaRequest(ClientSession *session, QByteArrayView data);
+
     // 报告请求处理
-    void handleReportRequest(ClientSession *session, const QByteArray &data);
+    void handleReportRequest(ClientSession *session, QByteArrayView data);
 
     // 密码变更请求处理
-    void handleChangePasswordRequest(ClientSession *session, const QByteArray &data);
+    void handleChangePasswordRequest(ClientSession *session, QByteArrayView data);
 
     // 发送响应
     void sendResponse(ClientSession *session, MessageType type, const QByteArray &data = QByteArray());
@@ -133,15 +167,9 @@ private:
     // 发送错误响应
     void sendErrorResponse(ClientSession *session, MessageType type, ErrorCode errorCode);
 
-    // 获取测试服务器列表
-    QList<ServerInfo> getTestServerList();
-
     // 清理会话
     void cleanupSession(ClientSession *session);
 
-    // 检查客户端权限
-    bool checkClientPermission(const QString &userName, int requiredLevel);
-
     // 更新客户端活动时间
     void updateClientActivity(ClientSession *session);
 
@@ -155,21 +183,31 @@ private:
     QString getCertificateSubject(const QSslCertificate &certificate);
 
 private:
+    // 密码修改任务的结果
+    struct ChangePasswordJobResult
+    {
+        ErrorCode code = ErrorCode::ServerInternal;
+    };
+
     QSharedPointer<ConfigManager> config_manager_;
-    QSharedPointer<UserDAO> user_dao_;
-    QSharedPointer<ReportDAO> report_dao_;
-    QSharedPointer<ServerDAO> server_dao_;
 
     QSslConfiguration ssl_config_;
-    QHash<QSslSocket *, ClientSession *> clients_;
-    QTimer *cleanup_timer_;
 
-    mutable QMutex clients_mutex_;
+    // TLS会话复用缓存（所有工作线程共享）
+    std::unique_ptr<TlsSessionCache> session_cache_;
+
+    // 握手前接入控制（令牌桶和握手上限）
+    std::unique_ptr<AdmissionController> admission_;
+
+    // 连接工作线程（会话按线程分片）
+    QList<ConnectionWorker *> workers_;
+    QList<QThread *> worker_threads_;
 
     // 配置参数
     int max_connections_;
-    int connection_timeout_; // 秒
-    int auth_timeout_;       // 秒
+    int connection_timeout_;   // 秒
+    int auth_timeout_;         // 秒，登录超时
+    int session_buffer_limit_; // 每个会话接收缓冲区上限（字节）
 
     QSharedPointer<AuthManager> auth_manager_;
 
@@ -0,0 +1,152 @@
+#ifndef TLSSESSIONCACHE_H
+#define TLSSESSIONCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+#include <list>
+
+#include <openssl/ssl.h>
+#include <openssl/evp.h>
+#if OPENSSL_VERSION_NUMBER < 0x30000000L
+#include <openssl/hmac.h>
+#endif
+
+// TLS会话缓存配置
+struct TlsSessionSettings
+{
+    bool enabled = true;               // 是否启用会话复用
+    bool enableTickets = true;         // 是否启用无状态会话票据
+    int cacheSize = 20480;             // 会话ID缓存的最大条目数
+    int sessionTimeout = 7200;         // 会话有效期（秒）
+    int ticketRotationInterval = 3600; // 票据密钥轮换间隔（秒）
+};
+
+// TLS会话复用：服务端会话ID缓存 + 带密钥轮换的会话票据。
+//
+// Qt为每个QSslSocket创建独立的SSL_CTX，OpenSSL内置的会话缓存和随机票据密钥
+// 都只在单个连接内有效，因此重连的客户端总是完整握手。本类在全局维护会话缓存
+// 和票据密钥，并通过OpenSSL的ex_data创建钩子在SSL对象创建时为其挂接回调。
+// 钩子只对处于Scope作用域内的当前线程生效，不影响其他TLS连接。
+class TlsSessionCache
+{
+public:
+    explicit TlsSessionCache(const TlsSessionSettings &settings);
+    ~TlsSessionCache();
+
+    TlsSessionCache(const TlsSessionCache &) = delete;
+    TlsSessionCache &operator=(const TlsSessionCache &) = delete;
+
+    const TlsSessionSettings &settings() const { return settings_; }
+
+    // 作用域对象：在其生命周期内，当前线程新建的SSL连接会挂接到缓存上。
+    // 用法：构造Scope后调用startServerEncryption，然后通过sslHandle()取得SSL对象。
+    class Scope
+    {
+    public:
+        explicit Scope(TlsSessionCache *cache);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        // 作用域内创建的SSL对象（仅用于查询握手结果）
+        void *sslHandle() const { return ssl_; }
+
+    private:
+        friend class TlsSessionCache;
+
+        TlsSessionCache *cache_;
+        SSL *ssl_;
+        Scope *previous_;
+    };
+
+    // 握手完成后记录本次握手是否为会话复用，返回true表示复用
+    bool recordHandshake(void *sslHandle);
+
+    // 统计信息
+    quint64 getFullHandshakes() const { return full_handshakes_.loadRelaxed(); }
+    quint64 getResumedHandshakes() const { return resumed_handshakes_.loadRelaxed(); }
+    quint64 getCacheHits() const { return cache_hits_.loadRelaxed(); }
+    quint64 getCacheMisses() const { return cache_misses_.loadRelaxed(); }
+    int getCachedSessionCount() const;
+
+private:
+    // 票据密钥
+    struct TicketKey
+    {
+        unsigned char name[16];
+        unsigned char aesKey[32];
+        unsigned char hmacKey[32];
+        qint64 createdAt = 0; // 单调时钟（毫秒）
+    };
+
+    // 缓存条目（序列化后的会话）
+    struct CacheEntry
+    {
+        QByteArray session;
+        qint64 expireAt = 0; // 单调时钟（毫秒）
+        std::list<QByteArray>::iterator order;
+    };
+
+    // 注册OpenSSL ex_data索引和创建钩子（进程内只执行一次）
+    static bool installHooks();
+
+    // SSL对象创建钩子
+    static void onSslNew(void *parent, void *ptr, CRYPTO_EX_DATA *ad, int idx, long argl, void *argp);
+
+    // 为新建的SSL对象及其SSL_CTX挂接会话缓存和票据回调
+    void attach(SSL *ssl);
+
+    static TlsSessionCache *fromSsl(SSL *ssl);
+
+    // OpenSSL会话缓存回调
+    static int newSessionCallback(SSL *ssl, SSL_SESSION *session);
+    static SSL_SESSION *getSessionCallback(SSL *ssl, const unsigned char *id, int idLength, int *copy);
+    static void removeSessionCallback(SSL_CTX *ctx, SSL_SESSION *session);
+
+    // 票据密钥回调（加密时使用当前密钥，解密时同时接受上一把密钥）
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    static int ticketKeyCallback(SSL *ssl, unsigned char *keyName, unsigned char *iv,
+                                 EVP_CIPHER_CTX *cipherCtx, EVP_MAC_CTX *macCtx, int enc);
+#else
+    static int ticketKeyCallback(SSL *ssl, unsigned char *keyName, unsigned char *iv,
+                                 EVP_CIPHER_CTX *cipherCtx, HMAC_CTX *hmacCtx, int enc);
+#endif
+
+    void storeSession(const QByteArray &id, const QByteArray &session);
+    QByteArray lookupSession(const QByteArray &id);
+    void removeSession(const QByteArray &id);
+
+    // 获取加密用票据密钥（必要时轮换）
+    bool currentTicketKey(TicketKey &key);
+
+    // 按名称查找解密用票据密钥，renew表示应使用新密钥重新签发票据
+    bool findTicketKey(const unsigned char *name, TicketKey &key, bool &renew);
+
+    bool generateTicketKey(TicketKey &key);
+
+    TlsSessionSettings settings_;
+    QElapsedTimer clock_;
+
+    mutable QMutex cache_mutex_;
+    QHash<QByteArray, CacheEntry> sessions_;
+    std::list<QByteArray> order_; // 插入顺序，用于淘汰最旧的会话
+
+    QMutex ticket_mutex_;
+    TicketKey current_key_;
+    TicketKey previous_key_;
+    bool has_previous_key_;
+
+    QAtomicInteger<quint64> full_handshakes_;
+    QAtomicInteger<quint64> resumed_handshakes_;
+    QAtomicInteger<quint64> cache_hits_;
+    QAtomicInteger<quint64> cache_misses_;
+
+    static int ssl_ex_index_;
+    static int ctx_ex_index_;
+};
+
+#endif // TLSSESSIONCACHE_H
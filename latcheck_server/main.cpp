@@ -2,6 +2,8 @@
 #include <QTimer>
 #include <QThread>
 #include <QSocketNotifier>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
 #include <csignal>
 #include <unistd.h>
 #include <sys/socket.h>
@@ -14,10 +16,16 @@
 #include "database/user_dao.h"
 #include "database/report_dao.h"
 #include "database/server_dao.h" // 添加ServerDAO头文件
+#include "database/db_executor.h"
+#include "database/report_ingest_queue.h"
+#include "latency/latency_engine.h"
 #include "auth/auth_manager.h"
 #include "server/tls_server.h"
-// 移除REST API头文件引用
-// #include "api/rest_api_server.h"
+#include "server/metrics_server.h"
+#include "common/latency_histogram.h"
+#include "api/rest_query_server.h"
+#include "catalog/server_catalog.h"
+#include "catalog/server_catalog_loader.h"
 
 // 在 LatCheckServer 类的 private 部分添加方法声明
 class LatCheckServer : public QObject
@@ -26,7 +34,7 @@ class LatCheckServer : public QObject
 
 public:
     explicit LatCheckServer(QObject *parent = nullptr)
-        : QObject(parent), is_running_(false)
+        : QObject(parent), db_pool_(nullptr), db_executor_(nullptr), metrics_server_(nullptr), rest_server_(nullptr), is_running_(false)
     {
         // 设置信号处理
         setupSignalHandlers();
@@ -79,8 +87,35 @@ public:
             report_dao_ = std::make_shared<ReportDAO>();
             server_dao_ = std::make_shared<ServerDAO>(); // 添加ServerDAO初始化
 
-            // 解析ip_result.txt文件并更新服务器信息
-            parseIpResultFile();
+            // 加载服务器目录，之后ip_result.txt或test_server的变化无需重启即可生效
+            ServerConfig catalogConfig = config_->getServerConfig();
+            if (!ServerCatalog::instance()->start(catalogConfig.serverListFile, catalogConfig.serverCatalogPollInterval))
+            {
+                Logger::instance()->error("Failed to start server catalog");
+                return false;
+            }
+
+            // 启动数据库执行线程，TLS会话中的数据库操作都在这些线程中执行
+            db_executor_ = DbExecutor::instance();
+            if (!db_executor_->start(dbConfig.workerThreads))
+            {
+                Logger::instance()->error("Failed to start database executor");
+                return false;
+            }
+
+            // 启动地点间延时引擎，报告入库后增量更新calculated_latencies
+            if (dbConfig.calculateLatencies && !LatencyEngine::instance()->start())
+            {
+                Logger::instance()->error("Failed to start latency engine");
+                return false;
+            }
+
+            // 启动报告组提交线程，多个会话的报告合并到同一个事务中保存
+            if (!ReportIngestQueue::instance()->start(dbConfig.groupCommitMaxReports, dbConfig.groupCommitMaxDelayMs))
+            {
+                Logger::instance()->error("Failed to start report ingest queue");
+                return false;
+            }
 
             // 5. 初始化认证管理器
             logger_ = Logger::instance();
@@ -94,9 +129,6 @@ public:
             // 修改第94行为：
             tls_server_->setConfigManager(QSharedPointer<ConfigManager>(config_, [](ConfigManager *) {}));
 
-            tls_server_->setUserDAO(QSharedPointer<UserDAO>(user_dao_.get()));
-            tls_server_->setReportDAO(QSharedPointer<ReportDAO>(report_dao_.get()));
-            tls_server_->setServerDAO(QSharedPointer<ServerDAO>(server_dao_.get()));
             tls_server_->setAuthManager(QSharedPointer<AuthManager>(auth_manager_.get()));
 
             Logger::instance()->info("All components initialized successfully");
@@ -138,6 +170,29 @@ public:
                 return false;
             }
 
+            // 启动本机监控端点（失败不影响主服务）
+            MetricsConfig metricsConfig = config_->getMetricsConfig();
+            if (metricsConfig.enabled)
+            {
+                metrics_server_ = new MetricsServer(tls_server_.get(), db_pool_, this);
+                if (!metrics_server_->start(metricsConfig))
+                {
+                    Logger::instance()->warning("Metrics endpoint is not available");
+                }
+            }
+
+            // 启动REST查询接口（失败不影响主服务）
+            ApiConfig apiConfig = config_->getApiConfig();
+            if (apiConfig.enabled)
+            {
+                rest_server_ = new RestQueryServer(this);
+                rest_server_->setAuthManager(auth_manager_);
+                if (!rest_server_->start(apiConfig))
+                {
+                    Logger::instance()->warning("REST query service is not available");
+                }
+            }
+
             is_running_ = true;
             Logger::instance()->info("LatCheckServer started successfully");
 
@@ -178,11 +233,36 @@ public:
         //     api_server_->stop();
         // }
 
+        if (metrics_server_)
+        {
+            metrics_server_->stop();
+        }
+
+        if (rest_server_)
+        {
+            rest_server_->stop();
+        }
+
         if (tls_server_)
         {
             tls_server_->stopServer();
         }
 
+        // 写入待提交的报告后停止组提交线程
+        ReportIngestQueue::instance()->stop();
+
+        // 处理完已入库报告的地点对后停止延时引擎
+        LatencyEngine::instance()->stop();
+
+        // 停止服务器目录的文件监视和轮询
+        ServerCatalog::instance()->stop();
+
+        // 等待在途的数据库任务完成后停止数据库执行线程
+        if (db_executor_)
+        {
+            db_executor_->stop();
+        }
+
         // 清理资源
         if (auth_manager_)
         {
@@ -203,6 +283,9 @@ private:
     ConfigManager *config_;
     Logger *logger_;
     DatabasePool *db_pool_;
+    DbExecutor *db_executor_;
+    MetricsServer *metrics_server_; // 本机监控端点
+    RestQueryServer *rest_server_;  // REST查询接口
     std::shared_ptr<UserDAO> user_dao_;
     std::shared_ptr<ReportDAO> report_dao_;
     std::shared_ptr<ServerDAO> server_dao_; // 添加ServerDAO成员变量
@@ -215,8 +298,10 @@ private:
     // 添加信号处理相关成员
     static int sigintFd[2];
     static int sigtermFd[2];
+    static int sigusr1Fd[2];
     QSocketNotifier *snInt;
     QSocketNotifier *snTerm;
+    QSocketNotifier *snUsr1;
 
     void setupSignalHandlers()
     {
@@ -225,14 +310,18 @@ private:
             qFatal("Couldn't create SIGINT socketpair");
         if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sigtermFd))
             qFatal("Couldn't create SIGTERM socketpair");
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sigusr1Fd))
+            qFatal("Couldn't create SIGUSR1 socketpair");
 
         snInt = new QSocketNotifier(sigintFd[1], QSocketNotifier::Read, this);
         connect(snInt, &QSocketNotifier::activated, this, &LatCheckServer::handleSigInt);
         snTerm = new QSocketNotifier(sigtermFd[1], QSocketNotifier::Read, this);
         connect(snTerm, &QSocketNotifier::activated, this, &LatCheckServer::handleSigTerm);
+        snUsr1 = new QSocketNotifier(sigusr1Fd[1], QSocketNotifier::Read, this);
+        connect(snUsr1, &QSocketNotifier::activated, this, &LatCheckServer::handleSigUsr1);
 
         // 设置信号处理器
-        struct sigaction sigint, sigterm;
+        struct sigaction sigint, sigterm, sigusr1;
 
         sigint.sa_handler = LatCheckServer::intSignalHandler;
         sigemptyset(&sigint.sa_mask);
@@ -242,10 +331,17 @@ private:
         sigemptyset(&sigterm.sa_mask);
         sigterm.sa_flags = SA_RESTART;
 
+        // SIGUSR1：输出请求耗时统计
+        sigusr1.sa_handler = LatCheckServer::usr1SignalHandler;
+        sigemptyset(&sigusr1.sa_mask);
+        sigusr1.sa_flags = SA_RESTART;
+
         if (sigaction(SIGINT, &sigint, 0))
             qFatal("Couldn't install SIGINT handler");
         if (sigaction(SIGTERM, &sigterm, 0))
             qFatal("Couldn't install SIGTERM handler");
+        if (sigaction(SIGUSR1, &sigusr1, 0))
+            qFatal("Couldn't install SIGUSR1 handler");
     }
 
     // 静态信号处理函数
@@ -263,110 +359,12 @@ private:
         [[maybe_unused]] ssize_t result = ::write(sigtermFd[0], &a, sizeof(a));
     }
 
-    // 在LatCheckServer类的private方法部分添加新方法的实现
-    // 修改 parseIpResultFile() 方法
-    void parseIpResultFile()
+    static void usr1SignalHandler(int)
     {
-        QString filePath = QString("config/ip_result.txt");
-        QFile file(filePath);
-
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-        {
-            Logger::instance()->error(QString("Failed to open IP result file: %1").arg(file.fileName()));
-            return;
-        }
-
-        // 手动获取一个数据库连接
-        QSqlDatabase db = DatabasePool::instance()->getConnection();
-        if (!db.isValid() || !db.isOpen())
-        {
-            Logger::instance()->error("Failed to get database connection for server insertion");
-            file.close();
-            return;
-        }
-
-        // 在当前连接上开始事务
-        if (!db.transaction())
-        {
-            Logger::instance()->error("Failed to begin transaction for server insertion");
-            DatabasePool::instance()->releaseConnection(db);
-            file.close();
-            return;
-        }
-
-        QTextStream in(&file);
-        QString header = in.readLine(); // 跳过表头
-
-        int successCount = 0;
-        int failCount = 0;
-        bool transactionSuccess = true;
-
-        while (!in.atEnd() && transactionSuccess)
-        {
-            QString line = in.readLine();
-            QStringList fields = line.split(',');
-
-            // 387, success, 185.247.184.62, 542ms, 意大利 米兰 SU区
-
-            if (fields.size() >= 4 && fields[1].trimmed() == "success")
-            {
-                QString ip = fields[2].trimmed();
-                QString description = fields[4].trimmed();
-
-                // 将 IP 地址转换为整数
-                quint32 ipInt = ipToInt(ip);
-
-                // 直接在当前连接上执行SQL，不通过server_dao_的方法
-                QSqlQuery query(db);
-                query.prepare("INSERT INTO test_server (location, ip_addr, active) VALUES (?, ?, ?) "
-                              "ON DUPLICATE KEY UPDATE ip_addr = VALUES(ip_addr), active = VALUES(active)");
-                query.addBindValue(description);
-                query.addBindValue(ipInt);
-                query.addBindValue(true);
-
-                if (!query.exec())
-                {
-                    Logger::instance()->error(QString("Failed to add server: %1, IP: %2 - %3")
-                                                  .arg(description)
-                                                  .arg(ip)
-                                                  .arg(query.lastError().text()));
-                    failCount++;
-                }
-                else
-                {
-                    successCount++;
-                }
-            }
-        }
-
-        // 提交或回滚事务
-        if (transactionSuccess && db.commit())
-        {
-            Logger::instance()->info(QString("Server insertion completed: %1 succeeded, %2 failed")
-                                         .arg(successCount)
-                                         .arg(failCount));
-        }
-        else
-        {
-            db.rollback();
-            Logger::instance()->error("Transaction for server insertion rolled back due to errors");
-        }
-
-        // 释放数据库连接
-        DatabasePool::instance()->releaseConnection(db);
-        file.close();
+        char a = 1;
+        [[maybe_unused]] ssize_t result = ::write(sigusr1Fd[0], &a, sizeof(a));
     }
-    // 实现 IP 地址转换方法
-    quint32 ipToInt(const QString &ip)
-    {
-        QHostAddress address(ip);
-        if (address.protocol() != QAbstractSocket::IPv4Protocol)
-        {
-            throw std::invalid_argument(QString("Invalid IPv4 address: %1").arg(ip).toStdString());
-        }
 
-        return address.toIPv4Address();
-    }
 
 public slots:
     void handleSigInt()
@@ -395,6 +393,21 @@ public slots:
         QCoreApplication::quit();
     }
 
+    void handleSigUsr1()
+    {
+        snUsr1->setEnabled(false);
+        char tmp;
+        [[maybe_unused]] ssize_t result = ::read(sigusr1Fd[1], &tmp, sizeof(tmp));
+
+        // 合并各线程的耗时直方图并输出
+        QString report = LatencyStats::instance()->report(&MessageProtocol::messageTypeName);
+        Logger::instance()->info(
+            QString("Received SIGUSR1, request latency statistics:\n%1")
+                .arg(report.isEmpty() ? QString("(no requests recorded)") : report));
+
+        snUsr1->setEnabled(true);
+    }
+
     void performCleanup()
     {
         try
@@ -463,11 +476,136 @@ public slots:
 // 定义静态成员
 int LatCheckServer::sigintFd[2];
 int LatCheckServer::sigtermFd[2];
+int LatCheckServer::sigusr1Fd[2];
+
+// 数据迁移：将逐行存储的报告记录转换为紧凑存储（见ReportDAO::encodeRecords），
+// 每个报告在单独的事务中转换，可以中断后重新执行
+static int migrateReportRecords(int batchSize)
+{
+    if (!ConfigManager::instance()->loadConfig("config/config.json"))
+    {
+        qCritical("Failed to load configuration");
+        return -1;
+    }
+
+    if (!Logger::instance()->initialize(ConfigManager::instance()->getLogConfig()))
+    {
+        return -1;
+    }
+
+    DatabaseConfig dbConfig = ConfigManager::instance()->getDatabaseConfig();
+    dbConfig.minConnections = 1;
+    if (!DatabasePool::instance()->initialize(dbConfig))
+    {
+        Logger::instance()->error("Failed to initialize database pool", "Migration");
+        return -1;
+    }
+
+    ReportDAO reportDao;
+    QElapsedTimer timer;
+    timer.start();
+
+    qint64 lastReportId = 0;
+    int reports = 0;
+    qint64 records = 0;
+    int failures = 0;
+    for (;;)
+    {
+        QList<qint64> reportIds = reportDao.getReportIdsWithRowRecords(lastReportId, batchSize);
+        if (reportIds.isEmpty())
+        {
+            break;
+        }
+
+        for (qint64 reportId : reportIds)
+        {
+            int recordCount = 0;
+            if (reportDao.packReportRecords(reportId, &recordCount) == ErrorCode::Success)
+            {
+                ++reports;
+                records += recordCount;
+            }
+            else
+            {
+                ++failures;
+            }
+        }
+
+        lastReportId = reportIds.last();
+        Logger::instance()->info(QString("Packed %1 reports (%2 records), last report ID %3")
+                                     .arg(reports)
+                                     .arg(records)
+                                     .arg(lastReportId),
+                                 "Migration");
+    }
+
+    Logger::instance()->info(QString("Record migration finished: %1 reports, %2 records, %3 failures, %4 ms")
+                                 .arg(reports)
+                                 .arg(records)
+                                 .arg(failures)
+                                 .arg(timer.elapsed()),
+                             "Migration");
+
+    DatabasePool::instance()->close();
+    return failures == 0 ? 0 : 1;
+}
+
+// 从ip_result格式的文件加载服务器目录后退出，用于较大的服务器目录
+static int loadServerCatalog(const QString &filePath, int chunkSize)
+{
+    if (!ConfigManager::instance()->loadConfig("config/config.json"))
+    {
+        qCritical("Failed to load configuration");
+        return -1;
+    }
+
+    if (!Logger::instance()->initialize(ConfigManager::instance()->getLogConfig()))
+    {
+        return -1;
+    }
+
+    DatabaseConfig dbConfig = ConfigManager::instance()->getDatabaseConfig();
+    dbConfig.minConnections = 1;
+    if (!DatabasePool::instance()->initialize(dbConfig))
+    {
+        Logger::instance()->error("Failed to initialize database pool", "ServerCatalog");
+        return -1;
+    }
+
+    ServerCatalogLoadStats stats;
+    ServerCatalogLoader loader(chunkSize);
+    bool success = loader.load(filePath, stats);
+
+    DatabasePool::instance()->close();
+    return success ? 0 : 1;
+}
 
 int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption migrateOption("migrate-records", "Convert row-stored report records to packed storage and exit.");
+    QCommandLineOption batchOption("batch-size", "Reports fetched per migration batch, or servers per upsert statement.", "n");
+    QCommandLineOption loadServersOption("load-servers", "Load the server catalog from an ip_result file and exit.", "file");
+    parser.addOption(migrateOption);
+    parser.addOption(batchOption);
+    parser.addOption(loadServersOption);
+    parser.process(app);
+
+    if (parser.isSet(migrateOption))
+    {
+        int batchSize = parser.isSet(batchOption) ? parser.value(batchOption).toInt() : 100;
+        return migrateReportRecords(qMax(1, batchSize));
+    }
+
+    if (parser.isSet(loadServersOption))
+    {
+        int chunkSize = parser.isSet(batchOption) ? parser.value(batchOption).toInt() : 500;
+        return loadServerCatalog(parser.value(loadServersOption), qMax(1, chunkSize));
+    }
+
     // 创建服务器实例
     LatCheckServer server;
 
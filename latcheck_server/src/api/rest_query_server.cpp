@@ -0,0 +1,894 @@
+#include "api/rest_query_server.h"
+#include "database/db_executor.h"
+#include "latency/latency_engine.h"
+#include "auth/password_utils.h"
+#include "auth/auth_manager.h"
+#include "config/config_manager.h"
+#include "logger/logger.h"
+
+#include <QFile>
+#include <QSslKey>
+#include <QSslCertificate>
+#include <QHostAddress>
+#include <QUrlQuery>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+
+namespace
+{
+    // 报告详细记录查询结果
+    struct ReportDetailResult
+    {
+        Report report;
+        QList<ReportRecord> records;
+    };
+
+    QJsonObject reportToJson(const Report &report)
+    {
+        QJsonObject object;
+        object["report_id"] = report.id;
+        object["check_location"] = report.location;
+        object["user_name"] = report.userName;
+        object["created_time"] = report.createdAt.toString(Qt::ISODate);
+        return object;
+    }
+
+    QByteArray successBody(QJsonObject object)
+    {
+        object["success"] = true;
+        return QJsonDocument(object).toJson(QJsonDocument::Compact);
+    }
+}
+
+RestQueryServer::RestQueryServer(QObject *parent)
+    : QTcpServer(parent),
+      use_ssl_(true),
+      next_connection_id_(1),
+      latencies_version_(0),
+      latencies_cached_(false),
+      request_count_(0),
+      cache_hits_(0),
+      cache_misses_(0)
+{
+}
+
+RestQueryServer::~RestQueryServer()
+{
+    stop();
+}
+
+bool RestQueryServer::start(const ApiConfig &config)
+{
+    config_ = config;
+    use_ssl_ = config.enableSSL;
+    report_cache_.setMaxCost(qMax(1, config.reportCacheEntries));
+    detail_cache_.setMaxCost(qMax(1, config.reportCacheEntries));
+
+    // 接入控制的速率和握手限制与TLS服务器相同，连接数上限使用本接口的配置
+    ServerConfig serverConfig = ConfigManager::instance()->getServerConfig();
+    AdmissionSettings admissionSettings;
+    admissionSettings.maxConnections = qMax(1, config.maxConnections);
+    admissionSettings.perIpRate = qMax(0.0, serverConfig.perIpConnectRate);
+    admissionSettings.perIpBurst = qMax(1, serverConfig.perIpConnectBurst);
+    admissionSettings.maxPendingHandshakes = qMax(0, serverConfig.maxPendingHandshakes);
+    admissionSettings.acceptQueueHighWatermark = qMax(0, serverConfig.acceptQueueHighWatermark);
+    admissionSettings.ipTableSize = qMax(1, serverConfig.admissionIpTableSize);
+    admission_ = std::make_unique<AdmissionController>(admissionSettings);
+
+    if (!auth_manager_)
+    {
+        Logger::instance()->warning("REST query server started without login throttling", "RestQueryServer");
+    }
+
+    if (use_ssl_)
+    {
+        QFile certFile(config.certificatePath);
+        QFile keyFile(config.privateKeyPath);
+        if (!certFile.open(QIODevice::ReadOnly) || !keyFile.open(QIODevice::ReadOnly))
+        {
+            Logger::instance()->error(QString("Failed to open API certificate or private key: %1, %2")
+                                          .arg(config.certificatePath, config.privateKeyPath),
+                                      "RestQueryServer");
+            return false;
+        }
+
+        QSslCertificate cert(&certFile, QSsl::Pem);
+        QSslKey key(&keyFile, QSsl::Rsa, QSsl::Pem);
+        if (cert.isNull() || key.isNull())
+        {
+            Logger::instance()->error("Invalid API certificate or private key", "RestQueryServer");
+            return false;
+        }
+
+        ssl_config_ = QSslConfiguration::defaultConfiguration();
+        ssl_config_.setLocalCertificate(cert);
+        ssl_config_.setPrivateKey(key);
+        ssl_config_.setPeerVerifyMode(QSslSocket::VerifyNone);
+        ssl_config_.setProtocol(QSsl::TlsV1_2OrLater);
+    }
+
+    if (!listen(QHostAddress(config.host), static_cast<quint16>(config.port)))
+    {
+        Logger::instance()->error(QString("Failed to start REST query server on %1:%2 - %3")
+                                      .arg(config.host)
+                                      .arg(config.port)
+                                      .arg(errorString()),
+                                  "RestQueryServer");
+        return false;
+    }
+
+    Logger::instance()->info(QString("REST query server listening on %1://%2:%3")
+                                 .arg(use_ssl_ ? "https" : "http")
+                                 .arg(config.host)
+                                 .arg(config.port),
+                             "RestQueryServer");
+    return true;
+}
+
+void RestQueryServer::stop()
+{
+    if (isListening())
+    {
+        close();
+        Logger::instance()->info(QString("REST query server stopped (%1 requests, cache %2 hits / %3 misses)")
+                                     .arg(request_count_)
+                                     .arg(cache_hits_)
+                                     .arg(cache_misses_),
+                                 "RestQueryServer");
+    }
+
+    const QList<Connection *> connections = connections_.values();
+    for (Connection *connection : connections)
+    {
+        connection->socket->disconnect(this);
+        connection->socket->abort();
+        connection->socket->deleteLater();
+        delete connection;
+    }
+    connections_.clear();
+    sockets_.clear();
+}
+
+void RestQueryServer::incomingConnection(qintptr socketDescriptor)
+{
+    // 在创建socket和TLS状态之前判定是否接收
+    QHostAddress peerAddress;
+    AdmissionResult result = admission_->admit(socketDescriptor, connections_.size(), &peerAddress);
+    if (result != AdmissionResult::Accepted)
+    {
+        AdmissionController::closeDescriptor(socketDescriptor);
+        Logger::instance()->warning(QString("REST connection from %1 rejected: %2")
+                                        .arg(peerAddress.toString())
+                                        .arg(AdmissionController::resultName(result)),
+                                    "RestQueryServer");
+        return;
+    }
+
+    // 在接入线程中直接接管描述符
+    admission_->dispatched();
+
+    QSslSocket *socket = new QSslSocket(this);
+    if (!socket->setSocketDescriptor(socketDescriptor))
+    {
+        delete socket;
+        AdmissionController::closeDescriptor(socketDescriptor);
+        admission_->handshakeFinished();
+        return;
+    }
+
+    Connection *connection = new Connection;
+    connection->id = next_connection_id_++;
+    connection->socket = socket;
+    connection->idleTimer = new QTimer(socket);
+    connection->idleTimer->setSingleShot(true);
+    connection->idleTimer->setInterval(qMax(1, config_.keepAliveTimeout) * 1000);
+    connection->handshakePending = true;
+    connections_.insert(connection->id, connection);
+    sockets_.insert(socket, connection);
+
+    connect(socket, &QSslSocket::readyRead, this, &RestQueryServer::onReadyRead);
+    connect(socket, &QSslSocket::disconnected, this, &RestQueryServer::onDisconnected);
+
+    quint64 id = connection->id;
+    connect(connection->idleTimer, &QTimer::timeout, this, [this, id]()
+            {
+                // 空闲超时：仍有未完成的请求时继续等待
+                Connection *connection = connections_.value(id);
+                if (!connection)
+                {
+                    return;
+                }
+                if (connection->responses.empty())
+                {
+                    closeConnection(connection);
+                }
+                else
+                {
+                    connection->idleTimer->start();
+                } });
+    connection->idleTimer->start();
+
+    if (use_ssl_)
+    {
+        connect(socket, &QSslSocket::encrypted, this, [this, id]()
+                {
+                    if (Connection *connection = connections_.value(id))
+                    {
+                        releaseHandshake(connection);
+                    } });
+        socket->setSslConfiguration(ssl_config_);
+        socket->startServerEncryption();
+    }
+    else
+    {
+        releaseHandshake(connection);
+    }
+}
+
+void RestQueryServer::releaseHandshake(Connection *connection)
+{
+    if (connection->handshakePending)
+    {
+        connection->handshakePending = false;
+        admission_->handshakeFinished();
+    }
+}
+
+void RestQueryServer::onReadyRead()
+{
+    Connection *connection = sockets_.value(qobject_cast<QSslSocket *>(sender()));
+    if (!connection)
+    {
+        return;
+    }
+
+    connection->buffer += connection->socket->readAll();
+    connection->idleTimer->start();
+
+    if (connection->buffer.size() > MaxHeaderSize + MaxBodySize + config_.maxPipelinedRequests * MaxHeaderSize)
+    {
+        // 对端持续发送而不读取响应
+        closeConnection(connection);
+        return;
+    }
+
+    processBuffer(connection);
+}
+
+void RestQueryServer::onDisconnected()
+{
+    QSslSocket *socket = qobject_cast<QSslSocket *>(sender());
+    Connection *connection = sockets_.value(socket);
+    if (!connection)
+    {
+        return;
+    }
+
+    releaseHandshake(connection);
+    connections_.remove(connection->id);
+    sockets_.remove(socket);
+    socket->deleteLater();
+    delete connection;
+}
+
+bool RestQueryServer::processBuffer(Connection *connection)
+{
+    quint64 id = connection->id;
+    while (!connection->closing && static_cast<int>(connection->responses.size()) < config_.maxPipelinedRequests)
+    {
+        HttpRequest request;
+        bool finished = false;
+        if (!parseRequest(connection, request, finished))
+        {
+            // 无法继续解析后续请求：发送400后关闭连接
+            connection->closing = true;
+            connection->buffer.clear();
+            ResponseHandle handle{id, connection->nextSequence++, false};
+            connection->responses.push_back(ResponseSlot{handle.sequence});
+            complete(handle, 400, errorBody("bad request"));
+            return false;
+        }
+
+        if (!finished)
+        {
+            break;
+        }
+
+        ResponseHandle handle{id, connection->nextSequence++, request.keepAlive};
+        connection->responses.push_back(ResponseSlot{handle.sequence});
+        connection->closing = !request.keepAlive;
+        ++request_count_;
+
+        dispatch(request, handle);
+
+        // 同步完成的请求可能已关闭连接
+        connection = connections_.value(id);
+        if (!connection)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool RestQueryServer::parseRequest(Connection *connection, HttpRequest &request, bool &finished)
+{
+    QByteArray &buffer = connection->buffer;
+    finished = false;
+
+    int headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0)
+    {
+        return buffer.size() <= MaxHeaderSize;
+    }
+    if (headerEnd > MaxHeaderSize)
+    {
+        return false;
+    }
+
+    QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() != 3 || !requestLine.at(2).startsWith("HTTP/1."))
+    {
+        return false;
+    }
+
+    request.method = requestLine.at(0);
+    request.keepAlive = requestLine.at(2) != "HTTP/1.0";
+
+    qint64 contentLength = 0;
+    for (int i = 1; i < lines.size(); ++i)
+    {
+        const QByteArray &line = lines.at(i);
+        int colon = line.indexOf(':');
+        if (colon <= 0)
+        {
+            continue;
+        }
+
+        QByteArray name = line.left(colon).trimmed().toLower();
+        QByteArray value = line.mid(colon + 1).trimmed();
+        if (name == "content-length")
+        {
+            bool ok = false;
+            contentLength = value.toLongLong(&ok);
+            if (!ok || contentLength < 0 || contentLength > MaxBodySize)
+            {
+                return false;
+            }
+        }
+        else if (name == "transfer-encoding")
+        {
+            // 不支持分块请求体
+            return false;
+        }
+        else if (name == "connection")
+        {
+            QByteArray token = value.toLower();
+            if (token == "close")
+            {
+                request.keepAlive = false;
+            }
+            else if (token == "keep-alive")
+            {
+                request.keepAlive = true;
+            }
+        }
+        else if (name == "authorization")
+        {
+            request.authorization = value;
+        }
+    }
+
+    qint64 requestSize = headerEnd + 4 + contentLength;
+    if (buffer.size() < requestSize)
+    {
+        return true;
+    }
+
+    QByteArray target = requestLine.at(1);
+    int queryStart = target.indexOf('?');
+    request.path = queryStart >= 0 ? target.left(queryStart) : target;
+    request.query = queryStart >= 0 ? target.mid(queryStart + 1) : QByteArray();
+    request.body = buffer.mid(headerEnd + 4, contentLength);
+    buffer.remove(0, requestSize);
+
+    finished = true;
+    return true;
+}
+
+void RestQueryServer::dispatch(const HttpRequest &request, const ResponseHandle &handle)
+{
+    if (request.path == "/api/login")
+    {
+        if (request.method != "POST")
+        {
+            complete(handle, 405, errorBody("method not allowed"));
+            return;
+        }
+        handleLogin(request, handle);
+        return;
+    }
+
+    QString userName;
+    if (!authorize(request, userName))
+    {
+        complete(handle, 401, errorBody("invalid or expired token"));
+        return;
+    }
+
+    if (request.method != "GET")
+    {
+        complete(handle, 405, errorBody("method not allowed"));
+        return;
+    }
+
+    if (request.path == "/api/latency")
+    {
+        handleLatency(request, handle);
+    }
+    else if (request.path == "/api/latencies/all")
+    {
+        handleAllLatencies(handle);
+    }
+    else if (request.path == "/api/reports")
+    {
+        handleReports(request, handle);
+    }
+    else if (request.path.startsWith("/api/report/"))
+    {
+        // /api/report/{id} 或 /api/report/{id}/detail
+        QList<QByteArray> parts = request.path.mid(int(sizeof("/api/report/")) - 1).split('/');
+        bool ok = false;
+        qint64 reportId = parts.first().toLongLong(&ok);
+        bool detail = parts.size() == 2 && parts.at(1) == "detail";
+        if (!ok || reportId <= 0 || parts.size() > 2 || (parts.size() == 2 && !detail))
+        {
+            complete(handle, 404, errorBody("not found"));
+            return;
+        }
+        handleReport(reportId, detail, handle);
+    }
+    else
+    {
+        complete(handle, 404, errorBody("not found"));
+    }
+}
+
+void RestQueryServer::handleLogin(const HttpRequest &request, const ResponseHandle &handle)
+{
+    QJsonObject body = QJsonDocument::fromJson(request.body).object();
+    QString userName = body.value("user_name").toString();
+    QString password = body.value("password").toString();
+    if (userName.isEmpty() || password.isEmpty())
+    {
+        complete(handle, 400, errorBody("user_name and password are required"));
+        return;
+    }
+
+    // 登录按源IP限速，被锁定的账户在验证密码前拒绝
+    Connection *connection = connections_.value(handle.connectionId);
+    QString clientIp = connection ? connection->socket->peerAddress().toString() : QString();
+    if (auth_manager_)
+    {
+        if (!auth_manager_->checkRateLimit(clientIp))
+        {
+            Logger::instance()->warning(QString("REST login rate limit exceeded for %1").arg(clientIp), "RestQueryServer");
+            complete(handle, 429, errorBody("too many login attempts"));
+            return;
+        }
+        if (auth_manager_->isAccountLocked(userName))
+        {
+            auth_manager_->recordLoginAttempt(userName, clientIp, false);
+            Logger::instance()->warning(QString("REST login for locked account: %1 from %2").arg(userName, clientIp), "RestQueryServer");
+            complete(handle, 403, errorBody("account locked"));
+            return;
+        }
+    }
+
+    bool submitted = DbExecutor::instance()->submit(
+        this,
+        [userName](DbContext &db)
+        {
+            return db.userDao->getUserByUsername(userName);
+        },
+        [this, handle, userName, password, clientIp](const User &user)
+        {
+            // 查询接口只对管理员和报告查询者开放
+            if (user.id == 0 || user.status != UserStatus::Active ||
+                !PasswordUtils::verifyPassword(password, user.passwordHash, user.salt))
+            {
+                if (auth_manager_)
+                {
+                    auth_manager_->recordLoginAttempt(userName, clientIp, false);
+                }
+                Logger::instance()->warning(QString("REST login failed for user: %1 from %2").arg(userName, clientIp), "RestQueryServer");
+                complete(handle, 401, errorBody("invalid user name or password"));
+                return;
+            }
+            if (auth_manager_)
+            {
+                auth_manager_->recordLoginAttempt(userName, clientIp, true);
+            }
+            if (user.role != UserRole::Admin && user.role != UserRole::ReportViewer)
+            {
+                complete(handle, 403, errorBody("permission denied"));
+                return;
+            }
+
+            // 登录时清理过期令牌
+            QDateTime now = QDateTime::currentDateTimeUtc();
+            for (auto it = tokens_.begin(); it != tokens_.end();)
+            {
+                it = it->expiresAt <= now ? tokens_.erase(it) : std::next(it);
+            }
+
+            QByteArray random(32, Qt::Uninitialized);
+            QRandomGenerator::system()->fillRange(reinterpret_cast<quint32 *>(random.data()), random.size() / 4);
+            QString token = QString::fromLatin1(random.toHex());
+            tokens_.insert(token, TokenInfo{userName, now.addSecs(config_.tokenTtl)});
+
+            QJsonObject result;
+            result["token"] = token;
+            result["expires_in"] = config_.tokenTtl;
+            complete(handle, 200, successBody(result));
+        });
+
+    if (!submitted)
+    {
+        complete(handle, 503, errorBody("database unavailable"));
+    }
+}
+
+void RestQueryServer::handleLatency(const HttpRequest &request, const ResponseHandle &handle)
+{
+    QUrlQuery params(QString::fromUtf8(request.query));
+    QString location1 = params.queryItemValue("location1", QUrl::FullyDecoded);
+    QString location2 = params.queryItemValue("location2", QUrl::FullyDecoded);
+    if (location1.isEmpty() || location2.isEmpty())
+    {
+        complete(handle, 400, errorBody("location1 and location2 are required"));
+        return;
+    }
+
+    LatencyEngine *engine = LatencyEngine::instance();
+    if (!engine->isRunning())
+    {
+        complete(handle, 503, errorBody("latency engine disabled"));
+        return;
+    }
+
+    LocationPairLatency pair;
+    if (!engine->matrix().pairLatency(location1, location2, pair))
+    {
+        complete(handle, 404, errorBody("no latency between the two locations"));
+        return;
+    }
+
+    QJsonObject result;
+    result["location1"] = location1;
+    result["location2"] = location2;
+    result["report1"] = pair.report1;
+    result["report2"] = pair.report2;
+    result["latency"] = pair.latency;
+    result["server_id"] = static_cast<qint64>(pair.serverId);
+    complete(handle, 200, successBody(result));
+}
+
+void RestQueryServer::handleAllLatencies(const ResponseHandle &handle)
+{
+    // 地点对只由LatencyEngine写入，更新次数不变时缓存的响应仍然有效
+    quint64 version = LatencyEngine::instance()->getUpdateCount();
+    if (latencies_cached_ && latencies_version_ == version)
+    {
+        ++cache_hits_;
+        complete(handle, 200, latencies_body_);
+        return;
+    }
+
+    ++cache_misses_;
+    bool submitted = DbExecutor::instance()->submit(
+        this,
+        [](DbContext &db)
+        {
+            return db.calculatedLatencyDao->getAllPairs();
+        },
+        [this, handle, version](const QList<LocationPairLatency> &pairs)
+        {
+            QJsonArray items;
+            for (const auto &pair : pairs)
+            {
+                QJsonObject item;
+                item["report1"] = pair.report1;
+                item["report2"] = pair.report2;
+                item["latency"] = pair.latency;
+                item["server_id"] = static_cast<qint64>(pair.serverId);
+                items.append(item);
+            }
+
+            QJsonObject result;
+            result["latencies"] = items;
+            QByteArray body = successBody(result);
+            if (version >= latencies_version_)
+            {
+                latencies_body_ = body;
+                latencies_version_ = version;
+                latencies_cached_ = true;
+            }
+            complete(handle, 200, body);
+        });
+
+    if (!submitted)
+    {
+        complete(handle, 503, errorBody("database unavailable"));
+    }
+}
+
+void RestQueryServer::handleReports(const HttpRequest &request, const ResponseHandle &handle)
+{
+    QUrlQuery params(QString::fromUtf8(request.query));
+    int limit = params.hasQueryItem("limit") ? params.queryItemValue("limit").toInt() : 100;
+    int offset = params.hasQueryItem("offset") ? params.queryItemValue("offset").toInt() : 0;
+    limit = qBound(1, limit, 1000);
+    offset = qMax(0, offset);
+
+    // cursor为上一页返回的next_cursor（"创建时间毫秒数:报告ID"，时间为数据库中保存的值），优先于offset
+    bool useCursor = params.hasQueryItem("cursor");
+    ReportPageCursor cursor;
+    if (useCursor)
+    {
+        QStringList parts = params.queryItemValue("cursor").split(':');
+        bool timeOk = false;
+        bool idOk = false;
+        qint64 msecs = parts.size() == 2 ? parts.at(0).toLongLong(&timeOk) : 0;
+        cursor.reportId = parts.size() == 2 ? parts.at(1).toLongLong(&idOk) : 0;
+        if (!timeOk || !idOk || cursor.reportId <= 0)
+        {
+            complete(handle, 400, errorBody("invalid cursor"));
+            return;
+        }
+        cursor.createdTime = QDateTime::fromMSecsSinceEpoch(msecs);
+    }
+
+    bool submitted = DbExecutor::instance()->submit(
+        this,
+        [limit, offset, useCursor, cursor](DbContext &db)
+        {
+            return useCursor ? db.reportDao->getReportsPage(cursor, limit) : db.reportDao->getAllReports(limit, offset);
+        },
+        [this, handle, limit](const QList<Report> &reports)
+        {
+            QJsonArray items;
+            for (const auto &report : reports)
+            {
+                items.append(reportToJson(report));
+            }
+
+            QJsonObject result;
+            result["reports"] = items;
+            if (reports.size() == limit)
+            {
+                result["next_cursor"] = QString("%1:%2").arg(reports.last().createdAt.toMSecsSinceEpoch()).arg(reports.last().id);
+            }
+            complete(handle, 200, successBody(result));
+        });
+
+    if (!submitted)
+    {
+        complete(handle, 503, errorBody("database unavailable"));
+    }
+}
+
+void RestQueryServer::handleReport(qint64 reportId, bool detail, const ResponseHandle &handle)
+{
+    // 报告写入后不再修改，序列化后的响应可以一直缓存
+    QCache<qint64, QByteArray> &cache = detail ? detail_cache_ : report_cache_;
+    if (const QByteArray *body = cache.object(reportId))
+    {
+        ++cache_hits_;
+        complete(handle, 200, *body);
+        return;
+    }
+
+    ++cache_misses_;
+    bool submitted = DbExecutor::instance()->submit(
+        this,
+        [reportId, detail](DbContext &db)
+        {
+            ReportDetailResult result;
+            result.report = db.reportDao->getReportById(reportId);
+            if (detail && result.report.id != 0)
+            {
+                result.records = db.reportDao->getReportRecords(reportId);
+            }
+            return result;
+        },
+        [this, handle, reportId, detail](const ReportDetailResult &detailResult)
+        {
+            if (detailResult.report.id == 0)
+            {
+                complete(handle, 404, errorBody("report not found"));
+                return;
+            }
+
+            QJsonObject result;
+            if (detail)
+            {
+                QJsonArray records;
+                for (const auto &record : detailResult.records)
+                {
+                    QJsonObject item;
+                    item["record_id"] = record.id;
+                    item["server_id"] = static_cast<qint64>(record.serverId);
+                    item["server_ip"] = QHostAddress(record.serverIp).toString();
+                    item["latency"] = record.latency;
+                    records.append(item);
+                }
+                result["report_id"] = reportId;
+                result["records"] = records;
+            }
+            else
+            {
+                result["report"] = reportToJson(detailResult.report);
+            }
+
+            QByteArray body = successBody(result);
+            (detail ? detail_cache_ : report_cache_).insert(reportId, new QByteArray(body));
+            complete(handle, 200, body);
+        });
+
+    if (!submitted)
+    {
+        complete(handle, 503, errorBody("database unavailable"));
+    }
+}
+
+bool RestQueryServer::authorize(const HttpRequest &request, QString &userName)
+{
+    static const QByteArray prefix = "Bearer ";
+    if (!request.authorization.startsWith(prefix))
+    {
+        return false;
+    }
+
+    QString token = QString::fromLatin1(request.authorization.mid(prefix.size()).trimmed());
+    auto it = tokens_.find(token);
+    if (it == tokens_.end())
+    {
+        return false;
+    }
+
+    if (it->expiresAt <= QDateTime::currentDateTimeUtc())
+    {
+        tokens_.erase(it);
+        return false;
+    }
+
+    userName = it->userName;
+    return true;
+}
+
+void RestQueryServer::complete(const ResponseHandle &handle, int status, const QByteArray &body)
+{
+    // 连接已关闭时丢弃结果
+    Connection *connection = connections_.value(handle.connectionId);
+    if (!connection)
+    {
+        return;
+    }
+
+    for (ResponseSlot &slot : connection->responses)
+    {
+        if (slot.sequence == handle.sequence)
+        {
+            slot.ready = true;
+            slot.close = !handle.keepAlive;
+            slot.data = httpResponse(status, body, handle.keepAlive);
+            break;
+        }
+    }
+
+    flushResponses(connection);
+}
+
+void RestQueryServer::flushResponses(Connection *connection)
+{
+    bool sent = false;
+    while (!connection->responses.empty() && connection->responses.front().ready)
+    {
+        ResponseSlot &slot = connection->responses.front();
+        connection->socket->write(slot.data);
+        sent = true;
+
+        if (slot.close)
+        {
+            closeConnection(connection);
+            return;
+        }
+        connection->responses.pop_front();
+    }
+
+    if (!sent)
+    {
+        return;
+    }
+    connection->idleTimer->start();
+
+    // 因管线化上限暂停解析的请求，在当前调用返回后继续处理
+    if (!connection->closing && !connection->buffer.isEmpty())
+    {
+        quint64 id = connection->id;
+        QMetaObject::invokeMethod(
+            this,
+            [this, id]()
+            {
+                if (Connection *connection = connections_.value(id))
+                {
+                    processBuffer(connection);
+                }
+            },
+            Qt::QueuedConnection);
+    }
+}
+
+void RestQueryServer::closeConnection(Connection *connection)
+{
+    QSslSocket *socket = connection->socket;
+    releaseHandshake(connection);
+    connections_.remove(connection->id);
+    sockets_.remove(socket);
+    delete connection;
+
+    // 已写入的响应发送完毕后关闭
+    socket->disconnect(this);
+    connect(socket, &QSslSocket::disconnected, socket, &QObject::deleteLater);
+    socket->disconnectFromHost();
+}
+
+QByteArray RestQueryServer::httpResponse(int status, const QByteArray &body, bool keepAlive)
+{
+    QByteArray response;
+    response.reserve(body.size() + 160);
+    response += "HTTP/1.1 " + QByteArray::number(status) + ' ' + statusReason(status) + "\r\n";
+    response += "Content-Type: application/json; charset=utf-8\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    response += body;
+    return response;
+}
+
+QByteArray RestQueryServer::errorBody(const QString &message)
+{
+    QJsonObject object;
+    object["success"] = false;
+    object["error"] = message;
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+const char *RestQueryServer::statusReason(int status)
+{
+    switch (status)
+    {
+    case 200:
+        return "OK";
+    case 400:
+        return "Bad Request";
+    case 401:
+        return "Unauthorized";
+    case 403:
+        return "Forbidden";
+    case 404:
+        return "Not Found";
+    case 405:
+        return "Method Not Allowed";
+    case 429:
+        return "Too Many Requests";
+    case 503:
+        return "Service Unavailable";
+    default:
+        return "Internal Server Error";
+    }
+}
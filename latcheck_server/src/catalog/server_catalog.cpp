@@ -0,0 +1,346 @@
+#include "catalog/server_catalog.h"
+#include "catalog/server_catalog_loader.h"
+#include "logger/logger.h"
+
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <atomic>
+
+ServerCatalogWorker::ServerCatalogWorker(ServerCatalog *catalog, const QString &filePath, int pollInterval, QObject *parent)
+    : ThreadWorker(parent),
+      catalog_(catalog),
+      file_path_(QFileInfo(filePath).absoluteFilePath()),
+      poll_interval_(pollInterval),
+      watcher_(nullptr),
+      reload_timer_(nullptr),
+      poll_timer_(nullptr)
+{
+}
+
+ServerCatalogWorker::~ServerCatalogWorker()
+{
+}
+
+void ServerCatalogWorker::start()
+{
+    server_dao_ = std::make_unique<ServerDAO>();
+
+    watcher_ = new QFileSystemWatcher(this);
+    connect(watcher_, &QFileSystemWatcher::fileChanged, this, &ServerCatalogWorker::onFileChanged);
+    connect(watcher_, &QFileSystemWatcher::directoryChanged, this, &ServerCatalogWorker::onDirectoryChanged);
+    watcher_->addPath(QFileInfo(file_path_).absolutePath());
+    watchFile();
+
+    reload_timer_ = new QTimer(this);
+    reload_timer_->setSingleShot(true);
+    reload_timer_->setInterval(500);
+    connect(reload_timer_, &QTimer::timeout, this, &ServerCatalogWorker::reloadFile);
+
+    if (poll_interval_ > 0)
+    {
+        poll_timer_ = new QTimer(this);
+        poll_timer_->setInterval(poll_interval_ * 1000);
+        connect(poll_timer_, &QTimer::timeout, this, &ServerCatalogWorker::refresh);
+        poll_timer_->start();
+    }
+
+    reloadFile();
+}
+
+void ServerCatalogWorker::stop()
+{
+    delete poll_timer_;
+    delete reload_timer_;
+    delete watcher_;
+    poll_timer_ = nullptr;
+    reload_timer_ = nullptr;
+    watcher_ = nullptr;
+
+    server_dao_.reset();
+
+    Logger::instance()->debug("Server catalog worker stopped", "ServerCatalog");
+}
+
+void ServerCatalogWorker::onFileChanged(const QString &path)
+{
+    Q_UNUSED(path);
+    watchFile();
+    reload_timer_->start();
+}
+
+void ServerCatalogWorker::onDirectoryChanged(const QString &path)
+{
+    Q_UNUSED(path);
+    // 文件被删除后重新创建时，只有目录会收到通知
+    if (!watcher_->files().contains(file_path_) && QFileInfo::exists(file_path_))
+    {
+        watchFile();
+        reload_timer_->start();
+    }
+}
+
+void ServerCatalogWorker::watchFile()
+{
+    if (!watcher_->files().contains(file_path_) && QFileInfo::exists(file_path_))
+    {
+        watcher_->addPath(file_path_);
+    }
+}
+
+void ServerCatalogWorker::reloadFile()
+{
+    if (QFileInfo::exists(file_path_))
+    {
+        ServerCatalogLoadStats stats;
+        ServerCatalogLoader loader;
+        if (!loader.load(file_path_, stats))
+        {
+            Logger::instance()->error(QString("Failed to load server catalog from %1").arg(file_path_), "ServerCatalog");
+        }
+        catalog_->reload_count_.ref();
+    }
+    else
+    {
+        Logger::instance()->warning(QString("Server list file not found: %1").arg(file_path_), "ServerCatalog");
+    }
+
+    refresh();
+}
+
+void ServerCatalogWorker::refresh()
+{
+    if (!server_dao_)
+    {
+        return;
+    }
+
+    QList<ServerInfo> servers;
+    if (!server_dao_->getActiveServers(servers))
+    {
+        // 查询失败时保留当前快照
+        return;
+    }
+
+    // 与当前快照比较，只有内容变化时才发布
+    ServerCatalogSnapshotPtr current = catalog_->snapshot();
+    int added = 0;
+    int removed = 0;
+    int changed = 0;
+    QList<ServerInfo>::const_iterator old = current->servers.constBegin();
+    for (const auto &server : std::as_const(servers))
+    {
+        while (old != current->servers.constEnd() && old->serverId < server.serverId)
+        {
+            ++removed;
+            ++old;
+        }
+        if (old != current->servers.constEnd() && old->serverId == server.serverId)
+        {
+            changed += old->ipAddr != server.ipAddr ? 1 : 0;
+            ++old;
+        }
+        else
+        {
+            ++added;
+        }
+    }
+    removed += current->servers.constEnd() - old;
+
+    if (current->version != 0 && added == 0 && removed == 0 && changed == 0)
+    {
+        return;
+    }
+
+    catalog_->publish(servers);
+    Logger::instance()->info(QString("Server catalog version %1: %2 active servers (%3 added, %4 removed, %5 changed)")
+                                 .arg(catalog_->getVersion())
+                                 .arg(servers.size())
+                                 .arg(added)
+                                 .arg(removed)
+                                 .arg(changed),
+                             "ServerCatalog");
+}
+
+const QByteArray &ServerCatalogSnapshot::listDeltaResponse(quint64 clientVersion, ListDeltaKind &kind) const
+{
+    // 版本0表示客户端没有缓存
+    if (clientVersion != 0 && clientVersion == version)
+    {
+        kind = ListDeltaKind::NotModified;
+        return notModifiedResponse;
+    }
+
+    auto it = deltaResponses.constFind(clientVersion);
+    if (it != deltaResponses.constEnd())
+    {
+        kind = ListDeltaKind::Delta;
+        return it.value();
+    }
+
+    kind = ListDeltaKind::Full;
+    return fullDeltaResponse;
+}
+
+ServerCatalog::ServerCatalog(QObject *parent)
+    : QObject(parent), reload_count_(0),
+      list_full_count_(0), list_delta_count_(0), list_not_modified_count_(0), list_response_bytes_(0),
+      version_base_(QRandomGenerator::system()->generate64() >> 1)
+{
+    // 尚未加载时也返回有效的空列表
+    auto empty = std::make_shared<ServerCatalogSnapshot>();
+    empty->listResponse = MessageProtocol::serializeListResponse(empty->servers);
+    empty->fullDeltaResponse = MessageProtocol::serializeListDeltaResponse(0, ListDeltaKind::Full, {}, empty->servers);
+    empty->notModifiedResponse = MessageProtocol::serializeListDeltaResponse(0, ListDeltaKind::NotModified, {}, {});
+    snapshot_ = std::move(empty);
+}
+
+ServerCatalog::~ServerCatalog()
+{
+    stop();
+}
+
+bool ServerCatalog::start(const QString &filePath, int pollInterval)
+{
+    if (isRunning())
+    {
+        Logger::instance()->warning("Server catalog already started", "ServerCatalog");
+        return true;
+    }
+
+    // 第一个快照发布后才开始接受连接
+    thread_.start("server-catalog", new ServerCatalogWorker(this, filePath, pollInterval), true);
+
+    Logger::instance()->info(QString("Server catalog started (%1 active servers, watching %2, polling every %3 s)")
+                                 .arg(snapshot()->servers.size())
+                                 .arg(filePath)
+                                 .arg(pollInterval),
+                             "ServerCatalog");
+    return true;
+}
+
+void ServerCatalog::stop()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+
+    thread_.stop();
+
+    Logger::instance()->info(QString("Server catalog stopped (version %1, %2 file reloads)")
+                                 .arg(getVersion())
+                                 .arg(getReloadCount()),
+                             "ServerCatalog");
+}
+
+bool ServerCatalog::isRunning() const
+{
+    return thread_.isRunning();
+}
+
+ServerCatalogSnapshotPtr ServerCatalog::snapshot() const
+{
+    return std::atomic_load(&snapshot_);
+}
+
+void ServerCatalog::recordListResponse(ListDeltaKind kind, qsizetype bytes)
+{
+    switch (kind)
+    {
+    case ListDeltaKind::NotModified:
+        list_not_modified_count_.ref();
+        break;
+    case ListDeltaKind::Delta:
+        list_delta_count_.ref();
+        break;
+    case ListDeltaKind::Full:
+        list_full_count_.ref();
+        break;
+    }
+    list_response_bytes_.fetchAndAddRelaxed(static_cast<quint64>(bytes));
+}
+
+quint64 ServerCatalog::getListResponseCount(ListDeltaKind kind) const
+{
+    switch (kind)
+    {
+    case ListDeltaKind::NotModified:
+        return list_not_modified_count_.loadRelaxed();
+    case ListDeltaKind::Delta:
+        return list_delta_count_.loadRelaxed();
+    case ListDeltaKind::Full:
+        return list_full_count_.loadRelaxed();
+    }
+    return 0;
+}
+
+void ServerCatalog::publish(const QList<ServerInfo> &servers)
+{
+    auto next = std::make_shared<ServerCatalogSnapshot>();
+    ServerCatalogSnapshotPtr current = snapshot();
+    next->version = (current->version != 0 ? current->version : version_base_) + 1;
+    next->servers = servers;
+    next->serverIndex = ServerIpIndex(servers);
+
+    // 每个版本只序列化一次，之后所有会话直接发送这些数据
+    next->listResponse = MessageProtocol::serializeListResponse(servers);
+    next->fullDeltaResponse = MessageProtocol::serializeListDeltaResponse(next->version, ListDeltaKind::Full, {}, servers);
+    next->notModifiedResponse = MessageProtocol::serializeListDeltaResponse(next->version, ListDeltaKind::NotModified, {}, {});
+    for (const auto &previous : std::as_const(history_))
+    {
+        QByteArray delta = buildDeltaResponse(*previous, *next);
+        if (!delta.isEmpty())
+        {
+            next->deltaResponses.insert(previous->version, delta);
+        }
+    }
+
+    history_.append(next);
+    while (history_.size() > MaxDeltaHistory)
+    {
+        history_.removeFirst();
+    }
+
+    // 读者持有的旧快照不受影响，最后一个持有者释放时回收
+    std::atomic_store(&snapshot_, ServerCatalogSnapshotPtr(std::move(next)));
+}
+
+QByteArray ServerCatalog::buildDeltaResponse(const ServerCatalogSnapshot &from, const ServerCatalogSnapshot &to)
+{
+    // 两个快照都按server_id升序，一次归并得到删除、新增和IP变化的服务器
+    QList<quint32> removedIds;
+    QList<ServerInfo> changed;
+    QList<ServerInfo>::const_iterator old = from.servers.constBegin();
+    for (const auto &server : to.servers)
+    {
+        while (old != from.servers.constEnd() && old->serverId < server.serverId)
+        {
+            removedIds.append(old->serverId);
+            ++old;
+        }
+        if (old != from.servers.constEnd() && old->serverId == server.serverId)
+        {
+            if (old->ipAddr != server.ipAddr)
+            {
+                changed.append(server);
+            }
+            ++old;
+        }
+        else
+        {
+            changed.append(server);
+        }
+    }
+    for (; old != from.servers.constEnd(); ++old)
+    {
+        removedIds.append(old->serverId);
+    }
+
+    // 增量不比完整列表小时直接发送完整列表
+    if (4 + removedIds.size() * 4 + changed.size() * 8 >= to.servers.size() * 8)
+    {
+        return QByteArray();
+    }
+
+    return MessageProtocol::serializeListDeltaResponse(to.version, ListDeltaKind::Delta, removedIds, changed);
+}
@@ -0,0 +1,308 @@
+#include "catalog/server_catalog_loader.h"
+#include "database/server_dao.h"
+#include "logger/logger.h"
+
+#include <QFile>
+#include <QHash>
+#include <QThread>
+#include <QFuture>
+#include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrent>
+#include <cstring>
+
+namespace
+{
+    // 去掉字段两端的空白（包括Windows换行的\r）
+    void trimField(const char *&begin, const char *&end)
+    {
+        while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '\r'))
+        {
+            ++begin;
+        }
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+        {
+            --end;
+        }
+    }
+
+    // 一个分块的解析结果
+    struct ChunkResult
+    {
+        QList<ServerCatalogEntry> entries;
+        ServerCatalogLoadStats stats;
+    };
+}
+
+ServerCatalogLoader::ServerCatalogLoader(int chunkSize)
+    : chunk_size_(qMax(1, chunkSize))
+{
+}
+
+bool ServerCatalogLoader::load(const QString &filePath, ServerCatalogLoadStats &stats)
+{
+    stats = ServerCatalogLoadStats();
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        Logger::instance()->error(QString("Failed to open IP result file: %1").arg(file.fileName()), "ServerCatalog");
+        return false;
+    }
+
+    QList<ServerCatalogEntry> entries = parse(file.readAll(), stats);
+    file.close();
+    stats.parseMs = timer.restart();
+
+    // 只写入与数据库不同的服务器
+    ServerDAO serverDao;
+    QList<ServerCatalogEntry> current;
+    if (!serverDao.getServerCatalog(current))
+    {
+        return false;
+    }
+
+    QHash<QString, const ServerCatalogEntry *> currentByLocation;
+    currentByLocation.reserve(current.size());
+    for (const auto &server : current)
+    {
+        currentByLocation.insert(server.location, &server);
+    }
+
+    QList<ServerCatalogEntry> changed;
+    for (const auto &entry : entries)
+    {
+        const ServerCatalogEntry *existing = currentByLocation.value(entry.location);
+        if (!existing)
+        {
+            ++stats.inserted;
+            changed.append(entry);
+        }
+        else if (existing->ipAddr != entry.ipAddr || existing->active != entry.active)
+        {
+            ++stats.updated;
+            changed.append(entry);
+        }
+        else
+        {
+            ++stats.unchanged;
+        }
+    }
+    stats.diffMs = timer.restart();
+
+    bool success = serverDao.upsertServers(changed, chunk_size_);
+    stats.applyMs = timer.elapsed();
+
+    Logger::instance()->info(QString("Server catalog %1: %2 lines, %3 parsed, %4 skipped, %5 duplicates; "
+                                     "%6 inserted, %7 updated, %8 unchanged; parse %9 ms, diff %10 ms, apply %11 ms")
+                                 .arg(success ? "loaded" : "load failed")
+                                 .arg(stats.lines)
+                                 .arg(stats.parsed)
+                                 .arg(stats.skipped)
+                                 .arg(stats.duplicates)
+                                 .arg(stats.inserted)
+                                 .arg(stats.updated)
+                                 .arg(stats.unchanged)
+                                 .arg(stats.parseMs)
+                                 .arg(stats.diffMs)
+                                 .arg(stats.applyMs),
+                             "ServerCatalog");
+    return success;
+}
+
+QList<ServerCatalogEntry> ServerCatalogLoader::parse(const QByteArray &content, ServerCatalogLoadStats &stats)
+{
+    const char *begin = content.constData();
+    const char *end = begin + content.size();
+
+    // 跳过表头
+    const char *headerEnd = static_cast<const char *>(memchr(begin, '\n', end - begin));
+    begin = headerEnd ? headerEnd + 1 : end;
+
+    // 按行边界分块，每个线程解析一块
+    int chunkCount = qBound(1, static_cast<int>((end - begin) / MinParallelChunkBytes), QThread::idealThreadCount());
+    QList<QPair<const char *, const char *>> chunks;
+    const char *chunkBegin = begin;
+    for (int i = 1; i <= chunkCount && chunkBegin < end; ++i)
+    {
+        const char *chunkEnd = i == chunkCount ? end : begin + (end - begin) * i / chunkCount;
+        if (chunkEnd < chunkBegin)
+        {
+            chunkEnd = chunkBegin;
+        }
+        const char *newline = static_cast<const char *>(memchr(chunkEnd, '\n', end - chunkEnd));
+        chunkEnd = newline ? newline + 1 : end;
+        chunks.append(qMakePair(chunkBegin, chunkEnd));
+        chunkBegin = chunkEnd;
+    }
+
+    QList<ChunkResult> results(chunks.size());
+    if (chunks.size() == 1)
+    {
+        parseLines(chunks.first().first, chunks.first().second, results[0].entries, results[0].stats);
+    }
+    else
+    {
+        QList<QFuture<void>> futures;
+        for (int i = 0; i < chunks.size(); ++i)
+        {
+            ChunkResult *result = &results[i];
+            QPair<const char *, const char *> chunk = chunks.at(i);
+            futures.append(QtConcurrent::run([chunk, result]()
+                                             { parseLines(chunk.first, chunk.second, result->entries, result->stats); }));
+        }
+        for (auto &future : futures)
+        {
+            future.waitForFinished();
+        }
+    }
+
+    // 按文件顺序合并，重复的位置用后出现的行覆盖
+    QList<ServerCatalogEntry> entries;
+    QHash<QString, int> indexByLocation;
+    for (const auto &result : results)
+    {
+        stats.lines += result.stats.lines;
+        stats.parsed += result.stats.parsed;
+        stats.skipped += result.stats.skipped;
+        entries.reserve(entries.size() + result.entries.size());
+        indexByLocation.reserve(indexByLocation.size() + result.entries.size());
+
+        for (const auto &entry : result.entries)
+        {
+            auto it = indexByLocation.constFind(entry.location);
+            if (it != indexByLocation.constEnd())
+            {
+                entries[it.value()] = entry;
+                ++stats.duplicates;
+                continue;
+            }
+            indexByLocation.insert(entry.location, entries.size());
+            entries.append(entry);
+        }
+    }
+
+    return entries;
+}
+
+void ServerCatalogLoader::parseLines(const char *begin, const char *end, QList<ServerCatalogEntry> &entries,
+                                     ServerCatalogLoadStats &stats)
+{
+    // 387, success, 185.247.184.62, 542ms, 意大利 米兰 SU区
+    while (begin < end)
+    {
+        const char *lineEnd = static_cast<const char *>(memchr(begin, '\n', end - begin));
+        if (!lineEnd)
+        {
+            lineEnd = end;
+        }
+
+        const char *lineBegin = begin;
+        begin = lineEnd + 1;
+
+        const char *trimmedBegin = lineBegin;
+        const char *trimmedEnd = lineEnd;
+        trimField(trimmedBegin, trimmedEnd);
+        if (trimmedBegin == trimmedEnd)
+        {
+            continue;
+        }
+        ++stats.lines;
+
+        // 前四个字段以逗号分隔，之后的内容都是位置描述
+        const char *fields[5];
+        const char *fieldEnds[5];
+        const char *pos = lineBegin;
+        int fieldCount = 0;
+        while (fieldCount < 4)
+        {
+            const char *comma = static_cast<const char *>(memchr(pos, ',', lineEnd - pos));
+            if (!comma)
+            {
+                break;
+            }
+            fields[fieldCount] = pos;
+            fieldEnds[fieldCount] = comma;
+            ++fieldCount;
+            pos = comma + 1;
+        }
+        if (fieldCount < 4)
+        {
+            ++stats.skipped;
+            continue;
+        }
+        fields[4] = pos;
+        fieldEnds[4] = lineEnd;
+        for (int i = 0; i < 5; ++i)
+        {
+            trimField(fields[i], fieldEnds[i]);
+        }
+
+        static const char success[] = "success";
+        const int successLength = sizeof(success) - 1;
+        ServerCatalogEntry entry;
+        if (fieldEnds[1] - fields[1] != successLength || memcmp(fields[1], success, successLength) != 0 ||
+            !parseIPv4(fields[2], fieldEnds[2], entry.ipAddr) || fields[4] == fieldEnds[4])
+        {
+            ++stats.skipped;
+            continue;
+        }
+
+        entry.location = QString::fromUtf8(fields[4], fieldEnds[4] - fields[4]);
+        if (entry.location.size() > MaxLocationLength)
+        {
+            ++stats.skipped;
+            continue;
+        }
+
+        entries.append(entry);
+        ++stats.parsed;
+    }
+}
+
+bool ServerCatalogLoader::parseIPv4(const char *begin, const char *end, quint32 &address)
+{
+    quint32 result = 0;
+    int octets = 0;
+    while (octets < 4)
+    {
+        if (begin == end || *begin < '0' || *begin > '9')
+        {
+            return false;
+        }
+
+        int value = 0;
+        int digits = 0;
+        while (begin < end && *begin >= '0' && *begin <= '9' && digits < 3)
+        {
+            value = value * 10 + (*begin - '0');
+            ++begin;
+            ++digits;
+        }
+        if (value > 255)
+        {
+            return false;
+        }
+
+        result = (result << 8) | static_cast<quint32>(value);
+        ++octets;
+
+        if (octets < 4)
+        {
+            if (begin == end || *begin != '.')
+            {
+                return false;
+            }
+            ++begin;
+        }
+    }
+
+    if (begin != end)
+    {
+        return false;
+    }
+
+    address = result;
+    return true;
+}
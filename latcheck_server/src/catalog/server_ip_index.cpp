@@ -0,0 +1,67 @@
+#include "catalog/server_ip_index.h"
+
+#include <algorithm>
+#include <utility>
+
+ServerIpIndex::ServerIpIndex()
+    : base_id_(0), direct_(false)
+{
+}
+
+ServerIpIndex::ServerIpIndex(const QList<ServerInfo> &servers)
+    : base_id_(0), direct_(false)
+{
+    // 目录快照中的服务器已按ID升序，其他来源先排序
+    QList<ServerInfo> sorted = servers;
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const ServerInfo &a, const ServerInfo &b)
+                     { return a.serverId < b.serverId; });
+
+    ids_.reserve(sorted.size());
+    ips_.reserve(sorted.size());
+    for (const auto &server : std::as_const(sorted))
+    {
+        if (!ids_.isEmpty() && ids_.last() == server.serverId)
+        {
+            ips_.last() = server.ipAddr;
+            continue;
+        }
+        ids_.append(server.serverId);
+        ips_.append(server.ipAddr);
+    }
+
+    if (ids_.isEmpty())
+    {
+        return;
+    }
+
+    quint64 spread = static_cast<quint64>(ids_.last()) - ids_.first() + 1;
+    if (spread > static_cast<quint64>(ids_.size()) * MaxDirectSpread)
+    {
+        return;
+    }
+
+    base_id_ = ids_.first();
+    slots_.fill(0, static_cast<qsizetype>(spread));
+    for (int i = 0; i < ids_.size(); ++i)
+    {
+        slots_[ids_.at(i) - base_id_] = static_cast<quint32>(i + 1);
+    }
+    direct_ = true;
+}
+
+bool ServerIpIndex::findSorted(quint32 serverId, quint32 &ipAddr) const
+{
+    auto it = std::lower_bound(ids_.constBegin(), ids_.constEnd(), serverId);
+    if (it == ids_.constEnd() || *it != serverId)
+    {
+        return false;
+    }
+    ipAddr = ips_.at(it - ids_.constBegin());
+    return true;
+}
+
+qsizetype ServerIpIndex::memoryUsage() const
+{
+    return (ids_.capacity() + ips_.capacity() + slots_.capacity()) * static_cast<qsizetype>(sizeof(quint32));
+}
@@ -0,0 +1,223 @@
+#include "common/latency_histogram.h"
+
+#include <QMutexLocker>
+#include <chrono>
+#include <cmath>
+
+void LatencyHistogram::record(qint64 valueUs)
+{
+    quint64 value = valueUs > 0 ? static_cast<quint64>(valueUs) : 0;
+    int index = bucketIndex(value);
+
+    // 单写者：读改写无需原子指令，relaxed存储保证读取方看到完整的值
+    counts_[index].storeRelaxed(counts_[index].loadRelaxed() + 1);
+    total_count_.storeRelaxed(total_count_.loadRelaxed() + 1);
+    sum_.storeRelaxed(sum_.loadRelaxed() + value);
+    if (value > max_.loadRelaxed())
+    {
+        max_.storeRelaxed(value);
+    }
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    for (int i = 0; i < BucketCount; ++i)
+    {
+        quint64 count = other.counts_[i].loadRelaxed();
+        if (count)
+        {
+            counts_[i].storeRelaxed(counts_[i].loadRelaxed() + count);
+        }
+    }
+    total_count_.storeRelaxed(total_count_.loadRelaxed() + other.total_count_.loadRelaxed());
+    sum_.storeRelaxed(sum_.loadRelaxed() + other.sum_.loadRelaxed());
+    max_.storeRelaxed(qMax(max_.loadRelaxed(), other.max_.loadRelaxed()));
+}
+
+double LatencyHistogram::mean() const
+{
+    quint64 total = count();
+    return total ? static_cast<double>(sum_.loadRelaxed()) / total : 0.0;
+}
+
+quint64 LatencyHistogram::percentile(double percent) const
+{
+    quint64 total = count();
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    // 取第ceil(p*N)个值所在的桶
+    double clamped = qBound(0.0, percent, 100.0);
+    quint64 target = qMax<quint64>(1, static_cast<quint64>(std::ceil(clamped / 100.0 * total)));
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i)
+    {
+        seen += counts_[i].loadRelaxed();
+        if (seen >= target)
+        {
+            return qMin(bucketUpperBound(i), max());
+        }
+    }
+    return max();
+}
+
+quint64 LatencyHistogram::countAtOrBelow(quint64 valueUs) const
+{
+    quint64 total = 0;
+    for (int i = 0; i < BucketCount && bucketUpperBound(i) <= valueUs; ++i)
+    {
+        total += counts_[i].loadRelaxed();
+    }
+    return total;
+}
+
+int LatencyHistogram::bucketIndex(quint64 valueUs)
+{
+    const quint64 maxValue = (quint64(1) << MaxValueBits) - 1;
+    if (valueUs > maxValue)
+    {
+        valueUs = maxValue;
+    }
+    if (valueUs < static_cast<quint64>(SubBucketCount))
+    {
+        return static_cast<int>(valueUs);
+    }
+
+    // 最高位决定所在区间，其后SubBucketBits位决定子桶
+    int msb = 63 - qCountLeadingZeroBits(valueUs);
+    int shift = msb - SubBucketBits;
+    return (shift + 1) * SubBucketCount + static_cast<int>((valueUs >> shift) - SubBucketCount);
+}
+
+quint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < SubBucketCount)
+    {
+        return static_cast<quint64>(index);
+    }
+
+    int shift = index / SubBucketCount - 1;
+    quint64 subBucket = static_cast<quint64>(index % SubBucketCount + SubBucketCount);
+    return ((subBucket + 1) << shift) - 1;
+}
+
+LatencyStats *LatencyStats::instance()
+{
+    // 每次记录耗时都会调用，局部静态变量只在首次初始化时同步，之后不加锁。
+    // 实例不销毁，进程退出前记录的耗时仍然有效
+    static LatencyStats *instance = new LatencyStats();
+    return instance;
+}
+
+qint64 LatencyStats::nowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+const char *LatencyStats::stageName(LatencyStage stage)
+{
+    switch (stage)
+    {
+    case LatencyStage::Queue:
+        return "queue";
+    case LatencyStage::Parse:
+        return "parse";
+    case LatencyStage::Database:
+        return "db";
+    case LatencyStage::Serialize:
+        return "serialize";
+    case LatencyStage::Write:
+        return "write";
+    case LatencyStage::Total:
+        return "total";
+    default:
+        return "unknown";
+    }
+}
+
+LatencyStats::Shard *LatencyStats::localShard()
+{
+    thread_local Shard *shard = nullptr;
+    if (!shard)
+    {
+        shard = new Shard();
+        QMutexLocker locker(&shards_mutex_);
+        shards_.push_back(shard);
+    }
+    return shard;
+}
+
+void LatencyStats::record(quint32 msgType, LatencyStage stage, qint64 elapsedUs)
+{
+    int typeIndex = msgType < static_cast<quint32>(MaxMessageTypes) ? static_cast<int>(msgType) : 0;
+    int stageIndex = static_cast<int>(stage);
+    if (stageIndex < 0 || stageIndex >= StageCount)
+    {
+        return;
+    }
+
+    std::atomic<LatencyHistogram *> &slot = localShard()->histograms[typeIndex][stageIndex];
+    LatencyHistogram *histogram = slot.load(std::memory_order_relaxed);
+    if (!histogram)
+    {
+        // 首次使用时分配，发布后其他线程才能读取
+        histogram = new LatencyHistogram();
+        slot.store(histogram, std::memory_order_release);
+    }
+    histogram->record(elapsedUs);
+}
+
+void LatencyStats::merged(quint32 msgType, LatencyStage stage, LatencyHistogram &result) const
+{
+    int typeIndex = msgType < static_cast<quint32>(MaxMessageTypes) ? static_cast<int>(msgType) : 0;
+    int stageIndex = static_cast<int>(stage);
+    if (stageIndex < 0 || stageIndex >= StageCount)
+    {
+        return;
+    }
+
+    QMutexLocker locker(&shards_mutex_);
+    for (const Shard *shard : shards_)
+    {
+        const LatencyHistogram *histogram = shard->histograms[typeIndex][stageIndex].load(std::memory_order_acquire);
+        if (histogram)
+        {
+            result.merge(*histogram);
+        }
+    }
+}
+
+QString LatencyStats::report(TypeNameFunc typeName) const
+{
+    QString text;
+    for (int type = 0; type < MaxMessageTypes; ++type)
+    {
+        for (int stage = 0; stage < StageCount; ++stage)
+        {
+            LatencyHistogram histogram;
+            merged(static_cast<quint32>(type), static_cast<LatencyStage>(stage), histogram);
+            if (histogram.count() == 0)
+            {
+                continue;
+            }
+
+            QString name = typeName ? QString::fromLatin1(typeName(static_cast<quint32>(type)))
+                                    : QString("0x%1").arg(type, 4, 16, QChar('0'));
+            text += QString("%1 %2: count=%3 mean=%4us p50=%5us p90=%6us p99=%7us p999=%8us max=%9us\n")
+                        .arg(name)
+                        .arg(stageName(static_cast<LatencyStage>(stage)))
+                        .arg(histogram.count())
+                        .arg(histogram.mean(), 0, 'f', 1)
+                        .arg(histogram.percentile(50.0))
+                        .arg(histogram.percentile(90.0))
+                        .arg(histogram.percentile(99.0))
+                        .arg(histogram.percentile(99.9))
+                        .arg(histogram.max());
+        }
+    }
+    return text;
+}
@@ -0,0 +1,93 @@
+#include "common/worker_thread.h"
+#include "database/database_pool.h"
+
+#include <QMutexLocker>
+#include <QDeadlineTimer>
+
+ThreadWorker::ThreadWorker(QObject *parent)
+    : QObject(parent)
+{
+}
+
+ThreadWorker::~ThreadWorker()
+{
+}
+
+WorkerThread::~WorkerThread()
+{
+    stop();
+}
+
+void WorkerThread::start(const QString &name, ThreadWorker *worker, bool waitStarted)
+{
+    if (isRunning())
+    {
+        delete worker;
+        return;
+    }
+
+    thread_ = new QThread();
+    thread_->setObjectName(name);
+
+    worker_ = worker;
+    worker_->moveToThread(thread_);
+    if (!waitStarted)
+    {
+        QObject::connect(thread_, &QThread::started, worker_, &ThreadWorker::start);
+    }
+    thread_->start();
+
+    if (waitStarted)
+    {
+        QMetaObject::invokeMethod(worker_, &ThreadWorker::start, Qt::BlockingQueuedConnection);
+    }
+}
+
+void WorkerThread::stop()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+
+    ThreadWorker *worker = worker_;
+    QMetaObject::invokeMethod(
+        worker,
+        [worker]()
+        {
+            worker->stop();
+            DatabasePool::instance()->releaseThreadConnections();
+        },
+        Qt::BlockingQueuedConnection);
+    thread_->quit();
+    thread_->wait();
+
+    delete worker_;
+    delete thread_;
+    worker_ = nullptr;
+    thread_ = nullptr;
+}
+
+void PendingCounter::finish(int n)
+{
+    if (count_.fetchAndSubOrdered(n) == n)
+    {
+        // 等待方在持有mutex_时检查计数，加锁后再唤醒避免丢失通知
+        QMutexLocker locker(&mutex_);
+        idle_.wakeAll();
+    }
+}
+
+bool PendingCounter::waitForZero(int timeoutMs)
+{
+    QDeadlineTimer deadline(timeoutMs);
+    QMutexLocker locker(&mutex_);
+    while (count_.loadAcquire() > 0)
+    {
+        if (!idle_.wait(&mutex_, deadline))
+        {
+            return count_.loadAcquire() == 0;
+        }
+    }
+    return true;
+}
@@ -135,7 +135,7 @@ QString ConfigManager::getPrivateKeyPath() const
 QString ConfigManager::getApiHost() const
 {
     QJsonObject apiConfig = getConfigSection("api");
-    return apiConfig.value("host").toString("0.0.0.0");
+    return apiConfig.value("host").toString("127.0.0.1");
 }
 
 int ConfigManager::getApiPort() const
@@ -196,6 +196,18 @@ LogConfig ConfigManager::getLogConfig() const
     return config;
 }
 
+MetricsConfig ConfigManager::getMetricsConfig() const
+{
+    MetricsConfig config;
+    QJsonObject metricsConfig = getConfigSection("metrics");
+
+    config.enabled = metricsConfig.value("enabled").toBool(true);
+    config.host = metricsConfig.value("host").toString("127.0.0.1");
+    config.port = metricsConfig.value("port").toInt(9100);
+
+    return config;
+}
+
 // Fix the TlsConfig method to match the actual struct definition
 TlsConfig ConfigManager::getTlsConfig() const
 {
@@ -224,6 +236,9 @@ DatabaseConfig ConfigManager::getDatabaseConfig() const
     DatabaseConfig config;
     QJsonObject dbConfig = getConfigSection("database");
 
+    config.backend = dbConfig.value("backend").toString("mysql");
+    config.sqlitePath = dbConfig.value("sqlite_path").toString("data/latcheck.db");
+    config.sqliteSchema = dbConfig.value("sqlite_schema").toString("database/create_database_sqlite.sql");
     config.host = dbConfig.value("host").toString("localhost");
     config.port = dbConfig.value("port").toInt(3306);
     config.database = dbConfig.value("database").toString("latcheck");
@@ -233,6 +248,14 @@ DatabaseConfig ConfigManager::getDatabaseConfig() const
     config.maxConnections = dbConfig.value("max_connections").toInt(10);
     config.connectionTimeout = dbConfig.value("connection_timeout").toInt(30);
     config.idleTimeout = dbConfig.value("idle_timeout").toInt(300);
+    config.validateAfterIdleMs = dbConfig.value("validate_after_idle_ms").toInt(30000);
+    config.workerThreads = dbConfig.value("worker_threads").toInt(4);
+    config.insertChunkSize = dbConfig.value("insert_chunk_size").toInt(500);
+    config.recordStorage = dbConfig.value("record_storage").toString("rows").trimmed().toLower();
+    config.statementCacheSize = dbConfig.value("statement_cache_size").toInt(64);
+    config.groupCommitMaxReports = dbConfig.value("group_commit_max_reports").toInt(64);
+    config.groupCommitMaxDelayMs = dbConfig.value("group_commit_max_delay_ms").toInt(20);
+    config.calculateLatencies = dbConfig.value("calculate_latencies").toBool(true);
     config.charset = dbConfig.value("charset").toString("utf8mb4");
     config.enableSSL = dbConfig.value("enable_ssl").toBool(false);
     config.sslCert = dbConfig.value("ssl_cert").toString("");
@@ -251,6 +274,21 @@ ServerConfig ConfigManager::getServerConfig() const
     config.port = serverConfig.value("port").toInt(8443);
     config.maxConnections = serverConfig.value("max_connections").toInt(1000);
     config.connectionTimeout = serverConfig.value("connection_timeout").toInt(300);
+    config.authTimeout = serverConfig.value("auth_timeout").toInt(10);
+    config.workerThreads = serverConfig.value("worker_threads").toInt(0);
+    config.sessionBufferLimit = serverConfig.value("session_buffer_limit").toInt(65536);
+    config.tlsSessionResumption = serverConfig.value("tls_session_resumption").toBool(true);
+    config.tlsSessionTickets = serverConfig.value("tls_session_tickets").toBool(true);
+    config.tlsSessionCacheSize = serverConfig.value("tls_session_cache_size").toInt(20480);
+    config.tlsSessionTimeout = serverConfig.value("tls_session_timeout").toInt(7200);
+    config.tlsTicketRotationInterval = serverConfig.value("tls_ticket_rotation_interval").toInt(3600);
+    config.perIpConnectRate = serverConfig.value("per_ip_connect_rate").toDouble(10.0);
+    config.perIpConnectBurst = serverConfig.value("per_ip_connect_burst").toInt(20);
+    config.maxPendingHandshakes = serverConfig.value("max_pending_handshakes").toInt(256);
+    config.acceptQueueHighWatermark = serverConfig.value("accept_queue_high_watermark").toInt(512);
+    config.admissionIpTableSize = serverConfig.value("admission_ip_table_size").toInt(4096);
+    config.serverListFile = serverConfig.value("server_list_file").toString("config/ip_result.txt");
+    config.serverCatalogPollInterval = serverConfig.value("server_catalog_poll_interval").toInt(30);
     config.enableSSL = serverConfig.value("enable_ssl").toBool(true);
     config.certificatePath = serverConfig.value("certificate").toString("config/certs/server.crt");
     config.privateKeyPath = serverConfig.value("private_key").toString("config/certs/server.key");
@@ -264,13 +302,19 @@ ApiConfig ConfigManager::getApiConfig() const
     ApiConfig config;
     QJsonObject apiConfig = getConfigSection("api");
 
-    config.host = apiConfig.value("host").toString("0.0.0.0");
+    config.enabled = apiConfig.value("enabled").toBool(false);
+    config.host = apiConfig.value("host").toString("127.0.0.1");
     config.port = apiConfig.value("port").toInt(8080);
     config.enableSSL = apiConfig.value("enable_ssl").toBool(false);
     config.certificatePath = apiConfig.value("certificate").toString("");
     config.privateKeyPath = apiConfig.value("private_key").toString("");
     config.enableCORS = apiConfig.value("enable_cors").toBool(true);
     config.logLevel = apiConfig.value("log_level").toString("INFO");
+    config.keepAliveTimeout = apiConfig.value("keep_alive_timeout").toInt(30);
+    config.maxPipelinedRequests = apiConfig.value("max_pipelined_requests").toInt(16);
+    config.maxConnections = apiConfig.value("max_connections").toInt(1000);
+    config.reportCacheEntries = apiConfig.value("report_cache_entries").toInt(4096);
+    config.tokenTtl = apiConfig.value("token_ttl").toInt(86400);
 
     // Handle allowed origins array
     QJsonArray originsArray = apiConfig.value("allowed_origins").toArray();
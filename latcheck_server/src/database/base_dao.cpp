@@ -25,7 +25,87 @@ BaseDAO::~BaseDAO()
     }
 }
 
-QSqlQuery BaseDAO::executeQuery(const QString &sql, const QVariantList &params)
+QueryResult::QueryResult(DatabasePool *pool, const QSqlDatabase &db, bool releaseConnection)
+    : pool_(pool), db_(db), own_query_(db), query_(&own_query_), release_(releaseConnection)
+{
+}
+
+QueryResult::QueryResult(QueryResult &&other) noexcept
+    : pool_(other.pool_),
+      db_(other.db_),
+      own_query_(std::move(other.own_query_)),
+      query_(other.query_ == &other.own_query_ ? &own_query_ : other.query_),
+      release_(other.release_)
+{
+    other.query_ = &other.own_query_;
+    other.release_ = false;
+}
+
+QueryResult::~QueryResult()
+{
+    finish();
+}
+
+void QueryResult::finish()
+{
+    // 缓存中的语句还会被复用，先结束结果集，驱动释放游标和尚未读取的行
+    if (query_ != &own_query_)
+    {
+        query_->finish();
+        query_ = &own_query_;
+    }
+    own_query_.finish();
+    if (release_)
+    {
+        release_ = false;
+        pool_->releaseConnection(db_);
+    }
+}
+
+QueryResult BaseDAO::executeQuery(const QString &sql, const QVariantList &params)
+{
+    // 如果在事务中，使用事务连接；事务中的连接不在这里释放，而是在事务结束时统一释放
+    bool inTransaction = in_transaction_ && transaction_connection_.isValid();
+    QueryResult result(pool_, inTransaction ? transaction_connection_ : pool_->getConnection(), !inTransaction);
+
+    if (!result.db_.isValid())
+    {
+        Logger::instance()->error("Database connection is not available");
+        return result; // 返回无效查询对象
+    }
+
+    // 事务中调用方可能在读完结果前执行其他语句，相同的SQL会覆盖结果集，缓存淘汰会销毁语句，
+    // 因此事务中的查询使用独立的语句对象
+    QSqlQuery *statement = inTransaction ? nullptr : cachedStatement(result.db_, sql);
+    if (statement)
+    {
+        result.query_ = statement;
+    }
+    else
+    {
+        // 缓存prepare失败时（已记录日志）重新prepare，错误保存在返回的查询对象中
+        result.own_query_.setForwardOnly(true);
+        if (!result.own_query_.prepare(sql))
+        {
+            if (inTransaction)
+            {
+                Logger::instance()->error(QString("Prepare failed: %1 - %2").arg(sql).arg(result.own_query_.lastError().text()));
+            }
+            markStatementsStale(result.db_, result.own_query_);
+            return result;
+        }
+    }
+
+    bindParameters(*result.query_, params);
+    if (!executeStatement(result.db_, *result.query_))
+    {
+        Logger::instance()->error(QString("Query failed: %1 - %2").arg(sql).arg(result.query_->lastError().text()));
+    }
+
+    return result;
+}
+
+bool BaseDAO::executeUpdate(const QString &sql, const QVariantList &params)
 {
     QSqlDatabase db;
 
@@ -39,25 +119,29 @@ QSqlQuery BaseDAO::executeQuery(const QString &sql, const QVariantList &params)
         db = pool_->getConnection();
     }
 
-    QSqlQuery query(db);
-
     if (!db.isValid())
     {
         Logger::instance()->error("Database connection is not available");
-        return query; // 返回无效查询对象
-    }
-
-    query.prepare(sql);
-
-    for (const auto &param : params)
-    {
-        query.addBindValue(param);
+        return false;
     }
 
-    bool success = query.exec();
-    if (!success)
+    bool success = false;
+    QSqlQuery *statement = cachedStatement(db, sql);
+    if (statement)
     {
-        Logger::instance()->error(QString("Query failed: %1 - %2").arg(sql).arg(query.lastError().text()));
+        bindParameters(*statement, params);
+        success = executeStatement(db, *statement);
+        if (success)
+        {
+            Logger::instance()->debug(QString("Update executed successfully: %1, affected rows: %2")
+                                          .arg(sql)
+                                          .arg(statement->numRowsAffected()),
+                                      "DAO");
+        }
+        else
+        {
+            logSqlError(*statement, "Update");
+        }
     }
 
     // 事务中的连接不在这里释放，而是在事务结束时统一释放
@@ -66,11 +150,17 @@ QSqlQuery BaseDAO::executeQuery(const QString &sql, const QVariantList &params)
         pool_->releaseConnection(db);
     }
 
-    return query; // 返回查询对象
+    return success;
 }
 
-bool BaseDAO::executeUpdate(const QString &sql, const QVariantList &params)
+int BaseDAO::executeBatchInsert(const QString &table, const QStringList &columns,
+                                const QList<QVariantList> &rows, int chunkSize, const QString &suffix)
 {
+    if (columns.isEmpty() || rows.isEmpty())
+    {
+        return 0;
+    }
+
     QSqlDatabase db;
 
     // 如果在事务中，使用事务连接
@@ -86,24 +176,91 @@ bool BaseDAO::executeUpdate(const QString &sql, const QVariantList &params)
     if (!db.isValid())
     {
         Logger::instance()->error("Database connection is not available");
-        return false;
+        return -1;
     }
 
-    QSqlQuery query(db);
-    query.prepare(sql);
+    // 单条语句的占位符数量不能超过后端的预处理语句限制
+    const int columnCount = columns.size();
+    chunkSize = qBound(1, chunkSize, dialect().maxBindParameters() / columnCount);
+
+    QString rowPlaceholder = "(" + QStringList(columnCount, "?").join(", ") + ")";
+    QString prefix = QString("INSERT INTO %1 (%2) VALUES ").arg(table, columns.join(", "));
 
-    for (const auto &param : params)
+    auto buildSql = [&](int rowCount)
     {
-        query.addBindValue(param);
-    }
+        QString sql;
+        sql.reserve(prefix.size() + rowCount * (rowPlaceholder.size() + 2) + suffix.size() + 1);
+        sql += prefix;
+        for (int i = 0; i < rowCount; ++i)
+        {
+            if (i > 0)
+            {
+                sql += ", ";
+            }
+            sql += rowPlaceholder;
+        }
+        if (!suffix.isEmpty())
+        {
+            sql += ' ';
+            sql += suffix;
+        }
+        return sql;
+    };
 
-    bool success = query.exec();
-    if (success)
+    QSqlQuery *query = nullptr;
+    QSqlQuery tailQuery;
+    int preparedRows = 0;
+    int statements = 0;
+    bool success = true;
+
+    for (int offset = 0; offset < rows.size(); offset += chunkSize)
     {
-        Logger::instance()->debug(QString("Update executed successfully: %1, affected rows: %2")
-                                      .arg(sql)
-                                      .arg(query.numRowsAffected()),
-                                  "DAO");
+        int rowCount = qMin(chunkSize, static_cast<int>(rows.size()) - offset);
+
+        if (rowCount != preparedRows)
+        {
+            if (rowCount == chunkSize)
+            {
+                // 完整分块使用同一条语句，从连接的语句缓存中获取，跨调用复用
+                query = cachedStatement(db, buildSql(rowCount));
+            }
+            else
+            {
+                // 最后一个分块的行数每次不同，不放入缓存，避免挤掉常用的语句
+                tailQuery = QSqlQuery(db);
+                query = &tailQuery;
+                if (!tailQuery.prepare(buildSql(rowCount)))
+                {
+                    logSqlError(tailQuery, "Batch insert prepare");
+                    markStatementsStale(db, tailQuery);
+                    query = nullptr;
+                }
+            }
+            if (!query)
+            {
+                success = false;
+                break;
+            }
+            preparedRows = rowCount;
+        }
+
+        int position = 0;
+        for (int row = offset; row < offset + rowCount; ++row)
+        {
+            const QVariantList &values = rows.at(row);
+            for (int column = 0; column < columnCount; ++column)
+            {
+                query->bindValue(position++, column < values.size() ? values.at(column) : QVariant());
+            }
+        }
+
+        if (!executeStatement(db, *query))
+        {
+            logSqlError(*query, "Batch insert");
+            success = false;
+            break;
+        }
+        ++statements;
     }
 
     // 事务中的连接不在这里释放，而是在事务结束时统一释放
@@ -112,7 +269,7 @@ bool BaseDAO::executeUpdate(const QString &sql, const QVariantList &params)
         pool_->releaseConnection(db);
     }
 
-    return success;
+    return success ? statements : -1;
 }
 
 bool BaseDAO::beginTransaction()
@@ -216,6 +373,39 @@ bool BaseDAO::rollbackTransaction()
     }
 }
 
+bool BaseDAO::createSavepoint(const QString &name)
+{
+    return executeSavepointCommand("SAVEPOINT " + name);
+}
+
+bool BaseDAO::rollbackToSavepoint(const QString &name)
+{
+    return executeSavepointCommand("ROLLBACK TO SAVEPOINT " + name);
+}
+
+bool BaseDAO::releaseSavepoint(const QString &name)
+{
+    return executeSavepointCommand("RELEASE SAVEPOINT " + name);
+}
+
+bool BaseDAO::executeSavepointCommand(const QString &sql)
+{
+    if (!in_transaction_ || !transaction_connection_.isValid())
+    {
+        Logger::instance()->warning(QString("Savepoint command outside transaction: %1").arg(sql));
+        return false;
+    }
+
+    // 保存点语句不支持预处理，直接执行
+    QSqlQuery query(transaction_connection_);
+    if (!query.exec(sql))
+    {
+        logSqlError(query, "Savepoint command");
+        return false;
+    }
+    return true;
+}
+
 qint64 BaseDAO::getLastInsertId()
 {
     QSqlDatabase db;
@@ -240,7 +430,7 @@ qint64 BaseDAO::getLastInsertId()
         return -1;
     }
 
-    QSqlQuery query("SELECT LAST_INSERT_ID()", db);
+    QSqlQuery query(dialect().lastInsertIdQuery(), db);
     qint64 result = -1;
     if (query.next())
     {
@@ -255,6 +445,41 @@ qint64 BaseDAO::getLastInsertId()
     return result;
 }
 
+QSqlQuery *BaseDAO::cachedStatement(const QSqlDatabase &db, const QString &sql)
+{
+    StatementCache *cache = pool_->statementCache(db);
+    if (!cache)
+    {
+        Logger::instance()->error("Database connection is not available");
+        return nullptr;
+    }
+    return cache->acquire(sql);
+}
+
+bool BaseDAO::executeStatement(const QSqlDatabase &db, QSqlQuery &query)
+{
+    if (query.exec())
+    {
+        return true;
+    }
+
+    markStatementsStale(db, query);
+    return false;
+}
+
+void BaseDAO::markStatementsStale(const QSqlDatabase &db, const QSqlQuery &query)
+{
+    // 连接断开后服务端的语句句柄全部失效，下次使用时重新prepare
+    if (query.lastError().type() == QSqlError::ConnectionError)
+    {
+        StatementCache *cache = pool_->statementCache(db);
+        if (cache)
+        {
+            cache->markStale();
+        }
+    }
+}
+
 void BaseDAO::bindParameters(QSqlQuery &query, const QVariantList &params)
 {
     for (int i = 0; i < params.size(); ++i)
@@ -287,7 +512,14 @@ QVariant BaseDAO::toDatabaseTimestamp(const QDateTime &dateTime)
     {
         return QVariant();
     }
-    return dateTime;
+    // 两种后端的时间列都只保存到秒，写入和比较使用同一个值：
+    // MySQL会对小数秒四舍五入，SQLite按文本比较，格式需要与datetime()一致
+    QDateTime seconds = dateTime.addMSecs(-dateTime.time().msec());
+    if (dialect().isSQLite())
+    {
+        return seconds.toString("yyyy-MM-dd HH:mm:ss");
+    }
+    return seconds;
 }
 
 bool BaseDAO::validateParameters(const QVariantList &params, int expectedCount)
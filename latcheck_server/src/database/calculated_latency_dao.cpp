@@ -0,0 +1,121 @@
+#include "database/calculated_latency_dao.h"
+#include "logger/logger.h"
+#include "config/config_manager.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+
+CalculatedLatencyDAO::CalculatedLatencyDAO(QObject *parent)
+    : BaseDAO(parent),
+      insert_chunk_size_(ConfigManager::instance()->getDatabaseConfig().insertChunkSize)
+{
+}
+
+bool CalculatedLatencyDAO::replacePairs(qint64 replacedReportId, const QList<LocationPairLatency> &pairs)
+{
+    if (replacedReportId <= 0 && pairs.isEmpty())
+    {
+        return true;
+    }
+
+    if (!beginTransaction())
+    {
+        return false;
+    }
+
+    bool ok = true;
+    if (replacedReportId > 0)
+    {
+        ok = executeUpdate("DELETE FROM calculated_latencies WHERE report1 = ? OR report2 = ?",
+                           {replacedReportId, replacedReportId});
+    }
+
+    if (ok && !pairs.isEmpty())
+    {
+        QList<QVariantList> rows;
+        rows.reserve(pairs.size());
+        for (const auto &pair : pairs)
+        {
+            rows.append({pair.report1, pair.report2, pair.latency, pair.serverId});
+        }
+
+        ok = executeBatchInsert("calculated_latencies", {"report1", "report2", "latency", "server_id"},
+                                rows, insert_chunk_size_) >= 0;
+    }
+
+    if (!ok || !commitTransaction())
+    {
+        Logger::instance()->error(QString("Failed to replace %1 location pairs (replaced report %2)")
+                                      .arg(pairs.size())
+                                      .arg(replacedReportId),
+                                  "CalculatedLatencyDAO");
+        rollbackTransaction();
+        return false;
+    }
+
+    return true;
+}
+
+int CalculatedLatencyDAO::deleteStalePairs()
+{
+    QueryResult query = executeQuery(
+        "DELETE FROM calculated_latencies "
+        "WHERE report1 NOT IN (SELECT MAX(report_id) FROM latcheck_report GROUP BY check_location) "
+        "OR report2 NOT IN (SELECT MAX(report_id) FROM latcheck_report GROUP BY check_location)");
+
+    if (query.lastError().type() != QSqlError::NoError)
+    {
+        Logger::instance()->error(QString("Failed to delete stale location pairs: %1").arg(query.lastError().text()),
+                                  "CalculatedLatencyDAO");
+        return -1;
+    }
+
+    return query.numRowsAffected();
+}
+
+QSet<qint64> CalculatedLatencyDAO::getReportsWithPairs()
+{
+    QSet<qint64> reportIds;
+
+    QueryResult query = executeQuery(
+        "SELECT report1 FROM calculated_latencies UNION SELECT report2 FROM calculated_latencies");
+
+    while (query.next())
+    {
+        reportIds.insert(query.value(0).toLongLong());
+    }
+
+    return reportIds;
+}
+
+QList<LocationPairLatency> CalculatedLatencyDAO::getAllPairs()
+{
+    QList<LocationPairLatency> pairs;
+
+    QueryResult query = executeQuery("SELECT report1, report2, latency, server_id FROM calculated_latencies");
+
+    while (query.next())
+    {
+        LocationPairLatency pair;
+        pair.report1 = query.value(0).toLongLong();
+        pair.report2 = query.value(1).toLongLong();
+        pair.latency = query.value(2).toInt();
+        pair.serverId = query.value(3).toUInt();
+        pairs.append(pair);
+    }
+
+    return pairs;
+}
+
+int CalculatedLatencyDAO::getPairCount()
+{
+    QueryResult query = executeQuery("SELECT COUNT(*) FROM calculated_latencies");
+
+    if (query.next())
+    {
+        return query.value(0).toInt();
+    }
+
+    return 0;
+}
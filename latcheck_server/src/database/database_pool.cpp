@@ -6,13 +6,34 @@
 #include <QThread>
 #include <QCoreApplication>
 #include <QMutexLocker>
-#include <QUuid>
+#include <QDeadlineTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QTextStream>
+#include <algorithm>
+#include <memory>
+#include <utility>
 
 DatabasePool *DatabasePool::instance_ = nullptr;
 QMutex DatabasePool::mutex_;
 
+namespace
+{
+    // 本线程连接的预处理语句缓存，以连接名为键。连接只在创建它的线程中使用，
+    // 缓存也按线程保存，执行语句时查找缓存不需要连接池的锁
+    struct ThreadStatementCaches
+    {
+        QHash<QString, StatementCache *> caches;
+
+        ~ThreadStatementCaches() { qDeleteAll(caches); }
+    };
+
+    thread_local ThreadStatementCaches threadStatementCaches;
+}
+
 DatabasePool::DatabasePool(QObject *parent)
-    : QObject(parent), active_connections_(0), connection_counter_(0), initialized_(false), min_connections_(5), max_connections_(20), connection_timeout_(30000), idle_timeout_(300)
+    : QObject(parent), active_connections_(0), idle_connections_(0), open_connections_(0), connection_counter_(0), initialized_(false), min_connections_(5), max_connections_(20), connection_timeout_(30000), idle_timeout_(300), validate_after_idle_(30000), statement_cache_size_(64)
 {
     health_check_timer_ = new QTimer(this);
     connect(health_check_timer_, &QTimer::timeout, this, &DatabasePool::checkConnections);
@@ -48,76 +69,167 @@ bool DatabasePool::initialize(const DatabaseConfig &config)
 
     config_ = config;
     min_connections_ = config.minConnections;
-    max_connections_ = config.maxConnections;
-    connection_timeout_ = config.connectionTimeout;
+    max_connections_ = qMax(1, config.maxConnections);
+    connection_timeout_ = config.connectionTimeout * 1000;
     idle_timeout_ = config.idleTimeout;
+    validate_after_idle_ = config.validateAfterIdleMs;
+    statement_cache_size_ = config.statementCacheSize;
 
-    // 创建初始连接
-    for (int i = 0; i < min_connections_; ++i)
+    bool backendOk = false;
+    dialect_ = SqlDialect(SqlDialect::parseBackend(config.backend, &backendOk));
+    if (!backendOk)
     {
-        QSqlDatabase db = createConnection();
-        if (!db.isValid())
-        {
-            Logger::instance()->error(QString("Failed to create initial connection %1").arg(i));
-            return false;
-        }
-        idle_connections_.enqueue(db);
+        Logger::instance()->error(QString("Unknown database backend: %1").arg(config.backend));
+        return false;
+    }
+
+    if (dialect_.isSQLite() && !QFileInfo(config.sqlitePath).absoluteDir().mkpath("."))
+    {
+        Logger::instance()->error(QString("Failed to create directory for SQLite database: %1").arg(config.sqlitePath));
+        return false;
+    }
+
+    // 连接与线程绑定，预先为其他线程创建的连接无法使用，
+    // 这里只创建一个连接验证配置，留给初始化线程使用
+    QSqlDatabase db = createConnection(nextConnectionName());
+    if (!db.isValid())
+    {
+        Logger::instance()->error("Failed to create initial connection");
+        return false;
     }
+    if (dialect_.isSQLite() && !initializeSqliteSchema(db))
+    {
+        discardConnections({std::exchange(db, QSqlDatabase())});
+        return false;
+    }
+    threads_[QThread::currentThread()].idle.append(IdleConnection{db, nowMs()});
+    idle_connections_ = 1;
+    open_connections_ = 1;
 
     initialized_ = true;
-    Logger::instance()->info(QString("Database pool initialized with %1 connections").arg(idle_connections_.size()));
+    Logger::instance()->info(QString("Database pool initialized (backend %1, max %2 connections, validate after %3 ms idle)")
+                                 .arg(SqlDialect::backendName(dialect_.backend()))
+                                 .arg(max_connections_)
+                                 .arg(validate_after_idle_));
     return true;
 }
 
-QSqlDatabase DatabasePool::getConnection()
+int DatabasePool::getActiveConnections() const
 {
     QMutexLocker locker(&connection_mutex_);
+    return active_connections_;
+}
 
-    if (!initialized_)
-    {
-        Logger::instance()->error("Database pool not initialized");
-        return QSqlDatabase();
-    }
+int DatabasePool::getIdleConnections() const
+{
+    QMutexLocker locker(&connection_mutex_);
+    return idle_connections_;
+}
+
+int DatabasePool::getTotalConnections() const
+{
+    QMutexLocker locker(&connection_mutex_);
+    return open_connections_;
+}
+
+int DatabasePool::getWaitingRequests() const
+{
+    QMutexLocker locker(&connection_mutex_);
+    return static_cast<int>(waiters_.size());
+}
+
+QSqlDatabase DatabasePool::getConnection()
+{
+    qint64 requestUs = LatencyStats::nowUs();
+    QThread *thread = QThread::currentThread();
+    IdleConnection slot;
+    QList<QSqlDatabase> expired;
+    QString connectionName;
 
-    // 等待可用连接，最多等待connectionTimeout毫秒
-    if (idle_connections_.isEmpty() && active_connections_ >= max_connections_)
     {
-        bool hasConnection = connection_condition_.wait(&connection_mutex_, connection_timeout_);
-        if (!hasConnection)
+        QMutexLocker locker(&connection_mutex_);
+
+        if (!initialized_)
         {
-            Logger::instance()->error("Connection timeout: no available connections");
+            Logger::instance()->error("Database pool not initialized");
             return QSqlDatabase();
         }
+
+        // 先处理本线程待关闭的连接，释放的名额分给排队的请求
+        expired = takeExpired(thread);
+        grantWaiters();
+        ensurePurgeTimer(threads_[thread]);
+
+        // 已有请求排队时不插队，按先来先服务顺序等待
+        if (!waiters_.empty() || !takeSlot(thread, slot))
+        {
+            Waiter waiter;
+            waiter.thread = thread;
+            waiters_.push_back(&waiter);
+
+            QDeadlineTimer deadline(connection_timeout_);
+            while (!waiter.granted)
+            {
+                if (!waiter.condition.wait(&connection_mutex_, deadline) && !waiter.granted)
+                {
+                    waiters_.erase(std::find(waiters_.begin(), waiters_.end(), &waiter));
+                    acquire_timeouts_.ref();
+                    acquire_wait_histogram_.record(LatencyStats::nowUs() - requestUs);
+                    Logger::instance()->error("Connection timeout: no available connections");
+
+                    locker.unlock();
+                    discardConnections(std::move(expired));
+                    return QSqlDatabase();
+                }
+            }
+            slot = waiter.connection;
+        }
+
+        // 包含等待锁和等待空闲连接的时间
+        acquire_wait_histogram_.record(LatencyStats::nowUs() - requestUs);
+
+        if (!slot.db.isValid())
+        {
+            connectionName = nextConnectionName();
+        }
     }
 
-    QSqlDatabase db;
+    discardConnections(std::move(expired));
 
-    if (!idle_connections_.isEmpty())
+    // 只有空闲较久的连接才验证，刚归还的连接直接使用
+    if (slot.db.isValid() && validate_after_idle_ >= 0 && nowMs() - slot.idleSinceMs >= validate_after_idle_)
     {
-        // 从空闲连接池获取连接
-        db = idle_connections_.dequeue();
-
-        // 验证连接是否有效
-        if (!isConnectionValid(db))
+        validations_.ref();
+        if (!isConnectionValid(slot.db))
         {
+            validation_failures_.ref();
             Logger::instance()->warning("Invalid connection found, creating new one");
-            db = createConnection();
+            {
+                QMutexLocker locker(&connection_mutex_);
+                dropStatementCache(slot.db);
+                connectionName = nextConnectionName();
+            }
+            discardConnections({std::exchange(slot.db, QSqlDatabase())});
         }
     }
-    else if (active_connections_ < max_connections_)
+
+    if (slot.db.isValid())
     {
-        // 创建新连接
-        db = createConnection();
+        return slot.db;
     }
 
-    if (db.isValid() && db.isOpen())
+    // 已占用名额，在锁外创建新连接
+    QSqlDatabase db = createConnection(connectionName);
+    if (!db.isValid())
     {
-        active_connections_++;
-        Logger::instance()->debug(QString("Connection acquired, active: %1, idle: %2")
-                                      .arg(active_connections_)
-                                      .arg(idle_connections_.size()));
+        QMutexLocker locker(&connection_mutex_);
+        active_connections_--;
+        open_connections_--;
+        grantWaiters();
+        return QSqlDatabase();
     }
 
+    Logger::instance()->debug(QString("Connection acquired, total: %1").arg(getTotalConnections()));
     return db;
 }
 
@@ -135,53 +247,103 @@ void DatabasePool::releaseConnection(QSqlDatabase &db)
         active_connections_--;
     }
 
-    // 验证连接是否仍然有效
-    if (isConnectionValid(db))
+    // 归还时不验证，借出时按空闲时间决定是否验证
+    ThreadConnections &connections = threads_[QThread::currentThread()];
+    if (db.isOpen())
     {
-        // 如果空闲连接数超过最小连接数，关闭多余连接
-        if (idle_connections_.size() >= min_connections_)
-        {
-            db.close();
-            Logger::instance()->debug("Connection closed (exceeds minimum pool size)");
-        }
-        else
-        {
-            Logger::instance()->debug(QString("Connection released, active: %1, idle: %2")
-                                          .arg(active_connections_)
-                                          .arg(idle_connections_.size()));
-        }
+        connections.idle.append(IdleConnection{db, nowMs()});
+        idle_connections_++;
     }
     else
     {
+        // 调用方仍持有该连接，留到本线程下次获取连接时关闭
+        connections.retired.append(db);
+        open_connections_--;
         Logger::instance()->warning("Invalid connection closed");
     }
 
     // 通知等待连接的线程
-    connection_condition_.wakeOne();
+    grantWaiters();
 }
 
-void DatabasePool::close()
+void DatabasePool::releaseThreadConnections()
 {
-    QMutexLocker locker(&connection_mutex_);
-
-    if (health_check_timer_)
+    QList<QSqlDatabase> connections;
+    std::unique_ptr<QTimer> purgeTimer;
     {
-        health_check_timer_->stop();
+        QMutexLocker locker(&connection_mutex_);
+
+        auto it = threads_.find(QThread::currentThread());
+        if (it == threads_.end())
+        {
+            return;
+        }
+
+        purgeTimer.reset(it->purgeTimer);
+
+        for (const IdleConnection &connection : std::as_const(it->idle))
+        {
+            connections.append(connection.db);
+        }
+        idle_connections_ -= it->idle.size();
+        open_connections_ -= it->idle.size();
+        connections += it->retired;
+        threads_.erase(it);
+
+        for (const QSqlDatabase &db : std::as_const(connections))
+        {
+            dropStatementCache(db);
+        }
+        grantWaiters();
     }
 
-    // 关闭所有空闲连接
-    while (!idle_connections_.isEmpty())
+    discardConnections(std::move(connections));
+}
+
+void DatabasePool::close()
+{
+    QList<QSqlDatabase> connections;
     {
-        QSqlDatabase db = idle_connections_.dequeue();
-        if (db.isOpen())
+        QMutexLocker locker(&connection_mutex_);
+
+        if (health_check_timer_)
         {
-            db.close();
+            health_check_timer_->stop();
         }
-    }
 
-    active_connections_ = 0;
-    initialized_ = false;
+        // 关闭所有空闲连接（此时使用数据库的线程应已停止，其语句缓存已随线程释放）
+        for (const ThreadConnections &thread : std::as_const(threads_))
+        {
+            for (const IdleConnection &connection : thread.idle)
+            {
+                connections.append(connection.db);
+            }
+            connections += thread.retired;
+
+            if (thread.purgeTimer && thread.purgeTimer->thread() == QThread::currentThread())
+            {
+                delete thread.purgeTimer;
+            }
+            else if (thread.purgeTimer)
+            {
+                thread.purgeTimer->deleteLater();
+            }
+        }
+        threads_.clear();
+
+        // 语句必须在连接关闭前释放
+        for (const QSqlDatabase &db : std::as_const(connections))
+        {
+            dropStatementCache(db);
+        }
+
+        active_connections_ = 0;
+        idle_connections_ = 0;
+        open_connections_ = 0;
+        initialized_ = false;
+    }
 
+    discardConnections(std::move(connections));
     Logger::instance()->info("Database pool closed");
 }
 
@@ -202,35 +364,179 @@ bool DatabasePool::testConnection()
 
 void DatabasePool::checkConnections()
 {
-    QMutexLocker locker(&connection_mutex_);
+    {
+        QMutexLocker locker(&connection_mutex_);
+
+        Logger::instance()->debug(QString("Health check: active=%1, idle=%2, total=%3, waiting=%4")
+                                      .arg(active_connections_)
+                                      .arg(idle_connections_)
+                                      .arg(open_connections_)
+                                      .arg(waiters_.size()));
+    }
+
+    // 只能关闭本线程的连接，其他线程的空闲连接由各自的清理定时器关闭
+    purgeThreadConnections();
+}
+
+void DatabasePool::purgeThreadConnections()
+{
+    QList<QSqlDatabase> expired;
+    {
+        QMutexLocker locker(&connection_mutex_);
+        expired = takeExpired(QThread::currentThread());
+        grantWaiters();
+    }
+
+    discardConnections(std::move(expired));
+}
+
+void DatabasePool::ensurePurgeTimer(ThreadConnections &connections)
+{
+    if (connections.purgeTimer || !QThread::currentThread()->eventDispatcher())
+    {
+        return;
+    }
+
+    // 定时器在当前线程中创建，超时和投递的任务都在该线程中执行
+    connections.purgeTimer = new QTimer();
+    connections.purgeTimer->setInterval(qMax(1000, idle_timeout_ * 500));
+    connect(connections.purgeTimer, &QTimer::timeout, connections.purgeTimer, [this]()
+            { purgeThreadConnections(); });
+    connections.purgeTimer->start();
+}
+
+bool DatabasePool::takeSlot(QThread *thread, IdleConnection &slot)
+{
+    // 优先复用本线程最近归还的连接
+    ThreadConnections &connections = threads_[thread];
+    if (!connections.idle.isEmpty())
+    {
+        slot = connections.idle.takeLast();
+        idle_connections_--;
+        active_connections_++;
+        return true;
+    }
+
+    // 达到上限时回收其他线程的空闲连接名额
+    if (open_connections_ >= max_connections_ && !retireOldestIdle(thread))
+    {
+        return false;
+    }
 
-    Logger::instance()->debug(QString("Health check: active=%1, idle=%2")
-                                  .arg(active_connections_)
-                                  .arg(idle_connections_.size()));
+    slot = IdleConnection();
+    open_connections_++;
+    active_connections_++;
+    return true;
+}
 
-    cleanupInvalidConnections();
+void DatabasePool::grantWaiters()
+{
+    // 队首请求无法满足时说明没有任何空闲连接和名额，后面的请求同样无法满足
+    while (!waiters_.empty())
+    {
+        Waiter *waiter = waiters_.front();
+        if (!takeSlot(waiter->thread, waiter->connection))
+        {
+            break;
+        }
+        waiters_.pop_front();
+        waiter->granted = true;
+        waiter->condition.wakeOne();
+    }
+}
 
-    // 确保最小连接数
-    while (idle_connections_.size() < min_connections_)
+bool DatabasePool::retireOldestIdle(QThread *exclude)
+{
+    ThreadConnections *oldest = nullptr;
+    for (auto it = threads_.begin(); it != threads_.end(); ++it)
     {
-        QSqlDatabase db = createConnection();
-        if (db.isValid() && db.isOpen())
+        if (it.key() == exclude || it->idle.isEmpty())
         {
-            idle_connections_.enqueue(db);
+            continue;
         }
-        else
+        if (!oldest || it->idle.first().idleSinceMs < oldest->idle.first().idleSinceMs)
         {
-            Logger::instance()->error("Failed to create connection during health check");
-            break;
+            oldest = &it.value();
+        }
+    }
+
+    if (!oldest)
+    {
+        return false;
+    }
+
+    // 连接只能由所属线程关闭，这里转移名额后通知所属线程关闭连接
+    oldest->retired.append(oldest->idle.takeFirst().db);
+    idle_connections_--;
+    open_connections_--;
+    if (oldest->purgeTimer)
+    {
+        QMetaObject::invokeMethod(oldest->purgeTimer, [this]()
+                                  { purgeThreadConnections(); }, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+QList<QSqlDatabase> DatabasePool::takeExpired(QThread *thread)
+{
+    auto it = threads_.find(thread);
+    if (it == threads_.end())
+    {
+        return QList<QSqlDatabase>();
+    }
+
+    QList<QSqlDatabase> expired = std::exchange(it->retired, QList<QSqlDatabase>());
+
+    // 关闭空闲超时的连接，保留min_connections个空闲连接
+    qint64 expireBeforeMs = nowMs() - static_cast<qint64>(idle_timeout_) * 1000;
+    while (!it->idle.isEmpty() && idle_connections_ > min_connections_ &&
+           it->idle.first().idleSinceMs < expireBeforeMs)
+    {
+        expired.append(it->idle.takeFirst().db);
+        idle_connections_--;
+        open_connections_--;
+    }
+
+    for (const QSqlDatabase &db : std::as_const(expired))
+    {
+        dropStatementCache(db);
+    }
+    return expired;
+}
+
+QString DatabasePool::nextConnectionName()
+{
+    return QString("connection_%1_%2")
+        .arg(QString::number(reinterpret_cast<quintptr>(QThread::currentThreadId())))
+        .arg(++connection_counter_);
+}
+
+void DatabasePool::discardConnections(QList<QSqlDatabase> connections)
+{
+    QStringList names;
+    for (QSqlDatabase &db : connections)
+    {
+        names.append(db.connectionName());
+        if (db.isOpen())
+        {
+            db.close();
         }
     }
+
+    // 移除前释放所有副本，否则Qt会警告连接仍在使用
+    connections.clear();
+    for (const QString &name : std::as_const(names))
+    {
+        QSqlDatabase::removeDatabase(name);
+    }
 }
 
-QSqlDatabase DatabasePool::createConnection()
+QSqlDatabase DatabasePool::createConnection(const QString &connectionName)
 {
-    QString connectionName = QString("connection_%1_%2")
-                                 .arg(QString::number(reinterpret_cast<quintptr>(QThread::currentThreadId())))
-                                 .arg(++connection_counter_);
+    if (dialect_.isSQLite())
+    {
+        return createSqliteConnection(connectionName);
+    }
 
     QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", connectionName);
     db.setHostName(config_.host);
@@ -273,6 +579,113 @@ QSqlDatabase DatabasePool::createConnection()
     return db;
 }
 
+QSqlDatabase DatabasePool::createSqliteConnection(const QString &connectionName)
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase(dialect_.driverName(), connectionName);
+    db.setDatabaseName(config_.sqlitePath);
+
+    // 写锁被占用时等待，而不是立即返回SQLITE_BUSY
+    db.setConnectOptions(QString("QSQLITE_BUSY_TIMEOUT=%1").arg(connection_timeout_));
+
+    if (!db.open())
+    {
+        Logger::instance()->error(QString("Failed to open SQLite database %1: %2")
+                                      .arg(config_.sqlitePath)
+                                      .arg(db.lastError().text()));
+        return QSqlDatabase();
+    }
+
+    // WAL模式下读写互不阻塞；FULL同步级别保证提交返回时数据已落盘（组提交依赖这一点）
+    QSqlQuery pragma(db);
+    const char *pragmas[] = {"PRAGMA journal_mode=WAL", "PRAGMA synchronous=FULL", "PRAGMA foreign_keys=ON"};
+    for (const char *sql : pragmas)
+    {
+        if (!pragma.exec(sql))
+        {
+            Logger::instance()->warning(QString("%1 failed: %2").arg(sql).arg(pragma.lastError().text()));
+        }
+    }
+
+    Logger::instance()->debug(QString("Created new SQLite connection: %1").arg(connectionName));
+    return db;
+}
+
+bool DatabasePool::initializeSqliteSchema(QSqlDatabase &db)
+{
+    if (db.tables().contains("users"))
+    {
+        return true;
+    }
+
+    QFile file(config_.sqliteSchema);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        Logger::instance()->error(QString("Failed to open SQLite schema file: %1").arg(config_.sqliteSchema));
+        return false;
+    }
+
+    // 按行拆分语句：以分号结尾的行结束一条语句，触发器需等到END;为止
+    QStringList statements;
+    QString current;
+    bool inTrigger = false;
+    QTextStream in(&file);
+    while (!in.atEnd())
+    {
+        QString line = in.readLine();
+        int comment = line.indexOf("--");
+        if (comment >= 0)
+        {
+            line.truncate(comment);
+        }
+        line = line.trimmed();
+        if (line.isEmpty())
+        {
+            continue;
+        }
+
+        if (current.isEmpty())
+        {
+            inTrigger = line.startsWith("CREATE TRIGGER", Qt::CaseInsensitive);
+        }
+        current += line + '\n';
+
+        if (inTrigger ? line.compare("END;", Qt::CaseInsensitive) == 0 : line.endsWith(';'))
+        {
+            statements.append(current);
+            current.clear();
+        }
+    }
+
+    if (!db.transaction())
+    {
+        Logger::instance()->error(QString("Failed to start schema transaction: %1").arg(db.lastError().text()));
+        return false;
+    }
+
+    QSqlQuery query(db);
+    for (const QString &sql : std::as_const(statements))
+    {
+        if (!query.exec(sql))
+        {
+            Logger::instance()->error(QString("Failed to apply SQLite schema: %1 - %2").arg(sql).arg(query.lastError().text()));
+            db.rollback();
+            return false;
+        }
+    }
+
+    if (!db.commit())
+    {
+        Logger::instance()->error(QString("Failed to commit SQLite schema: %1").arg(db.lastError().text()));
+        db.rollback();
+        return false;
+    }
+
+    Logger::instance()->info(QString("Created SQLite schema from %1 (%2 statements)")
+                                 .arg(config_.sqliteSchema)
+                                 .arg(statements.size()));
+    return true;
+}
+
 bool DatabasePool::isConnectionValid(const QSqlDatabase &db)
 {
     if (!db.isValid() || !db.isOpen())
@@ -284,25 +697,29 @@ bool DatabasePool::isConnectionValid(const QSqlDatabase &db)
     return query.exec("SELECT 1");
 }
 
-void DatabasePool::cleanupInvalidConnections()
+StatementCache *DatabasePool::statementCache(const QSqlDatabase &db)
 {
-    QQueue<QSqlDatabase> validConnections;
+    if (!db.isValid())
+    {
+        return nullptr;
+    }
 
-    while (!idle_connections_.isEmpty())
+    StatementCache *&cache = threadStatementCaches.caches[db.connectionName()];
+    if (!cache)
     {
-        QSqlDatabase db = idle_connections_.dequeue();
-        if (isConnectionValid(db))
-        {
-            validConnections.enqueue(db);
-        }
-        else
-        {
-            db.close();
-            Logger::instance()->warning("Removed invalid connection from pool");
-        }
+        cache = new StatementCache(db, statement_cache_size_, &statement_cache_stats_);
     }
+    return cache;
+}
 
-    idle_connections_ = validConnections;
+void DatabasePool::dropStatementCache(const QSqlDatabase &db)
+{
+    StatementCache *cache = threadStatementCaches.caches.take(db.connectionName());
+    if (cache)
+    {
+        cache->invalidate();
+        delete cache;
+    }
 }
 
 // RAII连接管理器实现
@@ -317,4 +734,4 @@ DatabaseConnection::~DatabaseConnection()
     {
         DatabasePool::instance()->releaseConnection(db_);
     }
-}
\ No newline at end of file
+}
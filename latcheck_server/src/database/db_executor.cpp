@@ -0,0 +1,132 @@
+#include "database/db_executor.h"
+#include "logger/logger.h"
+
+#include <QMutexLocker>
+
+DbWorker::DbWorker(int index, QObject *parent)
+    : ThreadWorker(parent), index_(index), pending_jobs_(0)
+{
+}
+
+DbWorker::~DbWorker()
+{
+}
+
+void DbWorker::start()
+{
+    user_dao_ = std::make_unique<UserDAO>();
+    report_dao_ = std::make_unique<ReportDAO>();
+    server_dao_ = std::make_unique<ServerDAO>();
+    calculated_latency_dao_ = std::make_unique<CalculatedLatencyDAO>();
+
+    context_.userDao = user_dao_.get();
+    context_.reportDao = report_dao_.get();
+    context_.serverDao = server_dao_.get();
+    context_.calculatedLatencyDao = calculated_latency_dao_.get();
+
+    Logger::instance()->debug(QString("Database worker %1 started").arg(index_), "DbExecutor");
+}
+
+void DbWorker::stop()
+{
+    context_ = DbContext();
+    user_dao_.reset();
+    report_dao_.reset();
+    server_dao_.reset();
+    calculated_latency_dao_.reset();
+
+    Logger::instance()->debug(QString("Database worker %1 stopped").arg(index_), "DbExecutor");
+}
+
+DbExecutor::DbExecutor(QObject *parent)
+    : QObject(parent)
+{
+}
+
+DbExecutor::~DbExecutor()
+{
+    stop();
+}
+
+bool DbExecutor::start(int threadCount)
+{
+    QMutexLocker locker(&workers_mutex_);
+
+    if (!threads_.isEmpty())
+    {
+        Logger::instance()->warning("Database executor already started", "DbExecutor");
+        return true;
+    }
+
+    if (threadCount <= 0)
+    {
+        threadCount = 1;
+    }
+
+    for (int i = 0; i < threadCount; ++i)
+    {
+        WorkerThread *thread = new WorkerThread();
+        thread->start(QString("db-worker-%1").arg(i), new DbWorker(i));
+        threads_.append(thread);
+    }
+
+    Logger::instance()->info(QString("Database executor started with %1 worker threads").arg(threadCount), "DbExecutor");
+    return true;
+}
+
+void DbExecutor::stop()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+
+    // 先等待已提交任务执行完毕
+    if (!waitForIdle())
+    {
+        Logger::instance()->warning(QString("Database executor stopping with %1 pending jobs")
+                                        .arg(getPendingJobs()),
+                                    "DbExecutor");
+    }
+
+    QMutexLocker locker(&workers_mutex_);
+
+    // 工作线程在析构时执行DbWorker::stop()并结束
+    qDeleteAll(threads_);
+    threads_.clear();
+
+    Logger::instance()->info("Database executor stopped", "DbExecutor");
+}
+
+bool DbExecutor::isRunning() const
+{
+    QMutexLocker locker(&workers_mutex_);
+    return !threads_.isEmpty();
+}
+
+int DbExecutor::getWorkerCount() const
+{
+    QMutexLocker locker(&workers_mutex_);
+    return threads_.size();
+}
+
+bool DbExecutor::waitForIdle(int timeoutMs)
+{
+    return pending_jobs_.waitForZero(timeoutMs);
+}
+
+DbWorker *DbExecutor::selectWorker() const
+{
+    QMutexLocker locker(&workers_mutex_);
+
+    DbWorker *selected = nullptr;
+    for (WorkerThread *thread : threads_)
+    {
+        DbWorker *worker = thread->worker<DbWorker>();
+        if (!selected || worker->pendingJobs() < selected->pendingJobs())
+        {
+            selected = worker;
+        }
+    }
+    return selected;
+}
@@ -1,16 +1,22 @@
 #include "database/report_dao.h"
 #include "database/base_dao.h"
 #include "logger/logger.h"
+#include "config/config_manager.h"
 #include "common/error_codes.h"
 #include "common/types.h"
 
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSqlRecord>
 #include <QVariant>
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <climits>
 
 ReportDAO::ReportDAO(QObject *parent)
-    : BaseDAO(parent)
+    : BaseDAO(parent),
+      insert_chunk_size_(ConfigManager::instance()->getDatabaseConfig().insertChunkSize),
+      packed_records_(ConfigManager::instance()->getDatabaseConfig().recordStorage == "packed")
 {
 }
 
@@ -29,76 +35,208 @@ ErrorCode ReportDAO::createReport(const Report &report, const QList<ReportRecord
         return ErrorCode::TransactionFailed;
     }
 
-    // 保存报告
-    QSqlQuery query = executeQuery(
-        "INSERT INTO latcheck_report (check_location, user_name, created_time) VALUES (?, ?, ?)",
-        {report.location, report.userName, report.createdAt.isValid() ? report.createdAt : QDateTime::currentDateTime()});
+    qint64 reportId = 0;
+    ErrorCode result = insertReport(report, records, reportId);
+    if (result != ErrorCode::Success)
+    {
+        rollbackTransaction();
+        return result;
+    }
 
-    if (query.lastError().type() != QSqlError::NoError)
+    // 提交事务
+    if (!commitTransaction())
+    {
+        rollbackTransaction();
+        Logger::instance()->error("Failed to commit transaction", "ReportDAO");
+        return ErrorCode::TransactionFailed;
+    }
+
+    logReportCreated(report, records.size(), reportId);
+    return ErrorCode::Success;
+}
+
+QList<ErrorCode> ReportDAO::createReportGroup(const QList<Report> &reports, const QList<QList<ReportRecord>> &records,
+                                              QList<qint64> *createdIds)
+{
+    QList<ErrorCode> results(reports.size(), ErrorCode::Success);
+    QList<qint64> reportIds(reports.size(), 0);
+    if (createdIds)
+    {
+        createdIds->fill(0, reports.size());
+    }
+
+    if (reports.isEmpty())
+    {
+        return results;
+    }
+
+    if (!beginTransaction())
+    {
+        Logger::instance()->error("Failed to start group transaction", "ReportDAO");
+        results.fill(ErrorCode::TransactionFailed);
+        return results;
+    }
+
+    // 每个报告使用独立的保存点，单个报告失败只回滚该报告
+    for (int i = 0; i < reports.size(); ++i)
+    {
+        const Report &report = reports.at(i);
+        if (!validateReportData(report))
+        {
+            Logger::instance()->error("Invalid report data", "ReportDAO");
+            results[i] = ErrorCode::InvalidData;
+            continue;
+        }
+
+        QString savepoint = QString("report_%1").arg(i);
+        if (!createSavepoint(savepoint))
+        {
+            results[i] = ErrorCode::DatabaseError;
+            continue;
+        }
+
+        const QList<ReportRecord> &reportRecords = i < records.size() ? records.at(i) : QList<ReportRecord>();
+        results[i] = insertReport(report, reportRecords, reportIds[i]);
+        bool savepointOk = results.at(i) == ErrorCode::Success ? releaseSavepoint(savepoint)
+                                                               : rollbackToSavepoint(savepoint);
+        if (!savepointOk)
+        {
+            // 无法确定事务状态，放弃整组
+            rollbackTransaction();
+            Logger::instance()->error(QString("Savepoint failure, group of %1 reports rolled back").arg(reports.size()), "ReportDAO");
+            failPending(results);
+            return results;
+        }
+    }
+
+    // 整组一次提交；提交失败时组内所有报告都未写入
+    if (!commitTransaction())
     {
         rollbackTransaction();
-        Logger::instance()->error(QString("Failed to create report: %1").arg(query.lastError().text()), "ReportDAO");
+        Logger::instance()->error(QString("Failed to commit group of %1 reports").arg(reports.size()), "ReportDAO");
+        failPending(results);
+        return results;
+    }
+
+    for (int i = 0; i < reports.size(); ++i)
+    {
+        if (results.at(i) == ErrorCode::Success)
+        {
+            logReportCreated(reports.at(i), i < records.size() ? records.at(i).size() : 0, reportIds.at(i));
+        }
+        else
+        {
+            reportIds[i] = 0;
+        }
+    }
+
+    if (createdIds)
+    {
+        *createdIds = reportIds;
+    }
+    return results;
+}
+
+void ReportDAO::failPending(QList<ErrorCode> &results)
+{
+    // 已写入和尚未处理（初始为成功）的报告都随整组回滚
+    for (ErrorCode &result : results)
+    {
+        if (result == ErrorCode::Success)
+        {
+            result = ErrorCode::TransactionFailed;
+        }
+    }
+}
+
+ErrorCode ReportDAO::insertReport(const Report &report, const QList<ReportRecord> &records, qint64 &reportId)
+{
+    // 紧凑存储没有数据库约束，在写入报告前统一检查
+    if (!validateRecords(records))
+    {
+        return ErrorCode::InvalidData;
+    }
+
+    // 保存报告（每个报告执行一次，使用连接中缓存的语句）
+    if (!executeUpdate("INSERT INTO latcheck_report (check_location, user_name, created_time) VALUES (?, ?, ?)",
+                       {report.location, report.userName,
+                        toDatabaseTimestamp(report.createdAt.isValid() ? report.createdAt : QDateTime::currentDateTime())}))
+    {
+        Logger::instance()->error("Failed to create report", "ReportDAO");
         return ErrorCode::DatabaseError;
     }
 
     // 获取刚创建的报告ID
-    qint64 reportId = getLastInsertId();
+    reportId = getLastInsertId();
     if (reportId <= 0)
     {
-        rollbackTransaction();
         Logger::instance()->error("Failed to get last inserted report ID", "ReportDAO");
         return ErrorCode::DatabaseError;
     }
 
-    // 保存报告记录
     if (!records.isEmpty())
     {
-        for (const auto &record : records)
+        QElapsedTimer timer;
+        timer.start();
+        bool inserted = packed_records_ ? insertPackedRecords(reportId, records) : insertRowRecords(reportId, records);
+        if (!inserted)
         {
-            QVariantList params;
-            params << reportId << record.serverIp << record.serverId << record.latency;
-
-            QSqlQuery recordQuery = executeQuery(
-                "INSERT INTO report_record (report_id, server_ip, server_id, latency) VALUES (?, ?, ?, ?)",
-                params);
-
-            if (recordQuery.lastError().type() != QSqlError::NoError)
-            {
-                rollbackTransaction();
-                Logger::instance()->error(QString("Failed to insert report record: %1").arg(recordQuery.lastError().text()), "ReportDAO");
-                return ErrorCode::DatabaseError;
-            }
+            Logger::instance()->error(QString("Failed to insert records for report %1").arg(reportId), "ReportDAO");
+            return ErrorCode::DatabaseError;
         }
+
+        Logger::instance()->debug(QString("Inserted %1 %2 records for report %3 (%4 ms)")
+                                      .arg(records.size())
+                                      .arg(packed_records_ ? "packed" : "row")
+                                      .arg(reportId)
+                                      .arg(timer.elapsed()),
+                                  "ReportDAO");
     }
 
-    // 提交事务
-    if (!commitTransaction())
+    return ErrorCode::Success;
+}
+
+bool ReportDAO::insertRowRecords(qint64 reportId, const QList<ReportRecord> &records)
+{
+    // 按块合并为多行INSERT，减少与数据库的往返次数
+    QList<QVariantList> rows;
+    rows.reserve(records.size());
+    for (const auto &record : records)
     {
-        rollbackTransaction();
-        Logger::instance()->error("Failed to commit transaction", "ReportDAO");
-        return ErrorCode::TransactionFailed;
+        rows.append({reportId, record.serverIp, record.serverId, record.latency});
     }
 
+    int statements = executeBatchInsert("report_record", {"report_id", "server_ip", "server_id", "latency"},
+                                        rows, insert_chunk_size_);
+    return statements >= 0;
+}
+
+bool ReportDAO::insertPackedRecords(qint64 reportId, const QList<ReportRecord> &records)
+{
+    return executeUpdate("INSERT INTO report_latency_blob (report_id, record_count, payload) VALUES (?, ?, ?)",
+                         {reportId, static_cast<int>(records.size()), encodeRecords(records)});
+}
+
+void ReportDAO::logReportCreated(const Report &report, int recordCount, qint64 reportId)
+{
     // 记录审计日志
     Logger::instance()->auditLog(report.userName, "CREATE_REPORT",
                                  QString("Report created - Location: %1, User: %2, Records: %3")
                                      .arg(report.location)
                                      .arg(report.userName)
-                                     .arg(records.size()));
+                                     .arg(recordCount));
 
     // 添加成功日志
     Logger::instance()->info(QString("Successfully created report ID %1 with %2 records for user %3")
                                  .arg(reportId)
-                                 .arg(records.size())
+                                 .arg(recordCount)
                                  .arg(report.userName),
                              "ReportDAO");
-
-    return ErrorCode::Success;
 }
 
 Report ReportDAO::getReportById(qint64 reportId)
 {
-    QSqlQuery query = executeQuery(
+    QueryResult query = executeQuery(
         "SELECT report_id, check_location, user_name, created_time FROM latcheck_report WHERE report_id = ?",
         {reportId});
 
@@ -111,7 +249,7 @@ Report ReportDAO::getReportById(qint64 reportId)
 
     if (query.next())
     {
-        return buildReportFromQuery(query);
+        return buildReportFromQuery(query, reportColumns(query));
     }
 
     QString error = QString("Failed to get report by ID: %1").arg(reportId);
@@ -124,8 +262,8 @@ QList<Report> ReportDAO::getReportsByUserName(const QString &userName, int limit
 {
     QList<Report> reports;
 
-    QSqlQuery query = executeQuery(
-        "SELECT report_id, check_location, user_name, created_time FROM latcheck_report WHERE user_name = ? ORDER BY created_time DESC LIMIT ? OFFSET ?",
+    QueryResult query = executeQuery(
+        "SELECT report_id, check_location, user_name, created_time FROM latcheck_report WHERE user_name = ? ORDER BY created_time DESC, report_id DESC LIMIT ? OFFSET ?",
         {userName, limit, offset});
 
     if (query.lastError().type() != QSqlError::NoError)
@@ -135,9 +273,10 @@ QList<Report> ReportDAO::getReportsByUserName(const QString &userName, int limit
         return reports;
     }
 
+    const ReportColumns columns = reportColumns(query);
     while (query.next())
     {
-        reports.append(buildReportFromQuery(query));
+        reports.append(buildReportFromQuery(query, columns));
     }
 
     return reports;
@@ -148,8 +287,8 @@ QList<Report> ReportDAO::getReportsByLocation(const QString &location, int limit
 {
     QList<Report> reports;
 
-    QSqlQuery query = executeQuery(
-        "SELECT report_id, check_location, user_name, created_time FROM latcheck_report WHERE check_location = ? ORDER BY created_time DESC LIMIT ? OFFSET ?",
+    QueryResult query = executeQuery(
+        "SELECT report_id, check_location, user_name, created_time FROM latcheck_report WHERE check_location = ? ORDER BY created_time DESC, report_id DESC LIMIT ? OFFSET ?",
         {location, limit, offset});
 
     if (query.lastError().type() != QSqlError::NoError)
@@ -159,9 +298,10 @@ QList<Report> ReportDAO::getReportsByLocation(const QString &location, int limit
         return reports;
     }
 
+    const ReportColumns columns = reportColumns(query);
     while (query.next())
     {
-        reports.append(buildReportFromQuery(query));
+        reports.append(buildReportFromQuery(query, columns));
     }
 
     return reports;
@@ -171,8 +311,8 @@ QList<Report> ReportDAO::getAllReports(int limit, int offset)
 {
     QList<Report> reports;
 
-    QSqlQuery query = executeQuery(
-        "SELECT report_id, check_location, user_name, created_time FROM latcheck_report ORDER BY created_time DESC LIMIT ? OFFSET ?",
+    QueryResult query = executeQuery(
+        "SELECT report_id, check_location, user_name, created_time FROM latcheck_report ORDER BY created_time DESC, report_id DESC LIMIT ? OFFSET ?",
         {limit, offset});
 
     if (query.lastError().type() != QSqlError::NoError)
@@ -181,9 +321,155 @@ QList<Report> ReportDAO::getAllReports(int limit, int offset)
         return reports;
     }
 
+    const ReportColumns columns = reportColumns(query);
     while (query.next())
     {
-        reports.append(buildReportFromQuery(query));
+        reports.append(buildReportFromQuery(query, columns));
+    }
+
+    return reports;
+}
+
+QList<Report> ReportDAO::getReportsPage(const ReportPageCursor &after, int limit, ReportPageCursor *next)
+{
+    QList<Report> reports;
+    queryReportsPage(QString(), QVariant(), after, limit, reports);
+    if (next)
+    {
+        *next = reports.isEmpty() ? after : ReportPageCursor{reports.last().createdAt, reports.last().id};
+    }
+    return reports;
+}
+
+QList<Report> ReportDAO::getReportsPageByUserName(const QString &userName, const ReportPageCursor &after, int limit,
+                                                  ReportPageCursor *next)
+{
+    QList<Report> reports;
+    queryReportsPage("user_name", userName, after, limit, reports);
+    if (next)
+    {
+        *next = reports.isEmpty() ? after : ReportPageCursor{reports.last().createdAt, reports.last().id};
+    }
+    return reports;
+}
+
+QList<Report> ReportDAO::getReportsPageByLocation(const QString &location, const ReportPageCursor &after, int limit,
+                                                  ReportPageCursor *next)
+{
+    QList<Report> reports;
+    queryReportsPage("check_location", location, after, limit, reports);
+    if (next)
+    {
+        *next = reports.isEmpty() ? after : ReportPageCursor{reports.last().createdAt, reports.last().id};
+    }
+    return reports;
+}
+
+bool ReportDAO::streamReports(const ReportBatchCallback &callback, int batchSize)
+{
+    return streamReportsBy(QString(), QVariant(), callback, batchSize);
+}
+
+bool ReportDAO::streamReportsByUserName(const QString &userName, const ReportBatchCallback &callback, int batchSize)
+{
+    return streamReportsBy("user_name", userName, callback, batchSize);
+}
+
+bool ReportDAO::streamReportsByLocation(const QString &location, const ReportBatchCallback &callback, int batchSize)
+{
+    return streamReportsBy("check_location", location, callback, batchSize);
+}
+
+bool ReportDAO::queryReportsPage(const QString &filterColumn, const QVariant &filterValue, const ReportPageCursor &after,
+                                 int limit, QList<Report> &reports)
+{
+    // 从上一页最后一个报告的键值处继续扫描索引(created_time, report_id)，
+    // 不需要像OFFSET那样先读取并丢弃前面的所有行。
+    // 单独的created_time <= ?条件使优化器可以按范围定位，只写OR条件时会退化为全索引扫描
+    QStringList conditions;
+    QVariantList params;
+    if (!filterColumn.isEmpty())
+    {
+        conditions.append(filterColumn + " = ?");
+        params.append(filterValue);
+    }
+    if (!after.isStart())
+    {
+        QVariant createdTime = toDatabaseTimestamp(after.createdTime);
+        conditions.append("created_time <= ? AND (created_time < ? OR report_id < ?)");
+        params << createdTime << createdTime << after.reportId;
+    }
+    params.append(qMax(1, limit));
+
+    QString sql = "SELECT report_id, check_location, user_name, created_time FROM latcheck_report";
+    if (!conditions.isEmpty())
+    {
+        sql += " WHERE " + conditions.join(" AND ");
+    }
+    sql += " ORDER BY created_time DESC, report_id DESC LIMIT ?";
+
+    QueryResult query = executeQuery(sql, params);
+    if (query.lastError().type() != QSqlError::NoError)
+    {
+        Logger::instance()->error(QString("Failed to get reports page after report ID %1: %2").arg(after.reportId).arg(query.lastError().text()), "ReportDAO");
+        return false;
+    }
+
+    const ReportColumns columns = reportColumns(query);
+    while (query.next())
+    {
+        reports.append(buildReportFromQuery(query, columns));
+    }
+
+    return true;
+}
+
+bool ReportDAO::streamReportsBy(const QString &filterColumn, const QVariant &filterValue,
+                                const ReportBatchCallback &callback, int batchSize)
+{
+    batchSize = qMax(1, batchSize);
+    ReportPageCursor cursor;
+    QList<Report> batch;
+    batch.reserve(batchSize);
+
+    forever
+    {
+        batch.clear();
+        if (!queryReportsPage(filterColumn, filterValue, cursor, batchSize, batch))
+        {
+            return false;
+        }
+        if (batch.isEmpty())
+        {
+            return true;
+        }
+
+        cursor = ReportPageCursor{batch.last().createdAt, batch.last().id};
+        if (!callback(batch) || batch.size() < batchSize)
+        {
+            return true;
+        }
+    }
+}
+
+QList<Report> ReportDAO::getLatestReportPerLocation()
+{
+    QList<Report> reports;
+
+    QueryResult query = executeQuery(
+        "SELECT report_id, check_location, user_name, created_time FROM latcheck_report "
+        "WHERE report_id IN (SELECT MAX(report_id) FROM latcheck_report GROUP BY check_location) ORDER BY report_id");
+
+    if (query.lastError().type() != QSqlError::NoError)
+    {
+        Logger::instance()->error(QString("Failed to get latest reports per location: %1").arg(query.lastError().text()), "ReportDAO");
+        return reports;
+    }
+
+    const ReportColumns columns = reportColumns(query);
+    while (query.next())
+    {
+        reports.append(buildReportFromQuery(query, columns));
     }
 
     return reports;
@@ -194,8 +480,14 @@ QList<ReportRecord> ReportDAO::getReportRecords(qint64 reportId)
 {
     QList<ReportRecord> records;
 
-    QSqlQuery query = executeQuery(
-        "SELECT record_id, report_id, server_ip, server_id, latency FROM report_record WHERE report_id = ?",
+    // 一次查询确定存储方式（两种方式写入的报告可以共存，紧凑数据优先）：
+    // 有紧凑数据时只返回一行payload，否则返回该报告的各行记录，payload为NULL
+    QueryResult query = executeQuery(
+        "SELECT rr.record_id, rr.report_id, rr.server_ip, rr.server_id, rr.latency, b.payload "
+        "FROM latcheck_report r "
+        "LEFT JOIN report_latency_blob b ON b.report_id = r.report_id "
+        "LEFT JOIN report_record rr ON rr.report_id = r.report_id AND b.report_id IS NULL "
+        "WHERE r.report_id = ?",
         {reportId});
 
     if (query.lastError().type() != QSqlError::NoError)
@@ -204,29 +496,260 @@ QList<ReportRecord> ReportDAO::getReportRecords(qint64 reportId)
         return records;
     }
 
+    const RecordColumns columns = recordColumns(query);
+    const int payloadColumn = query.query().record().indexOf("payload");
+    records.reserve(qMax(0, query.size()));
     while (query.next())
     {
-        records.append(buildReportRecordFromQuery(query));
+        QVariant payload = query.value(payloadColumn);
+        if (!payload.isNull())
+        {
+            if (!decodeRecords(payload.toByteArray(), reportId, records))
+            {
+                Logger::instance()->error(QString("Corrupted packed records for report ID %1").arg(reportId), "ReportDAO");
+                records.clear();
+            }
+            break;
+        }
+
+        // 没有任何记录的报告返回一行全为NULL的结果
+        if (!columns.value(query, RecordIdColumn).isNull())
+        {
+            records.append(buildReportRecordFromQuery(query, columns));
+        }
     }
 
     return records;
 }
 
-// 修改 buildReportRecordFromQuery 方法
-ReportRecord ReportDAO::buildReportRecordFromQuery(const QSqlQuery &query)
+bool ReportDAO::getRowRecords(qint64 reportId, QList<ReportRecord> &records)
+{
+    QueryResult query = executeQuery(
+        "SELECT record_id, report_id, server_ip, server_id, latency FROM report_record WHERE report_id = ?",
+        {reportId});
+
+    if (query.lastError().type() != QSqlError::NoError)
+    {
+        Logger::instance()->error(QString("Failed to get report records by report ID %1: %2").arg(reportId).arg(query.lastError().text()), "ReportDAO");
+        return false;
+    }
+
+    const RecordColumns columns = recordColumns(query);
+    records.reserve(records.size() + qMax(0, query.size()));
+    while (query.next())
+    {
+        records.append(buildReportRecordFromQuery(query, columns));
+    }
+
+    return true;
+}
+
+bool ReportDAO::getPackedRecords(qint64 reportId, QList<ReportRecord> &records, bool &found)
+{
+    found = false;
+
+    QueryResult query = executeQuery("SELECT payload FROM report_latency_blob WHERE report_id = ?", {reportId});
+    if (query.lastError().type() != QSqlError::NoError)
+    {
+        Logger::instance()->error(QString("Failed to get packed records by report ID %1: %2").arg(reportId).arg(query.lastError().text()), "ReportDAO");
+        return false;
+    }
+
+    if (!query.next())
+    {
+        return true;
+    }
+
+    found = true;
+    if (!decodeRecords(query.value(0).toByteArray(), reportId, records))
+    {
+        Logger::instance()->error(QString("Corrupted packed records for report ID %1").arg(reportId), "ReportDAO");
+        records.clear();
+        return false;
+    }
+
+    return true;
+}
+
+namespace
+{
+    const char kPackedRecordsVersion = 1;
+
+    void appendVarint(QByteArray &out, quint64 value)
+    {
+        while (value >= 0x80)
+        {
+            out.append(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.append(static_cast<char>(value));
+    }
+
+    bool readVarint(const uchar *&pos, const uchar *end, quint64 &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos < end; shift += 7)
+        {
+            uchar byte = *pos++;
+            value |= static_cast<quint64>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+QByteArray ReportDAO::encodeRecords(const QList<ReportRecord> &records)
+{
+    QByteArray payload;
+    // 典型情况下每条记录约7字节
+    payload.reserve(8 + records.size() * 8);
+    payload.append(kPackedRecordsVersion);
+    appendVarint(payload, static_cast<quint64>(records.size()));
+
+    qint64 previousId = 0;
+    for (const auto &record : records)
+    {
+        qint64 delta = static_cast<qint64>(record.serverId) - previousId;
+        previousId = record.serverId;
+        appendVarint(payload, (static_cast<quint64>(delta) << 1) ^ static_cast<quint64>(delta >> 63));
+        appendVarint(payload, static_cast<quint64>(record.latency));
+
+        quint32 ip = record.serverIp;
+        char ipBytes[4] = {static_cast<char>(ip >> 24), static_cast<char>(ip >> 16),
+                           static_cast<char>(ip >> 8), static_cast<char>(ip)};
+        payload.append(ipBytes, 4);
+    }
+
+    return payload;
+}
+
+bool ReportDAO::decodeRecords(const QByteArray &payload, qint64 reportId, QList<ReportRecord> &records)
+{
+    const uchar *pos = reinterpret_cast<const uchar *>(payload.constData());
+    const uchar *end = pos + payload.size();
+
+    if (pos == end || *pos++ != kPackedRecordsVersion)
+    {
+        return false;
+    }
+
+    quint64 count = 0;
+    // 每条记录至少6字节，据此拒绝不合理的记录数
+    if (!readVarint(pos, end, count) || count > static_cast<quint64>(end - pos) / 6)
+    {
+        return false;
+    }
+
+    records.reserve(records.size() + static_cast<int>(count));
+    qint64 previousId = 0;
+    for (quint64 i = 0; i < count; ++i)
+    {
+        quint64 zigzag = 0;
+        quint64 latency = 0;
+        if (!readVarint(pos, end, zigzag) || !readVarint(pos, end, latency) || end - pos < 4)
+        {
+            return false;
+        }
+
+        qint64 delta = static_cast<qint64>(zigzag >> 1) ^ -static_cast<qint64>(zigzag & 1);
+        previousId += delta;
+
+        ReportRecord record;
+        record.reportId = reportId;
+        record.serverId = static_cast<quint32>(previousId);
+        record.latency = static_cast<int>(qMin<quint64>(latency, INT_MAX));
+        record.serverIp = (static_cast<quint32>(pos[0]) << 24) | (static_cast<quint32>(pos[1]) << 16) |
+                          (static_cast<quint32>(pos[2]) << 8) | static_cast<quint32>(pos[3]);
+        pos += 4;
+        records.append(record);
+    }
+
+    return pos == end;
+}
+
+QList<qint64> ReportDAO::getReportIdsWithRowRecords(qint64 afterId, int limit)
+{
+    QList<qint64> reportIds;
+
+    QueryResult query = executeQuery(
+        "SELECT DISTINCT report_id FROM report_record WHERE report_id > ? ORDER BY report_id LIMIT ?",
+        {afterId, limit});
+
+    if (query.lastError().type() != QSqlError::NoError)
+    {
+        Logger::instance()->error(QString("Failed to list reports with row records: %1").arg(query.lastError().text()), "ReportDAO");
+        return reportIds;
+    }
+
+    while (query.next())
+    {
+        reportIds.append(query.value(0).toLongLong());
+    }
+
+    return reportIds;
+}
+
+ErrorCode ReportDAO::packReportRecords(qint64 reportId, int *recordCount)
+{
+    if (!beginTransaction())
+    {
+        return ErrorCode::DatabaseError;
+    }
+
+    QList<ReportRecord> records;
+    bool found = false;
+    QList<ReportRecord> packed;
+    if (!getPackedRecords(reportId, packed, found) || !getRowRecords(reportId, records))
+    {
+        rollbackTransaction();
+        return ErrorCode::DatabaseError;
+    }
+
+    // 已有紧凑数据时以紧凑数据为准（读取路径同样优先紧凑数据），只删除残留的行
+    bool ok = found || records.isEmpty() || insertPackedRecords(reportId, records);
+    if (ok)
+    {
+        ok = executeUpdate("DELETE FROM report_record WHERE report_id = ?", {reportId});
+    }
+
+    if (!ok || !commitTransaction())
+    {
+        Logger::instance()->error(QString("Failed to pack records for report %1").arg(reportId), "ReportDAO");
+        rollbackTransaction();
+        return ErrorCode::DatabaseError;
+    }
+
+    if (recordCount)
+    {
+        *recordCount = found ? 0 : records.size();
+    }
+    return ErrorCode::Success;
+}
+
+ReportDAO::RecordColumns ReportDAO::recordColumns(const QSqlQuery &query)
+{
+    static const std::array<const char *, RecordColumnCount> names = {
+        "record_id", "report_id", "server_ip", "server_id", "latency"};
+    return RecordColumns(query, names);
+}
+
+ReportRecord ReportDAO::buildReportRecordFromQuery(const QSqlQuery &query, const RecordColumns &columns)
 {
     ReportRecord record;
-    record.id = query.value("record_id").toLongLong();
-    record.reportId = query.value("report_id").toLongLong();
-    record.serverIp = static_cast<quint32>(query.value("server_ip").toUInt());
-    record.serverId = query.value("server_id").toInt();
-    record.latency = query.value("latency").toInt();
+    record.id = columns.value(query, RecordIdColumn).toLongLong();
+    record.reportId = columns.value(query, RecordReportIdColumn).toLongLong();
+    record.serverIp = static_cast<quint32>(columns.value(query, RecordServerIpColumn).toUInt());
+    record.serverId = columns.value(query, RecordServerIdColumn).toUInt();
+    record.latency = columns.value(query, RecordLatencyColumn).toInt();
     return record;
 }
 
 int ReportDAO::getReportCount()
 {
-    QSqlQuery query = executeQuery("SELECT COUNT(*) FROM latcheck_report");
+    QueryResult query = executeQuery("SELECT COUNT(*) FROM latcheck_report");
 
     if (query.next())
     {
@@ -236,13 +759,20 @@ int ReportDAO::getReportCount()
     return 0;
 }
 
-Report ReportDAO::buildReportFromQuery(const QSqlQuery &query)
+ReportDAO::ReportColumns ReportDAO::reportColumns(const QSqlQuery &query)
+{
+    static const std::array<const char *, ReportColumnCount> names = {
+        "report_id", "check_location", "user_name", "created_time"};
+    return ReportColumns(query, names);
+}
+
+Report ReportDAO::buildReportFromQuery(const QSqlQuery &query, const ReportColumns &columns)
 {
     Report report;
-    report.id = query.value("report_id").toLongLong();
-    report.location = query.value("check_location").toString();
-    report.userName = query.value("user_name").toString();
-    report.createdAt = query.value("created_time").toDateTime();
+    report.id = columns.value(query, ReportIdColumn).toLongLong();
+    report.location = columns.value(query, ReportLocationColumn).toString();
+    report.userName = columns.value(query, ReportUserNameColumn).toString();
+    report.createdAt = columns.value(query, ReportCreatedTimeColumn).toDateTime();
     return report;
 }
 
@@ -258,5 +788,22 @@ bool ReportDAO::validateReportData(const Report &report)
         return false;
     }
 
+    return true;
+}
+
+bool ReportDAO::validateRecords(const QList<ReportRecord> &records)
+{
+    // 协议中的延时为无符号32位，超过INT_MAX的值转换后为负数，不能当作0毫秒保存
+    for (const auto &record : records)
+    {
+        if (record.latency < 0 || record.latency > MaxRecordLatency)
+        {
+            Logger::instance()->error(QString("Invalid latency %1 for server ID %2")
+                                          .arg(record.latency)
+                                          .arg(record.serverId),
+                                      "ReportDAO");
+            return false;
+        }
+    }
     return true;
 }
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include "database/report_ingest_queue.h"
+#include "latency/latency_engine.h"
+#include "catalog/server_catalog.h"
+#include "common/latency_histogram.h"
+#include "logger/logger.h"
+
+#include <QMutexLocker>
+#include <utility>
+
+ReportIngestWorker::ReportIngestWorker(ReportIngestQueue *queue, QObject *parent)
+    : ThreadWorker(parent), queue_(queue), timer_(nullptr)
+{
+}
+
+ReportIngestWorker::~ReportIngestWorker()
+{
+}
+
+void ReportIngestWorker::start()
+{
+    report_dao_ = std::make_unique<ReportDAO>();
+    server_dao_ = std::make_unique<ServerDAO>();
+
+    timer_ = new QTimer(this);
+    timer_->setSingleShot(true);
+    timer_->setTimerType(Qt::PreciseTimer);
+    connect(timer_, &QTimer::timeout, this, &ReportIngestWorker::flush);
+
+    Logger::instance()->debug("Report ingest worker started", "ReportIngest");
+}
+
+void ReportIngestWorker::stop()
+{
+    // 写入停止前残留的报告
+    while (queue_->queuedCount() > 0)
+    {
+        flush();
+    }
+
+    delete timer_;
+    timer_ = nullptr;
+    report_dao_.reset();
+    server_dao_.reset();
+
+    Logger::instance()->debug("Report ingest worker stopped", "ReportIngest");
+}
+
+void ReportIngestWorker::schedule()
+{
+    if (queue_->queuedCount() >= queue_->max_reports_)
+    {
+        flush();
+        return;
+    }
+
+    qint64 oldestUs = queue_->oldestQueuedUs();
+    if (oldestUs < 0 || timer_->isActive())
+    {
+        return;
+    }
+
+    // 定时器从最早报告入队时开始计算，避免上一组提交期间入队的报告再等待一个完整周期
+    qint64 waitedMs = (LatencyStats::nowUs() - oldestUs) / 1000;
+    timer_->start(static_cast<int>(qMax<qint64>(0, queue_->max_delay_ms_ - waitedMs)));
+}
+
+void ReportIngestWorker::flush()
+{
+    timer_->stop();
+
+    QList<ReportIngestItem> items = queue_->takeGroup();
+    if (items.isEmpty())
+    {
+        return;
+    }
+
+    QList<ReportIngestResult> results = commitGroup(items);
+
+    // 事务结束后才将结果投递回各会话所在线程
+    for (int i = 0; i < items.size(); ++i)
+    {
+        ReportIngestItem &item = items[i];
+        QMetaObject::invokeMethod(
+            item.context,
+            [done = std::move(item.done), result = std::move(results[i])]()
+            { done(result); },
+            Qt::QueuedConnection);
+    }
+    queue_->groupFinished(items.size());
+
+    // 提交期间入队的报告
+    schedule();
+}
+
+QList<ReportIngestResult> ReportIngestWorker::commitGroup(QList<ReportIngestItem> &items)
+{
+    QList<ReportIngestResult> results(items.size());
+    qint64 startUs = LatencyStats::nowUs();
+    for (const ReportIngestItem &item : std::as_const(items))
+    {
+        LatencyStats::instance()->record(item.msgType, LatencyStage::Queue, startUs - item.submittedUs);
+    }
+
+    try
+    {
+        // 会话中没有目录快照时使用后备方案，每组只获取一次
+        ServerCatalogSnapshotPtr fallbackCatalog;
+
+        QList<Report> reports;
+        QList<QList<ReportRecord>> reportRecords;
+        reports.reserve(items.size());
+        reportRecords.reserve(items.size());
+
+        for (int i = 0; i < items.size(); ++i)
+        {
+            const ReportIngestItem &item = items.at(i);
+            const ServerCatalogSnapshot *catalog = item.catalog.get();
+            if (!catalog)
+            {
+                if (!fallbackCatalog)
+                {
+                    // 优先使用服务器目录的快照，目录未加载时才查询数据库
+                    fallbackCatalog = ServerCatalog::instance()->snapshot();
+                    if (fallbackCatalog->version == 0)
+                    {
+                        Logger::instance()->warning("Fetching server list from database as fallback", "ReportIngest");
+                        auto loaded = std::make_shared<ServerCatalogSnapshot>();
+                        loaded->servers = server_dao_->getActiveServers();
+                        loaded->serverIndex = ServerIpIndex(loaded->servers);
+                        fallbackCatalog = std::move(loaded);
+                    }
+                }
+                results[i].catalog = fallbackCatalog;
+                catalog = fallbackCatalog.get();
+            }
+
+            // 转换LatencyRecord为ReportRecord
+            QList<ReportRecord> records;
+            records.reserve(item.records.size());
+            for (const LatencyRecord &record : item.records)
+            {
+                ReportRecord reportRecord;
+                reportRecord.serverId = record.serverId;
+                reportRecord.latency = record.latency;
+
+                // 使用目录快照的索引查找IP地址
+                if (!catalog->serverIndex.find(record.serverId, reportRecord.serverIp))
+                {
+                    reportRecord.serverIp = 0;
+                    Logger::instance()->warning(QString("Failed to find IP for server ID: %1 when processing report from user: %2")
+                                                    .arg(record.serverId)
+                                                    .arg(item.report.userName));
+                }
+                records.append(reportRecord);
+            }
+
+            reports.append(item.report);
+            reportRecords.append(records);
+        }
+
+        // 保存报告和记录（整组一个事务）
+        QList<qint64> reportIds;
+        QList<ErrorCode> codes = report_dao_->createReportGroup(reports, reportRecords, &reportIds);
+        for (int i = 0; i < results.size() && i < codes.size(); ++i)
+        {
+            results[i].code = codes.at(i);
+
+            // 已提交的报告交给地点间延时引擎
+            if (codes.at(i) == ErrorCode::Success && reportIds.at(i) > 0)
+            {
+                LatencyEngine::instance()->submitReport(reports.at(i).location, reportIds.at(i), reportRecords.at(i));
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        Logger::instance()->error(QString("Exception in report group commit: %1").arg(e.what()), "ReportIngest");
+    }
+    catch (...)
+    {
+        Logger::instance()->error("Unknown exception in report group commit", "ReportIngest");
+    }
+
+    qint64 elapsedUs = LatencyStats::nowUs() - startUs;
+    for (const ReportIngestItem &item : std::as_const(items))
+    {
+        LatencyStats::instance()->record(item.msgType, LatencyStage::Database, elapsedUs);
+    }
+
+    Logger::instance()->debug(QString("Committed report group: %1 reports in %2us").arg(items.size()).arg(elapsedUs),
+                              "ReportIngest");
+    return results;
+}
+
+ReportIngestQueue::ReportIngestQueue(QObject *parent)
+    : QObject(parent), max_reports_(64), max_delay_ms_(20),
+      accepting_(false), group_count_(0), report_count_(0)
+{
+}
+
+ReportIngestQueue::~ReportIngestQueue()
+{
+    stop();
+}
+
+bool ReportIngestQueue::start(int maxReports, int maxDelayMs)
+{
+    if (isRunning())
+    {
+        Logger::instance()->warning("Report ingest queue already started", "ReportIngest");
+        return true;
+    }
+
+    max_reports_ = qMax(1, maxReports);
+    max_delay_ms_ = qMax(0, maxDelayMs);
+
+    thread_.start("report-ingest", new ReportIngestWorker(this));
+
+    {
+        QMutexLocker locker(&queue_mutex_);
+        accepting_ = true;
+    }
+
+    Logger::instance()->info(QString("Report ingest queue started (max %1 reports or %2 ms per group)")
+                                 .arg(max_reports_)
+                                 .arg(max_delay_ms_),
+                             "ReportIngest");
+    return true;
+}
+
+void ReportIngestQueue::stop()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&queue_mutex_);
+        accepting_ = false;
+    }
+
+    // 已入队的报告在工作对象停止时写入
+    thread_.stop();
+
+    Logger::instance()->info(QString("Report ingest queue stopped (%1 reports in %2 groups)")
+                                 .arg(getReportCount())
+                                 .arg(getGroupCount()),
+                             "ReportIngest");
+}
+
+bool ReportIngestQueue::isRunning() const
+{
+    return thread_.isRunning();
+}
+
+bool ReportIngestQueue::submit(QObject *context, ReportIngestItem item)
+{
+    if (!context || !item.done)
+    {
+        return false;
+    }
+
+    item.context = context;
+    item.submittedUs = LatencyStats::nowUs();
+
+    int queued = 0;
+    {
+        QMutexLocker locker(&queue_mutex_);
+        if (!accepting_)
+        {
+            Logger::instance()->error("Report ingest queue is not running, report rejected", "ReportIngest");
+            return false;
+        }
+        // 在报告对组提交线程可见之前计数，否则finish()可能先于add()执行，
+        // 计数变为负数且waitForIdle()收不到唤醒
+        pending_reports_.add();
+        queue_.append(std::move(item));
+        queued = queue_.size();
+    }
+
+    // 只在队列由空变为非空（启动定时器）和达到数量阈值（立即提交）时通知组提交线程
+    if (queued == 1 || queued == max_reports_)
+    {
+        QMetaObject::invokeMethod(thread_.worker<ReportIngestWorker>(), &ReportIngestWorker::schedule, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+bool ReportIngestQueue::waitForIdle(int timeoutMs)
+{
+    return pending_reports_.waitForZero(timeoutMs);
+}
+
+QList<ReportIngestItem> ReportIngestQueue::takeGroup()
+{
+    QMutexLocker locker(&queue_mutex_);
+    if (queue_.size() <= max_reports_)
+    {
+        return std::exchange(queue_, QList<ReportIngestItem>());
+    }
+
+    QList<ReportIngestItem> group;
+    group.reserve(max_reports_);
+    for (int i = 0; i < max_reports_; ++i)
+    {
+        group.append(std::move(queue_[i]));
+    }
+    queue_.remove(0, max_reports_);
+    return group;
+}
+
+qint64 ReportIngestQueue::oldestQueuedUs() const
+{
+    QMutexLocker locker(&queue_mutex_);
+    return queue_.isEmpty() ? -1 : queue_.first().submittedUs;
+}
+
+int ReportIngestQueue::queuedCount() const
+{
+    QMutexLocker locker(&queue_mutex_);
+    return queue_.size();
+}
+
+void ReportIngestQueue::groupFinished(int reports)
+{
+    group_count_.ref();
+    report_count_.fetchAndAddRelaxed(reports);
+    pending_reports_.finish(reports);
+}
@@ -2,6 +2,7 @@
 #include "logger/logger.h"
 #include <QHostAddress>
 #include <QSqlQuery>
+#include <QSqlError>
 #include <QVariant>
 
 ServerDAO::ServerDAO(QObject *parent)
@@ -12,21 +13,32 @@ ServerDAO::ServerDAO(QObject *parent)
 QList<ServerInfo> ServerDAO::getActiveServers()
 {
     QList<ServerInfo> servers;
+    getActiveServers(servers);
 
+    Logger::instance()->info("ServerDAO", QString("Retrieved %1 active servers from database").arg(servers.size()));
+    return servers;
+}
+
+bool ServerDAO::getActiveServers(QList<ServerInfo> &servers)
+{
     QString sql = "SELECT server_id, ip_addr FROM test_server WHERE active = ? ORDER BY server_id";
     QVariantList params;
     params << true;
 
-    QSqlQuery query = executeQuery(sql, params);
+    QueryResult query = executeQuery(sql, params);
+    if (query.lastError().type() != QSqlError::NoError)
+    {
+        Logger::instance()->error(QString("Failed to get active servers: %1").arg(query.lastError().text()), "ServerDAO");
+        return false;
+    }
 
-    // 移除不正确的 isValid() 检查，query.next() 会自动处理空结果集的情况
+    const ServerColumns columns = serverColumns(query);
     while (query.next())
     {
-        servers.append(buildServerInfoFromQuery(query));
+        servers.append(buildServerInfoFromQuery(query, columns));
     }
 
-    Logger::instance()->info("ServerDAO", QString("Retrieved %1 active servers from database").arg(servers.size()));
-    return servers;
+    return true;
 }
 
 ServerInfo ServerDAO::getServerById(int serverId)
@@ -42,11 +54,11 @@ ServerInfo ServerDAO::getServerById(int serverId)
     QVariantList params;
     params << serverId;
 
-    QSqlQuery query = executeQuery(sql, params);
+    QueryResult query = executeQuery(sql, params);
 
     if (query.next())
     {
-        server = buildServerInfoFromQuery(query);
+        server = buildServerInfoFromQuery(query, serverColumns(query));
     }
 
     return server;
@@ -65,11 +77,11 @@ ServerInfo ServerDAO::getServerByLocation(const QString &location)
     QVariantList params;
     params << location;
 
-    QSqlQuery query = executeQuery(sql, params);
+    QueryResult query = executeQuery(sql, params);
 
     if (query.next())
     {
-        server = buildServerInfoFromQuery(query);
+        server = buildServerInfoFromQuery(query, serverColumns(query));
     }
 
     return server;
@@ -81,17 +93,19 @@ QList<ServerInfo> ServerDAO::getAllServers()
 
     QString sql = "SELECT server_id, location, ip_addr FROM test_server ORDER BY server_id";
 
-    QSqlQuery query = executeQuery(sql, {});
+    QueryResult query = executeQuery(sql, {});
 
-    if (!query.isValid())
+    // 执行后定位在第一行之前，isValid()总是false，需要检查错误
+    if (query.lastError().type() != QSqlError::NoError)
     {
         Logger::instance()->error("Failed to get all servers from database", "ServerDAO");
         return servers;
     }
 
+    const ServerColumns columns = serverColumns(query);
     while (query.next())
     {
-        servers.append(buildServerInfoFromQuery(query));
+        servers.append(buildServerInfoFromQuery(query, columns));
     }
 
     return servers;
@@ -118,9 +132,9 @@ bool ServerDAO::addServer(const QString &location, quint32 ipAddr, bool active)
         return false;
     }
 
-    // 使用 INSERT ON DUPLICATE KEY UPDATE 语法来处理 location 唯一约束
-    QString sql = "INSERT INTO test_server (location, ip_addr, active) VALUES (?, ?, ?) "
-                  "ON DUPLICATE KEY UPDATE ip_addr = VALUES(ip_addr), active = VALUES(active)";
+    // 使用插入或更新语法来处理 location 唯一约束
+    QString sql = "INSERT INTO test_server (location, ip_addr, active) VALUES (?, ?, ?) " +
+                  dialect().upsertClause("location", {"ip_addr", "active"});
     QVariantList params;
     params << location << ipAddr << active;
 
@@ -141,12 +155,71 @@ bool ServerDAO::deleteServer(int serverId)
     return executeUpdate(sql, params);
 }
 
-ServerInfo ServerDAO::buildServerInfoFromQuery(const QSqlQuery &query)
+bool ServerDAO::getServerCatalog(QList<ServerCatalogEntry> &servers)
+{
+    QueryResult query = executeQuery("SELECT location, ip_addr, active FROM test_server");
+    if (query.lastError().type() != QSqlError::NoError)
+    {
+        Logger::instance()->error(QString("Failed to get server catalog: %1").arg(query.lastError().text()), "ServerDAO");
+        return false;
+    }
+
+    while (query.next())
+    {
+        ServerCatalogEntry server;
+        server.location = query.value(0).toString();
+        server.ipAddr = query.value(1).toUInt();
+        server.active = query.value(2).toBool();
+        servers.append(server);
+    }
+
+    return true;
+}
+
+bool ServerDAO::upsertServers(const QList<ServerCatalogEntry> &servers, int chunkSize)
+{
+    if (servers.isEmpty())
+    {
+        return true;
+    }
+
+    QList<QVariantList> rows;
+    rows.reserve(servers.size());
+    for (const auto &server : servers)
+    {
+        rows.append({server.location, server.ipAddr, server.active});
+    }
+
+    if (!beginTransaction())
+    {
+        Logger::instance()->error("Failed to begin transaction for server upsert", "ServerDAO");
+        return false;
+    }
+
+    int statements = executeBatchInsert("test_server", {"location", "ip_addr", "active"}, rows, chunkSize,
+                                        dialect().upsertClause("location", {"ip_addr", "active"}));
+    if (statements < 0 || !commitTransaction())
+    {
+        rollbackTransaction();
+        Logger::instance()->error(QString("Failed to upsert %1 servers").arg(servers.size()), "ServerDAO");
+        return false;
+    }
+
+    return true;
+}
+
+ServerDAO::ServerColumns ServerDAO::serverColumns(const QSqlQuery &query)
+{
+    static const std::array<const char *, ServerColumnCount> names = {"server_id", "ip_addr"};
+    return ServerColumns(query, names);
+}
+
+ServerInfo ServerDAO::buildServerInfoFromQuery(const QSqlQuery &query, const ServerColumns &columns)
 {
     ServerInfo server;
 
-    server.serverId = query.value("server_id").toUInt();
-    server.ipAddr = query.value("ip_addr").toUInt();
+    server.serverId = columns.value(query, ServerIdColumn).toUInt();
+    server.ipAddr = columns.value(query, ServerIpColumn).toUInt();
 
     return server;
 }
\ No newline at end of file
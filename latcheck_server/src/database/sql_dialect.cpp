@@ -0,0 +1,75 @@
+#include "database/sql_dialect.h"
+
+DatabaseBackend SqlDialect::parseBackend(const QString &name, bool *ok)
+{
+    QString normalized = name.trimmed().toLower();
+    if (ok)
+    {
+        *ok = true;
+    }
+
+    if (normalized.isEmpty() || normalized == "mysql")
+    {
+        return DatabaseBackend::MySQL;
+    }
+    if (normalized == "sqlite" || normalized == "sqlite3")
+    {
+        return DatabaseBackend::SQLite;
+    }
+
+    if (ok)
+    {
+        *ok = false;
+    }
+    return DatabaseBackend::MySQL;
+}
+
+const char *SqlDialect::backendName(DatabaseBackend backend)
+{
+    switch (backend)
+    {
+    case DatabaseBackend::SQLite:
+        return "sqlite";
+    case DatabaseBackend::MySQL:
+    default:
+        return "mysql";
+    }
+}
+
+QString SqlDialect::driverName() const
+{
+    return isSQLite() ? "QSQLITE" : "QMYSQL";
+}
+
+QString SqlDialect::now() const
+{
+    // SQLite的CURRENT_TIMESTAMP为UTC时间，与MySQL的NOW()保持一致使用本地时间
+    return isSQLite() ? "datetime('now', 'localtime')" : "NOW()";
+}
+
+QString SqlDialect::lastInsertIdQuery() const
+{
+    return isSQLite() ? "SELECT last_insert_rowid()" : "SELECT LAST_INSERT_ID()";
+}
+
+QString SqlDialect::upsertClause(const QString &conflictColumn, const QStringList &updateColumns) const
+{
+    QStringList assignments;
+    for (const QString &column : updateColumns)
+    {
+        assignments.append(isSQLite() ? QString("%1 = excluded.%1").arg(column)
+                                      : QString("%1 = VALUES(%1)").arg(column));
+    }
+
+    if (isSQLite())
+    {
+        return QString("ON CONFLICT(%1) DO UPDATE SET %2").arg(conflictColumn, assignments.join(", "));
+    }
+    return QString("ON DUPLICATE KEY UPDATE %1").arg(assignments.join(", "));
+}
+
+int SqlDialect::maxBindParameters() const
+{
+    // SQLite 3.32之前默认上限为999，按较小值处理
+    return isSQLite() ? 999 : 65535;
+}
@@ -0,0 +1,74 @@
+#include "database/statement_cache.h"
+#include "logger/logger.h"
+
+#include <QSqlError>
+
+StatementCache::StatementCache(const QSqlDatabase &db, int capacity, StatementCacheStats *stats)
+    : db_(db), capacity_(qMax(1, capacity)), stats_(stats), stale_(false)
+{
+}
+
+StatementCache::~StatementCache()
+{
+    index_.clear();
+    entries_.clear();
+}
+
+QSqlQuery *StatementCache::acquire(const QString &sql)
+{
+    if (stale_)
+    {
+        invalidate();
+    }
+
+    auto it = index_.constFind(sql);
+    if (it != index_.constEnd())
+    {
+        // 命中：移到表头
+        entries_.splice(entries_.begin(), entries_, it.value());
+        stats_->hits.ref();
+        return &entries_.front().query;
+    }
+
+    stats_->misses.ref();
+
+    // DAO只用next()顺序读取结果，只向前遍历时驱动不需要缓存已读取的行
+    QSqlQuery query(db_);
+    query.setForwardOnly(true);
+    if (!query.prepare(sql))
+    {
+        Logger::instance()->error(QString("Prepare failed: %1 - %2").arg(sql).arg(query.lastError().text()));
+
+        // 连接已断开时缓存中的语句同样失效
+        if (query.lastError().type() == QSqlError::ConnectionError)
+        {
+            markStale();
+        }
+        return nullptr;
+    }
+
+    // 超出容量时淘汰最久未使用的语句
+    while (static_cast<int>(entries_.size()) >= capacity_)
+    {
+        index_.remove(entries_.back().sql);
+        entries_.pop_back();
+        stats_->evictions.ref();
+    }
+
+    entries_.push_front(Entry{sql, std::move(query)});
+    index_.insert(sql, entries_.begin());
+    return &entries_.front().query;
+}
+
+void StatementCache::invalidate()
+{
+    stale_ = false;
+    if (entries_.empty())
+    {
+        return;
+    }
+
+    index_.clear();
+    entries_.clear();
+    stats_->invalidations.ref();
+}
@@ -29,17 +29,19 @@ User UserDAO::authenticateUser(const QString &username, const QString &passwordH
     QVariantList params;
     params << username << static_cast<int>(UserStatus::Deleted);
 
-    QSqlQuery query = executeQuery(sql, params);
+    QueryResult query = executeQuery(sql, params);
 
     if (query.next())
     {
-        QString storedHash = query.value("password_hash").toString();
-        QString storedSalt = query.value("salt").toString();
+        const UserColumns columns = userColumns(query);
+        QString storedHash = columns.value(query, UserPasswordHashColumn).toString();
+        QString storedSalt = columns.value(query, UserSaltColumn).toString();
 
         // 验证密码哈希和盐值
         if (passwordHash == storedHash && salt == storedSalt)
         {
-            user = buildUserFromQuery(query);
+            user = buildUserFromQuery(query, columns);
+            query.finish();
 
             // 更新最后登录时间
             updateLastLoginTime(user.id);
@@ -78,8 +80,9 @@ ErrorCode UserDAO::createUser(const QString &username, const QString &passwordHa
         return ErrorCode::UserExists;
     }
 
-    QString sql = "INSERT INTO users (username, password_hash, salt, role, status, created_at, updated_at) "
-                  "VALUES (?, ?, ?, ?, ?, NOW(), NOW())";
+    QString sql = QString("INSERT INTO users (username, password_hash, salt, role, status, created_at, updated_at) "
+                          "VALUES (?, ?, ?, ?, ?, %1, %1)")
+                      .arg(dialect().now());
 
     QVariantList params;
     params << username << passwordHash << salt
@@ -110,18 +113,12 @@ User UserDAO::getUserBasicInfo(const QString &username)
     QVariantList params;
     params << username << static_cast<int>(UserStatus::Deleted);
 
-    QSqlQuery query = executeQuery(sql, params);
+    QueryResult query = executeQuery(sql, params);
 
     if (query.next())
     {
-        user.id = query.value("user_id").toLongLong();
-        user.userName = query.value("username").toString();
-        user.role = static_cast<UserRole>(query.value("role").toInt());
-        user.status = static_cast<UserStatus>(query.value("status").toInt());
-        user.createdAt = fromDatabaseTimestamp(query.value("created_at"));
-        user.updatedAt = fromDatabaseTimestamp(query.value("updated_at"));
-        user.lastLoginAt = fromDatabaseTimestamp(query.value("last_login_at"));
-        // 不返回密码相关信息
+        // 查询中不包含密码相关的列，对应字段保持为空
+        user = buildUserFromQuery(query, userColumns(query));
     }
 
     return user;
@@ -134,7 +131,7 @@ ErrorCode UserDAO::updateUserPassword(qint64 userId, const QString &newPasswordH
         return ErrorCode::InvalidParameter;
     }
 
-    QString sql = "UPDATE users SET password_hash = ?, salt = ?, updated_at = NOW() WHERE user_id = ?";
+    QString sql = QString("UPDATE users SET password_hash = ?, salt = ?, updated_at = %1 WHERE user_id = ?").arg(dialect().now());
 
     QVariantList params;
     params << newPasswordHash << newSalt << userId;
@@ -170,14 +167,15 @@ ErrorCode UserDAO::updateUser(const User &user)
         return ErrorCode::UserExists;
     }
 
-    QString sql = "UPDATE users SET username = ?, role = ?, status = ?, updated_at = NOW() "
-                  "WHERE user_id = ?";
+    QString sql = QString("UPDATE users SET username = ?, role = ?, status = ?, updated_at = %1 "
+                          "WHERE user_id = ?")
+                      .arg(dialect().now());
 
     QVariantList params;
     params << user.userName << static_cast<int>(user.role)
            << static_cast<int>(user.status) << user.id;
 
-    QSqlQuery query = executeQuery(sql, params);
+    QueryResult query = executeQuery(sql, params);
 
     if (query.isValid())
     {
@@ -197,7 +195,7 @@ ErrorCode UserDAO::deleteUser(qint64 userId)
     }
 
     // 软删除：更新状态为已删除
-    QString sql = "UPDATE users SET status = ?, updated_at = NOW() WHERE user_id = ?";
+    QString sql = QString("UPDATE users SET status = ?, updated_at = %1 WHERE user_id = ?").arg(dialect().now());
 
     QVariantList params;
     params << static_cast<int>(UserStatus::Deleted) << userId;
@@ -227,11 +225,11 @@ User UserDAO::getUserById(qint64 userId)
     QVariantList params;
     params << userId << static_cast<int>(UserStatus::Deleted);
 
-    QSqlQuery query = executeQuery(sql, params);
+    QueryResult query = executeQuery(sql, params);
 
     if (query.next())
     {
-        user = buildUserFromQuery(query);
+        user = buildUserFromQuery(query, userColumns(query));
     }
 
     return user;
@@ -252,11 +250,11 @@ User UserDAO::getUserByUsername(const QString &username)
     QVariantList params;
     params << username << static_cast<int>(UserStatus::Active);
 
-    QSqlQuery query = executeQuery(sql, params);
+    QueryResult query = executeQuery(sql, params);
 
     if (query.next())
     {
-        user = buildUserFromQuery(query);
+        user = buildUserFromQuery(query, userColumns(query));
     }
 
     return user;
@@ -272,11 +270,12 @@ QList<User> UserDAO::getAllUsers()
     QVariantList params;
     params << static_cast<int>(UserStatus::Deleted);
 
-    QSqlQuery query = executeQuery(sql, params);
+    QueryResult query = executeQuery(sql, params);
 
+    const UserColumns columns = userColumns(query);
     while (query.next())
     {
-        users.append(buildUserFromQuery(query));
+        users.append(buildUserFromQuery(query, columns));
     }
 
     return users;
@@ -289,7 +288,7 @@ ErrorCode UserDAO::updateUserStatus(qint64 userId, UserStatus status)
         return ErrorCode::InvalidParameter;
     }
 
-    QString sql = "UPDATE users SET status = ?, updated_at = NOW() WHERE user_id = ?";
+    QString sql = QString("UPDATE users SET status = ?, updated_at = %1 WHERE user_id = ?").arg(dialect().now());
 
     QVariantList params;
     params << static_cast<int>(status) << userId;
@@ -332,7 +331,7 @@ ErrorCode UserDAO::updateLastLoginTime(qint64 userId)
         return ErrorCode::InvalidParameter;
     }
 
-    QString sql = "UPDATE users SET last_login_at = NOW() WHERE user_id = ?";
+    QString sql = QString("UPDATE users SET last_login_at = %1 WHERE user_id = ?").arg(dialect().now());
 
     QVariantList params;
     params << userId;
@@ -357,7 +356,7 @@ bool UserDAO::isUsernameExists(const QString &username)
     QVariantList params;
     params << username << static_cast<int>(UserStatus::Deleted);
 
-    QSqlQuery query = executeQuery(sql, params);
+    QueryResult query = executeQuery(sql, params);
 
     if (query.next())
     {
@@ -374,7 +373,7 @@ int UserDAO::getUserCount()
     QVariantList params;
     params << static_cast<int>(UserStatus::Deleted);
 
-    QSqlQuery query = executeQuery(sql, params);
+    QueryResult query = executeQuery(sql, params);
 
     if (query.next())
     {
@@ -384,18 +383,26 @@ int UserDAO::getUserCount()
     return 0;
 }
 
-User UserDAO::buildUserFromQuery(const QSqlQuery &query)
+UserDAO::UserColumns UserDAO::userColumns(const QSqlQuery &query)
+{
+    static const std::array<const char *, UserColumnCount> names = {
+        "user_id", "username", "password_hash", "salt", "role",
+        "status", "created_at", "updated_at", "last_login_at"};
+    return UserColumns(query, names);
+}
+
+User UserDAO::buildUserFromQuery(const QSqlQuery &query, const UserColumns &columns)
 {
     User user;
-    user.id = query.value("user_id").toLongLong();
-    user.userName = query.value("username").toString();
-    user.passwordHash = query.value("password_hash").toString();
-    user.salt = query.value("salt").toString();
-    user.role = static_cast<UserRole>(query.value("role").toInt());
-    user.status = static_cast<UserStatus>(query.value("status").toInt());
-    user.createdAt = fromDatabaseTimestamp(query.value("created_at"));
-    user.updatedAt = fromDatabaseTimestamp(query.value("updated_at"));
-    user.lastLoginAt = fromDatabaseTimestamp(query.value("last_login_at"));
+    user.id = columns.value(query, UserIdColumn).toLongLong();
+    user.userName = columns.value(query, UserNameColumn).toString();
+    user.passwordHash = columns.value(query, UserPasswordHashColumn).toString();
+    user.salt = columns.value(query, UserSaltColumn).toString();
+    user.role = static_cast<UserRole>(columns.value(query, UserRoleColumn).toInt());
+    user.status = static_cast<UserStatus>(columns.value(query, UserStatusColumn).toInt());
+    user.createdAt = fromDatabaseTimestamp(columns.value(query, UserCreatedAtColumn));
+    user.updatedAt = fromDatabaseTimestamp(columns.value(query, UserUpdatedAtColumn));
+    user.lastLoginAt = fromDatabaseTimestamp(columns.value(query, UserLastLoginAtColumn));
 
     return user;
 }
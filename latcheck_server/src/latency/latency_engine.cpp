@@ -0,0 +1,216 @@
+#include "latency/latency_engine.h"
+#include "common/latency_histogram.h"
+#include "logger/logger.h"
+
+#include <QMutexLocker>
+#include <QSet>
+#include <utility>
+
+LatencyEngineWorker::LatencyEngineWorker(LatencyEngine *engine, QObject *parent)
+    : ThreadWorker(parent), engine_(engine)
+{
+}
+
+LatencyEngineWorker::~LatencyEngineWorker()
+{
+}
+
+void LatencyEngineWorker::start()
+{
+    report_dao_ = std::make_unique<ReportDAO>();
+    calculated_dao_ = std::make_unique<CalculatedLatencyDAO>();
+
+    loadFromDatabase();
+
+    // 加载期间提交的报告
+    process();
+}
+
+void LatencyEngineWorker::stop()
+{
+    process();
+
+    report_dao_.reset();
+    calculated_dao_.reset();
+
+    Logger::instance()->debug("Latency engine worker stopped", "LatencyEngine");
+}
+
+void LatencyEngineWorker::process()
+{
+    if (!report_dao_)
+    {
+        return;
+    }
+
+    QHash<QString, LatencyEngine::PendingReport> pending = engine_->takePending();
+    for (auto it = pending.begin(); it != pending.end(); ++it)
+    {
+        applyReport(it.key(), it->reportId, it->records);
+        engine_->pending_reports_.deref();
+    }
+}
+
+void LatencyEngineWorker::loadFromDatabase()
+{
+    qint64 startUs = LatencyStats::nowUs();
+
+    // 清理上次退出前未替换的地点对
+    calculated_dao_->deleteStalePairs();
+    QSet<qint64> withPairs = calculated_dao_->getReportsWithPairs();
+
+    // 已有地点对的地点直接加载；其余地点（报告已入库但地点对未写入）按报告顺序补算，
+    // 每个补算的地点只与已加载的地点配对，因此每个地点对只写入一次
+    QList<Report> latest = report_dao_->getLatestReportPerLocation();
+    QList<Report> missing;
+    for (const Report &report : std::as_const(latest))
+    {
+        if (withPairs.contains(report.id))
+        {
+            engine_->matrix_.setLocation(report.location, report.id, report_dao_->getReportRecords(report.id));
+        }
+        else
+        {
+            missing.append(report);
+        }
+    }
+
+    for (const Report &report : std::as_const(missing))
+    {
+        applyReport(report.location, report.id, report_dao_->getReportRecords(report.id));
+    }
+
+    const LatencyMatrix &matrix = engine_->matrix_;
+    engine_->location_count_.storeRelaxed(matrix.locationCount());
+    Logger::instance()->info(QString("Latency engine loaded %1 locations x %2 servers (%3 recalculated, %4 KB, %5 kernel) in %6 ms")
+                                 .arg(matrix.locationCount())
+                                 .arg(matrix.serverCount())
+                                 .arg(missing.size())
+                                 .arg(matrix.memoryBytes() / 1024)
+                                 .arg(LatencyMatrix::kernelName())
+                                 .arg((LatencyStats::nowUs() - startUs) / 1000),
+                             "LatencyEngine");
+}
+
+void LatencyEngineWorker::applyReport(const QString &location, qint64 reportId, const QList<ReportRecord> &records)
+{
+    qint64 startUs = LatencyStats::nowUs();
+
+    qint64 replacedReportId = 0;
+    if (!engine_->matrix_.setLocation(location, reportId, records, &replacedReportId))
+    {
+        return;
+    }
+    QList<LocationPairLatency> pairs = engine_->matrix_.pairsFor(location);
+    qint64 computedUs = LatencyStats::nowUs();
+
+    if (!calculated_dao_->replacePairs(replacedReportId, pairs))
+    {
+        // 内存中的向量已更新，下次启动时该地点会因缺少地点对而重新计算
+        engine_->failures_.ref();
+    }
+
+    engine_->location_count_.storeRelaxed(engine_->matrix_.locationCount());
+    engine_->update_count_.ref();
+    engine_->pair_updates_.fetchAndAddRelaxed(pairs.size());
+
+    Logger::instance()->debug(QString("Updated %1 location pairs for %2 (report %3): compute %4us, write %5us")
+                                  .arg(pairs.size())
+                                  .arg(location)
+                                  .arg(reportId)
+                                  .arg(computedUs - startUs)
+                                  .arg(LatencyStats::nowUs() - computedUs),
+                              "LatencyEngine");
+}
+
+LatencyEngine::LatencyEngine(QObject *parent)
+    : QObject(parent), accepting_(false),
+      location_count_(0), pending_reports_(0), update_count_(0), pair_updates_(0), failures_(0)
+{
+}
+
+LatencyEngine::~LatencyEngine()
+{
+    stop();
+}
+
+bool LatencyEngine::start()
+{
+    if (isRunning())
+    {
+        Logger::instance()->warning("Latency engine already started", "LatencyEngine");
+        return true;
+    }
+
+    thread_.start("latency-engine", new LatencyEngineWorker(this));
+
+    {
+        QMutexLocker locker(&pending_mutex_);
+        accepting_ = true;
+    }
+
+    Logger::instance()->info("Latency engine started", "LatencyEngine");
+    return true;
+}
+
+void LatencyEngine::stop()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&pending_mutex_);
+        accepting_ = false;
+    }
+
+    thread_.stop();
+
+    Logger::instance()->info(QString("Latency engine stopped (%1 updates, %2 pairs written)")
+                                 .arg(getUpdateCount())
+                                 .arg(getPairUpdates()),
+                             "LatencyEngine");
+}
+
+bool LatencyEngine::isRunning() const
+{
+    return thread_.isRunning();
+}
+
+void LatencyEngine::submitReport(const QString &location, qint64 reportId, const QList<ReportRecord> &records)
+{
+    bool notify = false;
+    {
+        QMutexLocker locker(&pending_mutex_);
+        if (!accepting_)
+        {
+            return;
+        }
+
+        auto it = pending_.find(location);
+        if (it == pending_.end())
+        {
+            pending_.insert(location, PendingReport{reportId, records});
+            pending_reports_.ref();
+            notify = pending_.size() == 1;
+        }
+        else if (reportId > it->reportId)
+        {
+            // 同一地点只保留最新报告
+            *it = PendingReport{reportId, records};
+        }
+    }
+
+    // 只在队列由空变为非空时通知计算线程
+    if (notify)
+    {
+        QMetaObject::invokeMethod(thread_.worker<LatencyEngineWorker>(), &LatencyEngineWorker::process, Qt::QueuedConnection);
+    }
+}
+
+QHash<QString, LatencyEngine::PendingReport> LatencyEngine::takePending()
+{
+    QMutexLocker locker(&pending_mutex_);
+    return std::exchange(pending_, QHash<QString, PendingReport>());
+}
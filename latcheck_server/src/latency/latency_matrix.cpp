@@ -0,0 +1,450 @@
+#include "latency/latency_matrix.h"
+
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QtAlgorithms>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LATCHECK_MATRIX_SSE2 1
+#endif
+
+#if defined(LATCHECK_MATRIX_SSE2) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define LATCHECK_MATRIX_AVX2 1
+#endif
+
+namespace
+{
+    // 行宽对齐的单元格数，保证每个计算实现都按完整的向量处理
+    const int kRowAlignment = 32;
+
+    using MinPairSumFn = quint16 (*)(const quint16 *, const quint16 *, int);
+
+    quint16 minPairSumScalar(const quint16 *a, const quint16 *b, int n)
+    {
+        // 无效单元格为0x7FFF，与任意值相加都不小于初始值，不需要单独判断
+        int best = LatencyMatrix::kInvalidCell;
+        for (int i = 0; i < n; ++i)
+        {
+            int sum = a[i] + b[i];
+            if (sum < best)
+            {
+                best = sum;
+            }
+        }
+        return static_cast<quint16>(best);
+    }
+
+#ifdef LATCHECK_MATRIX_SSE2
+    quint16 horizontalMin(__m128i v)
+    {
+        v = _mm_min_epi16(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm_min_epi16(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+        v = _mm_min_epi16(v, _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return static_cast<quint16>(_mm_extract_epi16(v, 0));
+    }
+
+    quint16 minPairSumSse2(const quint16 *a, const quint16 *b, int n)
+    {
+        // 有效延时之和不超过19998，饱和加法使含无效单元格的和停在0x7FFF，有符号最小值即可
+        __m128i best0 = _mm_set1_epi16(static_cast<short>(LatencyMatrix::kInvalidCell));
+        __m128i best1 = best0;
+        __m128i best2 = best0;
+        __m128i best3 = best0;
+        for (int i = 0; i < n; i += 32)
+        {
+            const __m128i *pa = reinterpret_cast<const __m128i *>(a + i);
+            const __m128i *pb = reinterpret_cast<const __m128i *>(b + i);
+            best0 = _mm_min_epi16(best0, _mm_adds_epi16(_mm_loadu_si128(pa), _mm_loadu_si128(pb)));
+            best1 = _mm_min_epi16(best1, _mm_adds_epi16(_mm_loadu_si128(pa + 1), _mm_loadu_si128(pb + 1)));
+            best2 = _mm_min_epi16(best2, _mm_adds_epi16(_mm_loadu_si128(pa + 2), _mm_loadu_si128(pb + 2)));
+            best3 = _mm_min_epi16(best3, _mm_adds_epi16(_mm_loadu_si128(pa + 3), _mm_loadu_si128(pb + 3)));
+        }
+        return horizontalMin(_mm_min_epi16(_mm_min_epi16(best0, best1), _mm_min_epi16(best2, best3)));
+    }
+#endif
+
+#ifdef LATCHECK_MATRIX_AVX2
+    __attribute__((target("avx2"))) quint16 minPairSumAvx2(const quint16 *a, const quint16 *b, int n)
+    {
+        __m256i best0 = _mm256_set1_epi16(static_cast<short>(LatencyMatrix::kInvalidCell));
+        __m256i best1 = best0;
+        for (int i = 0; i < n; i += 32)
+        {
+            const __m256i *pa = reinterpret_cast<const __m256i *>(a + i);
+            const __m256i *pb = reinterpret_cast<const __m256i *>(b + i);
+            best0 = _mm256_min_epi16(best0, _mm256_adds_epi16(_mm256_loadu_si256(pa), _mm256_loadu_si256(pb)));
+            best1 = _mm256_min_epi16(best1, _mm256_adds_epi16(_mm256_loadu_si256(pa + 1), _mm256_loadu_si256(pb + 1)));
+        }
+        __m256i best = _mm256_min_epi16(best0, best1);
+        return horizontalMin(_mm_min_epi16(_mm256_castsi256_si128(best), _mm256_extracti128_si256(best, 1)));
+    }
+#endif
+
+    struct Kernel
+    {
+        MinPairSumFn fn;
+        const char *name;
+    };
+
+    Kernel selectKernel()
+    {
+#ifdef LATCHECK_MATRIX_AVX2
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return {minPairSumAvx2, "avx2"};
+        }
+#endif
+#ifdef LATCHECK_MATRIX_SSE2
+        return {minPairSumSse2, "sse2"};
+#else
+        return {minPairSumScalar, "scalar"};
+#endif
+    }
+
+    const Kernel &kernel()
+    {
+        static const Kernel selected = selectKernel();
+        return selected;
+    }
+}
+
+LatencyMatrix::LatencyMatrix()
+    : stride_(0), bitmap_words_(0)
+{
+}
+
+const char *LatencyMatrix::kernelName()
+{
+    return kernel().name;
+}
+
+quint16 LatencyMatrix::minPairSum(const quint16 *a, const quint16 *b, int n)
+{
+    return kernel().fn(a, b, n);
+}
+
+bool LatencyMatrix::setLocation(const QString &location, qint64 reportId, const QList<ReportRecord> &records,
+                                qint64 *replacedReportId)
+{
+    QWriteLocker locker(&lock_);
+
+    auto it = rows_.constFind(location);
+    if (it != rows_.constEnd() && reportId <= row_info_[it.value()].reportId)
+    {
+        return false;
+    }
+
+    // 先登记新服务器（可能重新分配行宽），再写入本行
+    for (const auto &record : records)
+    {
+        if (record.latency >= 0 && record.latency < kUnreachableLatency)
+        {
+            columnFor(record.serverId);
+        }
+    }
+
+    int row = rowFor(location);
+    if (replacedReportId)
+    {
+        *replacedReportId = row_info_[row].reportId;
+    }
+    row_info_[row].reportId = reportId;
+
+    quint16 *cells = cells_.data() + static_cast<size_t>(row) * stride_;
+    quint64 *valid = valid_.data() + static_cast<size_t>(row) * bitmap_words_;
+    std::fill(cells, cells + stride_, kInvalidCell);
+    std::fill(valid, valid + bitmap_words_, 0);
+
+    for (const auto &record : records)
+    {
+        if (record.latency < 0 || record.latency >= kUnreachableLatency)
+        {
+            continue;
+        }
+
+        // 同一服务器重复出现时取最小值
+        int column = columns_.value(record.serverId);
+        cells[column] = std::min(cells[column], static_cast<quint16>(record.latency));
+        valid[column / 64] |= quint64(1) << (column % 64);
+    }
+
+    return true;
+}
+
+int LatencyMatrix::rowFor(const QString &location)
+{
+    auto it = rows_.constFind(location);
+    if (it != rows_.constEnd())
+    {
+        return it.value();
+    }
+
+    int row = static_cast<int>(row_info_.size());
+    row_info_.push_back(Row{location, 0});
+    rows_.insert(location, row);
+    cells_.resize(cells_.size() + stride_, kInvalidCell);
+    valid_.resize(valid_.size() + bitmap_words_, 0);
+    return row;
+}
+
+int LatencyMatrix::columnFor(quint32 serverId)
+{
+    auto it = columns_.constFind(serverId);
+    if (it != columns_.constEnd())
+    {
+        return it.value();
+    }
+
+    int column = static_cast<int>(column_servers_.size());
+    reserveColumns(column + 1);
+    column_servers_.push_back(serverId);
+    columns_.insert(serverId, column);
+    return column;
+}
+
+void LatencyMatrix::reserveColumns(int columns)
+{
+    if (columns <= stride_)
+    {
+        return;
+    }
+
+    int stride = std::max(kRowAlignment, stride_);
+    while (stride < columns)
+    {
+        stride *= 2;
+    }
+    int bitmapWords = (stride + 63) / 64;
+
+    size_t rowCount = row_info_.size();
+    std::vector<quint16> cells(rowCount * stride, kInvalidCell);
+    std::vector<quint64> valid(rowCount * bitmapWords, 0);
+    for (size_t row = 0; row < rowCount; ++row)
+    {
+        std::copy_n(cells_.data() + row * stride_, stride_, cells.data() + row * stride);
+        std::copy_n(valid_.data() + row * bitmap_words_, bitmap_words_, valid.data() + row * bitmapWords);
+    }
+
+    cells_.swap(cells);
+    valid_.swap(valid);
+    stride_ = stride;
+    bitmap_words_ = bitmapWords;
+}
+
+bool LatencyMatrix::pairAt(int row1, int row2, LocationPairLatency &result) const
+{
+    quint16 best = minPairSum(cellsOf(row1), cellsOf(row2), stride_);
+    if (best >= kInvalidCell)
+    {
+        return false;
+    }
+
+    result.serverId = bestServerAt(row1, row2, best);
+    qint64 report1 = row_info_[row1].reportId;
+    qint64 report2 = row_info_[row2].reportId;
+    result.report1 = std::min(report1, report2);
+    result.report2 = std::max(report1, report2);
+    result.latency = best;
+    return true;
+}
+
+quint32 LatencyMatrix::bestServerAt(int row1, int row2, quint16 best) const
+{
+    // 取得最小值的服务器：只有找到最小值的地点对才需要再扫描一次
+    const quint16 *a = cellsOf(row1);
+    const quint16 *b = cellsOf(row2);
+    int columns = static_cast<int>(column_servers_.size());
+    for (int column = 0; column < columns; ++column)
+    {
+        if (a[column] + b[column] == best)
+        {
+            return column_servers_[column];
+        }
+    }
+    return 0;
+}
+
+bool LatencyMatrix::pairLatency(const QString &location1, const QString &location2, LocationPairLatency &result) const
+{
+    QReadLocker locker(&lock_);
+
+    auto it1 = rows_.constFind(location1);
+    auto it2 = rows_.constFind(location2);
+    if (it1 == rows_.constEnd() || it2 == rows_.constEnd() || it1.value() == it2.value())
+    {
+        return false;
+    }
+
+    return pairAt(it1.value(), it2.value(), result);
+}
+
+QList<LocationPairLatency> LatencyMatrix::pairsFor(const QString &location) const
+{
+    QReadLocker locker(&lock_);
+
+    QList<LocationPairLatency> pairs;
+    auto it = rows_.constFind(location);
+    if (it == rows_.constEnd())
+    {
+        return pairs;
+    }
+
+    int self = it.value();
+    int rowCount = static_cast<int>(row_info_.size());
+    pairs.reserve(rowCount - 1);
+    for (int row = 0; row < rowCount; ++row)
+    {
+        LocationPairLatency pair;
+        if (row != self && pairAt(self, row, pair))
+        {
+            pairs.append(pair);
+        }
+    }
+
+    return pairs;
+}
+
+QList<LatencySample> LatencyMatrix::validSamples(int row) const
+{
+    QList<LatencySample> samples;
+    const quint16 *cells = cellsOf(row);
+    const quint64 *valid = validOf(row);
+    for (int word = 0; word < bitmap_words_; ++word)
+    {
+        for (quint64 bits = valid[word]; bits != 0; bits &= bits - 1)
+        {
+            int column = word * 64 + static_cast<int>(qCountTrailingZeroBits(bits));
+            samples.append(LatencySample{column_servers_[column], cells[column]});
+        }
+    }
+    return samples;
+}
+
+QList<LatencySample> LatencyMatrix::samplesOf(const QString &location) const
+{
+    QReadLocker locker(&lock_);
+
+    auto it = rows_.constFind(location);
+    if (it == rows_.constEnd())
+    {
+        return QList<LatencySample>();
+    }
+
+    QList<LatencySample> samples = validSamples(it.value());
+    std::sort(samples.begin(), samples.end(), [](const LatencySample &a, const LatencySample &b)
+              { return a.serverId < b.serverId; });
+    return samples;
+}
+
+QList<LatencySample> LatencyMatrix::bestServers(const QString &location, int k) const
+{
+    QReadLocker locker(&lock_);
+
+    auto it = rows_.constFind(location);
+    if (it == rows_.constEnd() || k <= 0)
+    {
+        return QList<LatencySample>();
+    }
+
+    QList<LatencySample> samples = validSamples(it.value());
+    auto byLatency = [](const LatencySample &a, const LatencySample &b)
+    { return a.latency != b.latency ? a.latency < b.latency : a.serverId < b.serverId; };
+
+    int count = std::min(k, static_cast<int>(samples.size()));
+    std::partial_sort(samples.begin(), samples.begin() + count, samples.end(), byLatency);
+    samples.resize(count);
+    return samples;
+}
+
+QList<LocationDistance> LatencyMatrix::nearestLocations(const QString &location, int k) const
+{
+    QReadLocker locker(&lock_);
+
+    QList<LocationDistance> result;
+    auto it = rows_.constFind(location);
+    if (it == rows_.constEnd() || k <= 0)
+    {
+        return result;
+    }
+
+    // 大顶堆保存当前最近的k个地点，堆顶为其中最远的一个
+    struct Candidate
+    {
+        quint16 latency;
+        int row;
+        bool operator<(const Candidate &other) const
+        {
+            return latency != other.latency ? latency < other.latency : row < other.row;
+        }
+    };
+
+    int self = it.value();
+    const quint16 *cells = cellsOf(self);
+    int rowCount = static_cast<int>(row_info_.size());
+    std::vector<Candidate> heap;
+    heap.reserve(std::min(k, rowCount) + 1);
+    for (int row = 0; row < rowCount; ++row)
+    {
+        if (row == self)
+        {
+            continue;
+        }
+
+        Candidate candidate{minPairSum(cells, cellsOf(row), stride_), row};
+        if (candidate.latency >= kInvalidCell)
+        {
+            continue;
+        }
+
+        if (static_cast<int>(heap.size()) < k)
+        {
+            heap.push_back(candidate);
+            std::push_heap(heap.begin(), heap.end());
+        }
+        else if (candidate < heap.front())
+        {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = candidate;
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end());
+    result.reserve(static_cast<int>(heap.size()));
+    for (const Candidate &candidate : heap)
+    {
+        const Row &row = row_info_[candidate.row];
+        result.append(LocationDistance{row.location, row.reportId, candidate.latency,
+                                       bestServerAt(self, candidate.row, candidate.latency)});
+    }
+
+    return result;
+}
+
+qint64 LatencyMatrix::reportIdOf(const QString &location) const
+{
+    QReadLocker locker(&lock_);
+    auto it = rows_.constFind(location);
+    return it == rows_.constEnd() ? 0 : row_info_[it.value()].reportId;
+}
+
+int LatencyMatrix::locationCount() const
+{
+    QReadLocker locker(&lock_);
+    return static_cast<int>(row_info_.size());
+}
+
+int LatencyMatrix::serverCount() const
+{
+    QReadLocker locker(&lock_);
+    return static_cast<int>(column_servers_.size());
+}
+
+qint64 LatencyMatrix::memoryBytes() const
+{
+    QReadLocker locker(&lock_);
+    return static_cast<qint64>(cells_.capacity() * sizeof(quint16) + valid_.capacity() * sizeof(quint64));
+}
@@ -0,0 +1,134 @@
+#include "protocol/frame_buffer.h"
+
+#include <QtEndian>
+#include <cstring>
+
+FrameBuffer::FrameBuffer(qsizetype limit)
+    : read_pos_(0), write_pos_(0), limit_(qMax(limit, HeaderSize))
+{
+}
+
+void FrameBuffer::setLimit(qsizetype limit)
+{
+    limit_ = qMax(limit, HeaderSize);
+}
+
+qint64 FrameBuffer::readFrom(QIODevice *device)
+{
+    if (!device)
+    {
+        return -1;
+    }
+
+    qint64 available = device->bytesAvailable();
+    qsizetype want = static_cast<qsizetype>(qMin<qint64>(available, freeSpace()));
+    if (want <= 0)
+    {
+        return 0;
+    }
+
+    reserveTail(want);
+
+    qint64 bytesRead = device->read(storage_.data() + write_pos_, want);
+    if (bytesRead > 0)
+    {
+        write_pos_ += bytesRead;
+    }
+    return bytesRead;
+}
+
+bool FrameBuffer::append(const char *data, qsizetype len)
+{
+    if (len <= 0)
+    {
+        return true;
+    }
+    if (len > freeSpace())
+    {
+        return false;
+    }
+
+    reserveTail(len);
+    memcpy(storage_.data() + write_pos_, data, len);
+    write_pos_ += len;
+    return true;
+}
+
+FrameBuffer::FrameStatus FrameBuffer::peekFrame(MessageHeader &header, QByteArrayView &payload) const
+{
+    if (size() < HeaderSize)
+    {
+        return FrameStatus::Incomplete;
+    }
+
+    // 原地解码消息头（网络字节序）
+    const uchar *ptr = reinterpret_cast<const uchar *>(storage_.constData() + read_pos_);
+    header.msgType = qFromBigEndian<quint32>(ptr);
+    header.dataLength = qFromBigEndian<quint32>(ptr + 4);
+
+    // 在缓冲有效载荷之前检查帧长度
+    if (static_cast<quint64>(header.dataLength) + HeaderSize > static_cast<quint64>(limit_))
+    {
+        return FrameStatus::TooLarge;
+    }
+
+    qsizetype totalSize = HeaderSize + static_cast<qsizetype>(header.dataLength);
+    if (size() < totalSize)
+    {
+        return FrameStatus::Incomplete;
+    }
+
+    payload = QByteArrayView(storage_.constData() + read_pos_ + HeaderSize, header.dataLength);
+    return FrameStatus::Ready;
+}
+
+void FrameBuffer::consume(qsizetype len)
+{
+    read_pos_ = qMin(read_pos_ + len, write_pos_);
+
+    // 数据全部消费后游标归零，后续写入无需搬移
+    if (read_pos_ == write_pos_)
+    {
+        read_pos_ = 0;
+        write_pos_ = 0;
+    }
+}
+
+void FrameBuffer::clear()
+{
+    read_pos_ = 0;
+    write_pos_ = 0;
+}
+
+void FrameBuffer::reserveTail(qsizetype len)
+{
+    if (storage_.size() - write_pos_ >= len)
+    {
+        return;
+    }
+
+    // 先将未读数据前移，回收已消费的空间
+    qsizetype pending = size();
+    if (read_pos_ > 0)
+    {
+        if (pending > 0)
+        {
+            memmove(storage_.data(), storage_.constData() + read_pos_, pending);
+        }
+        read_pos_ = 0;
+        write_pos_ = pending;
+    }
+
+    if (storage_.size() - write_pos_ >= len)
+    {
+        return;
+    }
+
+    // 按倍数扩容，不超过上限
+    qsizetype capacity = qMax(storage_.size(), InitialCapacity);
+    while (capacity < write_pos_ + len)
+    {
+        capacity *= 2;
+    }
+    storage_.resize(qMin(capacity, qMax(limit_, write_pos_ + len)));
+}
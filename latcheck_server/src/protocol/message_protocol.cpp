@@ -22,7 +22,54 @@ QByteArray MessageProtocol::serializeHeader(const MessageHeader &header)
 
     return data;
 }
-MessageHeader MessageProtocol::deserializeHeader(const QByteArray &data)
+const char *MessageProtocol::messageTypeName(quint32 msgType)
+{
+    switch (static_cast<MessageType>(msgType))
+    {
+    case MessageType::LOGIN_REQUEST:
+        return "LOGIN_REQUEST";
+    case MessageType::LOGIN_OK:
+        return "LOGIN_OK";
+    case MessageType::LOGIN_FAIL:
+        return "LOGIN_FAIL";
+    case MessageType::LIST_REQUEST:
+        return "LIST_REQUEST";
+    case MessageType::LIST_RESPONSE:
+        return "LIST_RESPONSE";
+    case MessageType::REPORT_REQUEST:
+        return "REPORT_REQUEST";
+    case MessageType::REPORT_OK:
+        return "REPORT_OK";
+    case MessageType::REPORT_FAIL:
+        return "REPORT_FAIL";
+    case MessageType::CHANGE_PASSWORD_REQUEST:
+        return "CHANGE_PASSWORD_REQUEST";
+    case MessageType::CHANGE_PASSWORD_RESPONSE:
+        return "CHANGE_PASSWORD_RESPONSE";
+    case MessageType::LIST_DELTA_REQUEST:
+        return "LIST_DELTA_REQUEST";
+    case MessageType::LIST_DELTA_RESPONSE:
+        return "LIST_DELTA_RESPONSE";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+void MessageProtocol::appendMessage(QByteArray &out, MessageType type, QByteArrayView payload)
+{
+    qsizetype offset = out.size();
+    out.resize(offset + 8 + payload.size());
+
+    uchar *ptr = reinterpret_cast<uchar *>(out.data() + offset);
+    qToBigEndian<quint32>(static_cast<quint32>(type), ptr);
+    qToBigEndian<quint32>(static_cast<quint32>(payload.size()), ptr + 4);
+    if (!payload.isEmpty())
+    {
+        memcpy(ptr + 8, payload.data(), payload.size());
+    }
+}
+
+MessageHeader MessageProtocol::deserializeHeader(QByteArrayView data)
 {
     MessageHeader header;
     if (data.size() < 8)
@@ -31,9 +78,9 @@ MessageHeader MessageProtocol::deserializeHeader(const QByteArray &data)
         return header;
     }
 
-    QDataStream stream(data);
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream >> header.msgType >> header.dataLength;
+    const uchar *ptr = reinterpret_cast<const uchar *>(data.data());
+    header.msgType = qFromBigEndian<quint32>(ptr);
+    header.dataLength = qFromBigEndian<quint32>(ptr + 4);
 
     return header;
 }
@@ -58,7 +105,7 @@ QByteArray MessageProtocol::serializeLoginRequest(const QString &userName, const
     return data;
 }
 
-LoginRequestData MessageProtocol::deserializeLoginRequest(const QByteArray &data)
+LoginRequestData MessageProtocol::deserializeLoginRequest(QByteArrayView data)
 {
     LoginRequestData loginData;
 
@@ -79,27 +126,31 @@ LoginRequestData MessageProtocol::deserializeLoginRequest(const QByteArray &data
 
 QByteArray MessageProtocol::serializeListResponse(const QList<ServerInfo> &servers)
 {
-    QByteArray data;
-    QDataStream stream(&data, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
+    // 长度已知，一次分配后直接写入
+    QByteArray data(4 + servers.size() * 8, Qt::Uninitialized);
+    uchar *ptr = reinterpret_cast<uchar *>(data.data());
 
     // 写入服务器数量
-    stream << static_cast<quint32>(servers.size());
+    qToBigEndian<quint32>(static_cast<quint32>(servers.size()), ptr);
+    ptr += 4;
 
     // 写入每个服务器信息（只包含serverId和ipAddr）
     for (const ServerInfo &server : servers)
     {
-        stream << server.serverId;
-        stream << server.ipAddr;
+        qToBigEndian<quint32>(server.serverId, ptr);
+        qToBigEndian<quint32>(server.ipAddr, ptr + 4);
+        ptr += 8;
     }
 
     return data;
 }
 
-ListResponseData MessageProtocol::deserializeListResponse(const QByteArray &data)
+ListResponseData MessageProtocol::deserializeListResponse(QByteArrayView data)
 {
     ListResponseData response;
-    QDataStream stream(data);
+    // fromRawData不复制数据，仅包装视图供QDataStream读取
+    QByteArray raw = QByteArray::fromRawData(data.data(), data.size());
+    QDataStream stream(raw);
     stream.setByteOrder(QDataStream::BigEndian);
 
     // 读取服务器数量
@@ -118,6 +169,134 @@ ListResponseData MessageProtocol::deserializeListResponse(const QByteArray &data
     return response;
 }
 
+QByteArray MessageProtocol::serializeListDeltaRequest(quint64 catalogVersion)
+{
+    QByteArray data(8, Qt::Uninitialized);
+    qToBigEndian<quint64>(catalogVersion, data.data());
+    return data;
+}
+
+ListDeltaRequestData MessageProtocol::deserializeListDeltaRequest(QByteArrayView data)
+{
+    ListDeltaRequestData request;
+    if (data.size() >= 8)
+    {
+        request.catalogVersion = qFromBigEndian<quint64>(data.data());
+    }
+    return request;
+}
+
+QByteArray MessageProtocol::serializeListDeltaResponse(quint64 catalogVersion, ListDeltaKind kind,
+                                                       const QList<quint32> &removedIds, const QList<ServerInfo> &servers)
+{
+    qsizetype size = 12;
+    if (kind == ListDeltaKind::Delta)
+    {
+        size += 4 + removedIds.size() * 4;
+    }
+    if (kind != ListDeltaKind::NotModified)
+    {
+        size += 4 + servers.size() * 8;
+    }
+
+    QByteArray data(size, Qt::Uninitialized);
+    uchar *ptr = reinterpret_cast<uchar *>(data.data());
+
+    // 写入目录版本和响应类型
+    qToBigEndian<quint64>(catalogVersion, ptr);
+    qToBigEndian<quint32>(static_cast<quint32>(kind), ptr + 8);
+    ptr += 12;
+
+    // 写入删除的服务器ID
+    if (kind == ListDeltaKind::Delta)
+    {
+        qToBigEndian<quint32>(static_cast<quint32>(removedIds.size()), ptr);
+        ptr += 4;
+        for (quint32 serverId : removedIds)
+        {
+            qToBigEndian<quint32>(serverId, ptr);
+            ptr += 4;
+        }
+    }
+
+    // 写入新增或变化的服务器（Full为完整列表，格式与LIST_RESPONSE相同）
+    if (kind != ListDeltaKind::NotModified)
+    {
+        qToBigEndian<quint32>(static_cast<quint32>(servers.size()), ptr);
+        ptr += 4;
+        for (const ServerInfo &server : servers)
+        {
+            qToBigEndian<quint32>(server.serverId, ptr);
+            qToBigEndian<quint32>(server.ipAddr, ptr + 4);
+            ptr += 8;
+        }
+    }
+
+    return data;
+}
+
+ListDeltaResponseData MessageProtocol::deserializeListDeltaResponse(QByteArrayView data)
+{
+    ListDeltaResponseData response;
+    if (data.size() < 12)
+    {
+        return response;
+    }
+
+    const uchar *ptr = reinterpret_cast<const uchar *>(data.data());
+    const uchar *end = ptr + data.size();
+    quint64 catalogVersion = qFromBigEndian<quint64>(ptr);
+    quint32 kind = qFromBigEndian<quint32>(ptr + 8);
+    ptr += 12;
+
+    if (kind == static_cast<quint32>(ListDeltaKind::Delta))
+    {
+        if (end - ptr < 4)
+        {
+            return response;
+        }
+        quint32 removedCount = qFromBigEndian<quint32>(ptr);
+        ptr += 4;
+        if (static_cast<quint64>(end - ptr) < static_cast<quint64>(removedCount) * 4)
+        {
+            return response;
+        }
+        response.removedIds.reserve(removedCount);
+        for (quint32 i = 0; i < removedCount; ++i, ptr += 4)
+        {
+            response.removedIds.append(qFromBigEndian<quint32>(ptr));
+        }
+    }
+    else if (kind != static_cast<quint32>(ListDeltaKind::Full))
+    {
+        response.catalogVersion = catalogVersion;
+        return response;
+    }
+
+    // 读取新增或变化的服务器
+    if (end - ptr < 4)
+    {
+        response.removedIds.clear();
+        return response;
+    }
+    quint32 serverCount = qFromBigEndian<quint32>(ptr);
+    ptr += 4;
+    if (static_cast<quint64>(end - ptr) < static_cast<quint64>(serverCount) * 8)
+    {
+        response.removedIds.clear();
+        return response;
+    }
+    response.servers.reserve(serverCount);
+    for (quint32 i = 0; i < serverCount; ++i, ptr += 8)
+    {
+        response.servers.append(ServerInfo(qFromBigEndian<quint32>(ptr), qFromBigEndian<quint32>(ptr + 4)));
+    }
+
+    response.catalogVersion = catalogVersion;
+    response.kind = static_cast<ListDeltaKind>(kind);
+    return response;
+}
+
 QByteArray MessageProtocol::serializeReportRequest(const QString &location, const QList<LatencyRecord> &records)
 {
     QByteArray data;
@@ -147,7 +326,7 @@ QByteArray MessageProtocol::serializeReportRequest(const QString &location, cons
 
     return data;
 }
-ReportRequestData MessageProtocol::deserializeReportRequest(const QByteArray &data)
+ReportRequestData MessageProtocol::deserializeReportRequest(QByteArrayView data)
 {
     ReportRequestData reportData;
     // 检查数据长度是否足够（128字节位置信息 + 4字节记录数量 + 至少0条记录）
@@ -156,17 +335,15 @@ ReportRequestData MessageProtocol::deserializeReportRequest(const QByteArray &da
         return reportData;
     }
 
-    QDataStream stream(data);
-    stream.setByteOrder(QDataStream::BigEndian);
+    const uchar *ptr = reinterpret_cast<const uchar *>(data.data());
 
     // 读取128字节位置信息
-    char locationBuffer[LOCATION_LEN] = {0};
-    stream.readRawData(locationBuffer, sizeof(locationBuffer));
-    // 复制到结构体的location数组中
-    memcpy(reportData.location, locationBuffer, sizeof(locationBuffer));
+    memcpy(reportData.location, ptr, LOCATION_LEN);
+    ptr += LOCATION_LEN;
 
     // 读取记录数量
-    stream >> reportData.recordCount;
+    reportData.recordCount = qFromBigEndian<quint32>(ptr);
+    ptr += 4;
 
     // 安全检查：确保记录数量不会导致缓冲区溢出
     const quint32 maxAllowedRecords = 1000; // 根据实际需求调整此值
@@ -178,18 +355,18 @@ ReportRequestData MessageProtocol::deserializeReportRequest(const QByteArray &da
 
     // 检查剩余数据是否足够解析所有记录
     quint32 expectedRecordBytes = reportData.recordCount * 8; // 每条记录8字节（serverId和latency各4字节）
-    if (stream.device()->bytesAvailable() < expectedRecordBytes)
+    if (data.size() - (LOCATION_LEN + 4) < static_cast<qsizetype>(expectedRecordBytes))
     {
         reportData.recordCount = 0;
         return reportData;
     }
 
-    // 读取延时记录
-    for (quint32 i = 0; i < reportData.recordCount; ++i)
+    // 直接从载荷中读取延时记录
+    reportData.records.reserve(reportData.recordCount);
+    for (quint32 i = 0; i < reportData.recordCount; ++i, ptr += 8)
     {
-        LatencyRecord record;
-        stream >> record.serverId >> record.latency;
-        reportData.records.append(record);
+        reportData.records.append(LatencyRecord(qFromBigEndian<quint32>(ptr),
+                                                qFromBigEndian<quint32>(ptr + 4)));
     }
 
     return reportData;
@@ -199,7 +376,7 @@ bool MessageProtocol::validateHeader(const MessageHeader &header)
 {
     // 验证消息类型
     if (header.msgType < static_cast<quint32>(MessageType::LOGIN_REQUEST) ||
-        header.msgType > static_cast<quint32>(MessageType::REPORT_FAIL))
+        header.msgType > static_cast<quint32>(MessageType::LIST_DELTA_RESPONSE))
     {
         return false;
     }
@@ -239,7 +416,7 @@ QByteArray MessageProtocol::serializeChangePasswordRequest(const QString &userNa
 }
 
 // 修复第一处：deserializeChangePasswordRequest方法中的类型比较
-ChangePasswordRequestData MessageProtocol::deserializeChangePasswordRequest(const QByteArray &data)
+ChangePasswordRequestData MessageProtocol::deserializeChangePasswordRequest(QByteArrayView data)
 {
     ChangePasswordRequestData requestData;
     if (data.size() >= static_cast<qsizetype>(sizeof(ChangePasswordRequestData)))
@@ -263,7 +440,7 @@ QByteArray MessageProtocol::serializeChangePasswordResponse(quint32 resultCode)
 }
 
 // 修复第二处：deserializeChangePasswordResponse方法中的类型比较
-ChangePasswordResponseData MessageProtocol::deserializeChangePasswordResponse(const QByteArray &data)
+ChangePasswordResponseData MessageProtocol::deserializeChangePasswordResponse(QByteArrayView data)
 {
     ChangePasswordResponseData responseData;
     if (data.size() < static_cast<qsizetype>(sizeof(quint32)))
@@ -271,9 +448,7 @@ ChangePasswordResponseData MessageProtocol::deserializeChangePasswordResponse(co
         return responseData;
     }
 
-    QDataStream stream(data);
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream >> responseData.resultCode;
+    responseData.resultCode = qFromBigEndian<quint32>(data.data());
 
     return responseData;
 }
@@ -302,6 +477,10 @@ QString MessageProtocol::getMessageTypeString(MessageType type)
         return "CHANGE_PASSWORD_REQUEST";
     case MessageType::CHANGE_PASSWORD_RESPONSE:
         return "CHANGE_PASSWORD_RESPONSE";
+    case MessageType::LIST_DELTA_REQUEST:
+        return "LIST_DELTA_REQUEST";
+    case MessageType::LIST_DELTA_RESPONSE:
+        return "LIST_DELTA_RESPONSE";
     default:
         return "UNKNOWN";
     }
@@ -0,0 +1,199 @@
+#include "server/admission_controller.h"
+
+#include <QHashFunctions>
+#include <QRandomGenerator>
+#include <QtEndian>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+AdmissionController::AdmissionController(const AdmissionSettings &settings)
+    : settings_(settings),
+      set_mask_(0),
+      hash_seed_(QRandomGenerator::global()->generate()),
+      pending_handshakes_(0),
+      accept_queue_depth_(0)
+{
+    for (auto &counter : counters_)
+    {
+        counter.storeRelaxed(0);
+    }
+
+    // 组数取不超过配置的2的幂，表大小在运行期间固定
+    quint32 sets = 1;
+    while (static_cast<qint64>(sets) * 2 * Ways <= qMax(settings_.ipTableSize, Ways))
+    {
+        sets *= 2;
+    }
+    set_mask_ = sets - 1;
+    buckets_.resize(static_cast<size_t>(sets) * Ways);
+
+    clock_.start();
+}
+
+AdmissionResult AdmissionController::admit(qintptr socketDescriptor, int connectionCount, QHostAddress *peerAddress)
+{
+    // 先检查全局限制，代价最低
+    if (settings_.acceptQueueHighWatermark > 0 &&
+        accept_queue_depth_.loadRelaxed() >= settings_.acceptQueueHighWatermark)
+    {
+        return reject(AdmissionResult::AcceptQueueFull);
+    }
+
+    if (settings_.maxConnections > 0 && connectionCount >= settings_.maxConnections)
+    {
+        return reject(AdmissionResult::MaxConnections);
+    }
+
+    if (settings_.maxPendingHandshakes > 0 &&
+        pending_handshakes_.loadRelaxed() >= settings_.maxPendingHandshakes)
+    {
+        return reject(AdmissionResult::HandshakeLimit);
+    }
+
+    quint64 keyHigh = 0;
+    quint64 keyLow = 0;
+    bool hasPeer = peerKey(socketDescriptor, keyHigh, keyLow, peerAddress);
+
+    // 对端已断开时无法取得地址，交给工作线程按普通连接失败处理
+    if (hasPeer && settings_.perIpRate > 0.0 && !takeToken(keyHigh, keyLow))
+    {
+        return reject(AdmissionResult::RateLimited);
+    }
+
+    // 只有接入线程增加计数，检查之后再增加不会超过上限
+    pending_handshakes_.ref();
+    accept_queue_depth_.ref();
+    counters_[static_cast<int>(AdmissionResult::Accepted)].ref();
+    return AdmissionResult::Accepted;
+}
+
+AdmissionResult AdmissionController::reject(AdmissionResult result)
+{
+    counters_[static_cast<int>(result)].ref();
+    return result;
+}
+
+void AdmissionController::closeDescriptor(qintptr socketDescriptor)
+{
+    if (socketDescriptor >= 0)
+    {
+        ::close(static_cast<int>(socketDescriptor));
+    }
+}
+
+const char *AdmissionController::resultName(AdmissionResult result)
+{
+    switch (result)
+    {
+    case AdmissionResult::Accepted:
+        return "accepted";
+    case AdmissionResult::AcceptQueueFull:
+        return "accept queue full";
+    case AdmissionResult::MaxConnections:
+        return "max connections reached";
+    case AdmissionResult::HandshakeLimit:
+        return "too many pending handshakes";
+    case AdmissionResult::RateLimited:
+        return "per-IP rate limit exceeded";
+    default:
+        return "unknown";
+    }
+}
+
+quint64 AdmissionController::getRejectedCount(AdmissionResult result) const
+{
+    int index = static_cast<int>(result);
+    if (index <= 0 || index >= static_cast<int>(AdmissionResult::ResultCount))
+    {
+        return 0;
+    }
+    return counters_[index].loadRelaxed();
+}
+
+quint64 AdmissionController::getRejectedTotal() const
+{
+    quint64 total = 0;
+    for (int i = 1; i < static_cast<int>(AdmissionResult::ResultCount); ++i)
+    {
+        total += counters_[i].loadRelaxed();
+    }
+    return total;
+}
+
+bool AdmissionController::peerKey(qintptr socketDescriptor, quint64 &keyHigh, quint64 &keyLow, QHostAddress *peerAddress)
+{
+    sockaddr_storage storage;
+    socklen_t length = sizeof(storage);
+    memset(&storage, 0, sizeof(storage));
+    if (::getpeername(static_cast<int>(socketDescriptor), reinterpret_cast<sockaddr *>(&storage), &length) != 0)
+    {
+        return false;
+    }
+
+    if (storage.ss_family == AF_INET)
+    {
+        // IPv4地址按::ffff:a.b.c.d处理，与IPv4映射的IPv6连接共用令牌桶
+        const sockaddr_in *addr = reinterpret_cast<const sockaddr_in *>(&storage);
+        keyHigh = 0;
+        keyLow = Q_UINT64_C(0x0000ffff00000000) | qFromBigEndian<quint32>(&addr->sin_addr.s_addr);
+    }
+    else if (storage.ss_family == AF_INET6)
+    {
+        const sockaddr_in6 *addr = reinterpret_cast<const sockaddr_in6 *>(&storage);
+        keyHigh = qFromBigEndian<quint64>(addr->sin6_addr.s6_addr);
+        keyLow = qFromBigEndian<quint64>(addr->sin6_addr.s6_addr + 8);
+    }
+    else
+    {
+        return false;
+    }
+
+    if (peerAddress)
+    {
+        peerAddress->setAddress(reinterpret_cast<const sockaddr *>(&storage));
+    }
+    return true;
+}
+
+bool AdmissionController::takeToken(quint64 keyHigh, quint64 keyLow)
+{
+    qint64 now = clock_.elapsed();
+    double burst = qMax(1, settings_.perIpBurst);
+
+    quint64 key[2] = {keyHigh, keyLow};
+    quint32 set = static_cast<quint32>(qHashBits(key, sizeof(key), hash_seed_)) & set_mask_;
+    Bucket *bucketSet = &buckets_[static_cast<size_t>(set) * Ways];
+
+    Bucket *victim = nullptr;
+    for (int i = 0; i < Ways; ++i)
+    {
+        Bucket &bucket = bucketSet[i];
+        if (bucket.used && bucket.keyHigh == keyHigh && bucket.keyLow == keyLow)
+        {
+            // 按经过的时间补充令牌
+            bucket.tokens = qMin(burst, bucket.tokens + (now - bucket.lastMs) * settings_.perIpRate / 1000.0);
+            bucket.lastMs = now;
+            if (bucket.tokens < 1.0)
+            {
+                return false;
+            }
+            bucket.tokens -= 1.0;
+            return true;
+        }
+
+        // 优先使用空条目，否则淘汰最久未使用的条目
+        if (!victim || (victim->used && (!bucket.used || bucket.lastMs < victim->lastMs)))
+        {
+            victim = &bucket;
+        }
+    }
+
+    victim->keyHigh = keyHigh;
+    victim->keyLow = keyLow;
+    victim->lastMs = now;
+    victim->tokens = burst - 1.0;
+    victim->used = true;
+    return true;
+}
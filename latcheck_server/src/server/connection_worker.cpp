@@ -0,0 +1,540 @@
+#include "server/connection_worker.h"
+#include "server/tls_server.h"
+#include "logger/logger.h"
+#include "protocol/message_protocol.h"
+
+#include <QSslSocket>
+#include <QSslCipher>
+#include <QHostAddress>
+#include <QTimer>
+
+// 会话序号，用于在异步请求完成时识别会话（socket地址可能被复用）
+static QAtomicInteger<quint64> nextSessionId(1);
+
+ConnectionWorker::ConnectionWorker(TlsServer *server, int index, QObject *parent)
+    : QObject(parent),
+      server_(server),
+      index_(index),
+      tick_timer_(new QTimer(this)),
+      connection_count_(0),
+      authenticated_count_(0),
+      response_count_(0),
+      write_count_(0)
+{
+    // 设置时间轮刻度定时器（随worker一起移动到工作线程）
+    tick_timer_->setInterval(timing_wheel_.tickMs());
+    connect(tick_timer_, &QTimer::timeout, this, &ConnectionWorker::onTick);
+}
+
+ConnectionWorker::~ConnectionWorker()
+{
+    qDeleteAll(clients_);
+    clients_.clear();
+}
+
+void ConnectionWorker::start()
+{
+    tick_timer_->start();
+    Logger::instance()->debug(QString("Connection worker %1 started").arg(index_));
+}
+
+void ConnectionWorker::shutdown()
+{
+    tick_timer_->stop();
+
+    // 断开所有客户端连接
+    for (auto it = clients_.begin(); it != clients_.end(); ++it)
+    {
+        ClientSession *session = it.value();
+        releaseHandshake(session);
+        if (session->socket)
+        {
+            session->socket->disconnect(this);
+            session->socket->disconnectFromHost();
+            session->socket->deleteLater();
+        }
+        delete session;
+    }
+    clients_.clear();
+
+    connection_count_.storeRelaxed(0);
+    authenticated_count_.storeRelaxed(0);
+}
+
+void ConnectionWorker::addConnection(qintptr socketDescriptor)
+{
+    // 描述符已离开接入队列
+    server_->admission_->dispatched();
+
+    QSslSocket *sslSocket = new QSslSocket(this);
+    if (!sslSocket->setSocketDescriptor(socketDescriptor))
+    {
+        Logger::instance()->error("Failed to set socket descriptor");
+        delete sslSocket;
+        AdmissionController::closeDescriptor(socketDescriptor);
+        server_->admission_->handshakeFinished();
+        connection_count_.deref();
+        return;
+    }
+
+    // 获取并记录客户端连接信息
+    QString clientIp = sslSocket->peerAddress().toString();
+    quint16 clientPort = sslSocket->peerPort();
+    Logger::instance()->info(
+        QString("New incoming connection: %1:%2 (worker: %3, total connections: %4)")
+            .arg(clientIp)
+            .arg(clientPort)
+            .arg(index_)
+            .arg(server_->getConnectionCount()));
+
+    // 创建会话
+    ClientSession *session = new ClientSession();
+    session->socket = sslSocket;
+    session->worker = this;
+    session->sessionId = nextSessionId.fetchAndAddRelaxed(1);
+    session->connectTime = QDateTime::currentDateTime();
+    session->state = ClientState::Connected;
+    session->buffer.setLimit(server_->session_buffer_limit_);
+    session->handshakePending = true; // 接入时已占用握手名额
+    clients_.insert(sslSocket, session);
+
+    // 限制socket内部的解密数据缓冲，超出部分留在内核中形成背压
+    sslSocket->setReadBufferSize(server_->session_buffer_limit_);
+
+    // 登录超时和空闲超时登记到本线程的时间轮
+    session->authTimer.callback = [this, session]()
+    { onAuthTimeout(session); };
+    session->idleTimer.callback = [this, session]()
+    { onIdleTimeout(session); };
+    timing_wheel_.schedule(&session->authTimer, server_->auth_timeout_ * 1000LL);
+    timing_wheel_.schedule(&session->idleTimer, server_->connection_timeout_ * 1000LL);
+
+    // 设置SSL连接信号和槽
+    connect(sslSocket, &QSslSocket::encrypted, this, &ConnectionWorker::onSslReady);
+    connect(sslSocket, &QSslSocket::readyRead, this, &ConnectionWorker::onDataReceived);
+    connect(sslSocket, &QSslSocket::disconnected, this, &ConnectionWorker::onClientDisconnected);
+    connect(sslSocket, QOverload<const QList<QSslError> &>::of(&QSslSocket::sslErrors),
+            this, &ConnectionWorker::onSslErrors);
+
+    // 配置SSL并启动握手，作用域内创建的SSL对象会挂接到会话复用缓存
+    {
+        TlsSessionCache::Scope scope(server_->session_cache_.get());
+        sslSocket->setSslConfiguration(server_->ssl_config_);
+        sslSocket->startServerEncryption(); // 关键：启动SSL服务器端握手
+        session->sslHandle = scope.sslHandle();
+    }
+
+    Logger::instance()->debug(
+        QString("SSL handshake initiated for session: %1:%2")
+            .arg(clientIp)
+            .arg(clientPort));
+}
+
+void ConnectionWorker::markAuthenticated(ClientSession *session)
+{
+    if (!session || session->isAuthenticated)
+    {
+        return;
+    }
+
+    session->state = ClientState::Authenticated;
+    session->isAuthenticated = true;
+    authenticated_count_.ref();
+
+    // 登录成功后取消登录超时
+    timing_wheel_.cancel(&session->authTimer);
+}
+
+void ConnectionWorker::refreshIdleTimeout(ClientSession *session)
+{
+    timing_wheel_.schedule(&session->idleTimer, server_->connection_timeout_ * 1000LL);
+}
+
+void ConnectionWorker::onClientDisconnected()
+{
+    QSslSocket *socket = qobject_cast<QSslSocket *>(sender());
+    if (!socket)
+        return;
+
+    ClientSession *session = clients_.take(socket);
+
+    if (session)
+    {
+        // 握手未完成就断开时归还握手名额
+        releaseHandshake(session);
+
+        QString clientIp = socket->peerAddress().toString();
+        quint16 clientPort = socket->peerPort();
+        QString userName = session->userName.isEmpty() ? "(unauthenticated)" : session->userName;
+
+        if (session->isAuthenticated)
+        {
+            authenticated_count_.deref();
+        }
+        connection_count_.deref();
+
+        Logger::instance()->info(
+            QString("Client disconnected: %1:%2 (user: %3, total connections: %4)")
+                .arg(clientIp)
+                .arg(clientPort)
+                .arg(userName)
+                .arg(server_->getConnectionCount()));
+
+        delete session;
+    }
+
+    socket->deleteLater();
+}
+
+void ConnectionWorker::releaseHandshake(ClientSession *session)
+{
+    if (session->handshakePending)
+    {
+        session->handshakePending = false;
+        server_->admission_->handshakeFinished();
+    }
+}
+
+void ConnectionWorker::onTick()
+{
+    timing_wheel_.advance();
+}
+
+void ConnectionWorker::onAuthTimeout(ClientSession *session)
+{
+    // 到期的会话断开后由onClientDisconnected统一释放
+    Logger::instance()->warning(
+        QString("Authentication timeout for session from %1")
+            .arg(session->socket->peerAddress().toString()));
+    session->socket->disconnectFromHost();
+}
+
+void ConnectionWorker::onIdleTimeout(ClientSession *session)
+{
+    Logger::instance()->info(
+        QString("Connection timeout for user: %1").arg(session->userName));
+    session->socket->disconnectFromHost();
+}
+
+// 修改onSslReady方法以添加更多调试信息
+void ConnectionWorker::onSslReady()
+{
+    QSslSocket *socket = qobject_cast<QSslSocket *>(sender());
+    if (!socket)
+    {
+        return;
+    }
+
+    ClientSession *session = findSessionBySocket(socket);
+    if (!session)
+    {
+        return;
+    }
+
+    releaseHandshake(session);
+
+    // SSL握手完成信息记录
+    QString clientIp = socket->peerAddress().toString();
+    quint16 clientPort = socket->peerPort();
+    QString protocol = server_->getSslProtocolName(socket);
+    QSslCipher cipher = socket->sessionCipher();
+
+    // 验证客户端证书
+    if (server_->config_manager_ && server_->config_manager_->getRequireClientCert())
+    {
+        if (!server_->validateClientSubject(socket))
+        {
+            Logger::instance()->warning(QString("Client certificate validation failed: %1:%2").arg(clientIp).arg(clientPort));
+            socket->disconnectFromHost();
+            return;
+        }
+    }
+
+    // 记录本次握手是完整握手还是会话复用
+    bool resumed = false;
+    if (server_->session_cache_ && session->sslHandle)
+    {
+        resumed = server_->session_cache_->recordHandshake(session->sslHandle);
+    }
+
+    Logger::instance()->info(
+        QString("Client connected - SSL handshake completed: %1:%2, Protocol: %3, Cipher: %4, Handshake: %5")
+            .arg(clientIp)
+            .arg(clientPort)
+            .arg(protocol)
+            .arg(cipher.name())
+            .arg(resumed ? "resumed" : "full"));
+
+    if (server_->session_cache_)
+    {
+        Logger::instance()->debug(
+            QString("TLS handshakes: %1 full, %2 resumed, session cache: %3 entries, %4 hits, %5 misses")
+                .arg(server_->session_cache_->getFullHandshakes())
+                .arg(server_->session_cache_->getResumedHandshakes())
+                .arg(server_->session_cache_->getCachedSessionCount())
+                .arg(server_->session_cache_->getCacheHits())
+                .arg(server_->session_cache_->getCacheMisses()));
+    }
+
+    // 添加调试信息，确认socket处于可读状态
+    if (socket->bytesAvailable() > 0)
+    {
+        Logger::instance()->debug(
+            QString("Data already available after SSL handshake: %1 bytes")
+                .arg(socket->bytesAvailable()));
+    }
+}
+
+// 改进onDataReceived方法的错误处理和日志记录
+void ConnectionWorker::onDataReceived()
+{
+    QSslSocket *socket = qobject_cast<QSslSocket *>(sender());
+    if (!socket)
+    {
+        Logger::instance()->error("onDataReceived: Invalid socket");
+        return;
+    }
+
+    ClientSession *session = findSessionBySocket(socket);
+    if (!session)
+    {
+        Logger::instance()->error("onDataReceived: Session not found");
+        socket->disconnectFromHost();
+        return;
+    }
+
+    // 确保socket有效且可读
+    if (!socket->isValid() || !socket->isReadable())
+    {
+        Logger::instance()->error("onDataReceived: Socket is not valid or readable");
+        return;
+    }
+
+    server_->updateClientActivity(session); // 每次收到数据都更新活动时间
+
+    processBuffer(session);
+}
+
+void ConnectionWorker::processBuffer(ClientSession *session)
+{
+    QSslSocket *socket = session->socket;
+    session->corked = true;
+    qint64 bytesReceived = 0;
+
+    // 处理消息；会话有数据库请求未完成时暂停，保证同一会话内请求按序处理，
+    // 此时未读取的数据留在socket中，恢复处理后再继续读取
+    while (!session->requestInFlight)
+    {
+        MessageHeader header;
+        QByteArrayView payload;
+        FrameBuffer::FrameStatus status = session->buffer.peekFrame(header, payload);
+
+        if (status == FrameBuffer::FrameStatus::TooLarge)
+        {
+            // 在缓冲有效载荷之前拒绝超长消息
+            Logger::instance()->warning(
+                QString("Message too large from %1:%2 (type=%3, dataLength=%4, limit=%5), closing connection")
+                    .arg(socket->peerAddress().toString())
+                    .arg(socket->peerPort())
+                    .arg(header.msgType)
+                    .arg(header.dataLength)
+                    .arg(session->buffer.limit()));
+            session->buffer.clear();
+            flushResponses(session);
+            socket->disconnectFromHost();
+            return;
+        }
+
+        if (status == FrameBuffer::FrameStatus::Incomplete)
+        {
+            // 数据不足一帧，直接从socket读入缓冲区尾部
+            qint64 bytesRead = session->buffer.readFrom(socket);
+            if (bytesRead <= 0)
+            {
+                break;
+            }
+
+            bytesReceived += bytesRead;
+            continue;
+        }
+
+        Logger::instance()->debug(
+            QString("Message header: type=%1, dataLength=%2, totalSize=%3")
+                .arg(header.msgType)
+                .arg(header.dataLength)
+                .arg(FrameBuffer::HeaderSize + header.dataLength));
+
+        // 有效载荷以视图形式交给处理函数，处理完成后再消费
+        try
+        {
+            server_->processMessage(session, header, payload);
+        }
+        catch (const std::exception &e)
+        {
+            Logger::instance()->error(
+                QString("Error processing message: %1").arg(e.what()));
+            // 出现严重错误，清空缓冲区并断开连接
+            session->buffer.clear();
+            flushResponses(session);
+            socket->disconnectFromHost();
+            return;
+        }
+        catch (...)
+        {
+            Logger::instance()->error("Unknown error processing message");
+            session->buffer.clear();
+            flushResponses(session);
+            socket->disconnectFromHost();
+            return;
+        }
+
+        session->buffer.consume(FrameBuffer::HeaderSize + header.dataLength);
+    }
+
+    // 每次处理只记录一次本次读取的总量，不在读取循环中格式化日志
+    if (bytesReceived > 0)
+    {
+        Logger::instance()->debug(
+            QString("Data received from %1:%2 (size: %3 bytes)")
+                .arg(socket->peerAddress().toString())
+                .arg(socket->peerPort())
+                .arg(bytesReceived));
+    }
+
+    flushResponses(session);
+}
+
+void ConnectionWorker::queueResponse(ClientSession *session, MessageType type, QByteArrayView data)
+{
+    qint64 startUs = LatencyStats::nowUs();
+    MessageProtocol::appendMessage(session->outBuffer, type, data);
+    response_count_.ref();
+    LatencyStats::instance()->record(session->requestType, LatencyStage::Serialize, LatencyStats::nowUs() - startUs);
+
+    if (!session->corked)
+    {
+        flushResponses(session);
+    }
+}
+
+void ConnectionWorker::flushResponses(ClientSession *session)
+{
+    session->corked = false;
+    if (session->outBuffer.isEmpty())
+    {
+        return;
+    }
+
+    QSslSocket *socket = session->socket;
+    if (socket && socket->state() == QAbstractSocket::ConnectedState)
+    {
+        // 按指针写入，socket复制数据后发送缓冲区可以继续复用
+        qint64 startUs = LatencyStats::nowUs();
+        socket->write(session->outBuffer.constData(), session->outBuffer.size());
+        write_count_.ref();
+        LatencyStats::instance()->record(session->requestType, LatencyStage::Write, LatencyStats::nowUs() - startUs);
+    }
+
+    // 保留容量，避免每次响应重新分配
+    session->outBuffer.resize(0);
+}
+
+void ConnectionWorker::resumeSession(ClientSession *session)
+{
+    session->requestInFlight = false;
+
+    // 继续处理请求完成前已到达的消息
+    if (session->socket && session->socket->state() == QAbstractSocket::ConnectedState)
+    {
+        processBuffer(session);
+    }
+    else
+    {
+        flushResponses(session);
+    }
+}
+
+ClientSession *ConnectionWorker::findSession(QSslSocket *socket, quint64 sessionId)
+{
+    ClientSession *session = clients_.value(socket, nullptr);
+    if (!session || session->sessionId != sessionId)
+    {
+        return nullptr;
+    }
+    return session;
+}
+
+// 修改onSslErrors方法，智能区分不同类型的SSL错误
+void ConnectionWorker::onSslErrors(const QList<QSslError> &errors)
+{
+    QSslSocket *socket = qobject_cast<QSslSocket *>(sender());
+    if (!socket)
+    {
+        return;
+    }
+
+    // 记录所有SSL错误
+    bool hasCriticalError = false;
+    bool hasCertificateError = false;
+
+    for (const QSslError &error : errors)
+    {
+        Logger::instance()->warning(
+            QString("SSL Error: %1(%2)").arg(error.error()).arg(error.errorString()));
+
+        // 检查是否是与证书相关的错误
+        if (error.error() == QSslError::SelfSignedCertificate ||
+            error.error() == QSslError::SelfSignedCertificateInChain ||
+            error.error() == QSslError::InvalidCaCertificate ||
+            error.error() == QSslError::CertificateUntrusted ||
+            error.error() == QSslError::CertificateRevoked ||
+            error.error() == QSslError::InvalidPurpose ||
+            error.error() == QSslError::CertificateExpired ||
+            error.error() == QSslError::CertificateNotYetValid ||
+            error.error() == QSslError::HostNameMismatch ||
+            error.error() == QSslError::NoPeerCertificate ||
+            error.error() == QSslError::UnableToGetLocalIssuerCertificate ||
+            error.error() == QSslError::UnableToVerifyFirstCertificate)
+        {
+
+            hasCertificateError = true;
+
+            // 标记关键证书错误
+            if (error.error() == QSslError::NoPeerCertificate ||
+                error.error() == QSslError::CertificateExpired ||
+                error.error() == QSslError::CertificateNotYetValid ||
+                error.error() == QSslError::CertificateUntrusted ||
+                error.error() == QSslError::CertificateRevoked)
+            {
+                hasCriticalError = true;
+            }
+        }
+    }
+    QString clientIp = socket->peerAddress().toString();
+    quint16 clientPort = socket->peerPort();
+
+    // 检查是否需要客户端证书
+    if (server_->config_manager_ && server_->config_manager_->getRequireClientCert())
+    {
+
+        // 对于需要客户端证书的情况，只在关键证书验证错误时断开连接
+        if (hasCriticalError || hasCertificateError)
+        {
+            Logger::instance()->warning(QString("Client certificate validation failed, closing connection:%1:%2").arg(clientIp).arg(clientPort));
+            socket->disconnectFromHost();
+            return;
+        }
+        if (!server_->validateClientSubject(socket))
+        {
+            Logger::instance()->warning(QString("Client subject validation failed: %1:%2").arg(clientIp).arg(clientPort));
+            socket->disconnectFromHost();
+            return;
+        }
+    }
+    socket->ignoreSslErrors(); // 忽略错误，继续握手
+}
+
+ClientSession *ConnectionWorker::findSessionBySocket(QSslSocket *socket)
+{
+    return clients_.value(socket, nullptr);
+}
@@ -0,0 +1,582 @@
+#include "server/metrics_server.h"
+#include "server/tls_server.h"
+#include "server/tls_session_cache.h"
+#include "server/admission_controller.h"
+#include "database/database_pool.h"
+#include "database/db_executor.h"
+#include "database/report_ingest_queue.h"
+#include "latency/latency_engine.h"
+#include "catalog/server_catalog.h"
+#include "common/latency_histogram.h"
+#include "protocol/message_protocol.h"
+#include "logger/logger.h"
+
+#include <QHostAddress>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QUrlQuery>
+#include <QTimer>
+
+namespace
+{
+// 直方图导出的桶边界（微秒）
+const quint64 kHistogramBoundsUs[] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+    100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000};
+
+void appendMetricHeader(QByteArray &out, const char *name, const char *type, const char *help)
+{
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+template <typename T>
+void appendSample(QByteArray &out, const char *name, const QByteArray &labels, T value)
+{
+    out += name;
+    if (!labels.isEmpty())
+    {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += QByteArray::number(value);
+    out += '\n';
+}
+
+// 桶边界标签（取值固定，短格式即可）
+QByteArray secondsLabel(quint64 us)
+{
+    return QByteArray::number(static_cast<double>(us) / 1000000.0, 'g', 6);
+}
+
+// 累计值（_sum）：由整数微秒直接格式化为秒，不损失精度，rate()在累计值很大时仍然平滑
+QByteArray secondsValue(quint64 us)
+{
+    QByteArray fraction = QByteArray::number(us % 1000000);
+    return QByteArray::number(us / 1000000) + '.' + QByteArray(6 - fraction.size(), '0') + fraction;
+}
+} // namespace
+
+MetricsServer::MetricsServer(TlsServer *tlsServer, DatabasePool *dbPool, QObject *parent)
+    : QObject(parent),
+      tls_server_(tlsServer),
+      db_pool_(dbPool),
+      server_(new QTcpServer(this)),
+      start_time_(QDateTime::currentDateTime())
+{
+    connect(server_, &QTcpServer::newConnection, this, &MetricsServer::onNewConnection);
+}
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+bool MetricsServer::start(const MetricsConfig &config)
+{
+    QHostAddress address(config.host);
+    if (address.isNull() || !address.isLoopback())
+    {
+        Logger::instance()->error(
+            QString("Metrics endpoint must listen on a loopback address, got: %1").arg(config.host),
+            "MetricsServer");
+        return false;
+    }
+
+    if (!server_->listen(address, static_cast<quint16>(config.port)))
+    {
+        Logger::instance()->error(
+            QString("Failed to start metrics endpoint on %1:%2 - %3")
+                .arg(config.host)
+                .arg(config.port)
+                .arg(server_->errorString()),
+            "MetricsServer");
+        return false;
+    }
+
+    Logger::instance()->info(
+        QString("Metrics endpoint listening on http://%1:%2 (/health, /metrics, /stats)")
+            .arg(config.host)
+            .arg(config.port),
+        "MetricsServer");
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    if (server_->isListening())
+    {
+        server_->close();
+    }
+
+    for (auto it = pending_.begin(); it != pending_.end(); ++it)
+    {
+        it.key()->disconnect(this);
+        it.key()->abort();
+        it.key()->deleteLater();
+    }
+    pending_.clear();
+}
+
+void MetricsServer::onNewConnection()
+{
+    while (QTcpSocket *socket = server_->nextPendingConnection())
+    {
+        pending_.insert(socket, QByteArray());
+        connect(socket, &QTcpSocket::readyRead, this, &MetricsServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, &MetricsServer::onDisconnected);
+
+        // 请求在超时时间内未读完则断开
+        QTimer::singleShot(RequestTimeoutMs, socket, [socket]()
+                           { socket->abort(); });
+    }
+}
+
+void MetricsServer::onReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    auto it = pending_.find(socket);
+    if (!socket || it == pending_.end())
+    {
+        return;
+    }
+
+    it.value() += socket->readAll();
+    QByteArray &request = it.value();
+
+    int headerEnd = request.indexOf("\r\n\r\n");
+    if (headerEnd < 0)
+    {
+        if (request.size() > MaxRequestSize)
+        {
+            socket->write(httpResponse(431, "Request Header Fields Too Large", "text/plain", "request too large\n"));
+            pending_.erase(it);
+            socket->disconnectFromHost();
+        }
+        return;
+    }
+
+    // 只解析请求行：METHOD PATH VERSION
+    QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+    QByteArray response;
+    if (requestLine.size() < 2)
+    {
+        response = httpResponse(400, "Bad Request", "text/plain", "bad request\n");
+    }
+    else
+    {
+        QByteArray path = requestLine.at(1);
+        QByteArray query;
+        int queryStart = path.indexOf('?');
+        if (queryStart >= 0)
+        {
+            query = path.mid(queryStart + 1);
+            path.truncate(queryStart);
+        }
+        response = handleRequest(requestLine.at(0), path, query);
+    }
+
+    pending_.erase(it);
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+
+void MetricsServer::onDisconnected()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    if (!socket)
+    {
+        return;
+    }
+
+    pending_.remove(socket);
+    socket->deleteLater();
+}
+
+QByteArray MetricsServer::handleRequest(const QByteArray &method, const QByteArray &path, const QByteArray &query)
+{
+    if (method != "GET")
+    {
+        return httpResponse(405, "Method Not Allowed", "text/plain", "method not allowed\n");
+    }
+
+    if (path == "/health")
+    {
+        QByteArray body = buildHealth();
+        bool healthy = tls_server_ && tls_server_->isListening();
+        return httpResponse(healthy ? 200 : 503, healthy ? "OK" : "Service Unavailable", "application/json", body);
+    }
+    if (path == "/metrics")
+    {
+        return httpResponse(200, "OK", "text/plain; version=0.0.4", buildMetrics());
+    }
+    if (path == "/stats")
+    {
+        return httpResponse(200, "OK", "text/plain", buildStats());
+    }
+    if (path == "/topk/servers" || path == "/topk/locations")
+    {
+        if (!LatencyEngine::instance()->isRunning())
+        {
+            return httpResponse(503, "Service Unavailable", "text/plain", "latency engine disabled\n");
+        }
+
+        QString error;
+        QByteArray body = path == "/topk/servers" ? buildTopServers(query, error) : buildNearestLocations(query, error);
+        if (!error.isEmpty())
+        {
+            return httpResponse(400, "Bad Request", "text/plain", error.toUtf8() + '\n');
+        }
+        return httpResponse(200, "OK", "application/json", body);
+    }
+
+    return httpResponse(404, "Not Found", "text/plain", "not found\n");
+}
+
+QByteArray MetricsServer::buildHealth() const
+{
+    QJsonObject health;
+    bool listening = tls_server_ && tls_server_->isListening();
+    health["status"] = listening ? "ok" : "unavailable";
+    health["tls_listening"] = listening;
+    health["uptime_seconds"] = start_time_.secsTo(QDateTime::currentDateTime());
+
+    if (tls_server_)
+    {
+        health["connections"] = tls_server_->getConnectionCount();
+        health["authenticated_users"] = tls_server_->getAuthenticatedUserCount();
+        health["worker_threads"] = tls_server_->getWorkerCount();
+    }
+
+    QJsonObject database;
+    if (db_pool_)
+    {
+        database["active_connections"] = db_pool_->getActiveConnections();
+        database["idle_connections"] = db_pool_->getIdleConnections();
+        database["waiting_requests"] = db_pool_->getWaitingRequests();
+    }
+    database["executor_running"] = DbExecutor::instance()->isRunning();
+    database["pending_jobs"] = DbExecutor::instance()->getPendingJobs();
+    database["pending_reports"] = ReportIngestQueue::instance()->getPendingReports();
+    health["database"] = database;
+
+    return QJsonDocument(health).toJson(QJsonDocument::Compact) + '\n';
+}
+
+QByteArray MetricsServer::buildMetrics() const
+{
+    QByteArray out;
+    out.reserve(16384);
+
+    appendMetricHeader(out, "latcheck_up", "gauge", "Whether the TLS listener is accepting connections.");
+    appendSample(out, "latcheck_up", QByteArray(), tls_server_ && tls_server_->isListening() ? 1 : 0);
+
+    appendMetricHeader(out, "latcheck_uptime_seconds", "gauge", "Seconds since the process started serving.");
+    appendSample(out, "latcheck_uptime_seconds", QByteArray(), start_time_.secsTo(QDateTime::currentDateTime()));
+
+    if (tls_server_)
+    {
+        appendMetricHeader(out, "latcheck_connections", "gauge", "Open client connections.");
+        appendSample(out, "latcheck_connections", QByteArray(), tls_server_->getConnectionCount());
+
+        appendMetricHeader(out, "latcheck_authenticated_sessions", "gauge", "Authenticated client sessions.");
+        appendSample(out, "latcheck_authenticated_sessions", QByteArray(), tls_server_->getAuthenticatedUserCount());
+
+        appendMetricHeader(out, "latcheck_responses_total", "counter", "Responses queued to clients.");
+        appendSample(out, "latcheck_responses_total", QByteArray(), tls_server_->getResponseCount());
+
+        appendMetricHeader(out, "latcheck_response_writes_total", "counter", "Socket writes used to send responses.");
+        appendSample(out, "latcheck_response_writes_total", QByteArray(), tls_server_->getResponseWriteCount());
+
+        if (const TlsSessionCache *cache = tls_server_->sessionCache())
+        {
+            appendMetricHeader(out, "latcheck_tls_handshakes_total", "counter", "Completed TLS handshakes by mode.");
+            appendSample(out, "latcheck_tls_handshakes_total", "mode=\"full\"", cache->getFullHandshakes());
+            appendSample(out, "latcheck_tls_handshakes_total", "mode=\"resumed\"", cache->getResumedHandshakes());
+
+            appendMetricHeader(out, "latcheck_tls_session_cache_lookups_total", "counter", "TLS session ID cache lookups.");
+            appendSample(out, "latcheck_tls_session_cache_lookups_total", "result=\"hit\"", cache->getCacheHits());
+            appendSample(out, "latcheck_tls_session_cache_lookups_total", "result=\"miss\"", cache->getCacheMisses());
+
+            appendMetricHeader(out, "latcheck_tls_session_cache_entries", "gauge", "Sessions held in the TLS session cache.");
+            appendSample(out, "latcheck_tls_session_cache_entries", QByteArray(), cache->getCachedSessionCount());
+        }
+
+        if (const AdmissionController *admission = tls_server_->admissionController())
+        {
+            appendMetricHeader(out, "latcheck_admission_total", "counter", "Accepted sockets by admission decision.");
+            for (int i = 0; i < static_cast<int>(AdmissionResult::ResultCount); ++i)
+            {
+                AdmissionResult result = static_cast<AdmissionResult>(i);
+                quint64 value = result == AdmissionResult::Accepted ? admission->getAcceptedCount()
+                                                                    : admission->getRejectedCount(result);
+                appendSample(out, "latcheck_admission_total",
+                             QByteArray("result=\"") + AdmissionController::resultName(result) + '"', value);
+            }
+
+            appendMetricHeader(out, "latcheck_pending_handshakes", "gauge", "TLS handshakes in progress.");
+            appendSample(out, "latcheck_pending_handshakes", QByteArray(), admission->getPendingHandshakes());
+
+            appendMetricHeader(out, "latcheck_accept_queue_depth", "gauge", "Accepted sockets not yet taken by a worker.");
+            appendSample(out, "latcheck_accept_queue_depth", QByteArray(), admission->getAcceptQueueDepth());
+        }
+    }
+
+    // 消息计数和各阶段耗时
+    appendMetricHeader(out, "latcheck_messages_total", "counter", "Processed client messages by type.");
+    QByteArray durations;
+    for (int type = 0; type < LatencyStats::MaxMessageTypes; ++type)
+    {
+        QByteArray typeLabel = QByteArray("type=\"") + MessageProtocol::messageTypeName(static_cast<quint32>(type)) + '"';
+        for (int stage = 0; stage < static_cast<int>(LatencyStage::StageCount); ++stage)
+        {
+            LatencyHistogram histogram;
+            LatencyStats::instance()->merged(static_cast<quint32>(type), static_cast<LatencyStage>(stage), histogram);
+            if (histogram.count() == 0)
+            {
+                continue;
+            }
+
+            if (static_cast<LatencyStage>(stage) == LatencyStage::Total)
+            {
+                appendSample(out, "latcheck_messages_total", typeLabel, histogram.count());
+            }
+            appendHistogram(durations, "latcheck_request_duration_seconds",
+                            typeLabel + ",stage=\"" + LatencyStats::stageName(static_cast<LatencyStage>(stage)) + '"',
+                            histogram);
+        }
+    }
+    appendMetricHeader(out, "latcheck_request_duration_seconds", "histogram", "Request processing time by message type and stage.");
+    out += durations;
+
+    // 数据库
+    if (db_pool_)
+    {
+        appendMetricHeader(out, "latcheck_db_pool_connections", "gauge", "Database pool connections by state.");
+        appendSample(out, "latcheck_db_pool_connections", "state=\"active\"", db_pool_->getActiveConnections());
+        appendSample(out, "latcheck_db_pool_connections", "state=\"idle\"", db_pool_->getIdleConnections());
+
+        appendMetricHeader(out, "latcheck_db_pool_waiting", "gauge", "Requests queued for a database connection.");
+        appendSample(out, "latcheck_db_pool_waiting", QByteArray(), db_pool_->getWaitingRequests());
+
+        appendMetricHeader(out, "latcheck_db_pool_validations_total", "counter", "Idle connections validated on checkout by result.");
+        appendSample(out, "latcheck_db_pool_validations_total", "result=\"ok\"",
+                     db_pool_->getValidationCount() - db_pool_->getValidationFailures());
+        appendSample(out, "latcheck_db_pool_validations_total", "result=\"failed\"", db_pool_->getValidationFailures());
+
+        appendMetricHeader(out, "latcheck_db_pool_acquire_timeouts_total", "counter", "Connection requests that timed out.");
+        appendSample(out, "latcheck_db_pool_acquire_timeouts_total", QByteArray(), db_pool_->getAcquireTimeouts());
+
+        appendMetricHeader(out, "latcheck_db_pool_wait_seconds", "histogram", "Time spent waiting for a pooled connection.");
+        appendHistogram(out, "latcheck_db_pool_wait_seconds", QByteArray(), db_pool_->getAcquireWaitHistogram());
+
+        appendMetricHeader(out, "latcheck_db_statement_cache_total", "counter", "Prepared statement cache lookups and discards by result.");
+        appendSample(out, "latcheck_db_statement_cache_total", "result=\"hit\"", db_pool_->getStatementCacheHits());
+        appendSample(out, "latcheck_db_statement_cache_total", "result=\"miss\"", db_pool_->getStatementCacheMisses());
+        appendSample(out, "latcheck_db_statement_cache_total", "result=\"eviction\"", db_pool_->getStatementCacheEvictions());
+        appendSample(out, "latcheck_db_statement_cache_total", "result=\"invalidation\"", db_pool_->getStatementCacheInvalidations());
+    }
+
+    appendMetricHeader(out, "latcheck_db_pending_jobs", "gauge", "Database jobs queued or running.");
+    appendSample(out, "latcheck_db_pending_jobs", QByteArray(), DbExecutor::instance()->getPendingJobs());
+
+    // 报告组提交
+    ReportIngestQueue *ingest = ReportIngestQueue::instance();
+    appendMetricHeader(out, "latcheck_report_ingest_pending", "gauge", "Reports waiting for their group to commit.");
+    appendSample(out, "latcheck_report_ingest_pending", QByteArray(), ingest->getPendingReports());
+
+    appendMetricHeader(out, "latcheck_report_ingest_groups_total", "counter", "Report group transactions executed.");
+    appendSample(out, "latcheck_report_ingest_groups_total", QByteArray(), ingest->getGroupCount());
+
+    appendMetricHeader(out, "latcheck_report_ingest_reports_total", "counter", "Reports processed by group commit.");
+    appendSample(out, "latcheck_report_ingest_reports_total", QByteArray(), ingest->getReportCount());
+
+    // 地点间延时引擎
+    LatencyEngine *engine = LatencyEngine::instance();
+    appendMetricHeader(out, "latcheck_latency_engine_locations", "gauge", "Check locations held by the latency engine.");
+    appendSample(out, "latcheck_latency_engine_locations", QByteArray(), engine->getLocationCount());
+
+    appendMetricHeader(out, "latcheck_latency_matrix_servers", "gauge", "Test server columns in the latency matrix.");
+    appendSample(out, "latcheck_latency_matrix_servers", QByteArray(), engine->matrix().serverCount());
+
+    appendMetricHeader(out, "latcheck_latency_matrix_bytes", "gauge", "Memory held by latency matrix cells and validity bitmaps.");
+    appendSample(out, "latcheck_latency_matrix_bytes", QByteArray(), engine->matrix().memoryBytes());
+
+    appendMetricHeader(out, "latcheck_latency_engine_pending", "gauge", "Locations waiting for their pairs to be recalculated.");
+    appendSample(out, "latcheck_latency_engine_pending", QByteArray(), engine->getPendingReports());
+
+    appendMetricHeader(out, "latcheck_latency_engine_updates_total", "counter", "Location updates applied by the latency engine.");
+    appendSample(out, "latcheck_latency_engine_updates_total", QByteArray(), engine->getUpdateCount());
+
+    appendMetricHeader(out, "latcheck_latency_engine_pairs_total", "counter", "Location pairs written to calculated_latencies.");
+    appendSample(out, "latcheck_latency_engine_pairs_total", QByteArray(), engine->getPairUpdates());
+
+    appendMetricHeader(out, "latcheck_latency_engine_failures_total", "counter", "Location updates whose pairs failed to persist.");
+    appendSample(out, "latcheck_latency_engine_failures_total", QByteArray(), engine->getFailureCount());
+
+    // 服务器目录
+    ServerCatalogSnapshotPtr catalog = ServerCatalog::instance()->snapshot();
+    appendMetricHeader(out, "latcheck_server_catalog_servers", "gauge", "Active test servers in the published catalog snapshot.");
+    appendSample(out, "latcheck_server_catalog_servers", QByteArray(), catalog->servers.size());
+
+    appendMetricHeader(out, "latcheck_server_catalog_version", "gauge", "Version of the published catalog snapshot.");
+    appendSample(out, "latcheck_server_catalog_version", QByteArray(), catalog->version);
+
+    appendMetricHeader(out, "latcheck_server_catalog_reloads_total", "counter", "Server list file reloads.");
+    appendSample(out, "latcheck_server_catalog_reloads_total", QByteArray(), ServerCatalog::instance()->getReloadCount());
+
+    appendMetricHeader(out, "latcheck_list_responses_total", "counter", "Server list responses by kind.");
+    appendSample(out, "latcheck_list_responses_total", "kind=\"full\"", ServerCatalog::instance()->getListResponseCount(ListDeltaKind::Full));
+    appendSample(out, "latcheck_list_responses_total", "kind=\"delta\"", ServerCatalog::instance()->getListResponseCount(ListDeltaKind::Delta));
+    appendSample(out, "latcheck_list_responses_total", "kind=\"not_modified\"", ServerCatalog::instance()->getListResponseCount(ListDeltaKind::NotModified));
+
+    appendMetricHeader(out, "latcheck_list_response_bytes_total", "counter", "Payload bytes sent in server list responses.");
+    appendSample(out, "latcheck_list_response_bytes_total", QByteArray(), ServerCatalog::instance()->getListResponseBytes());
+
+    return out;
+}
+
+bool MetricsServer::parseTopKQuery(const QByteArray &query, QString &location, int &k, QString &error)
+{
+    QUrlQuery params(QString::fromUtf8(query));
+    location = params.queryItemValue("location", QUrl::FullyDecoded);
+    if (location.isEmpty())
+    {
+        error = "missing location";
+        return false;
+    }
+
+    k = DefaultTopK;
+    if (params.hasQueryItem("k"))
+    {
+        bool ok = false;
+        k = params.queryItemValue("k").toInt(&ok);
+        if (!ok || k <= 0)
+        {
+            error = "invalid k";
+            return false;
+        }
+    }
+    k = qMin(k, MaxTopK);
+    return true;
+}
+
+QByteArray MetricsServer::buildTopServers(const QByteArray &query, QString &error) const
+{
+    QString location;
+    int k = 0;
+    if (!parseTopKQuery(query, location, k, error))
+    {
+        return QByteArray();
+    }
+
+    qint64 startUs = LatencyStats::nowUs();
+    const LatencyMatrix &matrix = LatencyEngine::instance()->matrix();
+    QList<LatencySample> servers = matrix.bestServers(location, k);
+
+    QJsonArray items;
+    for (const auto &server : std::as_const(servers))
+    {
+        QJsonObject item;
+        item["server_id"] = static_cast<qint64>(server.serverId);
+        item["latency"] = server.latency;
+        items.append(item);
+    }
+
+    QJsonObject result;
+    result["location"] = location;
+    result["report_id"] = matrix.reportIdOf(location);
+    result["servers"] = items;
+    result["elapsed_us"] = LatencyStats::nowUs() - startUs;
+    return QJsonDocument(result).toJson(QJsonDocument::Compact) + '\n';
+}
+
+QByteArray MetricsServer::buildNearestLocations(const QByteArray &query, QString &error) const
+{
+    QString location;
+    int k = 0;
+    if (!parseTopKQuery(query, location, k, error))
+    {
+        return QByteArray();
+    }
+
+    qint64 startUs = LatencyStats::nowUs();
+    const LatencyMatrix &matrix = LatencyEngine::instance()->matrix();
+    QList<LocationDistance> locations = matrix.nearestLocations(location, k);
+
+    QJsonArray items;
+    for (const auto &nearest : std::as_const(locations))
+    {
+        QJsonObject item;
+        item["location"] = nearest.location;
+        item["report_id"] = nearest.reportId;
+        item["latency"] = nearest.latency;
+        item["server_id"] = static_cast<qint64>(nearest.serverId);
+        items.append(item);
+    }
+
+    QJsonObject result;
+    result["location"] = location;
+    result["report_id"] = matrix.reportIdOf(location);
+    result["locations"] = items;
+    result["elapsed_us"] = LatencyStats::nowUs() - startUs;
+    return QJsonDocument(result).toJson(QJsonDocument::Compact) + '\n';
+}
+
+QByteArray MetricsServer::buildStats() const
+{
+    QString report = LatencyStats::instance()->report(&MessageProtocol::messageTypeName);
+    if (report.isEmpty())
+    {
+        report = "no requests recorded\n";
+    }
+    return report.toUtf8();
+}
+
+void MetricsServer::appendHistogram(QByteArray &out, const char *name, const QByteArray &labels,
+                                    const LatencyHistogram &histogram)
+{
+    QByteArray bucketName = QByteArray(name) + "_bucket";
+    QByteArray prefix = labels.isEmpty() ? QByteArray() : labels + ',';
+
+    for (quint64 bound : kHistogramBoundsUs)
+    {
+        appendSample(out, bucketName.constData(), prefix + "le=\"" + secondsLabel(bound) + '"',
+                     histogram.countAtOrBelow(bound));
+    }
+    appendSample(out, bucketName.constData(), prefix + "le=\"+Inf\"", histogram.count());
+
+    out += name;
+    out += "_sum";
+    if (!labels.isEmpty())
+    {
+        out += '{' + labels + '}';
+    }
+    out += ' ';
+    out += secondsValue(histogram.sum());
+    out += '\n';
+
+    appendSample(out, (QByteArray(name) + "_count").constData(), labels, histogram.count());
+}
+
+QByteArray MetricsServer::httpResponse(int status, const char *reason, const char *contentType, const QByteArray &body)
+{
+    QByteArray response;
+    response.reserve(body.size() + 128);
+    response += "HTTP/1.1 " + QByteArray::number(status) + ' ' + reason + "\r\n";
+    response += QByteArray("Content-Type: ") + contentType + "\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += body;
+    return response;
+}
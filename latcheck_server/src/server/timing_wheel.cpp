@@ -0,0 +1,187 @@
+#include "server/timing_wheel.h"
+
+TimerNode::~TimerNode()
+{
+    if (wheel)
+    {
+        wheel->cancel(this);
+    }
+}
+
+TimingWheel::TimingWheel(int tickMs)
+    : current_tick_(0), tick_ms_(qMax(1, tickMs)), size_(0)
+{
+    for (int level = 0; level < LevelCount; ++level)
+    {
+        for (int i = 0; i < SlotCount; ++i)
+        {
+            slots_[level][i].prev = &slots_[level][i];
+            slots_[level][i].next = &slots_[level][i];
+        }
+    }
+    clock_.start();
+}
+
+TimingWheel::~TimingWheel()
+{
+    // 解除所有剩余节点与时间轮的关联，避免节点析构时访问已释放的时间轮
+    for (int level = 0; level < LevelCount; ++level)
+    {
+        for (int i = 0; i < SlotCount; ++i)
+        {
+            TimerNode *head = &slots_[level][i];
+            while (head->next != head)
+            {
+                TimerNode *node = head->next;
+                unlink(node);
+                node->wheel = nullptr;
+            }
+        }
+    }
+}
+
+void TimingWheel::schedule(TimerNode *node, qint64 delayMs)
+{
+    if (node->wheel)
+    {
+        node->wheel->cancel(node);
+    }
+
+    // 按单调时钟计算到期刻度（向上取整），至少在下一个刻度到期
+    quint64 expireTick = static_cast<quint64>((clock_.elapsed() + qMax<qint64>(0, delayMs) + tick_ms_ - 1) / tick_ms_);
+    node->expireTick = qMax(expireTick, current_tick_ + 1);
+    node->wheel = this;
+    insert(node);
+    ++size_;
+}
+
+void TimingWheel::cancel(TimerNode *node)
+{
+    if (node->wheel != this)
+    {
+        return;
+    }
+
+    unlink(node);
+    node->wheel = nullptr;
+    --size_;
+}
+
+int TimingWheel::advance()
+{
+    quint64 targetTick = static_cast<quint64>(clock_.elapsed() / tick_ms_);
+    int expired = 0;
+
+    while (current_tick_ < targetTick)
+    {
+        ++current_tick_;
+
+        // 最低层转完一圈时，从上层逐级下放定时器
+        int index = static_cast<int>(current_tick_ & (SlotCount - 1));
+        if (index == 0)
+        {
+            for (int level = 1; level < LevelCount; ++level)
+            {
+                int levelIndex = static_cast<int>((current_tick_ >> (SlotBits * level)) & (SlotCount - 1));
+                cascade(level, levelIndex);
+                if (levelIndex != 0)
+                {
+                    break;
+                }
+            }
+        }
+
+        // 先把到期槽整体摘到局部链表，回调中启动或取消其他定时器不影响遍历
+        TimerNode pending;
+        pending.prev = &pending;
+        pending.next = &pending;
+        spliceSlot(&slots_[0][index], &pending);
+
+        while (pending.next != &pending)
+        {
+            TimerNode *node = pending.next;
+            unlink(node);
+            node->wheel = nullptr;
+            --size_;
+            ++expired;
+
+            // 回调可能释放节点所属对象，先复制回调再执行
+            std::function<void()> callback = node->callback;
+            if (callback)
+            {
+                callback();
+            }
+        }
+    }
+
+    return expired;
+}
+
+void TimingWheel::insert(TimerNode *node)
+{
+    quint64 delta = node->expireTick - current_tick_;
+    quint64 expireTick = node->expireTick;
+
+    int level = 0;
+    while (level < LevelCount - 1 && delta >= (quint64(1) << (SlotBits * (level + 1))))
+    {
+        ++level;
+    }
+
+    // 超出最大范围的定时器放在最高层，逐级下放时会重新计算位置
+    quint64 maxDelta = (quint64(1) << (SlotBits * LevelCount)) - 1;
+    if (delta > maxDelta)
+    {
+        expireTick = current_tick_ + maxDelta;
+    }
+
+    int index = static_cast<int>((expireTick >> (SlotBits * level)) & (SlotCount - 1));
+    link(&slots_[level][index], node);
+}
+
+void TimingWheel::cascade(int level, int index)
+{
+    // 先摘下整个槽，重新放入的节点可能落回同一个槽（超出最大范围的定时器）
+    TimerNode pending;
+    pending.prev = &pending;
+    pending.next = &pending;
+    spliceSlot(&slots_[level][index], &pending);
+
+    while (pending.next != &pending)
+    {
+        TimerNode *node = pending.next;
+        unlink(node);
+        insert(node);
+    }
+}
+
+void TimingWheel::spliceSlot(TimerNode *from, TimerNode *to)
+{
+    if (from->next == from)
+    {
+        return;
+    }
+
+    to->next = from->next;
+    to->prev = from->prev;
+    to->next->prev = to;
+    to->prev->next = to;
+    from->prev = from;
+    from->next = from;
+}
+
+void TimingWheel::link(TimerNode *head, TimerNode *node)
+{
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+void TimingWheel::unlink(TimerNode *node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = nullptr;
+    node->next = nullptr;
+}
@@ -1,9 +1,13 @@
 #include "server/tls_server.h"
+#include "server/connection_worker.h"
 #include "config/config_manager.h"
 #include "logger/logger.h"
 #include "auth/auth_manager.h"
 #include "database/user_dao.h"
 #include "database/report_dao.h"
+#include "database/db_executor.h"
+#include "database/report_ingest_queue.h"
+#include "catalog/server_catalog.h"
 #include "protocol/message_protocol.h"
 #include "common/error_codes.h"
 #include "auth/password_utils.h"
@@ -21,17 +25,15 @@
 #include <QTimer>
 
 TlsServer::TlsServer(QObject *parent)
-    : QTcpServer(parent), config_manager_(nullptr), user_dao_(nullptr), report_dao_(nullptr),
-      cleanup_timer_(new QTimer(this)), max_connections_(100), connection_timeout_(300) // 5分钟
+    : QTcpServer(parent), config_manager_(nullptr),
+      max_connections_(100), connection_timeout_(300) // 5分钟
       ,
-      auth_timeout_(30), // 30秒
+      auth_timeout_(10), // 10秒
+      session_buffer_limit_(FrameBuffer::DefaultLimit),
       auth_manager_(nullptr),
       use_whitelist_(false),
       use_blacklist_(false)
 {
-    // 设置清理定时器
-    cleanup_timer_->setInterval(60000); // 每分钟清理一次
-    connect(cleanup_timer_, &QTimer::timeout, this, &TlsServer::onCleanupTimer);
 }
 
 TlsServer::~TlsServer()
@@ -47,6 +49,22 @@ bool TlsServer::startServer(const QString &host, quint16 port)
         return false;
     }
 
+    // 读取连接相关配置
+    ServerConfig serverConfig = config_manager_->getServerConfig();
+    max_connections_ = serverConfig.maxConnections;
+    connection_timeout_ = serverConfig.connectionTimeout;
+    auth_timeout_ = serverConfig.authTimeout;
+    session_buffer_limit_ = qMax(serverConfig.sessionBufferLimit, static_cast<int>(FrameBuffer::HeaderSize));
+
+    AdmissionSettings admissionSettings;
+    admissionSettings.maxConnections = max_connections_;
+    admissionSettings.perIpRate = qMax(0.0, serverConfig.perIpConnectRate);
+    admissionSettings.perIpBurst = qMax(1, serverConfig.perIpConnectBurst);
+    admissionSettings.maxPendingHandshakes = qMax(0, serverConfig.maxPendingHandshakes);
+    admissionSettings.acceptQueueHighWatermark = qMax(0, serverConfig.acceptQueueHighWatermark);
+    admissionSettings.ipTableSize = qMax(1, serverConfig.admissionIpTableSize);
+    admission_ = std::make_unique<AdmissionController>(admissionSettings);
+
     QHostAddress address;
     if (host == "0.0.0.0" || host.isEmpty())
     {
@@ -75,6 +93,9 @@ bool TlsServer::startServer(const QString &host, quint16 port)
         }
     }
 
+    // 先启动工作线程，再开始监听
+    startWorkers(serverConfig.workerThreads);
+
     if (!listen(address, port))
     {
         Logger::instance()->error(
@@ -82,15 +103,16 @@ bool TlsServer::startServer(const QString &host, quint16 port)
                 .arg(host)
                 .arg(port)
                 .arg(errorString()));
+        stopWorkers();
         return false;
     }
 
-    cleanup_timer_->start();
     Logger::instance()->info(
-        QString("TLS Server started on %1:%2 (listening on %3)")
+        QString("TLS Server started on %1:%2 (listening on %3, %4 worker threads)")
             .arg(host)
             .arg(port)
-            .arg(serverAddress().toString()));
+            .arg(serverAddress().toString())
+            .arg(workers_.size()));
     return true;
 }
 
@@ -102,66 +124,142 @@ bool TlsServer::startServer(quint16 port)
 
 void TlsServer::stopServer()
 {
-    if (isListening())
+    if (isListening() || !workers_.isEmpty())
     {
         close();
 
-        // 断开所有客户端连接
-        QMutexLocker locker(&clients_mutex_);
-        for (auto it = clients_.begin(); it != clients_.end(); ++it)
+        Logger::instance()->info(
+            QString("Responses sent: %1 in %2 socket writes")
+                .arg(getResponseCount())
+                .arg(getResponseWriteCount()));
+
+        // 断开所有客户端连接并停止工作线程
+        stopWorkers();
+
+        if (admission_)
         {
-            if (it.value()->socket)
-            {
-                it.value()->socket->disconnectFromHost();
-                it.value()->socket->deleteLater();
-            }
-            delete it.value();
+            Logger::instance()->info(
+                QString("Admission control: %1 accepted, %2 rejected (accept queue: %3, max connections: %4, handshakes: %5, rate limit: %6)")
+                    .arg(admission_->getAcceptedCount())
+                    .arg(admission_->getRejectedTotal())
+                    .arg(admission_->getRejectedCount(AdmissionResult::AcceptQueueFull))
+                    .arg(admission_->getRejectedCount(AdmissionResult::MaxConnections))
+                    .arg(admission_->getRejectedCount(AdmissionResult::HandshakeLimit))
+                    .arg(admission_->getRejectedCount(AdmissionResult::RateLimited)));
         }
-        clients_.clear();
 
-        cleanup_timer_->stop();
         Logger::instance()->info("TLS Server stopped");
     }
 }
 
-int TlsServer::getConnectionCount() const
+void TlsServer::startWorkers(int count)
 {
-    QMutexLocker locker(&clients_mutex_);
-    return clients_.size();
+    if (count <= 0)
+    {
+        count = qMax(1, QThread::idealThreadCount());
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        QThread *thread = new QThread(this);
+        thread->setObjectName(QString("tls-worker-%1").arg(i));
+
+        // worker不能有父对象，否则无法移动到工作线程
+        ConnectionWorker *worker = new ConnectionWorker(this, i);
+        worker->moveToThread(thread);
+        connect(thread, &QThread::started, worker, &ConnectionWorker::start);
+
+        workers_.append(worker);
+        worker_threads_.append(thread);
+        thread->start();
+    }
 }
 
-int TlsServer::getAuthenticatedUserCount() const
+void TlsServer::stopWorkers()
 {
-    QMutexLocker locker(&clients_mutex_);
-    int count = 0;
-    for (const ClientSession *session : clients_)
+    // 在工作线程中断开会话
+    for (ConnectionWorker *worker : std::as_const(workers_))
+    {
+        QMetaObject::invokeMethod(worker, &ConnectionWorker::shutdown, Qt::BlockingQueuedConnection);
+    }
+
+    // 等待在途的数据库任务和待提交的报告完成，其回调会投递到仍在运行的工作线程中并被丢弃
+    DbExecutor::instance()->waitForIdle();
+    ReportIngestQueue::instance()->waitForIdle();
+
+    for (int i = 0; i < workers_.size(); ++i)
     {
-        if (session && session->state == ClientState::Authenticated)
+        ConnectionWorker *worker = workers_.at(i);
+        QThread *thread = worker_threads_.at(i);
+
+        // 退出事件循环
+        thread->quit();
+        thread->wait();
+
+        delete worker;
+        delete thread;
+    }
+
+    workers_.clear();
+    worker_threads_.clear();
+}
+
+ConnectionWorker *TlsServer::selectWorker() const
+{
+    ConnectionWorker *selected = nullptr;
+    for (ConnectionWorker *worker : workers_)
+    {
+        if (!selected || worker->connectionCount() < selected->connectionCount())
         {
-            count++;
+            selected = worker;
         }
     }
+    return selected;
+}
+
+int TlsServer::getConnectionCount() const
+{
+    int count = 0;
+    for (const ConnectionWorker *worker : workers_)
+    {
+        count += worker->connectionCount();
+    }
     return count;
 }
 
-void TlsServer::setConfigManager(QSharedPointer<ConfigManager> config)
+quint64 TlsServer::getResponseCount() const
 {
-    config_manager_ = config;
+    quint64 count = 0;
+    for (const ConnectionWorker *worker : workers_)
+    {
+        count += worker->responseCount();
+    }
+    return count;
 }
 
-void TlsServer::setUserDAO(QSharedPointer<UserDAO> userDAO)
+quint64 TlsServer::getResponseWriteCount() const
 {
-    user_dao_ = userDAO;
+    quint64 count = 0;
+    for (const ConnectionWorker *worker : workers_)
+    {
+        count += worker->writeCount();
+    }
+    return count;
 }
 
-void TlsServer::setReportDAO(QSharedPointer<ReportDAO> reportDAO)
+int TlsServer::getAuthenticatedUserCount() const
 {
-    report_dao_ = reportDAO;
+    int count = 0;
+    for (const ConnectionWorker *worker : workers_)
+    {
+        count += worker->authenticatedCount();
+    }
+    return count;
 }
 
-void TlsServer::setServerDAO(QSharedPointer<ServerDAO> serverDAO)
+void TlsServer::setConfigManager(QSharedPointer<ConfigManager> config)
 {
-    server_dao_ = serverDAO;
+    config_manager_ = config;
 }
 
 void TlsServer::setAuthManager(QSharedPointer<AuthManager> authManager)
@@ -169,168 +267,35 @@ void TlsServer::setAuthManager(QSharedPointer<AuthManager> authManager)
     auth_manager_ = authManager;
 }
 
-// 修复incomingConnection方法
+// 接入线程只做接入控制，握手和会话处理都在工作线程中进行
 void TlsServer::incomingConnection(qintptr socketDescriptor)
 {
-    // 检查连接数限制
-    if (getConnectionCount() >= max_connections_)
+    ConnectionWorker *worker = selectWorker();
+    if (!worker || !admission_)
     {
-        QTcpSocket tempSocket;
-        tempSocket.setSocketDescriptor(socketDescriptor);
-        QString clientIp = tempSocket.peerAddress().toString();
-        quint16 clientPort = tempSocket.peerPort();
-        Logger::instance()->info(
-            QString("Connection rejected - Max connections reached (%1:%2)")
-                .arg(clientIp)
-                .arg(clientPort));
-        tempSocket.disconnectFromHost();
+        Logger::instance()->error("No connection worker available");
+        AdmissionController::closeDescriptor(socketDescriptor);
         return;
     }
 
-    QSslSocket *sslSocket = new QSslSocket(this);
-    if (!sslSocket->setSocketDescriptor(socketDescriptor))
+    // 在创建任何TLS状态之前判定，被拒绝的描述符直接关闭
+    QHostAddress peerAddress;
+    AdmissionResult result = admission_->admit(socketDescriptor, getConnectionCount(), &peerAddress);
+    if (result != AdmissionResult::Accepted)
     {
-        Logger::instance()->error("Failed to set socket descriptor");
-        delete sslSocket;
+        AdmissionController::closeDescriptor(socketDescriptor);
+        Logger::instance()->debug(
+            QString("Connection rejected - %1 (%2, total rejected: %3)")
+                .arg(AdmissionController::resultName(result))
+                .arg(peerAddress.toString())
+                .arg(admission_->getRejectedTotal()));
         return;
     }
 
-    // 获取并记录客户端连接信息
-    QString clientIp = sslSocket->peerAddress().toString();
-    quint16 clientPort = sslSocket->peerPort();
-    Logger::instance()->info(
-        QString("New incoming connection: %1:%2 (total connections: %3)")
-            .arg(clientIp)
-            .arg(clientPort)
-            .arg(getConnectionCount() + 1));
-
-    // 创建会话
-    ClientSession *session = new ClientSession();
-    session->socket = sslSocket;
-    session->connectTime = QDateTime::currentDateTime();
-    session->lastActiveTime = session->connectTime;
-    session->state = ClientState::Connected;
-
-    // 将会话添加到客户端列表
-    {
-        QMutexLocker locker(&clients_mutex_);
-        clients_.insert(sslSocket, session);
-    }
-
-    // 创建登录超时定时器并关联到会话
-    session->loginTimer = new QTimer(this);
-    session->loginTimer->setSingleShot(true);
-    session->loginTimer->setInterval(10000); // 10秒
-
-    connect(session->loginTimer, &QTimer::timeout, [this, sslSocket, session]()
-            {
-        if (session && session->state != ClientState::Authenticated) {
-            Logger::instance()->warning("Login timeout - disconnecting session");
-            if (sslSocket->isOpen()) {
-                sslSocket->disconnectFromHost();
-            }
-        }
-        if (session->loginTimer) {
-            session->loginTimer->deleteLater();
-            session->loginTimer = nullptr;
-        } });
-
-    // 当socket断开连接时清理登录定时器资源
-    connect(sslSocket, &QSslSocket::disconnected, [session]()
-            {
-        if (session->loginTimer) {
-            session->loginTimer->stop();
-            session->loginTimer->deleteLater();
-            session->loginTimer = nullptr;
-        } });
-
-    // 设置SSL连接信号和槽
-    connect(sslSocket, &QSslSocket::encrypted, this, &TlsServer::onSslReady);
-    connect(sslSocket, &QSslSocket::readyRead, this, &TlsServer::onDataReceived);
-    connect(sslSocket, &QSslSocket::disconnected, this, &TlsServer::onClientDisconnected);
-    connect(sslSocket, QOverload<const QList<QSslError> &>::of(&QSslSocket::sslErrors),
-            this, &TlsServer::onSslErrors);
-
-    // 配置SSL并启动握手
-    sslSocket->setSslConfiguration(ssl_config_);
-    sslSocket->startServerEncryption(); // 关键：启动SSL服务器端握手
-
-    // 启动登录超时定时器
-    session->loginTimer->start();
-
-    Logger::instance()->debug(
-        QString("SSL handshake initiated for session: %1:%2")
-            .arg(clientIp)
-            .arg(clientPort));
-}
-
-void TlsServer::onClientDisconnected()
-{
-    QSslSocket *socket = qobject_cast<QSslSocket *>(sender());
-    if (!socket)
-        return;
-
-    QMutexLocker locker(&clients_mutex_);
-    ClientSession *session = clients_.value(socket);
-
-    if (session)
-    {
-        QString clientIp = socket->peerAddress().toString();
-        quint16 clientPort = socket->peerPort();
-        QString userName = session->userName.isEmpty() ? "(unauthenticated)" : session->userName;
-
-        Logger::instance()->info(
-            QString("Client disconnected: %1:%2 (user: %3, total connections: %4)")
-                .arg(clientIp)
-                .arg(clientPort)
-                .arg(userName)
-                .arg(clients_.size() - 1));
-
-        delete session;
-    }
-
-    clients_.remove(socket);
-    socket->deleteLater();
-}
-
-void TlsServer::onCleanupTimer()
-{
-    QDateTime now = QDateTime::currentDateTime();
-    QMutexLocker locker(&clients_mutex_);
-
-    for (auto it = clients_.begin(); it != clients_.end();)
-    {
-        ClientSession *session = it.value();
-
-        // 清理未认证超时的连接
-        if (session->state == ClientState::Connected &&
-            session->connectTime.secsTo(now) > auth_timeout_)
-        {
-
-            Logger::instance()->warning(
-                QString("Authentication timeout for session from %1")
-                    .arg(session->socket->peerAddress().toString()));
-
-            session->socket->disconnectFromHost();
-            delete session;
-            it = clients_.erase(it);
-            continue;
-        }
-
-        // 清理长时间不活跃的连接
-        if (session->lastActiveTime.secsTo(now) > connection_timeout_)
-        {
-            Logger::instance()->info(
-                QString("Connection timeout for user: %1").arg(session->userName));
-
-            session->socket->disconnectFromHost();
-            delete session;
-            it = clients_.erase(it);
-            continue;
-        }
-
-        ++it;
-    }
+    // 先预占名额，保证并发接入时连接数统计准确
+    worker->reserveConnection();
+    QMetaObject::invokeMethod(worker, [worker, socketDescriptor]()
+                              { worker->addConnection(socketDescriptor); }, Qt::QueuedConnection);
 }
 
 // 修改initializeSsl方法，使用正确的SSL验证配置
@@ -432,6 +397,18 @@ bool TlsServer::initializeSsl()
     }
     ssl_config_.setProtocol(QSsl::TlsV1_2OrLater);
 
+    // 会话复用：重连的客户端可跳过完整握手
+    ServerConfig serverConfig = config_manager_->getServerConfig();
+    TlsSessionSettings sessionSettings;
+    sessionSettings.enabled = serverConfig.tlsSessionResumption;
+    sessionSettings.enableTickets = serverConfig.tlsSessionTickets;
+    sessionSettings.cacheSize = qMax(0, serverConfig.tlsSessionCacheSize);
+    sessionSettings.sessionTimeout = qMax(1, serverConfig.tlsSessionTimeout);
+    sessionSettings.ticketRotationInterval = qMax(1, serverConfig.tlsTicketRotationInterval);
+    session_cache_ = std::make_unique<TlsSessionCache>(sessionSettings);
+    ssl_config_.setSslOption(QSsl::SslOptionDisableSessionTickets,
+                             !(sessionSettings.enabled && sessionSettings.enableTickets));
+
     // 设置CA证书
     if (!ca_certificates_.isEmpty())
     {
@@ -441,15 +418,67 @@ bool TlsServer::initializeSsl()
     return true;
 }
 
-void TlsServer::handleLoginRequest(ClientSession *session, const QByteArray &data)
+// 异步请求的完成回调在会话所属的工作线程中执行：会话已断开时丢弃结果，
+// 否则处理结果后恢复该会话的消息分发
+template <typename Done>
+auto TlsServer::sessionCallback(ClientSession *session, Done done)
 {
-    if (!user_dao_)
+    ConnectionWorker *worker = session->worker;
+    QSslSocket *socket = session->socket;
+    quint64 sessionId = session->sessionId;
+
+    return [worker, socket, sessionId, done = std::move(done)](const auto &result) mutable
     {
-        sendErrorResponse(session, MessageType::LOGIN_FAIL, ErrorCode::ServerInternal);
-        return;
+        // 请求完成前客户端可能已断开
+        ClientSession *session = worker->findSession(socket, sessionId);
+        if (!session)
+        {
+            return;
+        }
+
+        // 响应暂存到发送缓冲区，与恢复处理后产生的响应一起写出
+        session->corked = true;
+        done(session, result);
+        LatencyStats::instance()->record(session->requestType, LatencyStage::Total,
+                                         LatencyStats::nowUs() - session->requestStartUs);
+        worker->resumeSession(session);
+    };
+}
+
+// 数据库任务在DB线程中执行，完成后回到会话所属的工作线程继续处理。
+// 请求未完成期间暂停该会话的消息分发，保证同一会话内的请求按序处理。
+template <typename Job, typename Done>
+bool TlsServer::submitDbRequest(ClientSession *session, Job job, Done done)
+{
+    quint32 msgType = session->requestType;
+    qint64 submittedUs = LatencyStats::nowUs();
+
+    // 在DB线程中统计排队和执行耗时
+    auto timedJob = [job = std::move(job), msgType, submittedUs](DbContext &db) mutable
+    {
+        qint64 startUs = LatencyStats::nowUs();
+        LatencyStats::instance()->record(msgType, LatencyStage::Queue, startUs - submittedUs);
+        auto result = job(db);
+        LatencyStats::instance()->record(msgType, LatencyStage::Database, LatencyStats::nowUs() - startUs);
+        return result;
+    };
+
+    session->requestInFlight = true;
+    bool submitted = DbExecutor::instance()->submit(session->worker, std::move(timedJob),
+                                                    sessionCallback(session, std::move(done)));
+
+    if (!submitted)
+    {
+        session->requestInFlight = false;
     }
+    return submitted;
+}
 
+void TlsServer::handleLoginRequest(ClientSession *session, QByteArrayView data)
+{
+    qint64 parseStartUs = LatencyStats::nowUs();
     LoginRequestData loginData = MessageProtocol::deserializeLoginRequest(data);
+    LatencyStats::instance()->record(session->requestType, LatencyStage::Parse, LatencyStats::nowUs() - parseStartUs);
     QString userName = QString::fromUtf8(loginData.userName);
     QString plainPassword = QString::fromUtf8(loginData.password);
 
@@ -457,8 +486,28 @@ void TlsServer::handleLoginRequest(ClientSession *session, const QByteArray &dat
         QString("Processing login request for user: %1").arg(userName));
 
     // 获取用户信息（包含密码哈希和盐值）
-    User user = user_dao_->getUserByUsername(userName);
-    user_dao_->printUser(user); // 调试输出用户信息
+    bool submitted = submitDbRequest(
+        session,
+        [userName](DbContext &db)
+        {
+            User user = db.userDao->getUserByUsername(userName);
+            db.userDao->printUser(user); // 调试输出用户信息
+            return user;
+        },
+        [this, userName, plainPassword](ClientSession *session, const User &user)
+        {
+            completeLoginRequest(session, userName, plainPassword, user);
+        });
+
+    if (!submitted)
+    {
+        sendErrorResponse(session, MessageType::LOGIN_FAIL, ErrorCode::ServerInternal);
+    }
+}
+
+void TlsServer::completeLoginRequest(ClientSession *session, const QString &userName,
+                                     const QString &plainPassword, const User &user)
+{
     if (user.id == 0)
     {
         sendErrorResponse(session, MessageType::LOGIN_FAIL, ErrorCode::InvalidUser);
@@ -495,19 +544,10 @@ void TlsServer::handleLoginRequest(ClientSession *session, const QByteArray &dat
     }
 
     // 登录成功
-    session->state = ClientState::Authenticated;
     session->userName = userName;
-    session->isAuthenticated = true;
+    session->worker->markAuthenticated(session);
     updateClientActivity(session);
 
-    // 登录成功后停止登录超时定时器
-    if (session->loginTimer)
-    {
-        session->loginTimer->stop();
-        session->loginTimer->deleteLater();
-        session->loginTimer = nullptr;
-    }
-
     // 发送成功响应 - 使用序列化处理字节序
     quint32 code = qToBigEndian(static_cast<quint32>(ErrorCode::Success));
     QByteArray response(reinterpret_cast<const char *>(&code), sizeof(code));
@@ -516,19 +556,13 @@ void TlsServer::handleLoginRequest(ClientSession *session, const QByteArray &dat
     Logger::instance()->info(
         QString("User logged in successfully: %1").arg(userName));
 }
-void TlsServer::handleReportRequest(ClientSession *session, const QByteArray &data)
+void TlsServer::handleReportRequest(ClientSession *session, QByteArrayView data)
 {
-    // 检查report_dao_是否有效
-    if (!report_dao_)
-    {
-        Logger::instance()->error("ReportDAO is not set");
-        sendResponse(session, MessageType::REPORT_FAIL, QByteArray());
-        return;
-    }
-
     try
     {
+        qint64 parseStartUs = LatencyStats::nowUs();
         ReportRequestData reportData = MessageProtocol::deserializeReportRequest(data);
+        LatencyStats::instance()->record(session->requestType, LatencyStage::Parse, LatencyStats::nowUs() - parseStartUs);
 
         // 创建报告对象
         Report report;
@@ -536,79 +570,55 @@ void TlsServer::handleReportRequest(ClientSession *session, const QByteArray &da
         report.location = reportData.location;
         report.createdAt = QDateTime::currentDateTime();
 
-        // 检查客户端会话中是否有服务器映射
-        if (session->serverIpMap.isEmpty())
+        // 客户端未请求过服务器列表时，由组提交线程使用当前目录快照
+        if (!session->catalog)
         {
             Logger::instance()->warning(
-                QString("No server IP mapping found in session for user %1")
+                QString("No server catalog found in session for user %1")
                     .arg(session->userName),
                 "TlsServer");
+        }
 
-            // 如果会话中没有映射，检查是否有服务器列表并创建映射
-            if (!session->servers.isEmpty())
+        // 报告进入组提交队列，与其他会话的报告在同一个事务中保存，
+        // 事务提交后才回调；目录快照不可修改，在组提交线程中直接读取索引
+        ReportIngestItem item;
+        item.report = report;
+        item.records = reportData.records;
+        item.catalog = session->catalog;
+        item.msgType = session->requestType;
+
+        session->requestInFlight = true;
+        item.done = sessionCallback(
+            session,
+            [this](ClientSession *session, const ReportIngestResult &result)
             {
-                Logger::instance()->info("Creating server IP mapping from session server list", "TlsServer");
-                for (const auto &server : session->servers)
+                // 保存后备方案使用的目录快照
+                if (result.catalog && !session->catalog)
                 {
-                    session->serverIpMap[server.serverId] = server.ipAddr;
+                    session->catalog = result.catalog;
                 }
-            }
-            else
-            {
-                // 如果两者都没有，则从数据库获取（作为后备方案）
-                Logger::instance()->warning("Fetching server list from database as fallback", "TlsServer");
-                QList<ServerInfo> servers = getTestServerList();
-                session->servers = servers;
-                for (const auto &server : servers)
+
+                if (result.code != ErrorCode::Success)
                 {
-                    session->serverIpMap[server.serverId] = server.ipAddr;
+                    Logger::instance()->warning(QString("Failed to create report for user %1: %2")
+                                                    .arg(session->userName)
+                                                    .arg(static_cast<int>(result.code)),
+                                                "TlsServer");
+                    sendErrorResponse(session, MessageType::REPORT_FAIL, result.code);
                 }
-            }
-        }
-
-        // 转换LatencyRecord为ReportRecord
-        QList<ReportRecord> reportRecords;
-        for (const LatencyRecord &record : reportData.records)
-        {
-            ReportRecord reportRecord;
-            reportRecord.serverId = record.serverId;
-            reportRecord.latency = record.latency;
-
-            // 使用映射表查找IP地址
-            quint32 serverIp = 0;
-            if (session->serverIpMap.contains(record.serverId))
-            {
-                serverIp = session->serverIpMap.value(record.serverId);
-            }
-            else
-            {
-                // 如果找不到 IP，记录警告日志
-                Logger::instance()->warning(QString("Failed to find IP for server ID: %1 when processing report from user: %2")
-                                                .arg(record.serverId)
-                                                .arg(session->userName));
-            }
-
-            reportRecord.serverIp = serverIp;
-            reportRecords.append(reportRecord);
-        }
-
-        // 保存报告和记录（使用事务）
-        ErrorCode result = report_dao_->createReport(report, reportRecords);
+                else
+                {
+                    Logger::instance()->info(QString("Report created successfully for user %1")
+                                                 .arg(session->userName),
+                                             "TlsServer");
+                    sendErrorResponse(session, MessageType::REPORT_OK, result.code);
+                }
+            });
 
-        if (result != ErrorCode::Success)
-        {
-            Logger::instance()->warning(QString("Failed to create report for user %1: %2")
-                                            .arg(session->userName)
-                                            .arg(static_cast<int>(result)),
-                                        "TlsServer");
-            sendErrorResponse(session, MessageType::REPORT_FAIL, result);
-        }
-        else
+        if (!ReportIngestQueue::instance()->submit(session->worker, std::move(item)))
         {
-            Logger::instance()->info(QString("Report created successfully for user %1")
-                                         .arg(session->userName),
-                                     "TlsServer");
-            sendErrorResponse(session, MessageType::REPORT_OK, result);
+            session->requestInFlight = false;
+            sendErrorResponse(session, MessageType::REPORT_FAIL, ErrorCode::ServerInternal);
         }
     }
     catch (const std::exception &e)
@@ -620,15 +630,6 @@ void TlsServer::handleReportRequest(ClientSession *session, const QByteArray &da
     }
 }
 
-bool TlsServer::checkClientPermission(const QString &userName, int requiredLevel)
-{
-    if (!user_dao_)
-        return false;
-
-    User user = user_dao_->getUserByUsername(userName);
-    return user.id != 0 && static_cast<int>(user.role) >= requiredLevel;
-}
-
 void TlsServer::sendResponse(ClientSession *session, MessageType type, const QByteArray &data)
 {
     if (!session || !session->socket || !session->socket->isValid())
@@ -636,14 +637,8 @@ void TlsServer::sendResponse(ClientSession *session, MessageType type, const QBy
         return;
     }
 
-    MessageHeader header(type, data.size());
-    QByteArray headerData = MessageProtocol::serializeHeader(header);
-
-    session->socket->write(headerData);
-    if (!data.isEmpty())
-    {
-        session->socket->write(data);
-    }
+    // 消息头和数据写入会话的发送缓冲区，批量处理结束时统一写出
+    session->worker->queueResponse(session, type, data);
 }
 
 // 添加缺失的方法实现
@@ -692,156 +687,14 @@ QString TlsServer::getSslProtocolName(QSslSocket *socket)
     return protocol;
 }
 
-// 修改onSslReady方法以添加更多调试信息
-void TlsServer::onSslReady()
-{
-    QSslSocket *socket = qobject_cast<QSslSocket *>(sender());
-    if (!socket)
-    {
-        return;
-    }
-
-    ClientSession *session = findSessionBySocket(socket);
-    if (!session)
-    {
-        return;
-    }
-
-    // SSL握手完成信息记录
-    QString clientIp = socket->peerAddress().toString();
-    quint16 clientPort = socket->peerPort();
-    QString protocol = getSslProtocolName(socket);
-    QSslCipher cipher = socket->sessionCipher();
-
-    // 验证客户端证书
-    if (config_manager_ && config_manager_->getRequireClientCert())
-    {
-        if (!validateClientSubject(socket))
-        {
-            Logger::instance()->warning(QString("Client certificate validation failed: %1:%2").arg(clientIp).arg(clientPort));
-            socket->disconnectFromHost();
-            return;
-        }
-    }
-
-    Logger::instance()->info(
-        QString("Client connected - SSL handshake completed: %1:%2, Protocol: %3, Cipher: %4")
-            .arg(clientIp)
-            .arg(clientPort)
-            .arg(protocol)
-            .arg(cipher.name()));
-
-    // 添加调试信息，确认socket处于可读状态
-    if (socket->bytesAvailable() > 0)
-    {
-        Logger::instance()->debug(
-            QString("Data already available after SSL handshake: %1 bytes")
-                .arg(socket->bytesAvailable()));
-    }
-}
-
-// 改进onDataReceived方法的错误处理和日志记录
-void TlsServer::onDataReceived()
-{
-    QSslSocket *socket = qobject_cast<QSslSocket *>(sender());
-    if (!socket)
-    {
-        Logger::instance()->error("onDataReceived: Invalid socket");
-        return;
-    }
-
-    ClientSession *session = findSessionBySocket(socket);
-    if (!session)
-    {
-        Logger::instance()->error("onDataReceived: Session not found");
-        socket->disconnectFromHost();
-        return;
-    }
-
-    // 确保socket有效且可读
-    if (!socket->isValid() || !socket->isReadable())
-    {
-        Logger::instance()->error("onDataReceived: Socket is not valid or readable");
-        return;
-    }
-
-    QByteArray data = socket->readAll();
-    QString clientIp = socket->peerAddress().toString();
-    quint16 clientPort = socket->peerPort();
-
-    Logger::instance()->info( // 提高日志级别以便更容易看到数据接收
-        QString("Data received from %1:%2 (size: %3 bytes)")
-            .arg(clientIp)
-            .arg(clientPort)
-            .arg(data.size()));
-
-    // 添加原始数据的十六进制输出用于调试
-    // Logger::instance()->debug(
-    //     QString("Raw data (hex): %1").arg(QString(data.toHex(' '))));
-
-    session->buffer.append(data);
-    updateClientActivity(session); // 每次收到数据都更新活动时间
-
-    // 处理消息
-    while (true)
-    {
-        // 检查缓冲区是否至少有消息头大小
-        if (session->buffer.size() < static_cast<qsizetype>(sizeof(MessageHeader)))
-        {
-            Logger::instance()->debug("Not enough data for message header");
-            break;
-        }
-
-        // 尝试解析消息头
-        try
-        {
-            MessageHeader header = MessageProtocol::deserializeHeader(session->buffer.left(sizeof(MessageHeader)));
-            quint32 totalSize = sizeof(MessageHeader) + header.dataLength;
-
-            Logger::instance()->debug(
-                QString("Message header: type=%1, dataLength=%2, totalSize=%3")
-                    .arg(header.msgType)
-                    .arg(header.dataLength)
-                    .arg(totalSize));
-
-            // 检查缓冲区是否有完整消息
-            if (session->buffer.size() < static_cast<qsizetype>(totalSize))
-            {
-                Logger::instance()->debug("Waiting for more data");
-                break;
-            }
-
-            // 提取有效载荷并处理消息
-            QByteArray payload = session->buffer.mid(sizeof(MessageHeader), header.dataLength);
-            processMessage(session, header, payload);
-            session->buffer.remove(0, totalSize);
-        }
-        catch (const std::exception &e)
-        {
-            Logger::instance()->error(
-                QString("Error processing message: %1").arg(e.what()));
-            // 出现严重错误，清空缓冲区并断开连接
-            session->buffer.clear();
-            socket->disconnectFromHost();
-            break;
-        }
-        catch (...)
-        {
-            Logger::instance()->error("Unknown error processing message");
-            session->buffer.clear();
-            socket->disconnectFromHost();
-            break;
-        }
-    }
-}
-
 // 增强updateClientActivity方法以记录活动
 void TlsServer::updateClientActivity(ClientSession *session)
 {
     if (!session)
         return;
 
-    session->lastActiveTime = QDateTime::currentDateTime();
+    // 重新计算空闲超时（时间轮O(1)操作）
+    session->worker->refreshIdleTimeout(session);
 
     // 添加socket非空检查，防止段错误
     if (session->socket && session->socket->isValid())
@@ -852,84 +705,7 @@ void TlsServer::updateClientActivity(ClientSession *session)
                 .arg(session->socket->peerPort()));
     }
 }
-// 修改onSslErrors方法，智能区分不同类型的SSL错误
-void TlsServer::onSslErrors(const QList<QSslError> &errors)
-{
-    QSslSocket *socket = qobject_cast<QSslSocket *>(sender());
-    if (!socket)
-    {
-        return;
-    }
-
-    // 记录所有SSL错误
-    bool hasCriticalError = false;
-    bool hasCertificateError = false;
-
-    for (const QSslError &error : errors)
-    {
-        Logger::instance()->warning(
-            QString("SSL Error: %1(%2)").arg(error.error()).arg(error.errorString()));
-
-        // 检查是否是与证书相关的错误
-        if (error.error() == QSslError::SelfSignedCertificate ||
-            error.error() == QSslError::SelfSignedCertificateInChain ||
-            error.error() == QSslError::InvalidCaCertificate ||
-            error.error() == QSslError::CertificateUntrusted ||
-            error.error() == QSslError::CertificateRevoked ||
-            error.error() == QSslError::InvalidPurpose ||
-            error.error() == QSslError::CertificateExpired ||
-            error.error() == QSslError::CertificateNotYetValid ||
-            error.error() == QSslError::HostNameMismatch ||
-            error.error() == QSslError::NoPeerCertificate ||
-            error.error() == QSslError::UnableToGetLocalIssuerCertificate ||
-            error.error() == QSslError::UnableToVerifyFirstCertificate)
-        {
-
-            hasCertificateError = true;
-
-            // 标记关键证书错误
-            if (error.error() == QSslError::NoPeerCertificate ||
-                error.error() == QSslError::CertificateExpired ||
-                error.error() == QSslError::CertificateNotYetValid ||
-                error.error() == QSslError::CertificateUntrusted ||
-                error.error() == QSslError::CertificateRevoked)
-            {
-                hasCriticalError = true;
-            }
-        }
-    }
-    QString clientIp = socket->peerAddress().toString();
-    quint16 clientPort = socket->peerPort();
-
-    // 检查是否需要客户端证书
-    if (config_manager_ && config_manager_->getRequireClientCert())
-    {
-
-        // 对于需要客户端证书的情况，只在关键证书验证错误时断开连接
-        if (hasCriticalError || hasCertificateError)
-        {
-            Logger::instance()->warning(QString("Client certificate validation failed, closing connection:%1:%2").arg(clientIp).arg(clientPort));
-            socket->disconnectFromHost();
-            return;
-        }
-        if (!validateClientSubject(socket))
-        {
-            Logger::instance()->warning(QString("Client subject validation failed: %1:%2").arg(clientIp).arg(clientPort));
-            socket->disconnectFromHost();
-            return;
-        }
-    }
-    socket->ignoreSslErrors(); // 忽略错误，继续握手
-}
-
-// 添加findSessionBySocket方法实现
-ClientSession *TlsServer::findSessionBySocket(QSslSocket *socket)
-{
-    QMutexLocker locker(&clients_mutex_);
-    return clients_.value(socket, nullptr);
-}
-
-void TlsServer::processMessage(ClientSession *session, const MessageHeader &header, const QByteArray &data)
+void TlsServer::processMessage(ClientSession *session, const MessageHeader &header, QByteArrayView data)
 {
     if (!session || !session->socket)
     {
@@ -937,6 +713,9 @@ void TlsServer::processMessage(ClientSession *session, const MessageHeader &head
     }
 
     MessageType msgType = static_cast<MessageType>(header.msgType);
+    session->requestType = header.msgType;
+    session->requestStartUs = LatencyStats::nowUs();
+
     QString clientIp = session->socket->peerAddress().toString();
     quint16 clientPort = session->socket->peerPort();
     QString userName = session->userName.isEmpty() ? "(unauthenticated)" : session->userName;
@@ -959,6 +738,10 @@ void TlsServer::processMessage(ClientSession *session, const MessageHeader &head
         Logger::instance()->debug("Handling LIST_REQUEST message");
         handleListRequest(session);
         break;
+    case MessageType::LIST_DELTA_REQUEST:
+        Logger::instance()->debug("Handling LIST_DELTA_REQUEST message");
+        handleListDeltaRequest(session, data);
+        break;
     case MessageType::REPORT_REQUEST:
         Logger::instance()->debug("Handling REPORT_REQUEST message");
         handleReportRequest(session, data);
@@ -976,8 +759,15 @@ void TlsServer::processMessage(ClientSession *session, const MessageHeader &head
         sendErrorResponse(session, MessageType::LOGIN_FAIL, ErrorCode::InvalidParameter);
         break;
     }
+
+    // 提交了数据库任务的请求在任务完成时统计总耗时
+    if (!session->requestInFlight)
+    {
+        LatencyStats::instance()->record(header.msgType, LatencyStage::Total,
+                                         LatencyStats::nowUs() - session->requestStartUs);
+    }
 }
-void TlsServer::handleChangePasswordRequest(ClientSession *session, const QByteArray &data)
+void TlsServer::handleChangePasswordRequest(ClientSession *session, QByteArrayView data)
 {
     if (!session)
     {
@@ -986,15 +776,10 @@ void TlsServer::handleChangePasswordRequest(ClientSession *session, const QByteA
         return;
     }
 
-    if (!user_dao_)
-    {
-        Logger::instance()->error("UserDAO not set, cannot process password change request");
-        sendErrorResponse(session, MessageType::CHANGE_PASSWORD_RESPONSE, ErrorCode::ServerInternal);
-        return;
-    }
-
     // 反序列化密码修改请求数据
+    qint64 parseStartUs = LatencyStats::nowUs();
     ChangePasswordRequestData requestData = MessageProtocol::deserializeChangePasswordRequest(data);
+    LatencyStats::instance()->record(session->requestType, LatencyStage::Parse, LatencyStats::nowUs() - parseStartUs);
 
     // 检查反序列化结果是否有效（检查userName第一个字符是否为空字符）
     if (strlen(requestData.userName) == 0 || strlen(requestData.oldPassword) == 0 || strlen(requestData.newPassword) == 0 ||
@@ -1005,52 +790,75 @@ void TlsServer::handleChangePasswordRequest(ClientSession *session, const QByteA
         return;
     }
 
-    // 获取用户信息
-    User user = user_dao_->getUserByUsername(requestData.userName);
-    if (user.id == -1)
-    {
-        Logger::instance()->warning(QString("User not found: %1").arg(session->userName));
-        sendErrorResponse(session, MessageType::CHANGE_PASSWORD_RESPONSE, ErrorCode::UserNotFound);
-        return;
-    }
-
-    // 验证旧密码
+    QString userName = QString::fromUtf8(requestData.userName);
     QString oldPassword = QString::fromUtf8(requestData.oldPassword).trimmed();
-    if (!PasswordUtils::verifyPassword(oldPassword, user.passwordHash, user.salt))
-    {
-        Logger::instance()->warning(QString("Incorrect old password for user: %1").arg(session->userName));
-        sendErrorResponse(session, MessageType::CHANGE_PASSWORD_RESPONSE, ErrorCode::InvalidPassword);
-        return;
-    }
-
-    // 验证新密码强度
     QString newPassword = QString::fromUtf8(requestData.newPassword).trimmed();
-    if (!PasswordUtils::validatePasswordStrength(newPassword))
-    {
-        Logger::instance()->warning(QString("New password does not meet strength requirements for user: %1").arg(session->userName));
-        sendErrorResponse(session, MessageType::CHANGE_PASSWORD_RESPONSE, ErrorCode::PasswordTooSimple);
-        return;
-    }
+    QString sessionUser = session->userName;
 
-    // 生成新的盐值和密码哈希
-    QString newSalt = PasswordUtils::generateSalt();
-    QString newPasswordHash = PasswordUtils::generatePasswordHash(newPassword, newSalt);
+    // 查询、校验和更新在同一个DB任务中完成
+    bool submitted = submitDbRequest(
+        session,
+        [userName, oldPassword, newPassword, sessionUser](DbContext &db)
+        {
+            ChangePasswordJobResult result;
 
-    // 更新用户密码
-    ErrorCode result = user_dao_->updateUserPassword(user.id, newPasswordHash, newSalt);
-    if (result != ErrorCode::Success)
-    {
-        Logger::instance()->error(QString("Failed to update password for user: %1, error: %2").arg(session->userName).arg(static_cast<int>(result)));
-        sendErrorResponse(session, MessageType::CHANGE_PASSWORD_RESPONSE, result);
-        return;
-    }
+            // 获取用户信息
+            User user = db.userDao->getUserByUsername(userName);
+            if (user.id == -1)
+            {
+                Logger::instance()->warning(QString("User not found: %1").arg(sessionUser));
+                result.code = ErrorCode::UserNotFound;
+                return result;
+            }
 
-    // 密码更新成功
-    Logger::instance()->info(QString("Password changed successfully for user: %1").arg(session->userName));
+            // 验证旧密码
+            if (!PasswordUtils::verifyPassword(oldPassword, user.passwordHash, user.salt))
+            {
+                Logger::instance()->warning(QString("Incorrect old password for user: %1").arg(sessionUser));
+                result.code = ErrorCode::InvalidPassword;
+                return result;
+            }
+
+            // 验证新密码强度
+            if (!PasswordUtils::validatePasswordStrength(newPassword))
+            {
+                Logger::instance()->warning(QString("New password does not meet strength requirements for user: %1").arg(sessionUser));
+                result.code = ErrorCode::PasswordTooSimple;
+                return result;
+            }
 
-    // 构建并发送成功响应
-    QByteArray response = MessageProtocol::serializeChangePasswordResponse(static_cast<quint32>(ErrorCode::Success));
-    sendResponse(session, MessageType::CHANGE_PASSWORD_RESPONSE, response);
+            // 生成新的盐值和密码哈希
+            QString newSalt = PasswordUtils::generateSalt();
+            QString newPasswordHash = PasswordUtils::generatePasswordHash(newPassword, newSalt);
+
+            // 更新用户密码
+            result.code = db.userDao->updateUserPassword(user.id, newPasswordHash, newSalt);
+            if (result.code != ErrorCode::Success)
+            {
+                Logger::instance()->error(QString("Failed to update password for user: %1, error: %2").arg(sessionUser).arg(static_cast<int>(result.code)));
+            }
+            return result;
+        },
+        [this](ClientSession *session, const ChangePasswordJobResult &result)
+        {
+            if (result.code != ErrorCode::Success)
+            {
+                sendErrorResponse(session, MessageType::CHANGE_PASSWORD_RESPONSE, result.code);
+                return;
+            }
+
+            // 密码更新成功
+            Logger::instance()->info(QString("Password changed successfully for user: %1").arg(session->userName));
+
+            // 构建并发送成功响应
+            QByteArray response = MessageProtocol::serializeChangePasswordResponse(static_cast<quint32>(ErrorCode::Success));
+            sendResponse(session, MessageType::CHANGE_PASSWORD_RESPONSE, response);
+        });
+
+    if (!submitted)
+    {
+        sendErrorResponse(session, MessageType::CHANGE_PASSWORD_RESPONSE, ErrorCode::ServerInternal);
+    }
 }
 
 void TlsServer::handleListRequest(ClientSession *session)
@@ -1061,50 +869,57 @@ void TlsServer::handleListRequest(ClientSession *session)
         return;
     }
 
-    // 获取服务器列表并创建ID到IP的映射
-    QList<ServerInfo> servers = getTestServerList();
-
-    // 保存服务器列表到客户端会话中
-    session->servers = servers;
-
-    // 创建并保存服务器ID到IP的映射
-    QMap<quint32, quint32> ipMap;
-    for (const auto &server : servers)
-    {
-        ipMap[server.serverId] = server.ipAddr;
-    }
-    session->serverIpMap = ipMap;
+    // 服务器列表来自目录的当前快照，不访问数据库；
+    // 会话只持有快照的引用，上传报告时按该版本的索引查找IP
+    ServerCatalogSnapshotPtr catalog = ServerCatalog::instance()->snapshot();
+    session->catalog = catalog;
 
-    // 记录日志
-    Logger::instance()->info(
-        QString("Stored %1 servers and their IP mapping in session for user %2")
-            .arg(servers.size())
+    Logger::instance()->debug(
+        QString("Stored %1 servers (catalog version %2) in session for user %3")
+            .arg(catalog->servers.size())
+            .arg(catalog->version)
             .arg(session->userName),
         "TlsServer");
 
-    // 发送服务器列表响应
-    QByteArray response = MessageProtocol::serializeListResponse(servers);
-    sendResponse(session, MessageType::LIST_RESPONSE, response);
+    // 发送目录发布时已序列化的服务器列表响应
+    ServerCatalog::instance()->recordListResponse(ListDeltaKind::Full, catalog->listResponse.size());
+    sendResponse(session, MessageType::LIST_RESPONSE, catalog->listResponse);
 }
 
-// 修改getTestServerList方法使用数据库查询
-QList<ServerInfo> TlsServer::getTestServerList()
+void TlsServer::handleListDeltaRequest(ClientSession *session, QByteArrayView data)
 {
-    // 如果ServerDAO未设置，返回空列表并记录错误
-    if (!server_dao_)
+    if (!session->isAuthenticated)
+    {
+        sendErrorResponse(session, MessageType::LOGIN_FAIL, ErrorCode::PermissionDenied);
+        return;
+    }
+
+    if (data.size() < 8)
     {
-        Logger::instance()->error("ServerDAO not set, cannot retrieve server list");
-        return QList<ServerInfo>();
+        sendErrorResponse(session, MessageType::LIST_DELTA_RESPONSE, ErrorCode::InvalidData);
+        return;
     }
 
-    // 从数据库获取活跃的服务器列表
-    QList<ServerInfo> servers = server_dao_->getActiveServers();
+    ListDeltaRequestData request = MessageProtocol::deserializeListDeltaRequest(data);
 
-    Logger::instance()->info(
-        QString("Retrieved %1 active servers from database")
-            .arg(servers.size()));
+    // 无论返回哪种响应，客户端更新后的列表都与当前快照一致
+    ServerCatalogSnapshotPtr catalog = ServerCatalog::instance()->snapshot();
+    session->catalog = catalog;
+
+    ListDeltaKind kind;
+    const QByteArray &response = catalog->listDeltaResponse(request.catalogVersion, kind);
+
+    Logger::instance()->debug(
+        QString("List delta for user %1: client version %2, catalog version %3, %4 response (%5 bytes)")
+            .arg(session->userName)
+            .arg(request.catalogVersion)
+            .arg(catalog->version)
+            .arg(kind == ListDeltaKind::NotModified ? "not modified" : (kind == ListDeltaKind::Delta ? "delta" : "full"))
+            .arg(response.size()),
+        "TlsServer");
 
-    return servers;
+    ServerCatalog::instance()->recordListResponse(kind, response.size());
+    sendResponse(session, MessageType::LIST_DELTA_RESPONSE, response);
 }
 
 void TlsServer::cleanupSession(ClientSession *session)
@@ -0,0 +1,423 @@
+#include "server/tls_session_cache.h"
+#include "logger/logger.h"
+
+#include <QMutexLocker>
+#include <openssl/rand.h>
+#include <openssl/crypto.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+#endif
+#include <cstring>
+#include <mutex>
+
+int TlsSessionCache::ssl_ex_index_ = -1;
+int TlsSessionCache::ctx_ex_index_ = -1;
+
+namespace
+{
+// 当前线程正在生效的作用域（startServerEncryption期间）
+thread_local TlsSessionCache::Scope *currentScope = nullptr;
+
+// 会话ID上下文：启用客户端证书验证时OpenSSL要求设置，否则拒绝复用会话
+const unsigned char kSessionIdContext[] = "latcheck_server";
+} // namespace
+
+TlsSessionCache::TlsSessionCache(const TlsSessionSettings &settings)
+    : settings_(settings),
+      has_previous_key_(false),
+      full_handshakes_(0),
+      resumed_handshakes_(0),
+      cache_hits_(0),
+      cache_misses_(0)
+{
+    clock_.start();
+
+    if (settings_.enabled && !installHooks())
+    {
+        Logger::instance()->error("Failed to register OpenSSL hooks, TLS session resumption disabled", "TlsSessionCache");
+        settings_.enabled = false;
+    }
+
+    if (settings_.enabled && settings_.enableTickets && !generateTicketKey(current_key_))
+    {
+        Logger::instance()->error("Failed to generate session ticket key, session tickets disabled", "TlsSessionCache");
+        settings_.enableTickets = false;
+    }
+
+    Logger::instance()->info(
+        QString("TLS session resumption: %1 (tickets: %2, cache size: %3, timeout: %4s, ticket key rotation: %5s)")
+            .arg(settings_.enabled ? "enabled" : "disabled")
+            .arg(settings_.enableTickets ? "enabled" : "disabled")
+            .arg(settings_.cacheSize)
+            .arg(settings_.sessionTimeout)
+            .arg(settings_.ticketRotationInterval),
+        "TlsSessionCache");
+}
+
+TlsSessionCache::~TlsSessionCache()
+{
+    // 清除密钥材料
+    OPENSSL_cleanse(&current_key_, sizeof(current_key_));
+    OPENSSL_cleanse(&previous_key_, sizeof(previous_key_));
+}
+
+TlsSessionCache::Scope::Scope(TlsSessionCache *cache)
+    : cache_(cache), ssl_(nullptr), previous_(currentScope)
+{
+    currentScope = this;
+}
+
+TlsSessionCache::Scope::~Scope()
+{
+    currentScope = previous_;
+}
+
+bool TlsSessionCache::installHooks()
+{
+    static std::once_flag once;
+    std::call_once(once, []()
+                   {
+        ssl_ex_index_ = SSL_get_ex_new_index(0, nullptr, &TlsSessionCache::onSslNew, nullptr, nullptr);
+        ctx_ex_index_ = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr); });
+
+    return ssl_ex_index_ >= 0 && ctx_ex_index_ >= 0;
+}
+
+void TlsSessionCache::onSslNew(void *parent, void *, CRYPTO_EX_DATA *, int, long, void *)
+{
+    // 只处理当前线程作用域内创建的SSL对象
+    Scope *scope = currentScope;
+    if (!scope || !scope->cache_ || !parent)
+    {
+        return;
+    }
+
+    SSL *ssl = static_cast<SSL *>(parent);
+    scope->ssl_ = ssl;
+    scope->cache_->attach(ssl);
+}
+
+void TlsSessionCache::attach(SSL *ssl)
+{
+    if (!settings_.enabled)
+    {
+        return;
+    }
+
+    // SSL_new时SSL_CTX已由Qt配置完毕，此处设置的回调在握手时才读取
+    SSL_CTX *ctx = SSL_get_SSL_CTX(ssl);
+    SSL_CTX_set_ex_data(ctx, ctx_ex_index_, this);
+
+    // 每个连接的SSL_CTX都是新建的，内部缓存无法跨连接使用，改用外部缓存
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+    SSL_CTX_sess_set_new_cb(ctx, &TlsSessionCache::newSessionCallback);
+    SSL_CTX_sess_set_get_cb(ctx, &TlsSessionCache::getSessionCallback);
+    SSL_CTX_sess_set_remove_cb(ctx, &TlsSessionCache::removeSessionCallback);
+    SSL_CTX_set_timeout(ctx, settings_.sessionTimeout);
+
+    if (settings_.enableTickets)
+    {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx, &TlsSessionCache::ticketKeyCallback);
+#else
+        SSL_CTX_set_tlsext_ticket_key_cb(ctx, &TlsSessionCache::ticketKeyCallback);
+#endif
+        SSL_clear_options(ssl, SSL_OP_NO_TICKET);
+    }
+    else
+    {
+        SSL_set_options(ssl, SSL_OP_NO_TICKET);
+    }
+
+    // 会话ID上下文在SSL_new时已从SSL_CTX复制，需直接设置到SSL对象上
+    SSL_set_session_id_context(ssl, kSessionIdContext, sizeof(kSessionIdContext) - 1);
+}
+
+TlsSessionCache *TlsSessionCache::fromSsl(SSL *ssl)
+{
+    if (!ssl || ctx_ex_index_ < 0)
+    {
+        return nullptr;
+    }
+    return static_cast<TlsSessionCache *>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), ctx_ex_index_));
+}
+
+bool TlsSessionCache::recordHandshake(void *sslHandle)
+{
+    SSL *ssl = static_cast<SSL *>(sslHandle);
+    bool resumed = ssl && SSL_session_reused(ssl);
+
+    if (resumed)
+    {
+        resumed_handshakes_.ref();
+    }
+    else
+    {
+        full_handshakes_.ref();
+    }
+    return resumed;
+}
+
+int TlsSessionCache::getCachedSessionCount() const
+{
+    QMutexLocker locker(&cache_mutex_);
+    return sessions_.size();
+}
+
+int TlsSessionCache::newSessionCallback(SSL *ssl, SSL_SESSION *session)
+{
+    TlsSessionCache *cache = fromSsl(ssl);
+    if (!cache)
+    {
+        return 0;
+    }
+
+    unsigned int idLength = 0;
+    const unsigned char *id = SSL_SESSION_get_id(session, &idLength);
+    if (idLength == 0)
+    {
+        return 0;
+    }
+
+    // 以DER格式保存，取出时重新解析，缓存不持有OpenSSL对象
+    int length = i2d_SSL_SESSION(session, nullptr);
+    if (length <= 0)
+    {
+        return 0;
+    }
+
+    QByteArray der(length, Qt::Uninitialized);
+    unsigned char *out = reinterpret_cast<unsigned char *>(der.data());
+    i2d_SSL_SESSION(session, &out);
+
+    cache->storeSession(QByteArray(reinterpret_cast<const char *>(id), idLength), der);
+
+    // 返回0表示未持有session的引用
+    return 0;
+}
+
+SSL_SESSION *TlsSessionCache::getSessionCallback(SSL *ssl, const unsigned char *id, int idLength, int *copy)
+{
+    *copy = 0;
+
+    TlsSessionCache *cache = fromSsl(ssl);
+    if (!cache)
+    {
+        return nullptr;
+    }
+
+    QByteArray der = cache->lookupSession(QByteArray(reinterpret_cast<const char *>(id), idLength));
+    if (der.isEmpty())
+    {
+        cache->cache_misses_.ref();
+        return nullptr;
+    }
+
+    const unsigned char *in = reinterpret_cast<const unsigned char *>(der.constData());
+    SSL_SESSION *session = d2i_SSL_SESSION(nullptr, &in, der.size());
+    if (session)
+    {
+        cache->cache_hits_.ref();
+    }
+    else
+    {
+        cache->cache_misses_.ref();
+    }
+
+    // copy为0时OpenSSL接管返回的会话对象
+    return session;
+}
+
+void TlsSessionCache::removeSessionCallback(SSL_CTX *ctx, SSL_SESSION *session)
+{
+    TlsSessionCache *cache = static_cast<TlsSessionCache *>(SSL_CTX_get_ex_data(ctx, ctx_ex_index_));
+    if (!cache)
+    {
+        return;
+    }
+
+    unsigned int idLength = 0;
+    const unsigned char *id = SSL_SESSION_get_id(session, &idLength);
+    if (idLength > 0)
+    {
+        cache->removeSession(QByteArray(reinterpret_cast<const char *>(id), idLength));
+    }
+}
+
+void TlsSessionCache::storeSession(const QByteArray &id, const QByteArray &session)
+{
+    QMutexLocker locker(&cache_mutex_);
+
+    auto it = sessions_.find(id);
+    if (it != sessions_.end())
+    {
+        order_.erase(it->order);
+        sessions_.erase(it);
+    }
+
+    // 超出容量时淘汰最旧的会话
+    while (!order_.empty() && sessions_.size() >= settings_.cacheSize)
+    {
+        sessions_.remove(order_.front());
+        order_.pop_front();
+    }
+
+    CacheEntry entry;
+    entry.session = session;
+    entry.expireAt = clock_.elapsed() + settings_.sessionTimeout * 1000LL;
+    entry.order = order_.insert(order_.end(), id);
+    sessions_.insert(id, entry);
+}
+
+QByteArray TlsSessionCache::lookupSession(const QByteArray &id)
+{
+    QMutexLocker locker(&cache_mutex_);
+
+    auto it = sessions_.find(id);
+    if (it == sessions_.end())
+    {
+        return QByteArray();
+    }
+
+    if (it->expireAt <= clock_.elapsed())
+    {
+        order_.erase(it->order);
+        sessions_.erase(it);
+        return QByteArray();
+    }
+
+    return it->session;
+}
+
+void TlsSessionCache::removeSession(const QByteArray &id)
+{
+    QMutexLocker locker(&cache_mutex_);
+
+    auto it = sessions_.find(id);
+    if (it != sessions_.end())
+    {
+        order_.erase(it->order);
+        sessions_.erase(it);
+    }
+}
+
+bool TlsSessionCache::generateTicketKey(TicketKey &key)
+{
+    if (RAND_bytes(key.name, sizeof(key.name)) <= 0 ||
+        RAND_bytes(key.aesKey, sizeof(key.aesKey)) <= 0 ||
+        RAND_bytes(key.hmacKey, sizeof(key.hmacKey)) <= 0)
+    {
+        return false;
+    }
+    key.createdAt = clock_.elapsed();
+    return true;
+}
+
+bool TlsSessionCache::currentTicketKey(TicketKey &key)
+{
+    QMutexLocker locker(&ticket_mutex_);
+
+    // 到达轮换间隔后生成新密钥，旧密钥保留一个周期用于解密已签发的票据
+    qint64 interval = qMax(1, settings_.ticketRotationInterval) * 1000LL;
+    if (clock_.elapsed() - current_key_.createdAt >= interval)
+    {
+        TicketKey next;
+        if (generateTicketKey(next))
+        {
+            previous_key_ = current_key_;
+            has_previous_key_ = true;
+            current_key_ = next;
+            Logger::instance()->info("Session ticket key rotated", "TlsSessionCache");
+        }
+        OPENSSL_cleanse(&next, sizeof(next));
+    }
+
+    key = current_key_;
+    return true;
+}
+
+bool TlsSessionCache::findTicketKey(const unsigned char *name, TicketKey &key, bool &renew)
+{
+    QMutexLocker locker(&ticket_mutex_);
+
+    qint64 interval = qMax(1, settings_.ticketRotationInterval) * 1000LL;
+    qint64 now = clock_.elapsed();
+
+    if (memcmp(name, current_key_.name, sizeof(current_key_.name)) == 0)
+    {
+        key = current_key_;
+        // 当前密钥已超过轮换间隔时，让OpenSSL用新密钥重新签发票据
+        renew = now - current_key_.createdAt >= interval;
+        return true;
+    }
+
+    // 上一把密钥只在轮换后的一个周期内有效
+    if (has_previous_key_ &&
+        memcmp(name, previous_key_.name, sizeof(previous_key_.name)) == 0 &&
+        now - current_key_.createdAt < interval)
+    {
+        key = previous_key_;
+        renew = true;
+        return true;
+    }
+
+    return false;
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+int TlsSessionCache::ticketKeyCallback(SSL *ssl, unsigned char *keyName, unsigned char *iv,
+                                       EVP_CIPHER_CTX *cipherCtx, EVP_MAC_CTX *macCtx, int enc)
+#else
+int TlsSessionCache::ticketKeyCallback(SSL *ssl, unsigned char *keyName, unsigned char *iv,
+                                       EVP_CIPHER_CTX *cipherCtx, HMAC_CTX *hmacCtx, int enc)
+#endif
+{
+    TlsSessionCache *cache = fromSsl(ssl);
+    if (!cache)
+    {
+        return enc ? -1 : 0;
+    }
+
+    TicketKey key;
+    bool renew = false;
+
+    if (enc)
+    {
+        // 签发票据：使用当前密钥，随机IV
+        cache->currentTicketKey(key);
+        if (RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) <= 0)
+        {
+            OPENSSL_cleanse(&key, sizeof(key));
+            return -1;
+        }
+        memcpy(keyName, key.name, sizeof(key.name));
+    }
+    else if (!cache->findTicketKey(keyName, key, renew))
+    {
+        // 未知或已过期的密钥：回退到完整握手
+        return 0;
+    }
+
+    bool ok = enc ? EVP_EncryptInit_ex(cipherCtx, EVP_aes_256_cbc(), nullptr, key.aesKey, iv) == 1
+                  : EVP_DecryptInit_ex(cipherCtx, EVP_aes_256_cbc(), nullptr, key.aesKey, iv) == 1;
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    char digest[] = "SHA256";
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, key.hmacKey, sizeof(key.hmacKey)),
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest, 0),
+        OSSL_PARAM_construct_end()};
+    ok = ok && EVP_MAC_CTX_set_params(macCtx, params) == 1;
+#else
+    ok = ok && HMAC_Init_ex(hmacCtx, key.hmacKey, sizeof(key.hmacKey), EVP_sha256(), nullptr) == 1;
+#endif
+
+    OPENSSL_cleanse(&key, sizeof(key));
+
+    if (!ok)
+    {
+        return -1;
+    }
+    return renew ? 2 : 1;
+}